@@ -0,0 +1,379 @@
+/*
+ * button_trace.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <unistd.h>         // POSIX API
+#include <fcntl.h>          // File controls
+#include <pthread.h>        // Trace lock
+#include <sys/mman.h>       // mmap
+#include <sys/stat.h>       // fstat
+
+#include "gpio.h"
+#include "gpio_mmap.h"
+#include "fm_clock.h"
+#include "fm_probes.h"
+#include "button_trace.h"   // Its header file
+
+typedef enum TraceMode {
+    TRACE_OFF = 0,          // Plain GPIO reads
+    TRACE_RECORD,           // GPIO reads, edges logged
+    TRACE_REPLAY            // Levels from the trace
+} TraceMode;
+
+typedef struct Pin {
+    uint8_t gpio;           // GPIO number
+    uint8_t level;          // Last recorded or replayed level
+} Pin;
+
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TraceMode mode = TRACE_OFF;
+static Pin pins[BTRACE_MAX_PINS];
+static uint8_t pin_count = 0;
+static BTrace_Stats stats;
+static uint64_t start_us = 0;           // Recording or replay start
+static uint64_t last_us = 0;            // Recording: time of the last record
+static int trace_fd = -1;               // Recording: the trace file
+static const BTrace_Record *p_records;  // Replay: the mapped records
+static uint32_t cursor = 0;             // Replay: next record to apply
+static uint64_t cursor_at_us = 0;       // Replay: trace time of the next record
+static uint64_t cursor_since_us = 0;    // Replay: when the next record became next
+
+/****************************************************************
+ * Function Name : findPin (private)
+ * Description   : Get the state of a button, adding it if new.
+ *                 Call with trace_mutex held.
+ * Returns       : the pin, NULL if the table is full
+ * Params        @gpio: the button's GPIO number
+ ****************************************************************/
+static Pin* findPin (uint8_t gpio)
+{
+    uint8_t index = 0;
+
+    for (index = 0; index < pin_count; index++)
+    {
+        if (pins[index].gpio == gpio)
+        {
+            return &pins[index];
+        }
+    }
+    if (pin_count >= BTRACE_MAX_PINS)
+    {
+        return NULL;
+    }
+    pins[pin_count].gpio = gpio;
+    pins[pin_count].level = 0;
+    return &pins[pin_count++];
+}
+
+/****************************************************************
+ * Function Name : readPin (private)
+ * Description   : Read a button from the mapped GPIO bank if it is
+ *                 mapped, from sysfs otherwise
+ * Returns       : 1 if pressed, 0 if released, -1 on failure
+ * Params        @gpio: the button's GPIO number
+ ****************************************************************/
+static int readPin (uint8_t gpio)
+{
+    int level = GPIOMmap_ReadValue(gpio);
+
+    return (level >= 0) ? level : GPIO_ReadValue(gpio);
+}
+
+/****************************************************************
+ * Function Name : advance (private)
+ * Description   : Move the replay to the next record.
+ *                 Call with trace_mutex held.
+ * Returns       : void
+ * Params        @now_us: current time
+ ****************************************************************/
+static void advance (uint64_t now_us)
+{
+    cursor++;
+    cursor_since_us = now_us;
+    if (cursor < stats.total)
+    {
+        cursor_at_us += p_records[cursor].delta_us;
+        return;
+    }
+    stats.elapsed_us = now_us - start_us;
+    printf("INFO: ButtonTrace - Replay done, %u edges in %llu ms (%u skipped)\n",
+           stats.events, (unsigned long long) (stats.elapsed_us / 1000), stats.skipped);
+}
+
+/****************************************************************
+ * Function Name : replayValue (private)
+ * Description   : Apply the next record if it is due and belongs to
+ *                 the button, or skip it if its button is never read.
+ *                 Call with trace_mutex held.
+ * Returns       : the replayed level of the button
+ * Params        @p_pin: the button
+ ****************************************************************/
+static int replayValue (Pin *p_pin)
+{
+    uint64_t now_us = FMClock_NowUs();
+    uint64_t due_us = 0;    // When the next record should apply
+
+    if (cursor >= stats.total)
+    {
+        return p_pin->level;
+    }
+    due_us = start_us + ((stats.speed > 0) ? (cursor_at_us / stats.speed) : 0);
+    if (now_us < due_us)
+    {
+        return p_pin->level;
+    }
+
+    if (p_records[cursor].gpio == p_pin->gpio)
+    {
+        p_pin->level = p_records[cursor].level;
+        stats.events++;
+        advance(now_us);
+    }
+    else if ((now_us - ((due_us > cursor_since_us) ? due_us : cursor_since_us)) > BTRACE_STALL_US)
+    {
+        stats.skipped++;
+        advance(now_us);
+    }
+    return p_pin->level;
+}
+
+/****************************************************************
+ * Function Name : logLevel (private)
+ * Description   : Append a record if the level of a pin changed.
+ *                 Call with trace_mutex held.
+ * Returns       : void
+ * Params        @gpio: the GPIO number
+ *               @level: its level
+ ****************************************************************/
+static void logLevel (uint8_t gpio, uint8_t level)
+{
+    BTrace_Record record;
+    uint64_t now_us = 0;
+    Pin *p_pin = findPin(gpio);
+
+    if ((p_pin != NULL) && (level != p_pin->level) && (trace_fd >= 0))
+    {
+        now_us = FMClock_NowUs();
+        record.delta_us = ((now_us - last_us) > UINT32_MAX) ? UINT32_MAX : (uint32_t) (now_us - last_us);
+        record.gpio = gpio;
+        record.level = level;
+        if (write(trace_fd, &record, sizeof(record)) == sizeof(record))
+        {
+            last_us = now_us;
+            p_pin->level = level;
+            stats.events++;
+        }
+    }
+}
+
+/****************************************************************
+ * Function Name : ButtonTrace_Record
+ * Description   : Start logging the button edges to a trace file
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: the trace file, truncated
+ *               @freq_khz: the current station
+ *               @audio: the current audio state
+ ****************************************************************/
+extern int ButtonTrace_Record (const char *p_path, uint32_t freq_khz, uint8_t audio)
+{
+    BTrace_Header header = { BTRACE_MAGIC, BTRACE_VERSION, sizeof(BTrace_Record), freq_khz, audio, { 0 } };
+    int fd = open(p_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+        perror("ERROR: ButtonTrace - Failed to create the trace");
+        return -1;
+    }
+    if (write(fd, &header, sizeof(header)) != sizeof(header))
+    {
+        perror("ERROR: ButtonTrace - Failed to write the trace header");
+        (void) close(fd);
+        return -1;
+    }
+
+    (void) pthread_mutex_lock(&trace_mutex);
+    trace_fd = fd;
+    start_us = FMClock_NowUs();
+    last_us = start_us;
+    mode = TRACE_RECORD;
+    (void) pthread_mutex_unlock(&trace_mutex);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : ButtonTrace_Replay
+ * Description   : Feed the button levels from a trace instead of
+ *                 the GPIO, starting now
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: the trace file
+ *               @speed: 1 = real time, N = N times faster,
+ *                       0 = every edge on the next read
+ *               @p_freq_khz: to store the station the recording
+ *                            started on
+ *               @p_audio: to store the audio state it started with
+ ****************************************************************/
+extern int ButtonTrace_Replay (const char *p_path, uint32_t speed, uint32_t *p_freq_khz, uint8_t *p_audio)
+{
+    const BTrace_Header *p_header;
+    struct stat info;
+    void *p_map;
+    int fd = open(p_path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        perror("ERROR: ButtonTrace - Failed to open the trace");
+        return -1;
+    }
+    if ((fstat(fd, &info) < 0) || (info.st_size < (off_t) sizeof(BTrace_Header)))
+    {
+        printf("ERROR: ButtonTrace - %s is not a button trace\n", p_path);
+        (void) close(fd);
+        return -1;
+    }
+    /* The trace is read in place; the mapping outlives the descriptor */
+    p_map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void) close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        perror("ERROR: ButtonTrace - Failed to map the trace");
+        return -1;
+    }
+    p_header = (const BTrace_Header *) p_map;
+    if ((p_header->magic != BTRACE_MAGIC) || (p_header->version != BTRACE_VERSION)
+        || (p_header->record_size != sizeof(BTrace_Record)))
+    {
+        printf("ERROR: ButtonTrace - %s is not a version %u button trace\n", p_path, BTRACE_VERSION);
+        (void) munmap(p_map, info.st_size);
+        return -1;
+    }
+
+    *p_freq_khz = p_header->freq_khz;
+    *p_audio = p_header->audio;
+
+    (void) pthread_mutex_lock(&trace_mutex);
+    p_records = (const BTrace_Record *) (p_header + 1);
+    stats.total = (info.st_size - sizeof(BTrace_Header)) / sizeof(BTrace_Record);
+    stats.speed = speed;
+    start_us = FMClock_NowUs();
+    cursor = 0;
+    cursor_at_us = (stats.total > 0) ? p_records[0].delta_us : 0;
+    cursor_since_us = start_us;
+    mode = TRACE_REPLAY;
+    (void) pthread_mutex_unlock(&trace_mutex);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : ButtonTrace_ReadValue
+ * Description   : Read the level of a button from the GPIO or the
+ *                 replayed trace
+ * Returns       : 1 if pressed, 0 if released, -1 on failure
+ * Params        @gpio: the button's GPIO number
+ ****************************************************************/
+extern int ButtonTrace_ReadValue (uint8_t gpio)
+{
+    Pin *p_pin;
+    int level = 0;
+
+    if (mode == TRACE_OFF)
+    {
+        level = readPin(gpio);
+        FM_PROBE2(button_sample, gpio, level);
+        return level;
+    }
+
+    if (mode == TRACE_REPLAY)
+    {
+        (void) pthread_mutex_lock(&trace_mutex);
+        p_pin = findPin(gpio);
+        level = (p_pin != NULL) ? replayValue(p_pin) : 0;
+        (void) pthread_mutex_unlock(&trace_mutex);
+        FM_PROBE2(button_sample, gpio, level);
+        return level;
+    }
+
+    level = readPin(gpio);
+    FM_PROBE2(button_sample, gpio, level);
+    if (level < 0)
+    {
+        return level;
+    }
+    /* The tasks poll every 10 ms, so a level change is already a
+     * debounced edge */
+    (void) pthread_mutex_lock(&trace_mutex);
+    logLevel(gpio, (level != 0));
+    (void) pthread_mutex_unlock(&trace_mutex);
+    return level;
+}
+
+/****************************************************************
+ * Function Name : ButtonTrace_LogEdge
+ * Description   : Log a level change read outside ButtonTrace_ReadValue,
+ *                 e.g. an encoder edge, to the trace being recorded
+ * Returns       : void
+ * Params        @gpio: the GPIO number
+ *               @level: its new level
+ ****************************************************************/
+extern void ButtonTrace_LogEdge (uint8_t gpio, uint8_t level)
+{
+    if (mode != TRACE_RECORD)
+    {
+        return;
+    }
+    (void) pthread_mutex_lock(&trace_mutex);
+    logLevel(gpio, (level != 0));
+    (void) pthread_mutex_unlock(&trace_mutex);
+}
+
+/****************************************************************
+ * Function Name : ButtonTrace_Done
+ * Description   : Check whether a replay has applied its last edge
+ * Returns       : 1 if done, 0 otherwise or if not replaying
+ * Params        : N/A
+ ****************************************************************/
+extern uint8_t ButtonTrace_Done (void)
+{
+    uint8_t done = 0;
+
+    (void) pthread_mutex_lock(&trace_mutex);
+    done = (mode == TRACE_REPLAY) && (cursor >= stats.total);
+    (void) pthread_mutex_unlock(&trace_mutex);
+    return done;
+}
+
+/****************************************************************
+ * Function Name : ButtonTrace_GetStats
+ * Description   : Get a copy of the record/replay counters
+ * Returns       : void
+ * Params        @p_stats: to store the counters
+ ****************************************************************/
+extern void ButtonTrace_GetStats (BTrace_Stats *p_stats)
+{
+    (void) pthread_mutex_lock(&trace_mutex);
+    *p_stats = stats;
+    (void) pthread_mutex_unlock(&trace_mutex);
+}
+
+/****************************************************************
+ * Function Name : ButtonTrace_Close
+ * Description   : Flush and close the trace being recorded
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void ButtonTrace_Close (void)
+{
+    (void) pthread_mutex_lock(&trace_mutex);
+    if (trace_fd >= 0)
+    {
+        (void) fsync(trace_fd);
+        (void) close(trace_fd);
+        trace_fd = -1;
+    }
+    (void) pthread_mutex_unlock(&trace_mutex);
+}
@@ -0,0 +1,124 @@
+/*
+ * button_trace.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef BUTTON_TRACE_H
+#define BUTTON_TRACE_H
+
+#include <stdint.h>     // Fixed-width int type
+
+/* Input layer of the button tasks. Normally it reads the GPIO and,
+ * when recording, logs every change of a debounced button level (the
+ * tasks sample every 10 ms) to a compact binary trace. When replaying,
+ * the levels come from a trace instead of the GPIO, at real speed or
+ * N times faster.
+ *
+ * Replay keeps the order of the trace across buttons: an edge is only
+ * applied when the task of its button reads, and every edge is seen by
+ * at least one read, so a faster replay never loses a press. An edge
+ * whose button is never read (not polled by this build) is skipped
+ * after BTRACE_STALL_US.
+ *
+ * Encoder edges are logged the same way (ButtonTrace_LogEdge) and
+ * replayed to a task that reads both encoder pins in turn. */
+
+#define BTRACE_MAGIC        0x52544246  // "FBTR"
+#define BTRACE_VERSION      1
+#define BTRACE_MAX_PINS     8           // Buttons a trace can hold
+#define BTRACE_STALL_US     1000000     // Wait for an edge's task before skipping it
+
+typedef struct BTrace_Header {
+    uint32_t magic;             // BTRACE_MAGIC
+    uint16_t version;           // BTRACE_VERSION
+    uint16_t record_size;       // sizeof(BTrace_Record)
+    uint32_t freq_khz;          // Station when the recording started
+    uint8_t  audio;             // Audio state when the recording started
+    uint8_t  reserved[3];
+} BTrace_Header;
+
+/* One level change, 6 bytes */
+typedef struct __attribute__((packed)) BTrace_Record {
+    uint32_t delta_us;          // Since the previous record (or the start), saturates
+    uint8_t  gpio;              // GPIO number of the button
+    uint8_t  level;             // 1 = pressed
+} BTrace_Record;
+
+typedef struct BTrace_Stats {
+    uint32_t events;            // Edges recorded or replayed
+    uint32_t total;             // Edges in the replayed trace
+    uint32_t skipped;           // Edges dropped, no task read their button
+    uint64_t elapsed_us;        // Replay start to its last edge, 0 until done
+    uint32_t speed;             // Replay speed, 0 = no waiting
+} BTrace_Stats;
+
+/****************************************************************
+ * Function Name : ButtonTrace_Record
+ * Description   : Start logging the button edges to a trace file
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: the trace file, truncated
+ *               @freq_khz: the current station
+ *               @audio: the current audio state
+ ****************************************************************/
+extern int ButtonTrace_Record (const char *p_path, uint32_t freq_khz, uint8_t audio);
+
+/****************************************************************
+ * Function Name : ButtonTrace_Replay
+ * Description   : Feed the button levels from a trace instead of
+ *                 the GPIO, starting now
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: the trace file
+ *               @speed: 1 = real time, N = N times faster,
+ *                       0 = every edge on the next read
+ *               @p_freq_khz: to store the station the recording
+ *                            started on
+ *               @p_audio: to store the audio state it started with
+ ****************************************************************/
+extern int ButtonTrace_Replay (const char *p_path, uint32_t speed, uint32_t *p_freq_khz, uint8_t *p_audio);
+
+/****************************************************************
+ * Function Name : ButtonTrace_ReadValue
+ * Description   : Read the level of a button from the GPIO or the
+ *                 replayed trace
+ * Returns       : 1 if pressed, 0 if released, -1 on failure
+ * Params        @gpio: the button's GPIO number
+ ****************************************************************/
+extern int ButtonTrace_ReadValue (uint8_t gpio);
+
+/****************************************************************
+ * Function Name : ButtonTrace_LogEdge
+ * Description   : Log a level change read outside ButtonTrace_ReadValue,
+ *                 e.g. an encoder edge, to the trace being recorded
+ * Returns       : void
+ * Params        @gpio: the GPIO number
+ *               @level: its new level
+ ****************************************************************/
+extern void ButtonTrace_LogEdge (uint8_t gpio, uint8_t level);
+
+/****************************************************************
+ * Function Name : ButtonTrace_Done
+ * Description   : Check whether a replay has applied its last edge
+ * Returns       : 1 if done, 0 otherwise or if not replaying
+ * Params        : N/A
+ ****************************************************************/
+extern uint8_t ButtonTrace_Done (void);
+
+/****************************************************************
+ * Function Name : ButtonTrace_GetStats
+ * Description   : Get a copy of the record/replay counters
+ * Returns       : void
+ * Params        @p_stats: to store the counters
+ ****************************************************************/
+extern void ButtonTrace_GetStats (BTrace_Stats *p_stats);
+
+/****************************************************************
+ * Function Name : ButtonTrace_Close
+ * Description   : Flush and close the trace being recorded
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void ButtonTrace_Close (void);
+
+#endif
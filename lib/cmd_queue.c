@@ -0,0 +1,220 @@
+/*
+ * cmd_queue.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <errno.h>          // ETIMEDOUT
+#include <pthread.h>        // Lock and condition
+
+#include "fm_clock.h"
+#include "fm_probes.h"
+#include "flight_rec.h"
+#include "cmd_queue.h"      // Its header file
+
+/****************************************************************
+ * Function Name : CmdQueue_Init
+ * Description   : Set up an empty queue
+ * Returns       : void
+ * Params        @p_queue: the queue
+ ****************************************************************/
+extern void CmdQueue_Init (CmdQueue *p_queue)
+{
+    (void) memset(p_queue, 0, sizeof(CmdQueue));
+    (void) pthread_mutex_init(&p_queue->mutex, NULL);
+    /* Timed takes count on FMClock_NowUs */
+    FMClock_CondInit(&p_queue->cond);
+    LatHist_Init(&p_queue->stats.wait_hist);
+    LatHist_Init(&p_queue->stats.done_hist);
+}
+
+/****************************************************************
+ * Function Name : CmdQueue_Post
+ * Description   : Add commands and wake the worker
+ * Returns       : the bits pending after the post
+ * Params        @p_queue: the queue
+ *               @bits: the command bits
+ ****************************************************************/
+extern uint8_t CmdQueue_Post (CmdQueue *p_queue, uint8_t bits)
+{
+    uint64_t now_us = FMClock_NowUs();
+    uint8_t pending = 0;
+    uint8_t bit = 0;
+
+    (void) pthread_mutex_lock(&p_queue->mutex);
+    for (bit = 0; bit < CMDQ_BITS; bit++)
+    {
+        if (!(bits & (1 << bit)))
+        {
+            continue;
+        }
+        p_queue->stats.posts++;
+        if (p_queue->pending & (1 << bit))
+        {
+            /* Served by the take that serves the first post */
+            p_queue->stats.coalesced++;
+        }
+        else
+        {
+            p_queue->posted_us[bit] = now_us;
+        }
+    }
+    p_queue->pending |= bits;
+    pending = p_queue->pending;
+    (void) pthread_mutex_unlock(&p_queue->mutex);
+    FMClock_CondSignal(&p_queue->cond);
+    FM_PROBE3(cmd_enqueue, p_queue, bits, pending);
+    FlightRec_Log(FLIGHTREC_CMD_POST, bits, pending, 0);
+    return pending;
+}
+
+/****************************************************************
+ * Function Name : CmdQueue_Take
+ * Description   : Wait for commands and take every pending one
+ * Returns       : the bits taken
+ * Params        @p_queue: the queue
+ *               @p_posted_us: to store when each bit taken was
+ *                             first posted (CMDQ_BITS entries),
+ *                             for CmdQueue_Done; may be NULL
+ ****************************************************************/
+extern uint8_t CmdQueue_Take (CmdQueue *p_queue, uint64_t *p_posted_us)
+{
+    return CmdQueue_TakeTimed(p_queue, p_posted_us, 0);
+}
+
+/****************************************************************
+ * Function Name : CmdQueue_TakeTimed
+ * Description   : Like CmdQueue_Take, but give up at a deadline
+ * Returns       : the bits taken, 0 if the deadline passed first
+ * Params        @p_queue: the queue
+ *               @p_posted_us: as for CmdQueue_Take
+ *               @deadline_us: monotonic time (FMClock_NowUs) to give
+ *                             up at, 0 to wait forever
+ ****************************************************************/
+extern uint8_t CmdQueue_TakeTimed (CmdQueue *p_queue, uint64_t *p_posted_us, uint64_t deadline_us)
+{
+    uint64_t now_us = 0;
+    uint64_t wait_us = 0;
+    uint64_t oldest_us = 0;     // Wait of the oldest post taken
+    uint8_t bits = 0;
+    uint8_t bit = 0;
+
+    (void) pthread_mutex_lock(&p_queue->mutex);
+    while (p_queue->pending == 0)
+    {
+        if (FMClock_CondWait(&p_queue->cond, &p_queue->mutex, deadline_us) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    bits = p_queue->pending;
+    if (bits == 0)
+    {
+        (void) pthread_mutex_unlock(&p_queue->mutex);
+        return 0;
+    }
+    p_queue->pending = 0;
+    now_us = FMClock_NowUs();
+    p_queue->stats.batches++;
+    for (bit = 0; bit < CMDQ_BITS; bit++)
+    {
+        if (bits & (1 << bit))
+        {
+            p_queue->stats.served++;
+            wait_us = now_us - p_queue->posted_us[bit];
+            LatHist_Record(&p_queue->stats.wait_hist, wait_us);
+            oldest_us = (wait_us > oldest_us) ? wait_us : oldest_us;
+            if (p_posted_us != NULL)
+            {
+                p_posted_us[bit] = p_queue->posted_us[bit];
+            }
+        }
+    }
+    (void) pthread_mutex_unlock(&p_queue->mutex);
+    FM_PROBE3(cmd_dequeue, p_queue, bits, oldest_us);
+    FlightRec_Log(FLIGHTREC_CMD_TAKE, bits, (uint32_t) oldest_us, 0);
+    return bits;
+}
+
+/****************************************************************
+ * Function Name : CmdQueue_Done
+ * Description   : Record the end of the work on taken commands
+ * Returns       : void
+ * Params        @p_queue: the queue
+ *               @bits: the bits taken
+ *               @p_posted_us: post times from CmdQueue_Take
+ ****************************************************************/
+extern void CmdQueue_Done (CmdQueue *p_queue, uint8_t bits, const uint64_t *p_posted_us)
+{
+    uint64_t now_us = FMClock_NowUs();
+    uint8_t bit = 0;
+
+    (void) pthread_mutex_lock(&p_queue->mutex);
+    for (bit = 0; bit < CMDQ_BITS; bit++)
+    {
+        if (bits & (1 << bit))
+        {
+            LatHist_Record(&p_queue->stats.done_hist, now_us - p_posted_us[bit]);
+        }
+    }
+    (void) pthread_mutex_unlock(&p_queue->mutex);
+}
+
+/****************************************************************
+ * Function Name : CmdQueue_Pending
+ * Description   : Get the pending bits without taking them
+ * Returns       : the bits, 0 if none
+ * Params        @p_queue: the queue
+ ****************************************************************/
+extern uint8_t CmdQueue_Pending (CmdQueue *p_queue)
+{
+    uint8_t pending = 0;
+
+    (void) pthread_mutex_lock(&p_queue->mutex);
+    pending = p_queue->pending;
+    (void) pthread_mutex_unlock(&p_queue->mutex);
+    return pending;
+}
+
+/****************************************************************
+ * Function Name : CmdQueue_GetStats
+ * Description   : Get a copy of the counters and histograms
+ * Returns       : void
+ * Params        @p_queue: the queue
+ *               @p_stats: to store the copy
+ ****************************************************************/
+extern void CmdQueue_GetStats (CmdQueue *p_queue, CmdQueue_Stats *p_stats)
+{
+    (void) pthread_mutex_lock(&p_queue->mutex);
+    *p_stats = p_queue->stats;
+    (void) pthread_mutex_unlock(&p_queue->mutex);
+}
+
+/****************************************************************
+ * Function Name : CmdQueue_Print
+ * Description   : Print the counters and the wait and done tails
+ * Returns       : void
+ * Params        @p_name: label printed in front of every line
+ *               @p_queue: the queue
+ ****************************************************************/
+extern void CmdQueue_Print (const char *p_name, CmdQueue *p_queue)
+{
+    CmdQueue_Stats stats;
+
+    CmdQueue_GetStats(p_queue, &stats);
+    printf("%s: %u posted, %u coalesced (%u%%), %u served in %u batches\n", p_name,
+           stats.posts, stats.coalesced, stats.posts ? ((stats.coalesced * 100) / stats.posts) : 0,
+           stats.served, stats.batches);
+    printf("%s: wait p50 %llu us, p99 %llu us, max %llu us; done p50 %llu us, p99 %llu us, max %llu us\n",
+           p_name,
+           (unsigned long long) LatHist_Percentile(&stats.wait_hist, 50),
+           (unsigned long long) LatHist_Percentile(&stats.wait_hist, 99),
+           (unsigned long long) stats.wait_hist.max_us,
+           (unsigned long long) LatHist_Percentile(&stats.done_hist, 50),
+           (unsigned long long) LatHist_Percentile(&stats.done_hist, 99),
+           (unsigned long long) stats.done_hist.max_us);
+}
@@ -0,0 +1,116 @@
+/*
+ * cmd_queue.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef CMD_QUEUE_H
+#define CMD_QUEUE_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <pthread.h>    // Lock and condition
+
+#include "latency_hist.h"
+
+/* Hand-off of commands from many posters to one worker. A command is
+ * one bit: posting a bit that is still pending coalesces into it, and
+ * the worker takes every pending bit at once, so posters never wait
+ * behind the worker. Each bit remembers when it was first posted, for
+ * the wait (post to take) and done (post to end of work) histograms. */
+
+#define CMDQ_BITS   8       // Commands a queue can hold
+
+typedef struct CmdQueue_Stats {
+    uint32_t posts;         // Commands posted
+    uint32_t coalesced;     // Posts merged into a command still pending
+    uint32_t batches;       // Takes by the worker
+    uint32_t served;        // Commands taken by the worker
+    LatHist  wait_hist;     // First post to take
+    LatHist  done_hist;     // First post to the end of the worker's job
+} CmdQueue_Stats;
+
+typedef struct CmdQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    uint8_t  pending;                   // Bits waiting, 0 = none
+    uint64_t posted_us[CMDQ_BITS];      // When each pending bit was first posted
+    CmdQueue_Stats stats;
+} CmdQueue;
+
+/****************************************************************
+ * Function Name : CmdQueue_Init
+ * Description   : Set up an empty queue
+ * Returns       : void
+ * Params        @p_queue: the queue
+ ****************************************************************/
+extern void CmdQueue_Init (CmdQueue *p_queue);
+
+/****************************************************************
+ * Function Name : CmdQueue_Post
+ * Description   : Add commands and wake the worker
+ * Returns       : the bits pending after the post
+ * Params        @p_queue: the queue
+ *               @bits: the command bits
+ ****************************************************************/
+extern uint8_t CmdQueue_Post (CmdQueue *p_queue, uint8_t bits);
+
+/****************************************************************
+ * Function Name : CmdQueue_Take
+ * Description   : Wait for commands and take every pending one
+ * Returns       : the bits taken
+ * Params        @p_queue: the queue
+ *               @p_posted_us: to store when each bit taken was
+ *                             first posted (CMDQ_BITS entries),
+ *                             for CmdQueue_Done; may be NULL
+ ****************************************************************/
+extern uint8_t CmdQueue_Take (CmdQueue *p_queue, uint64_t *p_posted_us);
+
+/****************************************************************
+ * Function Name : CmdQueue_TakeTimed
+ * Description   : Like CmdQueue_Take, but give up at a deadline
+ * Returns       : the bits taken, 0 if the deadline passed first
+ * Params        @p_queue: the queue
+ *               @p_posted_us: as for CmdQueue_Take
+ *               @deadline_us: monotonic time (FMClock_NowUs) to give
+ *                             up at, 0 to wait forever
+ ****************************************************************/
+extern uint8_t CmdQueue_TakeTimed (CmdQueue *p_queue, uint64_t *p_posted_us, uint64_t deadline_us);
+
+/****************************************************************
+ * Function Name : CmdQueue_Done
+ * Description   : Record the end of the work on taken commands
+ * Returns       : void
+ * Params        @p_queue: the queue
+ *               @bits: the bits taken
+ *               @p_posted_us: post times from CmdQueue_Take
+ ****************************************************************/
+extern void CmdQueue_Done (CmdQueue *p_queue, uint8_t bits, const uint64_t *p_posted_us);
+
+/****************************************************************
+ * Function Name : CmdQueue_Pending
+ * Description   : Get the pending bits without taking them
+ * Returns       : the bits, 0 if none
+ * Params        @p_queue: the queue
+ ****************************************************************/
+extern uint8_t CmdQueue_Pending (CmdQueue *p_queue);
+
+/****************************************************************
+ * Function Name : CmdQueue_GetStats
+ * Description   : Get a copy of the counters and histograms
+ * Returns       : void
+ * Params        @p_queue: the queue
+ *               @p_stats: to store the copy
+ ****************************************************************/
+extern void CmdQueue_GetStats (CmdQueue *p_queue, CmdQueue_Stats *p_stats);
+
+/****************************************************************
+ * Function Name : CmdQueue_Print
+ * Description   : Print the counters and the wait and done tails
+ * Returns       : void
+ * Params        @p_name: label printed in front of every line
+ *               @p_queue: the queue
+ ****************************************************************/
+extern void CmdQueue_Print (const char *p_name, CmdQueue *p_queue);
+
+#endif
@@ -0,0 +1,544 @@
+/*
+ * control_server.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#define _GNU_SOURCE                 // accept4
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <strings.h>        // strcasecmp
+#include <unistd.h>         // POSIX API
+#include <fcntl.h>          // File controls
+#include <errno.h>          // Error codes
+#include <pthread.h>        // Event ring lock
+#include <sys/socket.h>     // Sockets
+#include <sys/un.h>         // Unix domain sockets
+#include <sys/epoll.h>      // epoll
+#include <sys/eventfd.h>    // eventfd
+
+#include "fm_metrics.h"
+#include "control_server.h" // Its header file
+
+#define ID_LISTEN   0xFFFFFFFFU     // epoll tag of the listening socket
+#define ID_EVENTS   0xFFFFFFFEU     // epoll tag of the event notifier
+
+typedef struct Client {
+    int      fd;                        // -1 if the slot is free
+    uint8_t  subscribed;                // 1 = receives events
+    uint8_t  want_write;                // 1 = EPOLLOUT armed
+    uint16_t in_length;                 // Bytes in p_input
+    uint16_t out_length;                // Bytes in output
+    char     input[CTL_LINE_SIZE];      // Partial command line
+    char     output[CTL_OUTPUT_SIZE];   // Unsent reply / event bytes
+} Client;
+
+static Client clients[CTL_MAX_CLIENTS];
+static int listen_fd = -1;
+static int epoll_fd = -1;
+static int event_fd = -1;
+
+/* Events published by other threads, drained by the server thread */
+static char event_ring[CTL_EVENT_RING][CTL_LINE_SIZE];
+static uint32_t event_head = 0;     // Next slot to write
+static uint32_t event_tail = 0;     // Next slot to broadcast
+static pthread_mutex_t event_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static CtlServer_Stats stats;
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************
+ * Function Name : closeClient (private)
+ * Description   : Drop a client and free its slot
+ * Returns       : void
+ * Params        @p_client: the client
+ ****************************************************************/
+static void closeClient (Client *p_client)
+{
+    (void) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, p_client->fd, NULL);
+    (void) close(p_client->fd);
+
+    (void) pthread_mutex_lock(&stats_mutex);
+    stats.clients--;
+    FMMetrics_SetGauge(FM_G_CONTROL_CLIENTS, stats.clients);
+    if (p_client->subscribed)
+    {
+        stats.subscribers--;
+    }
+    (void) pthread_mutex_unlock(&stats_mutex);
+
+    p_client->fd = -1;
+    p_client->subscribed = 0;
+}
+
+/****************************************************************
+ * Function Name : flushClient (private)
+ * Description   : Send as much pending output as the socket takes
+ *                 and arm EPOLLOUT only while output is left
+ * Returns       : 0 on success, -1 if the client was closed
+ * Params        @p_client: the client
+ *               @id: the client's slot index
+ ****************************************************************/
+static int flushClient (Client *p_client, uint32_t id)
+{
+    struct epoll_event event;
+    ssize_t sent = 0;
+    uint8_t want_write;
+
+    while (p_client->out_length > 0)
+    {
+        sent = send(p_client->fd, p_client->output, p_client->out_length, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            closeClient(p_client);
+            return -1;
+        }
+        (void) memmove(p_client->output, p_client->output + sent, p_client->out_length - sent);
+        p_client->out_length -= (uint16_t) sent;
+    }
+
+    want_write = (p_client->out_length > 0);
+    if (want_write != p_client->want_write)
+    {
+        event.events = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0);
+        event.data.u32 = id;
+        (void) epoll_ctl(epoll_fd, EPOLL_CTL_MOD, p_client->fd, &event);
+        p_client->want_write = want_write;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : queueLine (private)
+ * Description   : Append a line (and newline) to a client's output.
+ *                 A client too slow to take it is dropped.
+ * Returns       : 0 on success, -1 if the client was closed
+ * Params        @p_client: the client
+ *               @p_line: the line, without newline
+ ****************************************************************/
+static int queueLine (Client *p_client, const char *p_line)
+{
+    size_t length = strlen(p_line);
+
+    if ((p_client->out_length + length + 1) > CTL_OUTPUT_SIZE)
+    {
+        (void) pthread_mutex_lock(&stats_mutex);
+        stats.slow_dropped++;
+        (void) pthread_mutex_unlock(&stats_mutex);
+        closeClient(p_client);
+        return -1;
+    }
+    (void) memcpy(p_client->output + p_client->out_length, p_line, length);
+    p_client->out_length += (uint16_t) length;
+    p_client->output[p_client->out_length++] = '\n';
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : acceptClients (private)
+ * Description   : Accept every pending connection
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void acceptClients (void)
+{
+    struct epoll_event event;
+    uint32_t id;
+    int fd;
+
+    while (1)
+    {
+        fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            /* EAGAIN: nothing left to accept */
+            return;
+        }
+
+        for (id = 0; id < CTL_MAX_CLIENTS; id++)
+        {
+            if (clients[id].fd < 0)
+            {
+                break;
+            }
+        }
+        if (id == CTL_MAX_CLIENTS)
+        {
+            (void) pthread_mutex_lock(&stats_mutex);
+            stats.rejected++;
+            (void) pthread_mutex_unlock(&stats_mutex);
+            (void) close(fd);
+            continue;
+        }
+
+        (void) memset(&clients[id], 0, sizeof(Client));
+        clients[id].fd = fd;
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u32 = id;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            (void) close(fd);
+            clients[id].fd = -1;
+            continue;
+        }
+
+        (void) pthread_mutex_lock(&stats_mutex);
+        stats.accepted++;
+        stats.clients++;
+        FMMetrics_SetGauge(FM_G_CONTROL_CLIENTS, stats.clients);
+        if (stats.clients > stats.peak_clients)
+        {
+            stats.peak_clients = stats.clients;
+        }
+        (void) pthread_mutex_unlock(&stats_mutex);
+    }
+}
+
+/****************************************************************
+ * Function Name : handleLine (private)
+ * Description   : Serve one command line from a client
+ * Returns       : 0 on success, -1 if the client was closed
+ * Params        @p_client: the client
+ *               @p_line: the line, without newline
+ *               @handler: callback for application commands
+ ****************************************************************/
+static int handleLine (Client *p_client, const char *p_line, CtlServer_Handler handler)
+{
+    char reply[CTL_LINE_SIZE] = "";
+
+    if (p_line[0] == '\0')
+    {
+        return 0;
+    }
+
+    (void) pthread_mutex_lock(&stats_mutex);
+    stats.commands++;
+    if (strcasecmp(p_line, "SUBSCRIBE") == 0)
+    {
+        stats.subscribers += p_client->subscribed ? 0 : 1;
+        p_client->subscribed = 1;
+        (void) snprintf(reply, sizeof(reply), "OK SUBSCRIBED");
+    }
+    else if (strcasecmp(p_line, "UNSUBSCRIBE") == 0)
+    {
+        stats.subscribers -= p_client->subscribed ? 1 : 0;
+        p_client->subscribed = 0;
+        (void) snprintf(reply, sizeof(reply), "OK UNSUBSCRIBED");
+    }
+    (void) pthread_mutex_unlock(&stats_mutex);
+
+    if (reply[0] == '\0')
+    {
+        handler(p_line, reply, sizeof(reply));
+    }
+    return queueLine(p_client, reply);
+}
+
+/****************************************************************
+ * Function Name : readClient (private)
+ * Description   : Read what a client sent and serve complete lines
+ * Returns       : void
+ * Params        @id: the client's slot index
+ *               @handler: callback for application commands
+ ****************************************************************/
+static void readClient (uint32_t id, CtlServer_Handler handler)
+{
+    Client *p_client = &clients[id];
+    ssize_t received = 0;
+    char *p_newline;
+    size_t line_length;
+
+    while (p_client->fd >= 0)
+    {
+        received = recv(p_client->fd, p_client->input + p_client->in_length,
+                        CTL_LINE_SIZE - p_client->in_length, MSG_DONTWAIT);
+        if (received == 0)
+        {
+            closeClient(p_client);
+            return;
+        }
+        if (received < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+            {
+                closeClient(p_client);
+                return;
+            }
+            break;
+        }
+        p_client->in_length += (uint16_t) received;
+
+        /* Serve every complete line in the buffer */
+        while ((p_client->fd >= 0)
+               && ((p_newline = memchr(p_client->input, '\n', p_client->in_length)) != NULL))
+        {
+            *p_newline = '\0';
+            line_length = (size_t) (p_newline - p_client->input) + 1;
+            if ((line_length > 1) && (p_newline[-1] == '\r'))
+            {
+                p_newline[-1] = '\0';
+            }
+            if (handleLine(p_client, p_client->input, handler) < 0)
+            {
+                return;
+            }
+            (void) memmove(p_client->input, p_client->input + line_length, p_client->in_length - line_length);
+            p_client->in_length -= (uint16_t) line_length;
+        }
+
+        /* A full buffer without a newline is not a valid command */
+        if ((p_client->fd >= 0) && (p_client->in_length == CTL_LINE_SIZE))
+        {
+            p_client->in_length = 0;
+            if (queueLine(p_client, "ERR LINE TOO LONG") < 0)
+            {
+                return;
+            }
+        }
+    }
+
+    if (p_client->fd >= 0)
+    {
+        (void) flushClient(p_client, id);
+    }
+}
+
+/****************************************************************
+ * Function Name : broadcastEvents (private)
+ * Description   : Send every queued event to every subscriber
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void broadcastEvents (void)
+{
+    char line[CTL_LINE_SIZE];
+    uint64_t count = 0;
+    uint32_t id;
+    uint32_t sent = 0;
+
+    /* Reset the notifier before draining so no event is missed */
+    (void) read(event_fd, &count, sizeof(count));
+
+    while (1)
+    {
+        (void) pthread_mutex_lock(&event_mutex);
+        if (event_tail == event_head)
+        {
+            (void) pthread_mutex_unlock(&event_mutex);
+            break;
+        }
+        (void) memcpy(line, event_ring[event_tail % CTL_EVENT_RING], CTL_LINE_SIZE);
+        event_tail++;
+        (void) pthread_mutex_unlock(&event_mutex);
+
+        for (id = 0; id < CTL_MAX_CLIENTS; id++)
+        {
+            if ((clients[id].fd >= 0) && clients[id].subscribed && (queueLine(&clients[id], line) == 0))
+            {
+                sent++;
+            }
+        }
+    }
+
+    /* One flush per client for the whole batch */
+    for (id = 0; id < CTL_MAX_CLIENTS; id++)
+    {
+        if ((clients[id].fd >= 0) && (clients[id].out_length > 0))
+        {
+            (void) flushClient(&clients[id], id);
+        }
+    }
+
+    (void) pthread_mutex_lock(&stats_mutex);
+    stats.events_sent += sent;
+    (void) pthread_mutex_unlock(&stats_mutex);
+}
+
+/****************************************************************
+ * Function Name : CtlServer_Open
+ * Description   : Create the listening socket, epoll set and the
+ *                 event notifier. A stale socket file is replaced.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: path of the Unix socket
+ ****************************************************************/
+extern int CtlServer_Open (const char *p_path)
+{
+    struct sockaddr_un address;
+    struct epoll_event event;
+    uint32_t id;
+
+    for (id = 0; id < CTL_MAX_CLIENTS; id++)
+    {
+        clients[id].fd = -1;
+    }
+
+    if (strlen(p_path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "ERROR: CtlServer - Socket path too long\n");
+        return -1;
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0)
+    {
+        perror("ERROR: CtlServer - Failed to create the socket");
+        return -1;
+    }
+
+    (void) memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    (void) strncpy(address.sun_path, p_path, sizeof(address.sun_path) - 1);
+    (void) unlink(p_path);
+    if ((bind(listen_fd, (struct sockaddr *) &address, sizeof(address)) < 0)
+        || (listen(listen_fd, CTL_LISTEN_BACKLOG) < 0))
+    {
+        perror("ERROR: CtlServer - Failed to listen on the socket");
+        (void) close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((epoll_fd < 0) || (event_fd < 0))
+    {
+        perror("ERROR: CtlServer - Failed to create the epoll set");
+        return -1;
+    }
+
+    event.events = EPOLLIN;
+    event.data.u32 = ID_LISTEN;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) < 0)
+    {
+        perror("ERROR: CtlServer - Failed to watch the socket");
+        return -1;
+    }
+    event.events = EPOLLIN;
+    event.data.u32 = ID_EVENTS;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &event) < 0)
+    {
+        perror("ERROR: CtlServer - Failed to watch the event notifier");
+        return -1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : CtlServer_Run
+ * Description   : Serve clients forever from the calling thread
+ * Returns       : -1 if the epoll loop fails
+ * Params        @handler: callback for application commands
+ ****************************************************************/
+extern int CtlServer_Run (CtlServer_Handler handler)
+{
+    struct epoll_event events[CTL_EPOLL_BATCH];
+    int ready = 0;
+    int i;
+    uint32_t id;
+
+    while (1)
+    {
+        ready = epoll_wait(epoll_fd, events, CTL_EPOLL_BATCH, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("ERROR: CtlServer - epoll_wait failed");
+            return -1;
+        }
+
+        for (i = 0; i < ready; i++)
+        {
+            id = events[i].data.u32;
+            if (id == ID_LISTEN)
+            {
+                acceptClients();
+            }
+            else if (id == ID_EVENTS)
+            {
+                broadcastEvents();
+            }
+            else if (clients[id].fd >= 0)
+            {
+                if (events[i].events & EPOLLOUT)
+                {
+                    if (flushClient(&clients[id], id) < 0)
+                    {
+                        continue;
+                    }
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                {
+                    readClient(id, handler);
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************
+ * Function Name : CtlServer_Publish
+ * Description   : Queue an event line for every subscriber. Safe to
+ *                 call from any thread; never blocks on clients.
+ * Returns       : void
+ * Params        @p_event: the event line, without newline
+ ****************************************************************/
+extern void CtlServer_Publish (const char *p_event)
+{
+    uint64_t one = 1;
+
+    if (event_fd < 0)
+    {
+        return;
+    }
+
+    (void) pthread_mutex_lock(&event_mutex);
+    /* A full ring drops the oldest event: state events supersede it */
+    if ((event_head - event_tail) == CTL_EVENT_RING)
+    {
+        event_tail++;
+        (void) pthread_mutex_lock(&stats_mutex);
+        stats.events_dropped++;
+        (void) pthread_mutex_unlock(&stats_mutex);
+    }
+    (void) strncpy(event_ring[event_head % CTL_EVENT_RING], p_event, CTL_LINE_SIZE - 1);
+    event_ring[event_head % CTL_EVENT_RING][CTL_LINE_SIZE - 1] = '\0';
+    event_head++;
+    (void) pthread_mutex_unlock(&event_mutex);
+
+    (void) pthread_mutex_lock(&stats_mutex);
+    stats.events++;
+    (void) pthread_mutex_unlock(&stats_mutex);
+
+    (void) write(event_fd, &one, sizeof(one));
+}
+
+/****************************************************************
+ * Function Name : CtlServer_GetStats
+ * Description   : Get a copy of the server counters
+ * Returns       : void
+ * Params        @p_stats: to store the counters
+ ****************************************************************/
+extern void CtlServer_GetStats (CtlServer_Stats *p_stats)
+{
+    (void) pthread_mutex_lock(&stats_mutex);
+    *p_stats = stats;
+    (void) pthread_mutex_unlock(&stats_mutex);
+}
@@ -0,0 +1,83 @@
+/*
+ * control_server.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef CONTROL_SERVER_H
+#define CONTROL_SERVER_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <stddef.h>     // size_t
+
+/* Line protocol over a Unix stream socket. Every command line gets
+ * one reply line ("OK ..." or "ERR ..."). SUBSCRIBE / UNSUBSCRIBE are
+ * handled here; other commands go to the application's handler.
+ * Subscribers also receive every published "EVENT ..." line. */
+
+#define CTL_MAX_CLIENTS     512     // Concurrent clients
+#define CTL_LINE_SIZE       128     // Longest command or event line
+#define CTL_OUTPUT_SIZE     1024    // Pending output per client
+#define CTL_EVENT_RING      64      // Published events not yet broadcast
+#define CTL_EPOLL_BATCH     64      // Events handled per epoll_wait
+#define CTL_LISTEN_BACKLOG  128
+
+typedef struct CtlServer_Stats {
+    uint32_t clients;           // Connected now
+    uint32_t peak_clients;      // Most connected at once
+    uint32_t accepted;          // Connections accepted
+    uint32_t rejected;          // Connections refused, table full
+    uint32_t subscribers;       // Subscribed now
+    uint32_t commands;          // Command lines handled
+    uint32_t events;            // Events published
+    uint32_t events_sent;       // Event lines queued to subscribers
+    uint32_t events_dropped;    // Events lost because the ring was full
+    uint32_t slow_dropped;      // Clients dropped for not reading
+} CtlServer_Stats;
+
+/****************************************************************
+ * Function Name : CtlServer_Handler
+ * Description   : Application callback for one command line
+ * Returns       : void
+ * Params        @p_command: the line, without the newline
+ *               @p_reply: to store the reply line, without newline
+ *               @reply_size: size of p_reply
+ ****************************************************************/
+typedef void (*CtlServer_Handler) (const char *p_command, char *p_reply, size_t reply_size);
+
+/****************************************************************
+ * Function Name : CtlServer_Open
+ * Description   : Create the listening socket, epoll set and the
+ *                 event notifier. A stale socket file is replaced.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: path of the Unix socket
+ ****************************************************************/
+extern int CtlServer_Open (const char *p_path);
+
+/****************************************************************
+ * Function Name : CtlServer_Run
+ * Description   : Serve clients forever from the calling thread
+ * Returns       : -1 if the epoll loop fails
+ * Params        @handler: callback for application commands
+ ****************************************************************/
+extern int CtlServer_Run (CtlServer_Handler handler);
+
+/****************************************************************
+ * Function Name : CtlServer_Publish
+ * Description   : Queue an event line for every subscriber. Safe to
+ *                 call from any thread; never blocks on clients.
+ * Returns       : void
+ * Params        @p_event: the event line, without newline
+ ****************************************************************/
+extern void CtlServer_Publish (const char *p_event);
+
+/****************************************************************
+ * Function Name : CtlServer_GetStats
+ * Description   : Get a copy of the server counters
+ * Returns       : void
+ * Params        @p_stats: to store the counters
+ ****************************************************************/
+extern void CtlServer_GetStats (CtlServer_Stats *p_stats);
+
+#endif
@@ -0,0 +1,324 @@
+/*
+ * deadline_monitor.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <stddef.h>         // offsetof
+#include <string.h>         // String-handling library
+#include <pthread.h>        // Stats lock, priority escalation
+#include <sched.h>          // Priority limits
+#include <errno.h>          // Error codes
+
+#include "fm_clock.h"
+#include "deadline_monitor.h" // Its header file
+
+static pthread_mutex_t dlmon_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************
+ * Function Name : escalate (private)
+ * Description   : Raise the calling thread's real-time priority by
+ *                 one step, up to DLMON_ESCALATE_MAX steps. A task
+ *                 on SCHED_DEADLINE keeps its reservation.
+ * Returns       : 0 on success, -1 if it cannot be raised
+ * Params        @p_task: the task running on the calling thread
+ ****************************************************************/
+static int escalate (DLMon_Task *p_task)
+{
+    struct sched_param param;
+    int policy = 0;
+
+    if ((p_task->escalations >= DLMON_ESCALATE_MAX) || (p_task->policy == RTSCHED_DEADLINE))
+    {
+        return -1;
+    }
+    /* The kernel's view of the thread: pthread_getschedparam returns
+     * the policy cached at creation, not one set by sched_setattr */
+    policy = sched_getscheduler(0);
+    if ((policy < 0) || (sched_getparam(0, &param) != 0))
+    {
+        return -1;
+    }
+    /* Only fixed-priority policies have a priority to raise */
+    if (((policy != SCHED_FIFO) && (policy != SCHED_RR))
+        || (param.sched_priority >= sched_get_priority_max(policy)))
+    {
+        return -1;
+    }
+    param.sched_priority++;
+    if (pthread_setschedparam(pthread_self(), policy, &param) != 0)
+    {
+        return -1;
+    }
+    p_task->escalations++;
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : reserve (private)
+ * Description   : Move the calling thread to SCHED_DEADLINE with a
+ *                 runtime derived from the measured CPU WCET
+ * Returns       : 0 on success, -1 if the kernel refused
+ * Params        @p_task: the task running on the calling thread
+ ****************************************************************/
+static int reserve (DLMon_Task *p_task)
+{
+    uint32_t period_us = p_task->period_us ? p_task->period_us : DLMON_SPORADIC_PERIOD;
+    uint32_t limit_us = (period_us * DLMON_MAX_RESERVATION) / 100;
+    uint32_t runtime_us = (uint32_t) ((p_task->cpu_wcet_us * DLMON_RUNTIME_MARGIN) / 100);
+
+    if (runtime_us < RTSCHED_MIN_RUNTIME_US)
+    {
+        runtime_us = RTSCHED_MIN_RUNTIME_US;
+    }
+    if (runtime_us > limit_us)
+    {
+        runtime_us = limit_us;
+    }
+
+    p_task->reserve_tried = 1;
+    if (RTSched_SetDeadline(runtime_us, period_us, period_us) < 0)
+    {
+        p_task->reserve_errno = errno;
+        printf("WARNING: DLMon - %s stays on %s, SCHED_DEADLINE refused: %s\n",
+               p_task->p_name, RTSched_PolicyName(p_task->policy), strerror(p_task->reserve_errno));
+        return -1;
+    }
+
+    (void) pthread_mutex_lock(&dlmon_mutex);
+    p_task->policy = RTSCHED_DEADLINE;
+    p_task->runtime_us = runtime_us;
+    p_task->reserve_period_us = period_us;
+    (void) pthread_mutex_unlock(&dlmon_mutex);
+    printf("INFO: DLMon - %s on SCHED_DEADLINE, runtime %u us every %u us\n",
+           p_task->p_name, runtime_us, period_us);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : DLMon_Init
+ * Description   : Clear the measurements of a task (the declared
+ *                 name, period, budget and action are kept)
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_Init (DLMon_Task *p_task)
+{
+    (void) pthread_mutex_lock(&dlmon_mutex);
+    (void) memset(&p_task->start_us, 0, sizeof(DLMon_Task) - offsetof(DLMon_Task, start_us));
+    LatHist_Init(&p_task->exec_hist);
+    LatHist_Init(&p_task->jitter_hist);
+    (void) pthread_mutex_unlock(&dlmon_mutex);
+}
+
+/****************************************************************
+ * Function Name : DLMon_RequestReservation
+ * Description   : Ask for a SCHED_DEADLINE reservation once the task
+ *                 is calibrated. Call after DLMon_Init.
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_RequestReservation (DLMon_Task *p_task)
+{
+    p_task->reserve = 1;
+}
+
+/****************************************************************
+ * Function Name : DLMon_JobStart
+ * Description   : Mark the release of a job of the task
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_JobStart (DLMon_Task *p_task)
+{
+    uint64_t now_us = FMClock_NowUs();
+    uint64_t interval_us = 0;
+    int cpu = RTSched_CurrentCpu();
+
+    (void) pthread_mutex_lock(&dlmon_mutex);
+    /* Release jitter: how far this job is from one period after the
+     * previous one */
+    if ((p_task->period_us > 0) && (p_task->last_start_us > 0))
+    {
+        interval_us = now_us - p_task->last_start_us;
+        LatHist_Record(&p_task->jitter_hist, (interval_us > p_task->period_us)
+                       ? (interval_us - p_task->period_us) : (p_task->period_us - interval_us));
+        if (interval_us >= (2 * (uint64_t) p_task->period_us))
+        {
+            p_task->late_releases++;
+        }
+    }
+    /* A job on another CPU than the last one starts with a cold cache */
+    if ((p_task->last_start_us > 0) && (cpu != p_task->last_cpu))
+    {
+        p_task->migrations++;
+    }
+    p_task->last_cpu = (int16_t) cpu;
+    p_task->last_start_us = now_us;
+    p_task->start_us = now_us;
+    (void) pthread_mutex_unlock(&dlmon_mutex);
+    p_task->start_cpu_us = FMClock_ThreadCpuUs();
+}
+
+/****************************************************************
+ * Function Name : DLMon_JobEnd
+ * Description   : Account the job started by DLMon_JobStart and
+ *                 take the task's action if it ran over budget.
+ *                 Does nothing if no job was started.
+ * Returns       : 1 on an overrun, 0 otherwise
+ * Params        @p_task: the task
+ ****************************************************************/
+extern int DLMon_JobEnd (DLMon_Task *p_task)
+{
+    uint64_t exec_us = 0;
+    uint64_t cpu_us = 0;
+    uint8_t overrun = 0;
+    uint8_t report = 0;
+
+    if (p_task->start_us == 0)
+    {
+        return 0;
+    }
+    cpu_us = FMClock_ThreadCpuUs() - p_task->start_cpu_us;
+
+    /* The task's own policy, as it was actually created */
+    if (p_task->jobs == 0)
+    {
+        p_task->policy = RTSched_GetPolicy();
+    }
+
+    (void) pthread_mutex_lock(&dlmon_mutex);
+    exec_us = FMClock_NowUs() - p_task->start_us;
+    p_task->start_us = 0;
+    p_task->jobs++;
+    p_task->busy_us += exec_us;
+    if (exec_us > p_task->wcet_us)
+    {
+        p_task->wcet_us = exec_us;
+    }
+    p_task->cpu_busy_us += cpu_us;
+    if (cpu_us > p_task->cpu_wcet_us)
+    {
+        p_task->cpu_wcet_us = cpu_us;
+    }
+    LatHist_Record(&p_task->exec_hist, exec_us);
+
+    if ((p_task->budget_us == 0) || (exec_us <= p_task->budget_us))
+    {
+        /* A degraded task recovers after a run of clean jobs */
+        if (p_task->degraded && (++p_task->clean_jobs >= DLMON_DEGRADE_CLEAR))
+        {
+            p_task->degraded = 0;
+        }
+    }
+    else
+    {
+        overrun = 1;
+        p_task->overruns++;
+        p_task->clean_jobs = 0;
+        /* Log the 1st, 2nd, 4th, 8th ... overrun so a storm stays readable */
+        report = ((p_task->overruns & (p_task->overruns - 1)) == 0);
+        switch (p_task->action)
+        {
+        case DLMON_DEGRADE:
+            p_task->degraded = 1;
+            break;
+        case DLMON_ESCALATE:
+            (void) escalate(p_task);
+            break;
+        default:
+            break;
+        }
+    }
+    (void) pthread_mutex_unlock(&dlmon_mutex);
+
+    if (report)
+    {
+        printf("WARNING: DLMon - %s ran %llu us, budget %u us (overrun #%u)\n",
+               p_task->p_name, (unsigned long long) exec_us, p_task->budget_us, p_task->overruns);
+    }
+
+    /* Calibrated: trade the fixed priority for a reservation. Done
+     * once the job is accounted, so the switch is not timed as part
+     * of it. */
+    if (p_task->reserve && !p_task->reserve_tried && (p_task->jobs >= DLMON_CALIBRATION_JOBS))
+    {
+        (void) reserve(p_task);
+    }
+    return overrun;
+}
+
+/****************************************************************
+ * Function Name : DLMon_Degraded
+ * Description   : Check whether the task should shed optional work
+ * Returns       : 1 if degraded, 0 otherwise
+ * Params        @p_task: the task
+ ****************************************************************/
+extern uint8_t DLMon_Degraded (const DLMon_Task *p_task)
+{
+    return p_task->degraded;
+}
+
+/****************************************************************
+ * Function Name : DLMon_Print
+ * Description   : Print the declared budget and measurements
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_Print (const DLMon_Task *p_task)
+{
+    (void) pthread_mutex_lock(&dlmon_mutex);
+    printf("Task %-12s period %6u us budget %6u us: jobs %u, overruns %u, WCET %llu us, avg %llu us, p99 %llu us\n",
+           p_task->p_name, p_task->period_us, p_task->budget_us, p_task->jobs, p_task->overruns,
+           (unsigned long long) p_task->wcet_us,
+           (unsigned long long) (p_task->jobs ? (p_task->busy_us / p_task->jobs) : 0),
+           (unsigned long long) LatHist_Percentile(&p_task->exec_hist, 99));
+    if (p_task->period_us > 0)
+    {
+        printf("Task %-12s release jitter p50 %llu us, p99 %llu us, max %llu us, late releases %u\n",
+               p_task->p_name,
+               (unsigned long long) LatHist_Percentile(&p_task->jitter_hist, 50),
+               (unsigned long long) LatHist_Percentile(&p_task->jitter_hist, 99),
+               (unsigned long long) p_task->jitter_hist.max_us, p_task->late_releases);
+    }
+    printf("Task %-12s policy %s, migrations %u, CPU WCET %llu us, CPU avg %llu us",
+           p_task->p_name, RTSched_PolicyName(p_task->policy), p_task->migrations,
+           (unsigned long long) p_task->cpu_wcet_us,
+           (unsigned long long) (p_task->jobs ? (p_task->cpu_busy_us / p_task->jobs) : 0));
+    if (p_task->policy == RTSCHED_DEADLINE)
+    {
+        printf(", reserved %u/%u us (%u.%u%%)", p_task->runtime_us, p_task->reserve_period_us,
+               (p_task->runtime_us * 100) / p_task->reserve_period_us,
+               ((p_task->runtime_us * 1000) / p_task->reserve_period_us) % 10);
+    }
+    else if (p_task->reserve_errno != 0)
+    {
+        printf(", SCHED_DEADLINE refused: %s", strerror(p_task->reserve_errno));
+    }
+    printf("\n");
+    if (p_task->escalations || p_task->degraded)
+    {
+        printf("Task %-12s escalations %u%s\n", p_task->p_name, p_task->escalations,
+               p_task->degraded ? ", degraded" : "");
+    }
+    (void) pthread_mutex_unlock(&dlmon_mutex);
+}
+
+/****************************************************************
+ * Function Name : DLMon_Utilization
+ * Description   : CPU share of a periodic task at its WCET
+ *                 (WCET / period), for the schedulability check
+ * Returns       : the utilization in permille, 0 if event driven
+ * Params        @p_task: the task
+ ****************************************************************/
+extern uint32_t DLMon_Utilization (const DLMon_Task *p_task)
+{
+    if (p_task->period_us == 0)
+    {
+        return 0;
+    }
+    return (uint32_t) ((p_task->wcet_us * 1000) / p_task->period_us);
+}
@@ -0,0 +1,132 @@
+/*
+ * deadline_monitor.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <stdint.h>         // Fixed-width int type
+
+#include "latency_hist.h"
+#include "rt_sched.h"
+
+/* Execution time of every job of a task is measured against the
+ * budget declared for it. Periodic tasks also record how far each
+ * release drifts from their period. Each task is only written by its
+ * own thread; the lock just keeps the stats dump consistent.
+ *
+ * A task may ask for a SCHED_DEADLINE reservation: after
+ * DLMON_CALIBRATION_JOBS jobs, its runtime is set from the measured
+ * CPU WCET and its period (and implicit deadline) from the task's
+ * period. If the kernel refuses, the task stays on SCHED_FIFO. */
+
+#define DLMON_ESCALATE_MAX  5       // Priority steps a task may gain
+#define DLMON_DEGRADE_CLEAR 100     // Jobs within budget to leave degraded mode
+#define DLMON_CALIBRATION_JOBS 50   // Jobs measured before reserving
+#define DLMON_RUNTIME_MARGIN   200  // Reserved runtime, percent of CPU WCET
+#define DLMON_MAX_RESERVATION  50   // Percent of a period one task may reserve
+#define DLMON_SPORADIC_PERIOD  10000 // us, reservation period of event driven tasks
+
+typedef enum DLMon_Action {
+    DLMON_LOG = 0,      // Print the overrun (rate limited)
+    DLMON_DEGRADE,      // Ask the task to shed optional work
+    DLMON_ESCALATE      // Raise the task's real-time priority one step
+} DLMon_Action;
+
+typedef struct DLMon_Task {
+    /* Declared in the task table */
+    const char  *p_name;
+    uint32_t    period_us;          // 0 = event driven
+    uint32_t    budget_us;          // Execution time per job, 0 = not monitored
+    DLMon_Action action;            // What to do on an overrun
+    /* Measured, reset by DLMon_Init */
+    uint64_t    start_us;           // Start of the running job, 0 if none
+    uint64_t    start_cpu_us;       // Thread CPU time at the start of the job
+    uint64_t    last_start_us;      // Start of the previous job
+    uint32_t    jobs;               // Jobs completed
+    uint32_t    overruns;           // Jobs over budget
+    uint32_t    late_releases;      // Periodic jobs that started a period late
+    int16_t     last_cpu;           // CPU the previous job started on
+    uint32_t    migrations;         // Jobs started on another CPU than the last
+    uint64_t    wcet_us;            // Worst-case execution time seen
+    uint64_t    busy_us;            // Execution time of all jobs
+    uint64_t    cpu_wcet_us;        // Worst CPU time of a job (no blocking)
+    uint64_t    cpu_busy_us;        // CPU time of all jobs
+    uint32_t    escalations;        // Priority steps taken
+    uint8_t     degraded;           // 1 = shed optional work
+    uint32_t    clean_jobs;         // Jobs within budget since degrading
+    LatHist     exec_hist;          // Execution time per job
+    LatHist     jitter_hist;        // |release interval - period|
+    uint8_t     reserve;            // 1 = switch to SCHED_DEADLINE once calibrated
+    uint8_t     reserve_tried;      // 1 = the switch was attempted
+    int         reserve_errno;      // Why the switch failed, 0 if it did not
+    RTSched_Policy policy;          // Policy the task runs under
+    uint32_t    runtime_us;         // Reservation, if policy is DEADLINE
+    uint32_t    reserve_period_us;
+} DLMon_Task;
+
+/****************************************************************
+ * Function Name : DLMon_Init
+ * Description   : Clear the measurements of a task (the declared
+ *                 name, period, budget and action are kept)
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_Init (DLMon_Task *p_task);
+
+/****************************************************************
+ * Function Name : DLMon_RequestReservation
+ * Description   : Ask for a SCHED_DEADLINE reservation once the task
+ *                 is calibrated. Call after DLMon_Init.
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_RequestReservation (DLMon_Task *p_task);
+
+/****************************************************************
+ * Function Name : DLMon_JobStart
+ * Description   : Mark the release of a job of the task
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_JobStart (DLMon_Task *p_task);
+
+/****************************************************************
+ * Function Name : DLMon_JobEnd
+ * Description   : Account the job started by DLMon_JobStart and
+ *                 take the task's action if it ran over budget.
+ *                 Does nothing if no job was started.
+ * Returns       : 1 on an overrun, 0 otherwise
+ * Params        @p_task: the task
+ ****************************************************************/
+extern int DLMon_JobEnd (DLMon_Task *p_task);
+
+/****************************************************************
+ * Function Name : DLMon_Degraded
+ * Description   : Check whether the task should shed optional work
+ * Returns       : 1 if degraded, 0 otherwise
+ * Params        @p_task: the task
+ ****************************************************************/
+extern uint8_t DLMon_Degraded (const DLMon_Task *p_task);
+
+/****************************************************************
+ * Function Name : DLMon_Print
+ * Description   : Print the declared budget and measurements
+ * Returns       : void
+ * Params        @p_task: the task
+ ****************************************************************/
+extern void DLMon_Print (const DLMon_Task *p_task);
+
+/****************************************************************
+ * Function Name : DLMon_Utilization
+ * Description   : CPU share of a periodic task at its WCET
+ *                 (WCET / period), for the schedulability check
+ * Returns       : the utilization in permille, 0 if event driven
+ * Params        @p_task: the task
+ ****************************************************************/
+extern uint32_t DLMon_Utilization (const DLMon_Task *p_task);
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * flight_rec.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <unistd.h>         // write, close
+#include <fcntl.h>          // open
+#include <signal.h>         // sigaction, raise
+
+#include "fm_clock.h"
+#include "flight_rec.h"     // Its header file
+
+static FlightRec_Ring rings[FLIGHTREC_MAX_RINGS];
+static uint32_t rings_used = 1;             // Ring 0 is always in use
+static uint64_t start_us = 0;
+static char dump_path[FLIGHTREC_PATH_SIZE] = "";
+static __thread FlightRec_Ring *p_own_ring = NULL;
+
+/****************************************************************
+ * Function Name : writeAll (private)
+ * Description   : Write a buffer completely. Async-signal safe.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @fd: the file
+ *               @p_data: the buffer
+ *               @size: its size
+ ****************************************************************/
+static int writeAll (int fd, const void *p_data, size_t size)
+{
+    const uint8_t *p_next = (const uint8_t *) p_data;
+    ssize_t written = 0;
+
+    while (size > 0)
+    {
+        written = write(fd, p_next, size);
+        if (written <= 0)
+        {
+            return -1;
+        }
+        p_next += written;
+        size -= (size_t) written;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : fatalHandler (private)
+ * Description   : Dump, then let the signal kill the process
+ * Returns       : void
+ * Params        @sig: the signal
+ ****************************************************************/
+static void fatalHandler (int sig)
+{
+    (void) FlightRec_Dump((uint32_t) sig);
+    /* The action is back to the default: this kills, with a core */
+    (void) raise(sig);
+}
+
+/****************************************************************
+ * Function Name : FlightRec_Init
+ * Description   : Start recording and set where dumps go
+ * Returns       : void
+ * Params        @p_path: dump file, NULL = no dumps
+ ****************************************************************/
+extern void FlightRec_Init (const char *p_path)
+{
+    start_us = FMClock_NowUs();
+    (void) strncpy(rings[0].name, "shared", FLIGHTREC_NAME_SIZE - 1);
+    if (p_path != NULL)
+    {
+        (void) strncpy(dump_path, p_path, FLIGHTREC_PATH_SIZE - 1);
+    }
+}
+
+/****************************************************************
+ * Function Name : FlightRec_RegisterThread
+ * Description   : Give the calling thread its own ring. Without a
+ *                 free ring the thread keeps using ring 0.
+ * Returns       : 0 on success, -1 if no ring is left
+ * Params        @p_name: thread name shown by the decoder
+ ****************************************************************/
+extern int FlightRec_RegisterThread (const char *p_name)
+{
+    uint32_t index = __atomic_fetch_add(&rings_used, 1, __ATOMIC_RELAXED);
+
+    if (index >= FLIGHTREC_MAX_RINGS)
+    {
+        (void) __atomic_fetch_sub(&rings_used, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    (void) strncpy(rings[index].name, p_name, FLIGHTREC_NAME_SIZE - 1);
+    p_own_ring = &rings[index];
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : FlightRec_Log
+ * Description   : Record an event in the calling thread's ring
+ * Returns       : void
+ * Params        @event: the event
+ *               @a, @b, @c: its arguments, see FlightRec_Event
+ ****************************************************************/
+extern void FlightRec_Log (FlightRec_Event event, uint32_t a, uint32_t b, int32_t c)
+{
+    FlightRec_Ring *p_ring = (p_own_ring != NULL) ? p_own_ring : &rings[0];
+    /* Only ring 0 has several writers, but one add costs no more than
+     * a load and a store */
+    uint32_t slot = __atomic_fetch_add(&p_ring->head, 1, __ATOMIC_RELAXED) & (FLIGHTREC_RING_SIZE - 1);
+    FlightRec_Record *p_record = &p_ring->records[slot];
+
+    p_record->at_us = FMClock_NowUs();
+    p_record->event = event;
+    p_record->a = a;
+    p_record->b = b;
+    p_record->c = c;
+}
+
+/****************************************************************
+ * Function Name : FlightRec_Dump
+ * Description   : Write every ring to the dump file. Async-signal
+ *                 safe.
+ * Returns       : 0 on success, -1 on failure or with no dump file
+ * Params        @reason: the signal number or FlightRec_Reason
+ ****************************************************************/
+extern int FlightRec_Dump (uint32_t reason)
+{
+    FlightRec_Header header;
+    int fd = 0;
+    int result = 0;
+
+    if (dump_path[0] == '\0')
+    {
+        return -1;
+    }
+    FlightRec_Log(FLIGHTREC_DUMP, reason, 0, 0);
+
+    header.magic = FLIGHTREC_MAGIC;
+    header.version = FLIGHTREC_VERSION;
+    header.record_size = sizeof(FlightRec_Record);
+    header.ring_size = FLIGHTREC_RING_SIZE;
+    header.rings = __atomic_load_n(&rings_used, __ATOMIC_RELAXED);
+    header.rings = (header.rings < FLIGHTREC_MAX_RINGS) ? header.rings : FLIGHTREC_MAX_RINGS;
+    header.reason = reason;
+    header.start_us = start_us;
+    header.dump_us = FMClock_NowUs();
+
+    fd = open(dump_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    result = writeAll(fd, &header, sizeof(header));
+    if (result == 0)
+    {
+        result = writeAll(fd, rings, header.rings * sizeof(FlightRec_Ring));
+    }
+    (void) close(fd);
+    return result;
+}
+
+/****************************************************************
+ * Function Name : FlightRec_CatchFatal
+ * Description   : Dump on SIGSEGV, SIGBUS, SIGILL, SIGFPE and
+ *                 SIGABRT, then die of the signal as before
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FlightRec_CatchFatal (void)
+{
+    static const int fatal_signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    struct sigaction action;
+    uint8_t index = 0;
+
+    (void) memset(&action, 0, sizeof(action));
+    action.sa_handler = &fatalHandler;
+    action.sa_flags = SA_RESETHAND;
+    (void) sigemptyset(&action.sa_mask);
+    for (index = 0; index < (sizeof(fatal_signals) / sizeof(fatal_signals[0])); index++)
+    {
+        (void) sigaction(fatal_signals[index], &action, NULL);
+    }
+}
+
+/****************************************************************
+ * Function Name : FlightRec_Path
+ * Description   : Get the dump file
+ * Returns       : the path, "" if none
+ * Params        : N/A
+ ****************************************************************/
+extern const char* FlightRec_Path (void)
+{
+    return dump_path;
+}
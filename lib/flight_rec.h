@@ -0,0 +1,131 @@
+/*
+ * flight_rec.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef FLIGHT_REC_H
+#define FLIGHT_REC_H
+
+#include <stdint.h>     // Fixed-width int type
+
+/* Always-on flight recorder: the last FLIGHTREC_RING_SIZE events of
+ * every thread, kept in static rings so a unit that stops responding
+ * still has its recent history. Each registered thread writes its own
+ * ring; ring 0 is shared by the threads that never registered. A
+ * record takes a slot with one atomic add and is filled in place, with
+ * no lock and no system call besides the clock read.
+ *
+ * The rings are written to a file as they are, header first, on a
+ * fatal signal, on SIGUSR2 or when the watchdog trips; only write(2)
+ * is used, so a signal handler may dump. A record being written at
+ * the time of the dump may be torn. tools/flight_decode prints a dump
+ * as one timeline. */
+
+#define FLIGHTREC_MAGIC         0x52474C46  // "FLGR"
+#define FLIGHTREC_VERSION       1
+#define FLIGHTREC_MAX_RINGS     16          // Ring 0 + registered threads
+#define FLIGHTREC_RING_SIZE     256         // Records per ring, a power of two
+#define FLIGHTREC_NAME_SIZE     16
+#define FLIGHTREC_PATH_SIZE     128
+
+typedef enum FlightRec_Event {
+    FLIGHTREC_NONE = 0,         // Never written
+    FLIGHTREC_BUTTON,           // a: GPIO of the press or encoder detent
+    FLIGHTREC_CMD_POST,         // a: bits posted, b: bits pending after
+    FLIGHTREC_CMD_TAKE,         // a: bits taken, b: wait of the oldest (us)
+    FLIGHTREC_I2C_READ,         // a: fd, b: length, c: result or -errno
+    FLIGHTREC_I2C_WRITE,        // a: fd, b: length, c: result or -errno
+    FLIGHTREC_I2C_CLOSE,        // a: fd, c: 0 or -errno
+    FLIGHTREC_I2C_REOPEN,       // a: new fd, c: 0 or -1
+    FLIGHTREC_TUNE,             // a: kHz, b: settle (us), c: lock result
+    FLIGHTREC_POWER,            // a: new power state, b: old one
+    FLIGHTREC_AUDIO,            // a: 1 = on, 0 = muted
+    FLIGHTREC_DUMP,             // a: signal or reason that dumped
+    FLIGHTREC_EVENTS
+} FlightRec_Event;
+
+typedef enum FlightRec_Reason {
+    FLIGHTREC_WATCHDOG = 0x100  // Above every signal number
+} FlightRec_Reason;
+
+typedef struct FlightRec_Record {
+    uint64_t at_us;             // FMClock_NowUs
+    uint32_t event;             // FlightRec_Event
+    uint32_t a;
+    uint32_t b;
+    int32_t  c;
+} FlightRec_Record;
+
+typedef struct FlightRec_Ring {
+    char     name[FLIGHTREC_NAME_SIZE];     // Thread name, "" if unused
+    uint32_t head;                          // Records ever taken; slot = head % size
+    uint32_t reserved;
+    FlightRec_Record records[FLIGHTREC_RING_SIZE];
+} __attribute__((aligned(64))) FlightRec_Ring;
+
+typedef struct FlightRec_Header {
+    uint32_t magic;             // FLIGHTREC_MAGIC
+    uint32_t version;           // FLIGHTREC_VERSION
+    uint32_t record_size;       // sizeof(FlightRec_Record)
+    uint32_t ring_size;         // FLIGHTREC_RING_SIZE
+    uint32_t rings;             // Rings that follow, ring 0 first
+    uint32_t reason;            // Signal number or FlightRec_Reason
+    uint64_t start_us;          // When the recorder started (FMClock_NowUs)
+    uint64_t dump_us;           // When it was dumped
+} FlightRec_Header;
+
+/****************************************************************
+ * Function Name : FlightRec_Init
+ * Description   : Start recording and set where dumps go
+ * Returns       : void
+ * Params        @p_path: dump file, NULL = no dumps
+ ****************************************************************/
+extern void FlightRec_Init (const char *p_path);
+
+/****************************************************************
+ * Function Name : FlightRec_RegisterThread
+ * Description   : Give the calling thread its own ring. Without a
+ *                 free ring the thread keeps using ring 0.
+ * Returns       : 0 on success, -1 if no ring is left
+ * Params        @p_name: thread name shown by the decoder
+ ****************************************************************/
+extern int FlightRec_RegisterThread (const char *p_name);
+
+/****************************************************************
+ * Function Name : FlightRec_Log
+ * Description   : Record an event in the calling thread's ring
+ * Returns       : void
+ * Params        @event: the event
+ *               @a, @b, @c: its arguments, see FlightRec_Event
+ ****************************************************************/
+extern void FlightRec_Log (FlightRec_Event event, uint32_t a, uint32_t b, int32_t c);
+
+/****************************************************************
+ * Function Name : FlightRec_Dump
+ * Description   : Write every ring to the dump file. Async-signal
+ *                 safe.
+ * Returns       : 0 on success, -1 on failure or with no dump file
+ * Params        @reason: the signal number or FlightRec_Reason
+ ****************************************************************/
+extern int FlightRec_Dump (uint32_t reason);
+
+/****************************************************************
+ * Function Name : FlightRec_CatchFatal
+ * Description   : Dump on SIGSEGV, SIGBUS, SIGILL, SIGFPE and
+ *                 SIGABRT, then die of the signal as before
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FlightRec_CatchFatal (void);
+
+/****************************************************************
+ * Function Name : FlightRec_Path
+ * Description   : Get the dump file
+ * Returns       : the path, "" if none
+ * Params        : N/A
+ ****************************************************************/
+extern const char* FlightRec_Path (void);
+
+#endif
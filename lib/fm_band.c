@@ -0,0 +1,134 @@
+/*
+ * fm_band.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <strings.h>        // strcasecmp
+
+#include "fm_band.h"        // Its header file
+
+/* Indexed by FMBand_Id */
+static const FMBand bands[FMBAND_COUNT] = {
+    /* Name  Low (kHz)  High (kHz)  Step (kHz)  De-emphasis (us)  Japan */
+    { "US",  87900,     107900,     200,        75,               0 },
+    { "EU",  87500,     108000,     100,        50,               0 },
+    { "JP",  76000,     91000,      100,        50,               1 },
+};
+
+static const FMBand *p_selected = &bands[FMBAND_US];
+static uint32_t channel_khz[FMBAND_MAX_CHANNELS];
+static uint16_t channel_count = 0;
+
+/****************************************************************
+ * Function Name : buildTable (private)
+ * Description   : Fill the channel table of the selected band
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void buildTable (void)
+{
+    uint32_t freq_khz = 0;
+
+    channel_count = 0;
+    for (freq_khz = p_selected->low_khz;
+         (freq_khz <= p_selected->high_khz) && (channel_count < FMBAND_MAX_CHANNELS);
+         freq_khz += p_selected->step_khz)
+    {
+        channel_khz[channel_count++] = freq_khz;
+    }
+}
+
+/****************************************************************
+ * Function Name : FMBand_Select
+ * Description   : Select the band by name and build its channel
+ *                 table. Call once at start-up; FMBAND_US until then.
+ * Returns       : 0 on success, -1 if the name is unknown
+ * Params        @p_name: "US", "EU" or "JP" (any case)
+ ****************************************************************/
+extern int FMBand_Select (const char *p_name)
+{
+    uint8_t id = 0;
+
+    for (id = 0; id < FMBAND_COUNT; id++)
+    {
+        if (strcasecmp(p_name, bands[id].p_name) == 0)
+        {
+            p_selected = &bands[id];
+            buildTable();
+            return 0;
+        }
+    }
+    printf("ERROR: FMBand - Unknown band %s (US, EU or JP)\n", p_name);
+    return -1;
+}
+
+/****************************************************************
+ * Function Name : FMBand_Get
+ * Description   : Get the selected band
+ * Returns       : the band descriptor
+ * Params        : N/A
+ ****************************************************************/
+extern const FMBand* FMBand_Get (void)
+{
+    return p_selected;
+}
+
+/****************************************************************
+ * Function Name : FMBand_Channels
+ * Description   : Get the number of channels of the selected band
+ * Returns       : the channel count
+ * Params        : N/A
+ ****************************************************************/
+extern uint16_t FMBand_Channels (void)
+{
+    if (channel_count == 0)
+    {
+        buildTable();
+    }
+    return channel_count;
+}
+
+/****************************************************************
+ * Function Name : FMBand_KHz
+ * Description   : Get the frequency of a channel
+ * Returns       : the frequency in kHz
+ * Params        @channel: channel index, below FMBand_Channels()
+ ****************************************************************/
+extern uint32_t FMBand_KHz (uint16_t channel)
+{
+    if (channel_count == 0)
+    {
+        buildTable();
+    }
+    return channel_khz[(channel < channel_count) ? channel : (channel_count - 1)];
+}
+
+/****************************************************************
+ * Function Name : FMBand_Index
+ * Description   : Get the channel nearest to a frequency
+ * Returns       : the channel index, FMBAND_NONE if the frequency
+ *                 is more than half a step outside the band
+ * Params        @freq_khz: the frequency in kHz
+ ****************************************************************/
+extern int FMBand_Index (uint32_t freq_khz)
+{
+    uint32_t half_step = p_selected->step_khz / 2;
+
+    if (((freq_khz + half_step) < p_selected->low_khz) || (freq_khz > (p_selected->high_khz + half_step)))
+    {
+        return FMBAND_NONE;
+    }
+    if (freq_khz <= p_selected->low_khz)
+    {
+        return 0;
+    }
+    if (freq_khz >= p_selected->high_khz)
+    {
+        return FMBand_Channels() - 1;
+    }
+    return (freq_khz - p_selected->low_khz + half_step) / p_selected->step_khz;
+}
@@ -0,0 +1,80 @@
+/*
+ * fm_band.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef FM_BAND_H
+#define FM_BAND_H
+
+#include <stdint.h>     // Fixed-width int type
+
+/* Broadcast bands the receiver can be deployed in. One band is
+ * selected at start-up; its channel table maps a channel index to the
+ * frequency in kHz, so stepping, scanning and presets work on indices
+ * and never compare floats. Frequencies only become channels at the
+ * edges: the state file, presets, traces and the control socket. */
+
+#define FMBAND_MAX_CHANNELS 256     // Largest channel table of any band
+#define FMBAND_NONE         -1      // FMBand_Index: outside the band
+
+typedef enum FMBand_Id {
+    FMBAND_US = 0,          // 87.9 - 107.9 MHz, 200kHz, 75us
+    FMBAND_EU,              // 87.5 - 108.0 MHz, 100kHz, 50us
+    FMBAND_JP,              // 76.0 - 91.0 MHz, 100kHz, 50us, band limit bit
+    FMBAND_COUNT
+} FMBand_Id;
+
+typedef struct FMBand {
+    const char *p_name;     // Name given to -b
+    uint32_t low_khz;       // First channel
+    uint32_t high_khz;      // Last channel
+    uint16_t step_khz;      // Channel spacing
+    uint8_t  deemphasis_us; // 75 or 50
+    uint8_t  japan;         // 1 = TEA5767 band limit bit (BL) set
+} FMBand;
+
+/****************************************************************
+ * Function Name : FMBand_Select
+ * Description   : Select the band by name and build its channel
+ *                 table. Call once at start-up; FMBAND_US until then.
+ * Returns       : 0 on success, -1 if the name is unknown
+ * Params        @p_name: "US", "EU" or "JP" (any case)
+ ****************************************************************/
+extern int FMBand_Select (const char *p_name);
+
+/****************************************************************
+ * Function Name : FMBand_Get
+ * Description   : Get the selected band
+ * Returns       : the band descriptor
+ * Params        : N/A
+ ****************************************************************/
+extern const FMBand* FMBand_Get (void);
+
+/****************************************************************
+ * Function Name : FMBand_Channels
+ * Description   : Get the number of channels of the selected band
+ * Returns       : the channel count
+ * Params        : N/A
+ ****************************************************************/
+extern uint16_t FMBand_Channels (void);
+
+/****************************************************************
+ * Function Name : FMBand_KHz
+ * Description   : Get the frequency of a channel
+ * Returns       : the frequency in kHz
+ * Params        @channel: channel index, below FMBand_Channels()
+ ****************************************************************/
+extern uint32_t FMBand_KHz (uint16_t channel);
+
+/****************************************************************
+ * Function Name : FMBand_Index
+ * Description   : Get the channel nearest to a frequency
+ * Returns       : the channel index, FMBAND_NONE if the frequency
+ *                 is more than half a step outside the band
+ * Params        @freq_khz: the frequency in kHz
+ ****************************************************************/
+extern int FMBand_Index (uint32_t freq_khz);
+
+#endif
@@ -0,0 +1,483 @@
+/*
+ * fm_clock.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <errno.h>      // ETIMEDOUT, EINTR
+#include <time.h>       // clock_gettime, clock_nanosleep
+#include <pthread.h>    // Virtual clock lock
+
+#include "fm_clock.h"   // Its header file
+
+#define FOREVER_US  UINT64_MAX
+
+typedef struct Waiter {
+    pthread_cond_t  wake;       // Signalled once, when woken
+    const void     *p_key;      // Condition waited for, NULL for a sleep
+    uint64_t        deadline_us;
+    uint64_t        order;      // Ties of deadlines, and the run order once ready
+    uint8_t         in_use;
+    uint8_t         counted;    // The waiter counts as running once woken
+    uint8_t         ready;      // Signalled, runs when nothing else does
+    uint8_t         woken;
+    uint8_t         timed_out;
+} Waiter;
+
+static uint8_t virtual_mode = 0;
+static uint64_t virtual_us = 0;             // Virtual time, written under clock_mutex
+static uint32_t running = 0;                // Counted threads not waiting in the clock
+static uint64_t next_order = 0;             // Waiter.order of the next wait or signal
+static pthread_mutex_t clock_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Waiter waiters[FMCLOCK_MAX_WAITERS];
+static pthread_key_t exit_key;              // Ends the count of a registered thread
+static __thread uint8_t counted = 0;        // The calling thread counts
+
+/****************************************************************
+ * Function Name : monotonicUs (private)
+ * Description   : Read the monotonic clock
+ * Returns       : the monotonic time in microseconds
+ * Params        : N/A
+ ****************************************************************/
+static uint64_t monotonicUs (void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * USEC_PER_SEC) + ((uint64_t) ts.tv_nsec / NSEC_PER_USEC);
+}
+
+/****************************************************************
+ * Function Name : wakeWaiter (private)
+ * Description   : Wake one waiter. Call with clock_mutex held.
+ * Returns       : void
+ * Params        @p_waiter: the waiter
+ *               @timed_out: 1 if its deadline passed
+ ****************************************************************/
+static void wakeWaiter (Waiter *p_waiter, uint8_t timed_out)
+{
+    p_waiter->woken = 1;
+    p_waiter->timed_out = timed_out;
+    /* Running from now, or time could move on before it is scheduled */
+    running += p_waiter->counted;
+    (void) pthread_cond_signal(&p_waiter->wake);
+}
+
+/****************************************************************
+ * Function Name : nextWaiter (private)
+ * Description   : Pick the waiter to run next: the first signalled
+ *                 one, else the earliest deadline, first come first
+ *                 served. Call with clock_mutex held.
+ * Returns       : the waiter, NULL if every waiter waits forever
+ * Params        : N/A
+ ****************************************************************/
+static Waiter* nextWaiter (void)
+{
+    Waiter *p_next = NULL;
+    Waiter *p_waiter = NULL;
+    uint8_t index = 0;
+
+    for (index = 0; index < FMCLOCK_MAX_WAITERS; index++)
+    {
+        p_waiter = &waiters[index];
+        if (!p_waiter->in_use || p_waiter->woken || (!p_waiter->ready && (p_waiter->deadline_us == FOREVER_US)))
+        {
+            continue;
+        }
+        if ((p_next == NULL) || (p_waiter->ready > p_next->ready)
+            || ((p_waiter->ready == p_next->ready) && p_waiter->ready && (p_waiter->order < p_next->order))
+            || ((p_waiter->ready == p_next->ready) && !p_waiter->ready
+                && ((p_waiter->deadline_us < p_next->deadline_us)
+                    || ((p_waiter->deadline_us == p_next->deadline_us) && (p_waiter->order < p_next->order)))))
+        {
+            p_next = p_waiter;
+        }
+    }
+    return p_next;
+}
+
+/****************************************************************
+ * Function Name : advance (private)
+ * Description   : With every counted thread waiting, run the next
+ *                 waiter, jumping to its deadline if it was not
+ *                 signalled. Call with clock_mutex held.
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void advance (void)
+{
+    Waiter *p_next = NULL;
+
+    /* An uncounted waiter woken does not stop the clock */
+    while (running == 0)
+    {
+        p_next = nextWaiter();
+        /* Everyone waits for everyone: only a real event can help now */
+        if (p_next == NULL)
+        {
+            return;
+        }
+        if (!p_next->ready && (p_next->deadline_us > virtual_us))
+        {
+            __atomic_store_n(&virtual_us, p_next->deadline_us, __ATOMIC_RELEASE);
+        }
+        wakeWaiter(p_next, !p_next->ready);
+    }
+}
+
+/****************************************************************
+ * Function Name : virtualWait (private)
+ * Description   : Wait in the virtual clock for a signal on a key
+ *                 or a deadline. The caller's mutex is released
+ *                 once the wait is registered, and taken back after.
+ * Returns       : 0 when signalled, ETIMEDOUT past the deadline
+ * Params        @p_key: what FMClock_CondSignal wakes, NULL for none
+ *               @p_mutex: the caller's mutex, NULL for none
+ *               @deadline_us: virtual time to give up at, FOREVER_US
+ ****************************************************************/
+static int virtualWait (const void *p_key, pthread_mutex_t *p_mutex, uint64_t deadline_us)
+{
+    Waiter *p_waiter = NULL;
+    uint8_t index = 0;
+    int result = 0;
+
+    (void) pthread_mutex_lock(&clock_mutex);
+    if (deadline_us <= virtual_us)
+    {
+        (void) pthread_mutex_unlock(&clock_mutex);
+        return ETIMEDOUT;
+    }
+    for (index = 0; (index < FMCLOCK_MAX_WAITERS) && (p_waiter == NULL); index++)
+    {
+        if (!waiters[index].in_use)
+        {
+            p_waiter = &waiters[index];
+        }
+    }
+    if (p_waiter == NULL)
+    {
+        (void) pthread_mutex_unlock(&clock_mutex);
+        printf("ERROR: FMClock - More than %u waiters\n", FMCLOCK_MAX_WAITERS);
+        return ETIMEDOUT;
+    }
+    p_waiter->p_key = p_key;
+    p_waiter->deadline_us = deadline_us;
+    p_waiter->order = next_order++;
+    p_waiter->in_use = 1;
+    p_waiter->counted = counted;
+    p_waiter->ready = 0;
+    p_waiter->woken = 0;
+    p_waiter->timed_out = 0;
+    running -= counted;
+    advance();
+
+    /* Registered first: a signal from now on finds the waiter */
+    if (p_mutex != NULL)
+    {
+        (void) pthread_mutex_unlock(p_mutex);
+    }
+    while (!p_waiter->woken)
+    {
+        (void) pthread_cond_wait(&p_waiter->wake, &clock_mutex);
+    }
+    result = p_waiter->timed_out ? ETIMEDOUT : 0;
+    p_waiter->in_use = 0;
+    (void) pthread_mutex_unlock(&clock_mutex);
+
+    if (p_mutex != NULL)
+    {
+        (void) pthread_mutex_lock(p_mutex);
+    }
+    return result;
+}
+
+/****************************************************************
+ * Function Name : wakeKey (private)
+ * Description   : Make the virtual clock waiters of a key ready.
+ *                 They run in turn once the caller waits, so one
+ *                 counted thread runs at a time.
+ * Returns       : void
+ * Params        @p_key: the key
+ *               @all: 1 for every waiter, 0 for the first
+ ****************************************************************/
+static void wakeKey (const void *p_key, uint8_t all)
+{
+    uint8_t index = 0;
+
+    (void) pthread_mutex_lock(&clock_mutex);
+    for (index = 0; index < FMCLOCK_MAX_WAITERS; index++)
+    {
+        if (waiters[index].in_use && !waiters[index].woken && !waiters[index].ready
+            && (waiters[index].p_key == p_key))
+        {
+            waiters[index].ready = 1;
+            waiters[index].order = next_order++;
+            if (!all)
+            {
+                break;
+            }
+        }
+    }
+    /* Signalled by a thread that does not count: run them now */
+    advance();
+    (void) pthread_mutex_unlock(&clock_mutex);
+}
+
+/****************************************************************
+ * Function Name : threadExit (private)
+ * Description   : End the count of a registered thread at its exit
+ * Returns       : void
+ * Params        @p_value: the thread's key value, unused
+ ****************************************************************/
+static void threadExit (void *p_value)
+{
+    (void) p_value;
+    FMClock_AddThreads(-1);
+}
+
+/****************************************************************
+ * Function Name : FMClock_NowUs
+ * Description   : Read the clock
+ * Returns       : the current monotonic or virtual time in
+ *                 microseconds
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t FMClock_NowUs (void)
+{
+    if (virtual_mode)
+    {
+        return __atomic_load_n(&virtual_us, __ATOMIC_ACQUIRE);
+    }
+    return monotonicUs();
+}
+
+/****************************************************************
+ * Function Name : FMClock_ThreadCpuUs
+ * Description   : Read the CPU time used by the calling thread
+ * Returns       : the thread's CPU time in microseconds
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t FMClock_ThreadCpuUs (void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ((uint64_t) ts.tv_sec * USEC_PER_SEC) + ((uint64_t) ts.tv_nsec / NSEC_PER_USEC);
+}
+
+/****************************************************************
+ * Function Name : FMClock_ProcessCpuUs
+ * Description   : Read the CPU time used by all threads together
+ * Returns       : the process's CPU time in microseconds
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t FMClock_ProcessCpuUs (void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ((uint64_t) ts.tv_sec * USEC_PER_SEC) + ((uint64_t) ts.tv_nsec / NSEC_PER_USEC);
+}
+
+/****************************************************************
+ * Function Name : FMClock_UseVirtual
+ * Description   : Switch to the virtual clock, starting at a time
+ *                 already read from the monotonic clock, so the work
+ *                 done since then takes no time. Call once, before
+ *                 any thread starts; the caller counts as running.
+ * Returns       : void
+ * Params        @start_us: the time to start at, e.g. the process
+ *                          start (FMClock_NowUs before the switch)
+ ****************************************************************/
+extern void FMClock_UseVirtual (uint64_t start_us)
+{
+    uint8_t index = 0;
+
+    for (index = 0; index < FMCLOCK_MAX_WAITERS; index++)
+    {
+        (void) pthread_cond_init(&waiters[index].wake, NULL);
+    }
+    (void) pthread_key_create(&exit_key, &threadExit);
+    virtual_us = start_us;
+    running = 1;
+    counted = 1;
+    virtual_mode = 1;
+}
+
+/****************************************************************
+ * Function Name : FMClock_IsVirtual
+ * Description   : Tell if the virtual clock is in use
+ * Returns       : 1 if it is, 0 for the monotonic clock
+ * Params        : N/A
+ ****************************************************************/
+extern uint8_t FMClock_IsVirtual (void)
+{
+    return virtual_mode;
+}
+
+/****************************************************************
+ * Function Name : FMClock_AddThreads
+ * Description   : Count threads about to start as running, so
+ *                 virtual time waits for them, or give the count of
+ *                 threads that failed to start back
+ * Returns       : void
+ * Params        @count: threads to start, negative for failures
+ ****************************************************************/
+extern void FMClock_AddThreads (int32_t count)
+{
+    if (!virtual_mode)
+    {
+        return;
+    }
+    (void) pthread_mutex_lock(&clock_mutex);
+    running += (uint32_t) count;
+    advance();
+    (void) pthread_mutex_unlock(&clock_mutex);
+}
+
+/****************************************************************
+ * Function Name : FMClock_RegisterThread
+ * Description   : Keep the count of the calling thread, started
+ *                 after FMClock_AddThreads, until it exits
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMClock_RegisterThread (void)
+{
+    if (!virtual_mode || counted)
+    {
+        return;
+    }
+    counted = 1;
+    (void) pthread_setspecific(exit_key, &counted);
+}
+
+/****************************************************************
+ * Function Name : FMClock_UnregisterThread
+ * Description   : Give the count of the calling thread back: it
+ *                 waits on real events from now on. Called once,
+ *                 registered or not.
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMClock_UnregisterThread (void)
+{
+    if (!virtual_mode)
+    {
+        return;
+    }
+    counted = 0;
+    (void) pthread_setspecific(exit_key, NULL);
+    FMClock_AddThreads(-1);
+}
+
+/****************************************************************
+ * Function Name : FMClock_SleepUs
+ * Description   : Sleep for a time
+ * Returns       : void
+ * Params        @sleep_us: the time in microseconds
+ ****************************************************************/
+extern void FMClock_SleepUs (uint64_t sleep_us)
+{
+    FMClock_SleepUntilUs(FMClock_NowUs() + sleep_us);
+}
+
+/****************************************************************
+ * Function Name : FMClock_SleepUntilUs
+ * Description   : Sleep until an absolute time
+ * Returns       : void
+ * Params        @wake_us: the time to wake at (FMClock_NowUs)
+ ****************************************************************/
+extern void FMClock_SleepUntilUs (uint64_t wake_us)
+{
+    struct timespec wake = { (time_t) (wake_us / USEC_PER_SEC),
+                             (long) ((wake_us % USEC_PER_SEC) * NSEC_PER_USEC) };
+
+    if (virtual_mode)
+    {
+        (void) virtualWait(NULL, NULL, wake_us);
+        return;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR)
+    {
+    }
+}
+
+/****************************************************************
+ * Function Name : FMClock_CondInit
+ * Description   : Set up a condition for timed waits on this clock
+ * Returns       : void
+ * Params        @p_cond: the condition
+ ****************************************************************/
+extern void FMClock_CondInit (pthread_cond_t *p_cond)
+{
+    pthread_condattr_t attr;
+
+    /* Real deadlines count on the monotonic clock, like FMClock_NowUs */
+    (void) pthread_condattr_init(&attr);
+    (void) pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    (void) pthread_cond_init(p_cond, &attr);
+    (void) pthread_condattr_destroy(&attr);
+}
+
+/****************************************************************
+ * Function Name : FMClock_CondWait
+ * Description   : pthread_cond_wait with an optional deadline on
+ *                 this clock. May wake spuriously.
+ * Returns       : 0 when signalled, ETIMEDOUT past the deadline
+ * Params        @p_cond: the condition, from FMClock_CondInit if
+ *                        the wait is timed
+ *               @p_mutex: its mutex, held by the caller
+ *               @deadline_us: time to give up at (FMClock_NowUs),
+ *                             0 to wait forever
+ ****************************************************************/
+extern int FMClock_CondWait (pthread_cond_t *p_cond, pthread_mutex_t *p_mutex, uint64_t deadline_us)
+{
+    struct timespec deadline = { (time_t) (deadline_us / USEC_PER_SEC),
+                                 (long) ((deadline_us % USEC_PER_SEC) * NSEC_PER_USEC) };
+
+    if (virtual_mode)
+    {
+        return virtualWait(p_cond, p_mutex, (deadline_us == 0) ? FOREVER_US : deadline_us);
+    }
+    if (deadline_us == 0)
+    {
+        return pthread_cond_wait(p_cond, p_mutex);
+    }
+    return pthread_cond_timedwait(p_cond, p_mutex, &deadline);
+}
+
+/****************************************************************
+ * Function Name : FMClock_CondSignal
+ * Description   : Wake a waiter of FMClock_CondWait
+ * Returns       : void
+ * Params        @p_cond: the condition
+ ****************************************************************/
+extern void FMClock_CondSignal (pthread_cond_t *p_cond)
+{
+    if (virtual_mode)
+    {
+        wakeKey(p_cond, 0);
+        return;
+    }
+    (void) pthread_cond_signal(p_cond);
+}
+
+/****************************************************************
+ * Function Name : FMClock_CondBroadcast
+ * Description   : Wake every waiter of FMClock_CondWait
+ * Returns       : void
+ * Params        @p_cond: the condition
+ ****************************************************************/
+extern void FMClock_CondBroadcast (pthread_cond_t *p_cond)
+{
+    if (virtual_mode)
+    {
+        wakeKey(p_cond, 1);
+        return;
+    }
+    (void) pthread_cond_broadcast(p_cond);
+}
@@ -0,0 +1,161 @@
+/*
+ * fm_clock.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef FM_CLOCK_H
+#define FM_CLOCK_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <time.h>       // clock_gettime
+#include <pthread.h>    // Condition waits
+
+#define USEC_PER_SEC  1000000ULL
+#define NSEC_PER_USEC 1000ULL
+#define FMCLOCK_MAX_WAITERS 64  // Threads blocked on the virtual clock at once
+
+/* Every timestamp, sleep and timed wait of the receiver goes through
+ * this clock. By default it is the monotonic clock. With
+ * FMClock_UseVirtual it becomes a discrete-event clock: time stands
+ * still while any counted thread runs, and jumps to the earliest
+ * deadline as soon as every counted thread waits in the clock. The
+ * counted threads take turns: a signalled waiter runs once its
+ * signaller waits, before any deadline, and deadlines wake earliest
+ * first. A run on the simulated bus then takes the same steps every
+ * time and only as long as the CPU work it does.
+ *
+ * A thread that blocks outside the clock (a mutex held across a sleep,
+ * a socket, a GPIO poll) stops virtual time, so such a thread must not
+ * count: the creator counts a thread with FMClock_AddThreads before it
+ * starts, and the thread then either registers (its count ends when it
+ * exits) or unregisters. The thread CPU clocks are always real. */
+
+/****************************************************************
+ * Function Name : FMClock_NowUs
+ * Description   : Read the monotonic clock
+ * Returns       : the current monotonic time in microseconds
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t FMClock_NowUs (void);
+
+/****************************************************************
+ * Function Name : FMClock_ThreadCpuUs
+ * Description   : Read the CPU time used by the calling thread
+ * Returns       : the thread's CPU time in microseconds
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t FMClock_ThreadCpuUs (void);
+
+/****************************************************************
+ * Function Name : FMClock_ProcessCpuUs
+ * Description   : Read the CPU time used by all threads together
+ * Returns       : the process's CPU time in microseconds
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t FMClock_ProcessCpuUs (void);
+
+/****************************************************************
+ * Function Name : FMClock_UseVirtual
+ * Description   : Switch to the virtual clock, starting at a time
+ *                 already read from the monotonic clock, so the work
+ *                 done since then takes no time. Call once, before
+ *                 any thread starts; the caller counts as running.
+ * Returns       : void
+ * Params        @start_us: the time to start at, e.g. the process
+ *                          start (FMClock_NowUs before the switch)
+ ****************************************************************/
+extern void FMClock_UseVirtual (uint64_t start_us);
+
+/****************************************************************
+ * Function Name : FMClock_IsVirtual
+ * Description   : Tell if the virtual clock is in use
+ * Returns       : 1 if it is, 0 for the monotonic clock
+ * Params        : N/A
+ ****************************************************************/
+extern uint8_t FMClock_IsVirtual (void);
+
+/****************************************************************
+ * Function Name : FMClock_AddThreads
+ * Description   : Count threads about to start as running, so
+ *                 virtual time waits for them, or give the count of
+ *                 threads that failed to start back
+ * Returns       : void
+ * Params        @count: threads to start, negative for failures
+ ****************************************************************/
+extern void FMClock_AddThreads (int32_t count);
+
+/****************************************************************
+ * Function Name : FMClock_RegisterThread
+ * Description   : Keep the count of the calling thread, started
+ *                 after FMClock_AddThreads, until it exits
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMClock_RegisterThread (void);
+
+/****************************************************************
+ * Function Name : FMClock_UnregisterThread
+ * Description   : Give the count of the calling thread back: it
+ *                 waits on real events from now on. Called once,
+ *                 registered or not.
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMClock_UnregisterThread (void);
+
+/****************************************************************
+ * Function Name : FMClock_SleepUs
+ * Description   : Sleep for a time
+ * Returns       : void
+ * Params        @sleep_us: the time in microseconds
+ ****************************************************************/
+extern void FMClock_SleepUs (uint64_t sleep_us);
+
+/****************************************************************
+ * Function Name : FMClock_SleepUntilUs
+ * Description   : Sleep until an absolute time
+ * Returns       : void
+ * Params        @wake_us: the time to wake at (FMClock_NowUs)
+ ****************************************************************/
+extern void FMClock_SleepUntilUs (uint64_t wake_us);
+
+/****************************************************************
+ * Function Name : FMClock_CondInit
+ * Description   : Set up a condition for timed waits on this clock
+ * Returns       : void
+ * Params        @p_cond: the condition
+ ****************************************************************/
+extern void FMClock_CondInit (pthread_cond_t *p_cond);
+
+/****************************************************************
+ * Function Name : FMClock_CondWait
+ * Description   : pthread_cond_wait with an optional deadline on
+ *                 this clock. May wake spuriously.
+ * Returns       : 0 when signalled, ETIMEDOUT past the deadline
+ * Params        @p_cond: the condition, from FMClock_CondInit if
+ *                        the wait is timed
+ *               @p_mutex: its mutex, held by the caller
+ *               @deadline_us: time to give up at (FMClock_NowUs),
+ *                             0 to wait forever
+ ****************************************************************/
+extern int FMClock_CondWait (pthread_cond_t *p_cond, pthread_mutex_t *p_mutex, uint64_t deadline_us);
+
+/****************************************************************
+ * Function Name : FMClock_CondSignal
+ * Description   : Wake a waiter of FMClock_CondWait
+ * Returns       : void
+ * Params        @p_cond: the condition
+ ****************************************************************/
+extern void FMClock_CondSignal (pthread_cond_t *p_cond);
+
+/****************************************************************
+ * Function Name : FMClock_CondBroadcast
+ * Description   : Wake every waiter of FMClock_CondWait
+ * Returns       : void
+ * Params        @p_cond: the condition
+ ****************************************************************/
+extern void FMClock_CondBroadcast (pthread_cond_t *p_cond);
+
+#endif
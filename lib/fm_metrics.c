@@ -0,0 +1,178 @@
+/*
+ * fm_metrics.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <string.h>     // String-handling library
+#include <unistd.h>     // POSIX API
+#include <fcntl.h>      // File controls
+#include <sys/mman.h>   // shm_open, mmap
+
+#include "fm_clock.h"
+#include "fm_metrics.h" // Its header file
+
+#define TUNE_BUCKET_BASE_US 1000    // Upper bound of the first bucket
+
+static FMMetrics_Segment fallback_segment;      // Used when shm is unavailable
+static char segment_name[64] = "";              // shm name to unlink, "" if none
+
+__thread FMMetrics_Slot *g_fm_metrics_slot = NULL;
+FMMetrics_Slot *g_fm_metrics_shared = &fallback_segment.slot[0];
+FMMetrics_Segment *g_fm_metrics = &fallback_segment;
+
+/****************************************************************
+ * Function Name : segmentInit (private)
+ * Description   : Lay out an empty segment. The magic goes in last
+ *                 so a reader never trusts a half-written header.
+ * Returns       : void
+ * Params        @p_segment: the segment
+ ****************************************************************/
+static void segmentInit (FMMetrics_Segment *p_segment)
+{
+    (void) memset(p_segment, 0, sizeof(FMMetrics_Segment));
+    p_segment->version = FM_METRICS_VERSION;
+    p_segment->size = sizeof(FMMetrics_Segment);
+    p_segment->slots = 1;
+    p_segment->start_us = FMClock_NowUs();
+    (void) strncpy(p_segment->slot[0].name, "shared", FM_METRICS_NAME_SIZE - 1);
+    __atomic_store_n(&p_segment->magic, FM_METRICS_MAGIC, __ATOMIC_RELEASE);
+}
+
+/****************************************************************
+ * Function Name : FMMetrics_Open
+ * Description   : Create and map the shared memory segment. On
+ *                 failure the counters stay in process memory, so
+ *                 the instrumentation never has to check.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_name: shm_open name, e.g. FM_METRICS_NAME
+ ****************************************************************/
+extern int FMMetrics_Open (const char *p_name)
+{
+    int fd = 0;     // to store the shared memory object
+    void *p_map;    // to store the mapped address
+
+    segmentInit(&fallback_segment);
+
+    fd = shm_open(p_name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        perror("ERROR: FMMetrics - Failed to open the metrics segment");
+        return -1;
+    }
+
+    /* Resize to the current layout; stale contents are reset below */
+    if (ftruncate(fd, sizeof(FMMetrics_Segment)) < 0)
+    {
+        perror("ERROR: FMMetrics - Failed to size the metrics segment");
+        (void) close(fd);
+        return -1;
+    }
+
+    p_map = mmap(NULL, sizeof(FMMetrics_Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    /* The mapping keeps its own reference to the object */
+    (void) close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        perror("ERROR: FMMetrics - Failed to map the metrics segment");
+        return -1;
+    }
+
+    /* Counters start from zero on every run, as Prometheus expects
+     * after a restart */
+    __atomic_store_n(&((FMMetrics_Segment *) p_map)->magic, 0, __ATOMIC_RELEASE);
+    segmentInit((FMMetrics_Segment *) p_map);
+    g_fm_metrics = (FMMetrics_Segment *) p_map;
+    g_fm_metrics_shared = &g_fm_metrics->slot[0];
+    (void) strncpy(segment_name, p_name, sizeof(segment_name) - 1);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : FMMetrics_RegisterThread
+ * Description   : Give the calling thread its own counter slot.
+ *                 Without a free slot the thread keeps using slot 0.
+ * Returns       : 0 on success, -1 if no slot is left
+ * Params        @p_name: thread name shown by the reader
+ ****************************************************************/
+extern int FMMetrics_RegisterThread (const char *p_name)
+{
+    FMMetrics_Slot *p_slot;
+    uint32_t index;
+
+    index = __atomic_fetch_add(&g_fm_metrics->slots, 1, __ATOMIC_RELAXED);
+    if (index >= FM_METRICS_MAX_SLOTS)
+    {
+        (void) __atomic_fetch_sub(&g_fm_metrics->slots, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    p_slot = &g_fm_metrics->slot[index];
+    (void) strncpy(p_slot->name, p_name, FM_METRICS_NAME_SIZE - 1);
+    g_fm_metrics_slot = p_slot;
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : FMMetrics_ObserveTune
+ * Description   : Count a tune in the latency histogram
+ * Returns       : void
+ * Params        @latency_us: request to lock latency
+ ****************************************************************/
+extern void FMMetrics_ObserveTune (uint64_t latency_us)
+{
+    uint8_t bucket = 0;
+
+    /* Bucket b holds latencies up to 1ms << b; the last one is +Inf */
+    while ((bucket < (FM_METRICS_TUNE_BUCKETS - 1))
+           && (latency_us > ((uint64_t) TUNE_BUCKET_BASE_US << bucket)))
+    {
+        bucket++;
+    }
+
+    FMMetrics_Add(FM_M_TUNES, 1);
+    FMMetrics_Add(FM_M_TUNE_SUM_US, latency_us);
+    FMMetrics_Add((FMMetrics_Counter) (FM_M_TUNE_BUCKET + bucket), 1);
+}
+
+/****************************************************************
+ * Function Name : FMMetrics_Total
+ * Description   : Sum a counter over every slot, for the stats dump
+ * Returns       : the total
+ * Params        @counter: the counter
+ ****************************************************************/
+extern uint64_t FMMetrics_Total (FMMetrics_Counter counter)
+{
+    uint32_t slots = __atomic_load_n(&g_fm_metrics->slots, __ATOMIC_RELAXED);
+    uint64_t total = 0;
+    uint32_t slot = 0;
+
+    if (slots > FM_METRICS_MAX_SLOTS)
+    {
+        slots = FM_METRICS_MAX_SLOTS;
+    }
+    for (slot = 0; slot < slots; slot++)
+    {
+        total += __atomic_load_n(&g_fm_metrics->slot[slot].counters[counter], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+/****************************************************************
+ * Function Name : FMMetrics_Close
+ * Description   : Remove the segment name. The mapping stays valid
+ *                 until exit, so threads still counting are safe.
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMMetrics_Close (void)
+{
+    if (segment_name[0] != '\0')
+    {
+        (void) shm_unlink(segment_name);
+        segment_name[0] = '\0';
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ * fm_metrics.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef FM_METRICS_H
+#define FM_METRICS_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <stddef.h>     // NULL
+
+/* Counters and gauges in a POSIX shared memory segment, so external
+ * scrapers read them with plain loads and no call into the receiver.
+ * Each thread owns a cache-line aligned slot of counters; slot 0 is
+ * shared by threads that never registered. Updates are relaxed
+ * atomics, so a reader never sees a torn 64-bit value. */
+
+#define FM_METRICS_NAME         "/fm_receiver.metrics"  // shm_open name
+#define FM_METRICS_MAGIC        0x464D4D54  // "FMMT"
+#define FM_METRICS_VERSION      1
+#define FM_METRICS_MAX_SLOTS    16          // Slot 0 + registered threads
+#define FM_METRICS_NAME_SIZE    16
+#define FM_METRICS_CACHE_LINE   64
+#define FM_METRICS_TUNE_BUCKETS 10          // <= 1, 2, 4 ... 256 ms, then +Inf
+
+typedef enum FMMetrics_Counter {
+    FM_M_I2C_READS = 0,     // Register reads that went through
+    FM_M_I2C_WRITES,        // Register writes that went through
+    FM_M_I2C_BYTES,         // Bytes moved on the bus
+    FM_M_I2C_ERRORS,        // Failed reads and writes
+    FM_M_I2C_RETRIES,       // Transfer attempts after a failure
+    FM_M_I2C_REOPENS,       // Bus reopen + device rebind attempts
+    FM_M_I2C_ELIDED,        // Writes skipped, image already on the device
+    FM_M_BUTTON_EVENTS,     // Completed button presses
+    FM_M_COMMANDS,          // Commands posted to the FM thread
+    FM_M_TUNES,             // Tunes completed (any outcome)
+    FM_M_TUNE_TIMEOUTS,     // Tunes that did not lock in time
+    FM_M_TUNE_FAILURES,     // Tunes that failed
+    FM_M_TUNE_SUM_US,       // Sum of request to lock latencies
+    FM_M_TUNE_BUCKET,       // First of FM_METRICS_TUNE_BUCKETS buckets
+    FM_M_COUNTERS = FM_M_TUNE_BUCKET + FM_METRICS_TUNE_BUCKETS
+} FMMetrics_Counter;
+
+typedef enum FMMetrics_Gauge {
+    FM_G_QUEUE_DEPTH = 0,   // Commands waiting for the FM thread
+    FM_G_FREQUENCY_KHZ,     // Tuned frequency
+    FM_G_LOCKED,            // 1 = PLL locked on the tuned frequency
+    FM_G_AUDIO,             // 1 = audio on
+    FM_G_SIGNAL_LEVEL,      // Smoothed level ADC (0 - 15)
+    FM_G_CONTROL_CLIENTS,   // Control socket clients
+    FM_G_POWER_STATE,       // 0 = playing, 1 = muted, 2 = standby
+    FM_G_GAUGES
+} FMMetrics_Gauge;
+
+typedef struct FMMetrics_Slot {
+    char     name[FM_METRICS_NAME_SIZE];    // Thread name, "" if unused
+    uint64_t counters[FM_M_COUNTERS];
+} __attribute__((aligned(FM_METRICS_CACHE_LINE))) FMMetrics_Slot;
+
+typedef struct FMMetrics_Segment {
+    uint32_t magic;             // FM_METRICS_MAGIC once initialised
+    uint32_t version;           // FM_METRICS_VERSION
+    uint32_t size;              // sizeof(FMMetrics_Segment)
+    uint32_t slots;             // Slots in use, including slot 0
+    uint64_t start_us;          // Monotonic time the receiver started
+    int64_t  gauges[FM_G_GAUGES] __attribute__((aligned(FM_METRICS_CACHE_LINE)));
+    FMMetrics_Slot slot[FM_METRICS_MAX_SLOTS];
+} FMMetrics_Segment;
+
+/* Slot of the calling thread, NULL until it registers */
+extern __thread FMMetrics_Slot *g_fm_metrics_slot;
+/* Slot 0 of the segment (a private slot before FMMetrics_Open) */
+extern FMMetrics_Slot *g_fm_metrics_shared;
+/* The segment (a private one before FMMetrics_Open) */
+extern FMMetrics_Segment *g_fm_metrics;
+
+/****************************************************************
+ * Function Name : FMMetrics_Open
+ * Description   : Create and map the shared memory segment. On
+ *                 failure the counters stay in process memory, so
+ *                 the instrumentation never has to check.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_name: shm_open name, e.g. FM_METRICS_NAME
+ ****************************************************************/
+extern int FMMetrics_Open (const char *p_name);
+
+/****************************************************************
+ * Function Name : FMMetrics_RegisterThread
+ * Description   : Give the calling thread its own counter slot.
+ *                 Without a free slot the thread keeps using slot 0.
+ * Returns       : 0 on success, -1 if no slot is left
+ * Params        @p_name: thread name shown by the reader
+ ****************************************************************/
+extern int FMMetrics_RegisterThread (const char *p_name);
+
+/****************************************************************
+ * Function Name : FMMetrics_ObserveTune
+ * Description   : Count a tune in the latency histogram
+ * Returns       : void
+ * Params        @latency_us: request to lock latency
+ ****************************************************************/
+extern void FMMetrics_ObserveTune (uint64_t latency_us);
+
+/****************************************************************
+ * Function Name : FMMetrics_Total
+ * Description   : Sum a counter over every slot, for the stats dump
+ * Returns       : the total
+ * Params        @counter: the counter
+ ****************************************************************/
+extern uint64_t FMMetrics_Total (FMMetrics_Counter counter);
+
+/****************************************************************
+ * Function Name : FMMetrics_Close
+ * Description   : Remove the segment name. The mapping stays valid
+ *                 until exit, so threads still counting are safe.
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMMetrics_Close (void);
+
+/****************************************************************
+ * Function Name : FMMetrics_Add
+ * Description   : Add to a counter of the calling thread's slot
+ * Returns       : void
+ * Params        @counter: the counter
+ *               @value: the amount to add
+ ****************************************************************/
+static inline void FMMetrics_Add (FMMetrics_Counter counter, uint64_t value)
+{
+    FMMetrics_Slot *p_slot = g_fm_metrics_slot;
+
+    if (p_slot == NULL)
+    {
+        p_slot = g_fm_metrics_shared;
+    }
+    (void) __atomic_fetch_add(&p_slot->counters[counter], value, __ATOMIC_RELAXED);
+}
+
+/****************************************************************
+ * Function Name : FMMetrics_SetGauge
+ * Description   : Set a gauge
+ * Returns       : void
+ * Params        @gauge: the gauge
+ *               @value: the new value
+ ****************************************************************/
+static inline void FMMetrics_SetGauge (FMMetrics_Gauge gauge, int64_t value)
+{
+    __atomic_store_n(&g_fm_metrics->gauges[gauge], value, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * fm_probes.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef FM_PROBES_H
+#define FM_PROBES_H
+
+/* USDT (user-level statically defined tracing) probes of the "fm"
+ * provider, for bpftrace or perf on a unit in the field. With
+ * <sys/sdt.h> (systemtap-sdt-dev) installed, each probe is a single
+ * nop and a note in the ELF file: nothing runs until a tracer attaches.
+ * Without the header, or built with -DFM_NO_PROBES, the probes are
+ * compiled out. Arguments must have no side effects.
+ *
+ *   button_sample (gpio, level)             every button read
+ *   button_event  (gpio)                    a complete press
+ *   cmd_enqueue   (queue, bits, pending)    CmdQueue_Post
+ *   cmd_dequeue   (queue, bits, wait_us)    CmdQueue_Take, oldest post
+ *   i2c_start     (fd, length, read)        before a bus transfer
+ *   i2c_end       (fd, length, result)      after it, result < 0 on failure
+ *   tune_done     (freq_khz, lock_result, settle_us, audio_us)
+ *
+ * List them with: perf list 'sdt_fm:*' after perf buildid-cache --add,
+ * or bpftrace -l 'usdt:./fm_receiver:fm:*'. */
+
+#if !defined(FM_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define FM_PROBES_ENABLED 1
+#endif
+#endif
+
+#ifdef FM_PROBES_ENABLED
+#define FM_PROBE1(name, a)              DTRACE_PROBE1(fm, name, a)
+#define FM_PROBE2(name, a, b)           DTRACE_PROBE2(fm, name, a, b)
+#define FM_PROBE3(name, a, b, c)        DTRACE_PROBE3(fm, name, a, b, c)
+#define FM_PROBE4(name, a, b, c, d)     DTRACE_PROBE4(fm, name, a, b, c, d)
+#else
+#define FM_PROBE1(name, a)              do { } while (0)
+#define FM_PROBE2(name, a, b)           do { } while (0)
+#define FM_PROBE3(name, a, b, c)        do { } while (0)
+#define FM_PROBE4(name, a, b, c, d)     do { } while (0)
+#endif
+
+#endif
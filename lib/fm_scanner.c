@@ -0,0 +1,257 @@
+/*
+ * fm_scanner.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <sched.h>          // sched_yield
+
+#include "fm_clock.h"
+#include "fm_scanner.h"     // Its header file
+
+static FMScanner_Result result;     // Written by the publisher only
+static uint32_t sequence = 0;       // Odd while a publish is in progress
+static uint32_t read_retries = 0;   // Copies repeated by readers
+
+/****************************************************************
+ * Function Name : FMScanner_FindStations
+ * Description   : Pick the stations out of the levels of a sweep:
+ *                 local level peaks of at least FMSCANNER_MIN_LEVEL
+ * Returns       : the number of stations stored
+ * Params        @p_levels: level per band channel
+ *               @p_stereo: stereo flag per band channel
+ *               @channels: channels swept
+ *               @p_found: to store the stations
+ *               @max_found: room in p_found
+ ****************************************************************/
+extern uint16_t FMScanner_FindStations (const uint8_t *p_levels, const uint8_t *p_stereo, uint16_t channels,
+                                        FMStore_Station *p_found, uint16_t max_found)
+{
+    uint16_t channel = 0;
+    uint16_t count = 0;
+
+    for (channel = 0; (channel < channels) && (count < max_found); channel++)
+    {
+        if ((p_levels[channel] >= FMSCANNER_MIN_LEVEL)
+            && ((channel == 0) || (p_levels[channel] >= p_levels[channel - 1]))
+            && ((channel == (channels - 1)) || (p_levels[channel] > p_levels[channel + 1])))
+        {
+            p_found[count].freq_khz = FMBand_KHz(channel);
+            p_found[count].level = p_levels[channel];
+            p_found[count].stereo = p_stereo[channel];
+            p_found[count].reserved = 0;
+            count++;
+        }
+    }
+    return count;
+}
+
+/****************************************************************
+ * Function Name : FMScanner_PlanInit
+ * Description   : Start a plan with nothing known: its first sweep
+ *                 visits the whole band
+ * Returns       : void
+ * Params        @p_plan: the plan
+ *               @channels: channels of the band
+ ****************************************************************/
+extern void FMScanner_PlanInit (FMScanner_Plan *p_plan, uint16_t channels)
+{
+    (void) memset(p_plan, 0, sizeof(FMScanner_Plan));
+    p_plan->channels = (channels < FMBAND_MAX_CHANNELS) ? channels : FMBAND_MAX_CHANNELS;
+    p_plan->force_full = 1;
+}
+
+/****************************************************************
+ * Function Name : FMScanner_PlanSweep
+ * Description   : Start a sweep and pick its channels in p_plan->probe
+ * Returns       : the number of channels to probe
+ * Params        @p_plan: the plan
+ *               @full: 1 to visit the whole band whatever the plan
+ ****************************************************************/
+extern uint16_t FMScanner_PlanSweep (FMScanner_Plan *p_plan, uint8_t full)
+{
+    uint16_t channel = 0;
+    uint16_t count = 0;
+    uint8_t station = 0;
+
+    p_plan->full = full || p_plan->force_full;
+    p_plan->force_full = 0;
+    p_plan->probed = 0;
+    p_plan->changed = 0;
+    p_plan->start_us = FMClock_NowUs();
+    p_plan->turn++;
+
+    for (channel = 0; channel < p_plan->channels; channel++)
+    {
+        /* A station, or next to one: it may move, fade or split */
+        station = (p_plan->levels[channel] >= FMSCANNER_MIN_LEVEL)
+                  || ((channel > 0) && (p_plan->levels[channel - 1] >= FMSCANNER_MIN_LEVEL))
+                  || ((channel + 1 < p_plan->channels) && (p_plan->levels[channel + 1] >= FMSCANNER_MIN_LEVEL));
+        p_plan->probe[channel] = p_plan->full || station || (p_plan->probed_us[channel] == 0)
+                                 || ((channel % FMSCANNER_EMPTY_EVERY) == (p_plan->turn % FMSCANNER_EMPTY_EVERY));
+        count += p_plan->probe[channel];
+    }
+    return count;
+}
+
+/****************************************************************
+ * Function Name : FMScanner_PlanRecord
+ * Description   : Record the probe of a channel
+ * Returns       : 1 if the channel changed, 0 otherwise
+ * Params        @p_plan: the plan
+ *               @channel: the channel probed
+ *               @level: its level
+ *               @stereo: its stereo flag
+ ****************************************************************/
+extern uint8_t FMScanner_PlanRecord (FMScanner_Plan *p_plan, uint16_t channel, uint8_t level, uint8_t stereo)
+{
+    uint8_t changed = 0;
+
+    if (channel >= p_plan->channels)
+    {
+        return 0;
+    }
+
+    /* The first probe only fills the table; after that, a level step
+     * past the noise, a station appearing or going, or a pilot change */
+    changed = (p_plan->probed_us[channel] != 0)
+              && ((((level > p_plan->levels[channel]) ? (level - p_plan->levels[channel])
+                                                       : (p_plan->levels[channel] - level)) >= FMSCANNER_LEVEL_DELTA)
+                  || ((level >= FMSCANNER_MIN_LEVEL) != (p_plan->levels[channel] >= FMSCANNER_MIN_LEVEL))
+                  || (stereo != p_plan->stereo[channel]));
+
+    p_plan->levels[channel] = level;
+    p_plan->stereo[channel] = stereo;
+    p_plan->probed_us[channel] = FMClock_NowUs();
+    p_plan->probed++;
+    p_plan->changed += changed;
+    return changed;
+}
+
+/****************************************************************
+ * Function Name : FMScanner_PlanEnd
+ * Description   : End the sweep: update the stats and, if the
+ *                 change rate was high, plan a full sweep next
+ * Returns       : void
+ * Params        @p_plan: the plan
+ ****************************************************************/
+extern void FMScanner_PlanEnd (FMScanner_Plan *p_plan)
+{
+    uint64_t now_us = FMClock_NowUs();
+    uint64_t oldest_us = now_us;
+    uint16_t channel = 0;
+
+    p_plan->stats.probes += p_plan->probed;
+    p_plan->stats.changes += p_plan->changed;
+    if (p_plan->full)
+    {
+        p_plan->stats.full_sweeps++;
+        p_plan->stats.full_us = now_us - p_plan->start_us;
+    }
+    else
+    {
+        p_plan->stats.incremental_sweeps++;
+        p_plan->stats.incremental_us = now_us - p_plan->start_us;
+        p_plan->stats.probes_saved += p_plan->channels - p_plan->probed;
+    }
+
+    /* Every channel reflects the band as of its last probe */
+    for (channel = 0; channel < p_plan->channels; channel++)
+    {
+        if (p_plan->probed_us[channel] < oldest_us)
+        {
+            oldest_us = p_plan->probed_us[channel];
+        }
+    }
+    p_plan->stats.converge_us = now_us - oldest_us;
+
+    /* The band is moving (a drive, an antenna change): the partial
+     * view is no longer worth trusting */
+    if ((p_plan->probed > 0) && ((p_plan->changed * 100) >= (p_plan->probed * FMSCANNER_FULL_RATE)))
+    {
+        p_plan->force_full = 1;
+    }
+}
+
+/****************************************************************
+ * Function Name : FMScanner_Publish
+ * Description   : Publish the stations of a finished sweep. Only
+ *                 one thread may publish.
+ * Returns       : void
+ * Params        @p_found: the stations
+ *               @count: number of stations
+ *               @sweep_us: how long the sweep took
+ *               @p_stats: stats of the plan, NULL if none
+ ****************************************************************/
+extern void FMScanner_Publish (const FMStore_Station *p_found, uint16_t count, uint64_t sweep_us,
+                               const FMScanner_PlanStats *p_stats)
+{
+    uint32_t seq = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+
+    /* Odd: readers copying from here on will retry */
+    __atomic_store_n(&sequence, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    result.sweeps++;
+    result.swept_us = FMClock_NowUs();
+    result.sweep_us = sweep_us;
+    result.count = (count < FM_STORE_SCAN_SIZE) ? count : FM_STORE_SCAN_SIZE;
+    (void) memcpy(result.stations, p_found, result.count * sizeof(FMStore_Station));
+    if (p_stats != NULL)
+    {
+        result.plan = *p_stats;
+    }
+
+    __atomic_store_n(&sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+/****************************************************************
+ * Function Name : FMScanner_Read
+ * Description   : Copy the last published sweep, without a lock
+ * Returns       : 0 on success, -1 if nothing was published yet
+ * Params        @p_result: to store the copy
+ ****************************************************************/
+extern int FMScanner_Read (FMScanner_Result *p_result)
+{
+    uint32_t before = 0;
+    uint32_t after = 0;
+
+    while (1)
+    {
+        before = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        if (before == 0)
+        {
+            return -1;
+        }
+        if (!(before & 1))
+        {
+            (void) memcpy(p_result, &result, sizeof(FMScanner_Result));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            after = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+            if (after == before)
+            {
+                return 0;
+            }
+        }
+
+        /* The publisher is mid-copy; it finishes in microseconds */
+        (void) __atomic_fetch_add(&read_retries, 1, __ATOMIC_RELAXED);
+        (void) sched_yield();
+    }
+}
+
+/****************************************************************
+ * Function Name : FMScanner_ReadRetries
+ * Description   : Get how often a reader had to copy again because
+ *                 a publish overlapped its copy
+ * Returns       : the retry count
+ * Params        : N/A
+ ****************************************************************/
+extern uint32_t FMScanner_ReadRetries (void)
+{
+    return __atomic_load_n(&read_retries, __ATOMIC_RELAXED);
+}
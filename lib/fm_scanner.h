@@ -0,0 +1,153 @@
+/*
+ * fm_scanner.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef FM_SCANNER_H
+#define FM_SCANNER_H
+
+#include <stdint.h>     // Fixed-width int type
+
+#include "fm_band.h"
+#include "fm_state_store.h"
+
+/* Station list of the last band sweep. The secondary tuner sweeps in
+ * the background and publishes every finished sweep here; any thread
+ * reads it without a lock. The writer is a single thread and marks a
+ * publish in progress with an odd sequence number; a reader that sees
+ * the sequence odd or changed across its copy copies again. */
+
+#define FMSCANNER_MIN_LEVEL 7       // Level ADC a station must reach
+
+/* Incremental sweeps. Most of the band is the same from one sweep to
+ * the next, so the plan keeps the last level, stereo flag and probe
+ * time of every channel and only re-probes stations and their
+ * neighbours each sweep; empty channels take turns, one in
+ * FMSCANNER_EMPTY_EVERY per sweep. When too many of the probes find
+ * a change, the next sweep visits the whole band. */
+#define FMSCANNER_LEVEL_DELTA 2     // Level ADC steps that count as a change
+#define FMSCANNER_EMPTY_EVERY 4     // An empty channel is probed every this many sweeps
+#define FMSCANNER_FULL_RATE   25    // % of probes changed that forces a full sweep
+
+typedef struct FMScanner_PlanStats {
+    uint32_t full_sweeps;           // Sweeps of the whole band
+    uint32_t incremental_sweeps;    // Sweeps of stations, neighbours and some empty channels
+    uint64_t probes;                // Channels probed
+    uint64_t probes_saved;          // Channels an incremental sweep left out
+    uint32_t changes;               // Probes that found a changed channel
+    uint64_t full_us;               // Duration of the last full sweep
+    uint64_t incremental_us;        // Duration of the last incremental sweep
+    uint64_t converge_us;           // Oldest channel probe at the end of the last
+                                    // sweep: a change anywhere shows within this
+} FMScanner_PlanStats;
+
+typedef struct FMScanner_Plan {
+    uint16_t channels;                          // Channels of the band
+    uint8_t  levels[FMBAND_MAX_CHANNELS];       // Last level per channel
+    uint8_t  stereo[FMBAND_MAX_CHANNELS];       // Last stereo flag per channel
+    uint64_t probed_us[FMBAND_MAX_CHANNELS];    // When it was probed, 0 = never
+    uint8_t  probe[FMBAND_MAX_CHANNELS];        // 1 = probe it in this sweep
+    uint8_t  full;                              // 1 = this sweep visits every channel
+    uint8_t  force_full;                        // 1 = the next sweep visits every channel
+    uint32_t turn;                              // Sweeps planned, picks the empty channels
+    uint16_t probed;                            // Probes of this sweep
+    uint16_t changed;                           // Of those, changed
+    uint64_t start_us;                          // When this sweep started
+    FMScanner_PlanStats stats;
+} FMScanner_Plan;
+
+typedef struct FMScanner_Result {
+    uint32_t sweeps;                            // Sweeps published so far
+    uint64_t swept_us;                          // When the last one finished (FMClock_NowUs)
+    uint64_t sweep_us;                          // How long it took
+    uint16_t count;                             // Stations found
+    FMStore_Station stations[FM_STORE_SCAN_SIZE];
+    FMScanner_PlanStats plan;                   // Of the plan that made it
+} FMScanner_Result;
+
+/****************************************************************
+ * Function Name : FMScanner_PlanInit
+ * Description   : Start a plan with nothing known: its first sweep
+ *                 visits the whole band
+ * Returns       : void
+ * Params        @p_plan: the plan
+ *               @channels: channels of the band
+ ****************************************************************/
+extern void FMScanner_PlanInit (FMScanner_Plan *p_plan, uint16_t channels);
+
+/****************************************************************
+ * Function Name : FMScanner_PlanSweep
+ * Description   : Start a sweep and pick its channels in p_plan->probe
+ * Returns       : the number of channels to probe
+ * Params        @p_plan: the plan
+ *               @full: 1 to visit the whole band whatever the plan
+ ****************************************************************/
+extern uint16_t FMScanner_PlanSweep (FMScanner_Plan *p_plan, uint8_t full);
+
+/****************************************************************
+ * Function Name : FMScanner_PlanRecord
+ * Description   : Record the probe of a channel
+ * Returns       : 1 if the channel changed, 0 otherwise
+ * Params        @p_plan: the plan
+ *               @channel: the channel probed
+ *               @level: its level
+ *               @stereo: its stereo flag
+ ****************************************************************/
+extern uint8_t FMScanner_PlanRecord (FMScanner_Plan *p_plan, uint16_t channel, uint8_t level, uint8_t stereo);
+
+/****************************************************************
+ * Function Name : FMScanner_PlanEnd
+ * Description   : End the sweep: update the stats and, if the
+ *                 change rate was high, plan a full sweep next
+ * Returns       : void
+ * Params        @p_plan: the plan
+ ****************************************************************/
+extern void FMScanner_PlanEnd (FMScanner_Plan *p_plan);
+
+/****************************************************************
+ * Function Name : FMScanner_FindStations
+ * Description   : Pick the stations out of the levels of a sweep:
+ *                 local level peaks of at least FMSCANNER_MIN_LEVEL
+ * Returns       : the number of stations stored
+ * Params        @p_levels: level per band channel
+ *               @p_stereo: stereo flag per band channel
+ *               @channels: channels swept
+ *               @p_found: to store the stations
+ *               @max_found: room in p_found
+ ****************************************************************/
+extern uint16_t FMScanner_FindStations (const uint8_t *p_levels, const uint8_t *p_stereo, uint16_t channels,
+                                        FMStore_Station *p_found, uint16_t max_found);
+
+/****************************************************************
+ * Function Name : FMScanner_Publish
+ * Description   : Publish the stations of a finished sweep. Only
+ *                 one thread may publish.
+ * Returns       : void
+ * Params        @p_found: the stations
+ *               @count: number of stations
+ *               @sweep_us: how long the sweep took
+ *               @p_stats: stats of the plan, NULL if none
+ ****************************************************************/
+extern void FMScanner_Publish (const FMStore_Station *p_found, uint16_t count, uint64_t sweep_us,
+                               const FMScanner_PlanStats *p_stats);
+
+/****************************************************************
+ * Function Name : FMScanner_Read
+ * Description   : Copy the last published sweep, without a lock
+ * Returns       : 0 on success, -1 if nothing was published yet
+ * Params        @p_result: to store the copy
+ ****************************************************************/
+extern int FMScanner_Read (FMScanner_Result *p_result);
+
+/****************************************************************
+ * Function Name : FMScanner_ReadRetries
+ * Description   : Get how often a reader had to copy again because
+ *                 a publish overlapped its copy
+ * Returns       : the retry count
+ * Params        : N/A
+ ****************************************************************/
+extern uint32_t FMScanner_ReadRetries (void);
+
+#endif
@@ -0,0 +1,362 @@
+/*
+ * fm_state_store.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stddef.h>     // offsetof
+#include <string.h>     // String-handling library
+#include <unistd.h>     // POSIX API
+#include <fcntl.h>      // File controls
+#include <pthread.h>    // Writer lock
+#include <sys/mman.h>   // mmap, msync
+
+#include "fm_clock.h"
+#include "fm_state_store.h" // Its header file
+
+/* Checksum covers everything after the checksum field */
+#define CHECKSUM_START  (offsetof(FMStore_Image, checksum) + sizeof(uint32_t))
+#define CHECKSUM_LENGTH (sizeof(FMStore_Image) - CHECKSUM_START)
+
+static FMStore_Image fallback_image;            // Used when the file cannot be mapped
+static FMStore_Image *p_image = &fallback_image;
+static uint8_t mapped = 0;                      // 1 if p_image points at the file
+static uint8_t dirty = 0;                       // Updates not yet msync'ed
+static uint64_t last_sync_us = 0;               // Time of the last msync
+static pthread_mutex_t store_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************
+ * Function Name : crc32 (private)
+ * Description   : Compute the CRC-32 (IEEE 802.3) of a buffer
+ * Returns       : the checksum
+ * Params        @p_data: the buffer
+ *               @length: number of bytes
+ ****************************************************************/
+static uint32_t crc32 (const uint8_t *p_data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    size_t i;
+    uint8_t bit;
+
+    for (i = 0; i < length; i++)
+    {
+        crc ^= p_data[i];
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+/****************************************************************
+ * Function Name : imageChecksum (private)
+ * Description   : Compute the checksum of the current image
+ * Returns       : the checksum
+ * Params        : N/A
+ ****************************************************************/
+static uint32_t imageChecksum (void)
+{
+    return crc32((const uint8_t *) p_image + CHECKSUM_START, CHECKSUM_LENGTH);
+}
+
+/****************************************************************
+ * Function Name : imageReset (private)
+ * Description   : Write the default state into the image
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void imageReset (void)
+{
+    (void) memset(p_image, 0, sizeof(FMStore_Image));
+    p_image->magic = FM_STORE_MAGIC;
+    p_image->version = FM_STORE_VERSION;
+    p_image->size = sizeof(FMStore_Image);
+    p_image->last_freq_khz = FM_STORE_DEFAULT_FREQ_KHZ;
+    p_image->audio = 1;
+    p_image->checksum = imageChecksum();
+}
+
+/****************************************************************
+ * Function Name : imageValid (private)
+ * Description   : Check the header and checksum of the image
+ * Returns       : 1 if valid, 0 otherwise
+ * Params        : N/A
+ ****************************************************************/
+static uint8_t imageValid (void)
+{
+    return (p_image->magic == FM_STORE_MAGIC)
+        && (p_image->version == FM_STORE_VERSION)
+        && (p_image->size == sizeof(FMStore_Image))
+        && (p_image->checksum == imageChecksum());
+}
+
+/****************************************************************
+ * Function Name : imageUpdated (private)
+ * Description   : Seal an update: bump sequence, refresh checksum
+ *                 and mark the image for the next batched msync.
+ *                 Must be called with store_mutex held.
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void imageUpdated (void)
+{
+    p_image->sequence++;
+    p_image->checksum = imageChecksum();
+    dirty = 1;
+}
+
+/****************************************************************
+ * Function Name : FMStore_Open
+ * Description   : Map the state file, validate it and reset it to
+ *                 defaults when it is missing or corrupted. If the
+ *                 file cannot be mapped, an in-memory image is used
+ *                 so callers can always read the state.
+ * Returns       : 0 when a valid image was loaded, 1 when defaults
+ *                 were written, -1 when running without a file
+ * Params        @p_path: path to the state file, NULL to run from
+ *                        the defaults without a file
+ ****************************************************************/
+extern int FMStore_Open (const char *p_path)
+{
+    int fd = 0;     // to store the opened state file
+    void *p_map;    // to store the mapped address
+
+    if (p_path == NULL)
+    {
+        imageReset();
+        return -1;
+    }
+
+    fd = open(p_path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        perror("ERROR: FMStore - Failed to open the state file");
+        imageReset();
+        return -1;
+    }
+
+    /* Size the file to the fixed layout; a new file reads as zeros */
+    if (ftruncate(fd, sizeof(FMStore_Image)) < 0)
+    {
+        perror("ERROR: FMStore - Failed to size the state file");
+        (void) close(fd);
+        imageReset();
+        return -1;
+    }
+
+    p_map = mmap(NULL, sizeof(FMStore_Image), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    /* The mapping keeps its own reference to the file */
+    (void) close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        perror("ERROR: FMStore - Failed to map the state file");
+        imageReset();
+        return -1;
+    }
+
+    p_image = (FMStore_Image *) p_map;
+    mapped = 1;
+    last_sync_us = FMClock_NowUs();
+
+    if (imageValid())
+    {
+        return 0;
+    }
+
+    /* Missing, old or corrupted: start over from the defaults */
+    imageReset();
+    (void) FMStore_Sync(1);
+    return 1;
+}
+
+/****************************************************************
+ * Function Name : FMStore_Get
+ * Description   : Get the mapped image for read-only access
+ * Returns       : pointer to the image (never NULL after Open)
+ * Params        : N/A
+ ****************************************************************/
+extern const FMStore_Image* FMStore_Get (void)
+{
+    return p_image;
+}
+
+/****************************************************************
+ * Function Name : FMStore_SetFrequency
+ * Description   : Record the last tuned frequency
+ * Returns       : void
+ * Params        @freq_khz: the tuned frequency in kHz
+ ****************************************************************/
+extern void FMStore_SetFrequency (uint32_t freq_khz)
+{
+    (void) pthread_mutex_lock(&store_mutex);
+    if (p_image->last_freq_khz != freq_khz)
+    {
+        p_image->last_freq_khz = freq_khz;
+        imageUpdated();
+    }
+    (void) pthread_mutex_unlock(&store_mutex);
+}
+
+/****************************************************************
+ * Function Name : FMStore_SetAudio
+ * Description   : Record the audio state
+ * Returns       : void
+ * Params        @audio: 1 = unmuted, 0 = muted
+ ****************************************************************/
+extern void FMStore_SetAudio (uint8_t audio)
+{
+    (void) pthread_mutex_lock(&store_mutex);
+    if (p_image->audio != audio)
+    {
+        p_image->audio = audio;
+        imageUpdated();
+    }
+    (void) pthread_mutex_unlock(&store_mutex);
+}
+
+/****************************************************************
+ * Function Name : FMStore_SetPreset
+ * Description   : Save a frequency into a preset slot
+ * Returns       : 0 on success, -1 on invalid slot
+ * Params        @slot: preset index (0 - FM_STORE_NUM_PRESETS-1)
+ *               @freq_khz: frequency in kHz, 0 to clear the slot
+ ****************************************************************/
+extern int FMStore_SetPreset (uint8_t slot, uint32_t freq_khz)
+{
+    if (slot >= FM_STORE_NUM_PRESETS)
+    {
+        return -1;
+    }
+
+    (void) pthread_mutex_lock(&store_mutex);
+    p_image->presets_khz[slot] = freq_khz;
+    imageUpdated();
+    (void) pthread_mutex_unlock(&store_mutex);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : FMStore_GetPreset
+ * Description   : Read a preset slot under the store lock, so it is
+ *                 never read from a mapping being closed
+ * Returns       : the frequency in kHz, FM_STORE_EMPTY_PRESET if the
+ *                 slot is empty or invalid
+ * Params        @slot: preset index (0 - FM_STORE_NUM_PRESETS-1)
+ ****************************************************************/
+extern uint32_t FMStore_GetPreset (uint8_t slot)
+{
+    uint32_t freq_khz = FM_STORE_EMPTY_PRESET;
+
+    if (slot >= FM_STORE_NUM_PRESETS)
+    {
+        return FM_STORE_EMPTY_PRESET;
+    }
+
+    (void) pthread_mutex_lock(&store_mutex);
+    freq_khz = p_image->presets_khz[slot];
+    (void) pthread_mutex_unlock(&store_mutex);
+    return freq_khz;
+}
+
+/****************************************************************
+ * Function Name : FMStore_SetScanTable
+ * Description   : Replace the last scan table
+ * Returns       : void
+ * Params        @p_stations: the stations found by the scan
+ *               @count: number of stations (clamped to the table)
+ ****************************************************************/
+extern void FMStore_SetScanTable (const FMStore_Station *p_stations, uint16_t count)
+{
+    if (count > FM_STORE_SCAN_SIZE)
+    {
+        count = FM_STORE_SCAN_SIZE;
+    }
+
+    (void) pthread_mutex_lock(&store_mutex);
+    (void) memset(p_image->scan, 0, sizeof(p_image->scan));
+    (void) memcpy(p_image->scan, p_stations, count * sizeof(FMStore_Station));
+    p_image->scan_count = count;
+    imageUpdated();
+    (void) pthread_mutex_unlock(&store_mutex);
+}
+
+/****************************************************************
+ * Function Name : FMStore_CopyScan
+ * Description   : Copy the last scan table under the store lock, so
+ *                 a scan being stored is never read half written
+ * Returns       : number of stations copied
+ * Params        @p_stations: to store the stations, room for
+ *                            FM_STORE_SCAN_SIZE
+ ****************************************************************/
+extern uint16_t FMStore_CopyScan (FMStore_Station *p_stations)
+{
+    uint16_t count = 0;
+
+    (void) pthread_mutex_lock(&store_mutex);
+    count = p_image->scan_count;
+    if (count > FM_STORE_SCAN_SIZE)
+    {
+        count = FM_STORE_SCAN_SIZE;
+    }
+    (void) memcpy(p_stations, p_image->scan, count * sizeof(FMStore_Station));
+    (void) pthread_mutex_unlock(&store_mutex);
+    return count;
+}
+
+/****************************************************************
+ * Function Name : FMStore_Sync
+ * Description   : Flush pending updates to the file. Unless forced,
+ *                 msync is batched to once per FM_STORE_SYNC_US.
+ *                 Updates left pending are still in the shared
+ *                 mapping and reach the file on kernel writeback.
+ * Returns       : 0 on success or nothing to do, -1 on failure
+ * Params        @force: 1 to flush now regardless of the batching
+ ****************************************************************/
+extern int FMStore_Sync (uint8_t force)
+{
+    int ret = 0;
+    uint64_t now_us = FMClock_NowUs();
+
+    (void) pthread_mutex_lock(&store_mutex);
+    if (mapped && (dirty || force) && (force || ((now_us - last_sync_us) >= FM_STORE_SYNC_US)))
+    {
+        /* MS_ASYNC schedules the writeback without blocking the caller */
+        if (msync(p_image, sizeof(FMStore_Image), force ? MS_SYNC : MS_ASYNC) < 0)
+        {
+            perror("ERROR: FMStore - Failed to sync the state file");
+            ret = -1;
+        }
+        else
+        {
+            dirty = 0;
+            last_sync_us = now_us;
+        }
+    }
+    (void) pthread_mutex_unlock(&store_mutex);
+    return ret;
+}
+
+/****************************************************************
+ * Function Name : FMStore_Close
+ * Description   : Flush and unmap the state file
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMStore_Close (void)
+{
+    if (!mapped)
+    {
+        return;
+    }
+
+    (void) FMStore_Sync(1);
+    (void) pthread_mutex_lock(&store_mutex);
+    (void) munmap(p_image, sizeof(FMStore_Image));
+    p_image = &fallback_image;
+    mapped = 0;
+    (void) pthread_mutex_unlock(&store_mutex);
+}
@@ -0,0 +1,137 @@
+/*
+ * fm_state_store.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef FM_STATE_STORE_H
+#define FM_STATE_STORE_H
+
+#include <stdint.h>     // Fixed-width int type
+
+#define FM_STORE_MAGIC        0x464D5354 // "FMST"
+#define FM_STORE_VERSION      1
+#define FM_STORE_NUM_PRESETS  8
+#define FM_STORE_SCAN_SIZE    64
+#define FM_STORE_SYNC_US      2000000    // Batch msync to at most once per 2s
+
+#define FM_STORE_DEFAULT_FREQ_KHZ 94700  // Same station as DEFAULT_FREQ
+#define FM_STORE_EMPTY_PRESET     0
+
+/* One entry of the last scan table */
+typedef struct FMStore_Station {
+    uint32_t freq_khz;  // Station frequency in kHz
+    uint8_t  level;     // Level ADC reading (0 - 15)
+    uint8_t  stereo;    // 1 if the station was received in stereo
+    uint16_t reserved;
+} FMStore_Station;
+
+/* Fixed on-disk layout. The file is mmap'ed and read in place,
+ * so every field has an explicit width and natural alignment. */
+typedef struct FMStore_Image {
+    uint32_t magic;         // FM_STORE_MAGIC
+    uint16_t version;       // FM_STORE_VERSION
+    uint16_t size;          // sizeof(FMStore_Image)
+    uint32_t checksum;      // CRC-32 of every byte after this field
+    uint32_t sequence;      // Bumped on every update
+    uint32_t last_freq_khz; // Last tuned frequency in kHz
+    uint8_t  audio;         // 1 = unmuted, 0 = muted
+    uint8_t  reserved[3];
+    uint32_t presets_khz[FM_STORE_NUM_PRESETS]; // 0 = empty slot
+    uint16_t scan_count;    // Valid entries in scan[]
+    uint16_t reserved2;
+    FMStore_Station scan[FM_STORE_SCAN_SIZE];
+} FMStore_Image;
+
+/****************************************************************
+ * Function Name : FMStore_Open
+ * Description   : Map the state file, validate it and reset it to
+ *                 defaults when it is missing or corrupted. If the
+ *                 file cannot be mapped, an in-memory image is used
+ *                 so callers can always read the state.
+ * Returns       : 0 when a valid image was loaded, 1 when defaults
+ *                 were written, -1 when running without a file
+ * Params        @p_path: path to the state file, NULL to run from
+ *                        the defaults without a file
+ ****************************************************************/
+extern int FMStore_Open (const char *p_path);
+
+/****************************************************************
+ * Function Name : FMStore_Get
+ * Description   : Get the mapped image for read-only access
+ * Returns       : pointer to the image (never NULL after Open)
+ * Params        : N/A
+ ****************************************************************/
+extern const FMStore_Image* FMStore_Get (void);
+
+/****************************************************************
+ * Function Name : FMStore_SetFrequency
+ * Description   : Record the last tuned frequency
+ * Returns       : void
+ * Params        @freq_khz: the tuned frequency in kHz
+ ****************************************************************/
+extern void FMStore_SetFrequency (uint32_t freq_khz);
+
+/****************************************************************
+ * Function Name : FMStore_SetAudio
+ * Description   : Record the audio state
+ * Returns       : void
+ * Params        @audio: 1 = unmuted, 0 = muted
+ ****************************************************************/
+extern void FMStore_SetAudio (uint8_t audio);
+
+/****************************************************************
+ * Function Name : FMStore_SetPreset
+ * Description   : Save a frequency into a preset slot
+ * Returns       : 0 on success, -1 on invalid slot
+ * Params        @slot: preset index (0 - FM_STORE_NUM_PRESETS-1)
+ *               @freq_khz: frequency in kHz, 0 to clear the slot
+ ****************************************************************/
+extern int FMStore_SetPreset (uint8_t slot, uint32_t freq_khz);
+
+/****************************************************************
+ * Function Name : FMStore_GetPreset
+ * Description   : Read a preset slot under the store lock
+ * Returns       : the frequency in kHz, FM_STORE_EMPTY_PRESET if the
+ *                 slot is empty or invalid
+ * Params        @slot: preset index (0 - FM_STORE_NUM_PRESETS-1)
+ ****************************************************************/
+extern uint32_t FMStore_GetPreset (uint8_t slot);
+
+/****************************************************************
+ * Function Name : FMStore_SetScanTable
+ * Description   : Replace the last scan table
+ * Returns       : void
+ * Params        @p_stations: the stations found by the scan
+ *               @count: number of stations (clamped to the table)
+ ****************************************************************/
+extern void FMStore_SetScanTable (const FMStore_Station *p_stations, uint16_t count);
+
+/****************************************************************
+ * Function Name : FMStore_CopyScan
+ * Description   : Copy the last scan table under the store lock
+ * Returns       : number of stations copied
+ * Params        @p_stations: to store the stations, room for
+ *                            FM_STORE_SCAN_SIZE
+ ****************************************************************/
+extern uint16_t FMStore_CopyScan (FMStore_Station *p_stations);
+
+/****************************************************************
+ * Function Name : FMStore_Sync
+ * Description   : Flush pending updates to the file. Unless forced,
+ *                 msync is batched to once per FM_STORE_SYNC_US.
+ * Returns       : 0 on success or nothing to do, -1 on failure
+ * Params        @force: 1 to flush now regardless of the batching
+ ****************************************************************/
+extern int FMStore_Sync (uint8_t force);
+
+/****************************************************************
+ * Function Name : FMStore_Close
+ * Description   : Flush and unmap the state file
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void FMStore_Close (void);
+
+#endif
@@ -2,7 +2,7 @@
  *  gpio.h
  *  Author: Vy Phan
  *  Created on: 04/24/2023
- *  Last Updated: 04/25/2023
+ *  Last Updated: 10/18/2026
  */
 #include <stdio.h>      // Standard I/O
 #include <stdint.h>     // Fixed-width int type
@@ -175,3 +175,91 @@ int GPIO_WriteValue(const uint8_t gpio, const char* p_value)
     }
 	return 0;
 }
+
+/****************************************************************
+ * Function Name : GPIO_SetEdge
+ * Description   : Select the edges of an input GPIO that wake a
+ *                 poll() on its value file
+ * Returns       : 0 on success, -1 on failure
+ * Params        : @gpio: the input GPIO number
+ *                 @p_edge: GPIO_EDGE_BOTH, GPIO_EDGE_NONE, "rising"
+ *                          or "falling"
+ ****************************************************************/
+int GPIO_SetEdge(const uint8_t gpio, const char* p_edge)
+{
+    int ret = 0;          // to store the error code of the function
+    int fd = 0;           // to store the opened gpio file directory
+    char buffer[50] = ""; // to store the formatted gpio file path
+
+    /* Format the gpio path to set the edge */
+    ret = snprintf(buffer, sizeof(buffer), "%sgpio%d/edge", GPIO_PATH, gpio);
+    if (ret < 0)
+    {
+        perror("ERROR: GPIO - Failed to format the GPIO string path");
+        return -1;
+    }
+
+    fd = open(buffer, O_WRONLY);
+    if (fd < 0)
+    {
+        perror("ERROR: GPIO - Failed to open the GPIO edge file");
+        return -1;
+    }
+    ret = write(fd, p_edge, strlen(p_edge));
+    (void) close(fd);
+    if (ret < 0)
+    {
+        perror("ERROR: GPIO - Failed to write to the GPIO edge file");
+        return -1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : GPIO_OpenValue
+ * Description   : Open the value file of an input GPIO and keep it
+ *                 open, to poll() it for edges (POLLPRI)
+ * Returns       : the file descriptor on success, -1 on failure
+ * Params        : @gpio: the input GPIO number
+ ****************************************************************/
+int GPIO_OpenValue(const uint8_t gpio)
+{
+    int ret = 0;          // to store the error code of the function
+    int fd = 0;           // to store the opened gpio file directory
+    char buffer[50] = ""; // to store the formatted gpio file path
+
+    ret = snprintf(buffer, sizeof(buffer), "%sgpio%d/value", GPIO_PATH, gpio);
+    if (ret < 0)
+    {
+        perror("ERROR: GPIO - Failed to format the GPIO string path");
+        return -1;
+    }
+
+    fd = open(buffer, O_RDONLY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        perror("ERROR: GPIO - Failed to open the GPIO file directory");
+        return -1;
+    }
+    return fd;
+}
+
+/****************************************************************
+ * Function Name : GPIO_ReadFd
+ * Description   : Read the value of a GPIO from its open value file;
+ *                 this also acknowledges the edge that woke poll()
+ * Returns       : pin value on success, -1 on failure
+ * Params        : @fd: the value file from GPIO_OpenValue
+ ****************************************************************/
+int GPIO_ReadFd(const int fd)
+{
+    char state = '0';     // buffer to store the input
+
+    /* sysfs value files are read from the start every time */
+    if ((lseek(fd, 0, SEEK_SET) < 0) || (read(fd, &state, 1) != 1))
+    {
+        perror("ERROR: GPIO - Failed to read the GPIO value file");
+        return -1;
+    }
+    return (state == '1') ? 1 : 0;
+}
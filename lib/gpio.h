@@ -2,7 +2,7 @@
  * gpio.h
  * Author: Vy Phan
  * Created on: 04/24/2023
- * Last Updated: 04/25/2023
+ * Last Updated: 10/18/2026
  */
 
 #ifndef GPIO_H
@@ -21,6 +21,8 @@
 #define GPIO_OUT    "out"
 #define GPIO_HI     "1"
 #define GPIO_LO     "0"
+#define GPIO_EDGE_BOTH "both"
+#define GPIO_EDGE_NONE "none"
 
 #define P9_11 30
 #define P9_12 60
@@ -57,4 +59,33 @@ int GPIO_ReadValue(const uint8_t gpio);
  ****************************************************************/
 int GPIO_WriteValue(const uint8_t gpio, const char* p_value);
 
+/****************************************************************
+ * Function Name : GPIO_SetEdge
+ * Description   : Select the edges of an input GPIO that wake a
+ *                 poll() on its value file
+ * Returns       : 0 on success, -1 on failure
+ * Params        : @gpio: the input GPIO number
+ *                 @p_edge: GPIO_EDGE_BOTH, GPIO_EDGE_NONE, "rising"
+ *                          or "falling"
+ ****************************************************************/
+int GPIO_SetEdge(const uint8_t gpio, const char* p_edge);
+
+/****************************************************************
+ * Function Name : GPIO_OpenValue
+ * Description   : Open the value file of an input GPIO and keep it
+ *                 open, to poll() it for edges (POLLPRI)
+ * Returns       : the file descriptor on success, -1 on failure
+ * Params        : @gpio: the input GPIO number
+ ****************************************************************/
+int GPIO_OpenValue(const uint8_t gpio);
+
+/****************************************************************
+ * Function Name : GPIO_ReadFd
+ * Description   : Read the value of a GPIO from its open value file;
+ *                 this also acknowledges the edge that woke poll()
+ * Returns       : pin value on success, -1 on failure
+ * Params        : @fd: the value file from GPIO_OpenValue
+ ****************************************************************/
+int GPIO_ReadFd(const int fd);
+
 #endif
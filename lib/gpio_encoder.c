@@ -0,0 +1,231 @@
+/*
+ * gpio_encoder.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <poll.h>           // poll
+
+#include "gpio_encoder.h"   // Its header file
+
+#define SKIPPED 2           // Both pins changed: a state was missed
+
+/* Indexed by (previous state << 2) | new state; clockwise is
+ * 00 -> 01 -> 11 -> 10 -> 00 */
+static const int8_t transitions[16] = {
+    /* to:  00        01        10        11  */
+            0,        +1,       -1,       SKIPPED,    // from 00
+            -1,       0,        SKIPPED,  +1,         // from 01
+            +1,       SKIPPED,  0,        -1,         // from 10
+            SKIPPED,  -1,       +1,       0           // from 11
+};
+
+/****************************************************************
+ * Function Name : scaleFor (private)
+ * Description   : Get the channels one detent moves
+ * Returns       : the channel count
+ * Params        @p_encoder: the encoder
+ *               @direction: direction of the detent
+ *               @at_us: when it was turned
+ ****************************************************************/
+static uint8_t scaleFor (const GPIO_Encoder *p_encoder, int8_t direction, uint64_t at_us)
+{
+    uint64_t interval_us = at_us - p_encoder->last_detent_us;
+
+    /* Only a steady turn one way speeds up */
+    if ((direction != p_encoder->last_detent) || (p_encoder->last_detent_us == 0))
+    {
+        return 1;
+    }
+    if (interval_us < GPIOENC_FAST_US)
+    {
+        return GPIOENC_FAST_SCALE;
+    }
+    if (interval_us < GPIOENC_MEDIUM_US)
+    {
+        return GPIOENC_MEDIUM_SCALE;
+    }
+    return 1;
+}
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Init
+ * Description   : Set up an encoder at rest, without touching the GPIO
+ * Returns       : void
+ * Params        @p_encoder: the encoder
+ *               @gpio_a: A input
+ *               @gpio_b: B input
+ ****************************************************************/
+extern void GPIOEncoder_Init (GPIO_Encoder *p_encoder, uint8_t gpio_a, uint8_t gpio_b)
+{
+    (void) memset(p_encoder, 0, sizeof(GPIO_Encoder));
+    p_encoder->gpio_a = gpio_a;
+    p_encoder->gpio_b = gpio_b;
+    p_encoder->fd_a = -1;
+    p_encoder->fd_b = -1;
+    p_encoder->state = GPIOENC_REST;
+}
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Open
+ * Description   : Make both pins inputs that report both edges,
+ *                 open their value files and read the start state
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_encoder: the encoder
+ ****************************************************************/
+extern int GPIOEncoder_Open (GPIO_Encoder *p_encoder)
+{
+    int level_a = 0;
+    int level_b = 0;
+
+    if ((GPIO_SetDirection(p_encoder->gpio_a, GPIO_IN) < 0) || (GPIO_SetDirection(p_encoder->gpio_b, GPIO_IN) < 0)
+        || (GPIO_SetEdge(p_encoder->gpio_a, GPIO_EDGE_BOTH) < 0) || (GPIO_SetEdge(p_encoder->gpio_b, GPIO_EDGE_BOTH) < 0))
+    {
+        return -1;
+    }
+    p_encoder->fd_a = GPIO_OpenValue(p_encoder->gpio_a);
+    p_encoder->fd_b = GPIO_OpenValue(p_encoder->gpio_b);
+    if ((p_encoder->fd_a < 0) || (p_encoder->fd_b < 0))
+    {
+        return -1;
+    }
+
+    /* Reading also clears the edges pending from before */
+    level_a = GPIO_ReadFd(p_encoder->fd_a);
+    level_b = GPIO_ReadFd(p_encoder->fd_b);
+    if ((level_a < 0) || (level_b < 0))
+    {
+        return -1;
+    }
+    p_encoder->state = (uint8_t) ((level_a << 1) | level_b);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Wait
+ * Description   : Wait for an edge on either pin and read the state
+ * Returns       : 1 with the new state, 0 on timeout, -1 on failure
+ * Params        @p_encoder: the encoder
+ *               @timeout_ms: longest wait, -1 = forever
+ *               @p_state: to store the A/B state, A in bit 1
+ ****************************************************************/
+extern int GPIOEncoder_Wait (GPIO_Encoder *p_encoder, int timeout_ms, uint8_t *p_state)
+{
+    struct pollfd fds[2] = {
+        { p_encoder->fd_a, POLLPRI | POLLERR, 0 },
+        { p_encoder->fd_b, POLLPRI | POLLERR, 0 }
+    };
+    int ready = poll(fds, 2, timeout_ms);
+    int level_a = 0;
+    int level_b = 0;
+
+    if (ready <= 0)
+    {
+        return ready;
+    }
+
+    /* Both pins are read after any edge: the state is what the decoder
+     * needs, and reading acknowledges the edge of each pin */
+    level_a = GPIO_ReadFd(p_encoder->fd_a);
+    level_b = GPIO_ReadFd(p_encoder->fd_b);
+    if ((level_a < 0) || (level_b < 0))
+    {
+        return -1;
+    }
+    *p_state = (uint8_t) ((level_a << 1) | level_b);
+    return 1;
+}
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Feed
+ * Description   : Decode a new A/B state
+ * Returns       : the channels it moved, signed; 0 if no detent
+ * Params        @p_encoder: the encoder
+ *               @state: the A/B state, A in bit 1
+ *               @at_us: when it was read, for velocity scaling
+ ****************************************************************/
+extern int32_t GPIOEncoder_Feed (GPIO_Encoder *p_encoder, uint8_t state, uint64_t at_us)
+{
+    int8_t step = transitions[((p_encoder->state & 0x3) << 2) | (state & 0x3)];
+    int8_t direction = 0;
+    uint8_t detents = 0;
+    int32_t channels = 0;
+
+    p_encoder->state = state & 0x3;
+    if (step == SKIPPED)
+    {
+        /* Two quarters the way it was going; a missed state with no
+         * movement before it cannot be placed */
+        if (p_encoder->direction == 0)
+        {
+            (void) __atomic_add_fetch(&p_encoder->stats.invalid, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+        step = 2 * p_encoder->direction;
+        (void) __atomic_add_fetch(&p_encoder->stats.skipped, 1, __ATOMIC_RELAXED);
+    }
+    if (step == 0)
+    {
+        return 0;
+    }
+    p_encoder->direction = (step > 0) ? 1 : -1;
+    p_encoder->quarters += step;
+    (void) __atomic_add_fetch(&p_encoder->stats.transitions, (step > 0) ? step : -step, __ATOMIC_RELAXED);
+
+    /* Detents are counted on the return to rest, each one needing at
+     * least three of its four quarters: a bounce back and forth comes
+     * back to rest near zero, and a read that missed a rest state
+     * counts every detent passed */
+    if (p_encoder->state != GPIOENC_REST)
+    {
+        return 0;
+    }
+    direction = (p_encoder->quarters > 0) ? 1 : -1;
+    detents = (uint8_t) (((direction * p_encoder->quarters) + 1) / GPIOENC_QUARTERS);
+    p_encoder->quarters = 0;
+    if (detents == 0)
+    {
+        return 0;
+    }
+
+    channels = direction * detents * scaleFor(p_encoder, direction, at_us);
+    p_encoder->last_detent = direction;
+    p_encoder->last_detent_us = at_us;
+    (void) __atomic_add_fetch(&p_encoder->stats.detents, detents, __ATOMIC_RELAXED);
+    (void) __atomic_add_fetch(&p_encoder->stats.position, direction * detents, __ATOMIC_RELAXED);
+    (void) __atomic_add_fetch(&p_encoder->stats.steps, (channels > 0) ? channels : -channels, __ATOMIC_RELAXED);
+    (void) __atomic_add_fetch(&p_encoder->pending, channels, __ATOMIC_RELEASE);
+    return channels;
+}
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Take
+ * Description   : Take the channels moved since the last take
+ * Returns       : the channels, signed
+ * Params        @p_encoder: the encoder
+ ****************************************************************/
+extern int32_t GPIOEncoder_Take (GPIO_Encoder *p_encoder)
+{
+    return __atomic_exchange_n(&p_encoder->pending, 0, __ATOMIC_ACQUIRE);
+}
+
+/****************************************************************
+ * Function Name : GPIOEncoder_GetStats
+ * Description   : Get a copy of the decoder counters
+ * Returns       : void
+ * Params        @p_encoder: the encoder
+ *               @p_stats: to store the counters
+ ****************************************************************/
+extern void GPIOEncoder_GetStats (GPIO_Encoder *p_encoder, GPIOEnc_Stats *p_stats)
+{
+    p_stats->transitions = __atomic_load_n(&p_encoder->stats.transitions, __ATOMIC_RELAXED);
+    p_stats->skipped = __atomic_load_n(&p_encoder->stats.skipped, __ATOMIC_RELAXED);
+    p_stats->invalid = __atomic_load_n(&p_encoder->stats.invalid, __ATOMIC_RELAXED);
+    p_stats->detents = __atomic_load_n(&p_encoder->stats.detents, __ATOMIC_RELAXED);
+    p_stats->position = __atomic_load_n(&p_encoder->stats.position, __ATOMIC_RELAXED);
+    p_stats->steps = __atomic_load_n(&p_encoder->stats.steps, __ATOMIC_RELAXED);
+}
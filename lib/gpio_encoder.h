@@ -0,0 +1,118 @@
+/*
+ * gpio_encoder.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef GPIO_ENCODER_H
+#define GPIO_ENCODER_H
+
+#include <stdint.h>     // Fixed-width int type
+
+#include "gpio.h"
+
+/* Quadrature rotary encoder on two GPIO inputs. The decoder is woken
+ * by every edge of either pin (poll() on the sysfs value files) instead
+ * of a 10 ms poll, which would miss the transitions of a fast turn.
+ *
+ * Each new A/B state is looked up in a transition table indexed by the
+ * previous and new state: +1 or -1 for one quarter step, 0 for no
+ * change, and a skipped state when both pins changed between two reads
+ * (a missed edge). A skipped state counts as two quarters in the last
+ * direction. The encoder rests at GPIOENC_REST on every detent, and
+ * detents are counted when it comes back to rest, each one needing at
+ * least three of its four quarters, so contact bounce cancels out and
+ * half a turn back and forth is no detent. Detents turned
+ * quickly move several channels (velocity scaling).
+ *
+ * The decoder thread is the only writer; the steps it produces and
+ * its counters are read and taken by other threads with atomics. */
+
+#define GPIOENC_QUARTERS        4       // Transitions per detent
+#define GPIOENC_REST            0x3     // A and B high between detents
+#define GPIOENC_FAST_US         40000   // Detents closer than this...
+#define GPIOENC_FAST_SCALE      5       // ...move this many channels
+#define GPIOENC_MEDIUM_US       100000  // Detents closer than this...
+#define GPIOENC_MEDIUM_SCALE    2       // ...move this many channels
+
+typedef struct GPIOEnc_Stats {
+    uint32_t transitions;   // Quarter steps decoded
+    uint32_t skipped;       // States missed between two reads, recovered
+    uint32_t invalid;       // States missed with no direction to go by
+    uint32_t detents;       // Detents turned, either way
+    int32_t  position;      // Net detents, clockwise positive
+    uint32_t steps;         // Channels moved after velocity scaling
+} GPIOEnc_Stats;
+
+typedef struct GPIO_Encoder {
+    uint8_t  gpio_a;            // A input
+    uint8_t  gpio_b;            // B input
+    int      fd_a;              // Value files, -1 when not open
+    int      fd_b;
+    uint8_t  state;             // Last A/B state, A in bit 1
+    int8_t   direction;         // Last quarter step, -1, 0 or +1
+    int8_t   quarters;          // Quarter steps since the last detent
+    int8_t   last_detent;       // Direction of the last detent
+    uint64_t last_detent_us;    // When it was turned
+    int32_t  pending;           // Channels not taken yet, atomic
+    GPIOEnc_Stats stats;        // Written by the decoder, read atomically
+} GPIO_Encoder;
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Init
+ * Description   : Set up an encoder at rest, without touching the GPIO
+ * Returns       : void
+ * Params        @p_encoder: the encoder
+ *               @gpio_a: A input
+ *               @gpio_b: B input
+ ****************************************************************/
+extern void GPIOEncoder_Init (GPIO_Encoder *p_encoder, uint8_t gpio_a, uint8_t gpio_b);
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Open
+ * Description   : Make both pins inputs that report both edges,
+ *                 open their value files and read the start state
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_encoder: the encoder
+ ****************************************************************/
+extern int GPIOEncoder_Open (GPIO_Encoder *p_encoder);
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Wait
+ * Description   : Wait for an edge on either pin and read the state
+ * Returns       : 1 with the new state, 0 on timeout, -1 on failure
+ * Params        @p_encoder: the encoder
+ *               @timeout_ms: longest wait, -1 = forever
+ *               @p_state: to store the A/B state, A in bit 1
+ ****************************************************************/
+extern int GPIOEncoder_Wait (GPIO_Encoder *p_encoder, int timeout_ms, uint8_t *p_state);
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Feed
+ * Description   : Decode a new A/B state
+ * Returns       : the channels it moved, signed; 0 if no detent
+ * Params        @p_encoder: the encoder
+ *               @state: the A/B state, A in bit 1
+ *               @at_us: when it was read, for velocity scaling
+ ****************************************************************/
+extern int32_t GPIOEncoder_Feed (GPIO_Encoder *p_encoder, uint8_t state, uint64_t at_us);
+
+/****************************************************************
+ * Function Name : GPIOEncoder_Take
+ * Description   : Take the channels moved since the last take
+ * Returns       : the channels, signed
+ * Params        @p_encoder: the encoder
+ ****************************************************************/
+extern int32_t GPIOEncoder_Take (GPIO_Encoder *p_encoder);
+
+/****************************************************************
+ * Function Name : GPIOEncoder_GetStats
+ * Description   : Get a copy of the decoder counters
+ * Returns       : void
+ * Params        @p_encoder: the encoder
+ *               @p_stats: to store the counters
+ ****************************************************************/
+extern void GPIOEncoder_GetStats (GPIO_Encoder *p_encoder, GPIOEnc_Stats *p_stats);
+
+#endif
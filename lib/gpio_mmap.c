@@ -0,0 +1,194 @@
+/*
+ * gpio_mmap.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <unistd.h>         // close, ftruncate
+#include <fcntl.h>          // open
+#include <sys/mman.h>       // mmap, munmap
+#include <sys/stat.h>       // fstat
+
+#include "gpio_mmap.h"      // Its header file
+
+typedef struct GPIOMmap_Pin {
+    uint8_t  gpio;
+    uint8_t  bank;          // gpio / 32
+    uint32_t mask;          // 1 << (gpio % 32) in the bank's DATAIN
+} GPIOMmap_Pin;
+
+static const off_t bank_bases[GPIOMMAP_BANKS] = {
+    0x44E07000, 0x4804C000, 0x481AC000, 0x481AE000
+};
+
+static GPIOMmap_Pin pins[GPIOMMAP_MAX_PINS];
+static uint8_t pin_count = 0;
+static volatile uint8_t *p_banks[GPIOMMAP_BANKS];  // Mapped register space, NULL if unused
+static uint8_t used_banks = 0;                      // Bit b set = bank b mapped
+
+/****************************************************************
+ * Function Name : bankOffset (private)
+ * Description   : Where a bank is in the mapped file
+ * Returns       : the offset
+ * Params        @stand_in: 1 for a stand-in file, 0 for /dev/mem
+ *               @bank: the bank
+ ****************************************************************/
+static off_t bankOffset (uint8_t stand_in, uint8_t bank)
+{
+    return stand_in ? ((off_t) bank * GPIOMMAP_BANK_SIZE) : bank_bases[bank];
+}
+
+/****************************************************************
+ * Function Name : GPIOMmap_Open
+ * Description   : Build the pin table and map the banks it uses
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: GPIOMMAP_DEV_MEM, or a stand-in file
+ *               @p_gpios: the GPIO numbers, pin i of GPIOMmap_ReadAll
+ *               @count: number of pins, up to GPIOMMAP_MAX_PINS
+ ****************************************************************/
+extern int GPIOMmap_Open (const char *p_path, const uint8_t *p_gpios, uint8_t count)
+{
+    uint8_t stand_in = (strcmp(p_path, GPIOMMAP_DEV_MEM) != 0);
+    struct stat info;
+    void *p_map = NULL;
+    uint8_t index = 0;
+    uint8_t bank = 0;
+    int fd = 0;
+
+    GPIOMmap_Close();
+    if (count > GPIOMMAP_MAX_PINS)
+    {
+        printf("ERROR: GPIOMmap_Open - %u pins, at most %u\n", count, GPIOMMAP_MAX_PINS);
+        return -1;
+    }
+    for (index = 0; index < count; index++)
+    {
+        if ((p_gpios[index] / 32) >= GPIOMMAP_BANKS)
+        {
+            printf("ERROR: GPIOMmap_Open - No GPIO %u\n", p_gpios[index]);
+            return -1;
+        }
+        pins[index].gpio = p_gpios[index];
+        pins[index].bank = p_gpios[index] / 32;
+        pins[index].mask = 1U << (p_gpios[index] % 32);
+        used_banks |= (uint8_t) (1U << pins[index].bank);
+    }
+
+    fd = stand_in ? open(p_path, O_RDWR | O_CREAT, 0644) : open(p_path, O_RDONLY | O_SYNC);
+    if (fd < 0)
+    {
+        perror("ERROR: GPIOMmap_Open - Failed to open the GPIO memory");
+        used_banks = 0;
+        return -1;
+    }
+    /* A new stand-in reads all low until a level is written */
+    if (stand_in && ((fstat(fd, &info) != 0)
+        || ((info.st_size < (GPIOMMAP_BANKS * GPIOMMAP_BANK_SIZE))
+            && (ftruncate(fd, GPIOMMAP_BANKS * GPIOMMAP_BANK_SIZE) != 0))))
+    {
+        perror("ERROR: GPIOMmap_Open - Failed to size the stand-in");
+        (void) close(fd);
+        used_banks = 0;
+        return -1;
+    }
+    for (bank = 0; bank < GPIOMMAP_BANKS; bank++)
+    {
+        if ((used_banks & (1U << bank)) == 0)
+        {
+            continue;
+        }
+        p_map = mmap(NULL, GPIOMMAP_BANK_SIZE, PROT_READ, MAP_SHARED, fd, bankOffset(stand_in, bank));
+        if (p_map == MAP_FAILED)
+        {
+            perror("ERROR: GPIOMmap_Open - Failed to map a GPIO bank");
+            (void) close(fd);
+            GPIOMmap_Close();
+            return -1;
+        }
+        p_banks[bank] = (volatile uint8_t *) p_map;
+    }
+    /* The mappings outlive the descriptor */
+    (void) close(fd);
+    pin_count = count;
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : GPIOMmap_ReadValue
+ * Description   : Read the level of one pin
+ * Returns       : 1 if high, 0 if low, -1 if the pin is not mapped
+ * Params        @gpio: the GPIO number
+ ****************************************************************/
+extern int GPIOMmap_ReadValue (uint8_t gpio)
+{
+    uint8_t index = 0;
+    uint32_t datain = 0;
+
+    for (index = 0; index < pin_count; index++)
+    {
+        if (pins[index].gpio == gpio)
+        {
+            datain = *(volatile uint32_t *) (p_banks[pins[index].bank] + GPIOMMAP_DATAIN);
+            return (datain & pins[index].mask) ? 1 : 0;
+        }
+    }
+    return -1;
+}
+
+/****************************************************************
+ * Function Name : GPIOMmap_ReadAll
+ * Description   : Read every pin in one pass, one load per bank
+ * Returns       : the levels, bit i for pin i of GPIOMmap_Open
+ * Params        : N/A
+ ****************************************************************/
+extern uint32_t GPIOMmap_ReadAll (void)
+{
+    uint32_t datain[GPIOMMAP_BANKS] = { 0 };
+    uint32_t levels = 0;
+    uint8_t bank = 0;
+    uint8_t index = 0;
+
+    /* Snapshot the banks first, so every pin of a bank is from the
+     * same instant */
+    for (bank = 0; bank < GPIOMMAP_BANKS; bank++)
+    {
+        if (p_banks[bank] != NULL)
+        {
+            datain[bank] = *(volatile uint32_t *) (p_banks[bank] + GPIOMMAP_DATAIN);
+        }
+    }
+    for (index = 0; index < pin_count; index++)
+    {
+        if (datain[pins[index].bank] & pins[index].mask)
+        {
+            levels |= 1U << index;
+        }
+    }
+    return levels;
+}
+
+/****************************************************************
+ * Function Name : GPIOMmap_Close
+ * Description   : Unmap the banks and forget the pins
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void GPIOMmap_Close (void)
+{
+    uint8_t bank = 0;
+
+    pin_count = 0;
+    used_banks = 0;
+    for (bank = 0; bank < GPIOMMAP_BANKS; bank++)
+    {
+        if (p_banks[bank] != NULL)
+        {
+            (void) munmap((void *) p_banks[bank], GPIOMMAP_BANK_SIZE);
+            p_banks[bank] = NULL;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * gpio_mmap.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef GPIO_MMAP_H
+#define GPIO_MMAP_H
+
+#include <stdint.h>     // Fixed-width int type
+
+/* Button levels read straight from the DATAIN registers of the AM335x
+ * GPIO banks, mapped from /dev/mem: a read is one load, with no system
+ * call. GPIO n is bit n % 32 of bank n / 32. The pin table is built
+ * when the pins are opened, and only the banks they use are mapped.
+ *
+ * Any other path is a stand-in file: the banks are laid out back to
+ * back from offset 0 (GPIOMMAP_STANDIN_DATAIN), and the file is
+ * created or extended as needed. Writing a DATAIN word of the file
+ * (tools/gpio_bench -w) sets the levels the receiver reads, so the
+ * backend can be checked and timed off-target.
+ *
+ * Pin directions are still set through sysfs (gpio.c); the backend
+ * only reads. */
+
+#define GPIOMMAP_DEV_MEM        "/dev/mem"
+#define GPIOMMAP_BANKS          4
+#define GPIOMMAP_BANK_SIZE      0x1000      // Register space of one bank
+#define GPIOMMAP_DATAIN         0x138       // Input level register, one bit per pin
+#define GPIOMMAP_MAX_PINS       32          // Pins of one GPIOMmap_ReadAll
+#define GPIOMMAP_STANDIN_DATAIN(bank)   (((bank) * GPIOMMAP_BANK_SIZE) + GPIOMMAP_DATAIN)
+
+/****************************************************************
+ * Function Name : GPIOMmap_Open
+ * Description   : Build the pin table and map the banks it uses
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: GPIOMMAP_DEV_MEM, or a stand-in file
+ *               @p_gpios: the GPIO numbers, pin i of GPIOMmap_ReadAll
+ *               @count: number of pins, up to GPIOMMAP_MAX_PINS
+ ****************************************************************/
+extern int GPIOMmap_Open (const char *p_path, const uint8_t *p_gpios, uint8_t count);
+
+/****************************************************************
+ * Function Name : GPIOMmap_ReadValue
+ * Description   : Read the level of one pin
+ * Returns       : 1 if high, 0 if low, -1 if the pin is not mapped
+ * Params        @gpio: the GPIO number
+ ****************************************************************/
+extern int GPIOMmap_ReadValue (uint8_t gpio);
+
+/****************************************************************
+ * Function Name : GPIOMmap_ReadAll
+ * Description   : Read every pin in one pass, one load per bank
+ * Returns       : the levels, bit i for pin i of GPIOMmap_Open
+ * Params        : N/A
+ ****************************************************************/
+extern uint32_t GPIOMmap_ReadAll (void);
+
+/****************************************************************
+ * Function Name : GPIOMmap_Close
+ * Description   : Unmap the banks and forget the pins
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void GPIOMmap_Close (void);
+
+#endif
@@ -2,7 +2,7 @@
  * i2c_bbb.c
  * Author: Vy Phan
  * Created: 04/24/2023
- * Last Updated: 04/27/2023
+ * Last Updated: 10/18/2026
  */
 
 
@@ -13,8 +13,29 @@
 #include <linux/i2c-dev.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <errno.h>
 
 #include "i2c_bbb.h"
+#include "fm_metrics.h"
+#include "fm_probes.h"
+#include "flight_rec.h"
+
+/* Every bus access goes through these, so the simulator can stand in
+ * for /dev/i2c-N when built with -DI2C_SIMULATOR */
+#ifdef I2C_SIMULATOR
+#include "i2c_sim.h"
+#define BUS_OPEN(path)              I2CSim_Open(path)
+#define BUS_SET_SLAVE(bus, addr)    I2CSim_SetSlave(bus, addr)
+#define BUS_READ(bus, buf, len)     I2CSim_Read(bus, buf, len)
+#define BUS_WRITE(bus, buf, len)    I2CSim_Write(bus, buf, len)
+#define BUS_CLOSE(bus)              I2CSim_Close(bus)
+#else
+#define BUS_OPEN(path)              open(path, O_RDWR)
+#define BUS_SET_SLAVE(bus, addr)    ioctl(bus, I2C_SLAVE, addr)
+#define BUS_READ(bus, buf, len)     read(bus, buf, len)
+#define BUS_WRITE(bus, buf, len)    write(bus, buf, len)
+#define BUS_CLOSE(bus)              close(bus)
+#endif
 
 /****************************************************************
  * Function Name : I2C_OpenBus
@@ -26,7 +47,7 @@
 extern int8_t I2C_OpenBus (int *p_i2c_bus, char *p_i2c_dev_path)
 {
     /* open the i2c bus */
-    if ((*p_i2c_bus = open(p_i2c_dev_path, O_RDWR)) < 0)
+    if ((*p_i2c_bus = BUS_OPEN(p_i2c_dev_path)) < 0)
     {
         /* Failed to open the i2c bus */
         perror ("ERROR: I2C - Failed to open the bus.");
@@ -46,11 +67,10 @@ extern int8_t I2C_OpenBus (int *p_i2c_bus, char *p_i2c_dev_path)
 extern int8_t I2C_ConnectToDevice (int i2c_bus, BYTE slave_addr)
 {
     /* Connect to the slave device through the i2c bus */
-    if (ioctl(i2c_bus, I2C_SLAVE, slave_addr) < 0)
+    if (BUS_SET_SLAVE(i2c_bus, slave_addr) < 0)
     {
+        /* Leave the bus open: the caller owns it and may retry */
         perror("ERROR: I2C - Failed to connect to the slave device.");
-        /* Close the bus */
-        I2C_Close(i2c_bus);
         return -1;
     }
     return 0;
@@ -79,8 +99,9 @@ extern int8_t I2C_Init (int *p_i2c_bus, char *p_i2c_dev_path, BYTE slave_addr)
     {
         /* Failed to set the slave address */
         perror("ERROR: I2C - Failed to init the slave device.");
-        /* Close the bus */
+        /* Close the bus this function opened */
         I2C_Close(*p_i2c_bus);
+        *p_i2c_bus = -1;
         return -1;
     }
     return 0;
@@ -100,26 +121,26 @@ extern int8_t I2C_Read (int i2c_bus, BYTE reg_addr, BYTE *p_buffer)
     int8_t ret = 0;
 
     /* First, Write the register address*/
-    if (write(i2c_bus, &reg_addr, I2C_ONE_BYTE) < 0)
+    if (BUS_WRITE(i2c_bus, &reg_addr, I2C_ONE_BYTE) < 0)
     {
+        FMMetrics_Add(FM_M_I2C_ERRORS, 1);
         perror("ERROR: I2C - Failed to reset the read address\n");
-        /* Close the bus */
-        I2C_Close(i2c_bus);
         return -1;
     }
 
     /* Read the data byte of the register
     Note: p_buffer is an array of bytes, storing the read data */
-    ret = read(i2c_bus, p_buffer, I2C_ONE_BYTE);
+    ret = BUS_READ(i2c_bus, p_buffer, I2C_ONE_BYTE);
     
     if (ret == -1)
     {
         /* Failed to read */
+        FMMetrics_Add(FM_M_I2C_ERRORS, 1);
         perror("ERROR: I2C - Failed to read");
-        /* Close the bus */
-        I2C_Close(i2c_bus);
         return -1;
     }
+    FMMetrics_Add(FM_M_I2C_READS, 1);
+    FMMetrics_Add(FM_M_I2C_BYTES, I2C_ONE_BYTE + ret);
     return ret;
 }
 
@@ -140,32 +161,57 @@ extern int8_t I2C_Write (int i2c_bus, BYTE reg_addr, BYTE data)
 
     int8_t ret = 0;
     /* Write to register */
-    ret = write(i2c_bus, buffer, I2C_TWO_BYTES);
+    ret = BUS_WRITE(i2c_bus, buffer, I2C_TWO_BYTES);
 
     /* If successfully written to registers, the write function will return
     the correct number of bytes that have been written to registers */
     if ((ret == -1) || (ret != I2C_TWO_BYTES))
     {
-        /* Failed to write to the register */
+        /* Failed to write to the register; a short write counts as I/O error */
+        if (ret != -1)
+        {
+            errno = EIO;
+        }
+        FMMetrics_Add(FM_M_I2C_ERRORS, 1);
         perror("ERROR: I2C - Failed to write to the register.");
-        /* Close the bus */
-        I2C_Close(i2c_bus);
         return -1;
     }
+    FMMetrics_Add(FM_M_I2C_WRITES, 1);
+    FMMetrics_Add(FM_M_I2C_BYTES, I2C_TWO_BYTES);
     return 0;
 }
 
+/****************************************************************
+ * Function Name : I2C_ReadRegisters
+ * Description   : Read data from multiple registers
+ * Returns       : 0 on success, -1 on failure
+ * Params        @i2c_bus: file descriptor of i2c bus
+ *               @p_data: to store the read data from register
+ *               @num_of_bytes: the number of bytes to be read
+ ****************************************************************/
 extern int8_t I2C_ReadRegisters (int i2c_bus, BYTE *p_data, uint8_t num_of_bytes)
 {
+    int ret = 0;
+
     /* Read the "number of bytes" from the registers and store the given byte array pointer*/
-    if (read(i2c_bus, p_data, num_of_bytes) != num_of_bytes)
+    FM_PROBE3(i2c_start, i2c_bus, num_of_bytes, 1);
+    ret = BUS_READ(i2c_bus, p_data, num_of_bytes);
+    FM_PROBE3(i2c_end, i2c_bus, num_of_bytes, ret);
+    if (ret != num_of_bytes)
     {
-        /* Failed to read from the registers */
+        /* Failed to read from the registers; a short read counts as I/O error */
+        if (ret != -1)
+        {
+            errno = EIO;
+        }
+        FlightRec_Log(FLIGHTREC_I2C_READ, (uint32_t) i2c_bus, num_of_bytes, -errno);
+        FMMetrics_Add(FM_M_I2C_ERRORS, 1);
         perror("ERROR: I2C - Failed to read from registers");
-        /* Close the bus */
-        I2C_Close(i2c_bus);
         return -1;
     }
+    FlightRec_Log(FLIGHTREC_I2C_READ, (uint32_t) i2c_bus, num_of_bytes, ret);
+    FMMetrics_Add(FM_M_I2C_READS, 1);
+    FMMetrics_Add(FM_M_I2C_BYTES, num_of_bytes);
     return 0;
 
 }
@@ -182,18 +228,27 @@ extern int8_t I2C_WriteRegisters (int i2c_bus, BYTE *p_data, uint8_t num_of_byte
 {
     int8_t ret = 0;
     /* Write to register */
-    ret = write(i2c_bus, p_data, num_of_bytes);
+    FM_PROBE3(i2c_start, i2c_bus, num_of_bytes, 0);
+    ret = BUS_WRITE(i2c_bus, p_data, num_of_bytes);
+    FM_PROBE3(i2c_end, i2c_bus, num_of_bytes, ret);
 
     /* If successfully written to registers, the write function will return
     the correct number of bytes that have been written to registers */
     if ((ret == -1) || (ret != num_of_bytes))
     {
-        /* Failed to write to the register */
+        /* Failed to write to the register; a short write counts as I/O error */
+        if (ret != -1)
+        {
+            errno = EIO;
+        }
+        FlightRec_Log(FLIGHTREC_I2C_WRITE, (uint32_t) i2c_bus, num_of_bytes, -errno);
+        FMMetrics_Add(FM_M_I2C_ERRORS, 1);
         perror("ERROR: I2C - Failed to write to the registers.");
-        /* Close the bus */
-        I2C_Close(i2c_bus);
         return -1;
     }
+    FlightRec_Log(FLIGHTREC_I2C_WRITE, (uint32_t) i2c_bus, num_of_bytes, ret);
+    FMMetrics_Add(FM_M_I2C_WRITES, 1);
+    FMMetrics_Add(FM_M_I2C_BYTES, num_of_bytes);
     return ret;
 }
 
@@ -206,11 +261,74 @@ extern int8_t I2C_WriteRegisters (int i2c_bus, BYTE *p_data, uint8_t num_of_byte
 extern int8_t I2C_Close (int i2c_bus)
 {
     /* Close the i2c bus */
-    if (close(i2c_bus) < 0)
+    if (BUS_CLOSE(i2c_bus) < 0)
     {
+        FlightRec_Log(FLIGHTREC_I2C_CLOSE, (uint32_t) i2c_bus, 0, -errno);
         /* Failed to close */
         perror ("ERROR: I2C - Failed to close bus.");
         return -1;
     }
+    FlightRec_Log(FLIGHTREC_I2C_CLOSE, (uint32_t) i2c_bus, 0, 0);
     return 0;
 }
+
+/****************************************************************
+ * Function Name : I2C_Reopen
+ * Description   : Recover an unusable bus: close the old descriptor
+ *                 (if any), open the bus again and rebind the device
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_i2c_bus: Pointer to the file descriptor, updated
+ *                           in place (-1 if the bus cannot be opened)
+ *               @p_i2c_dev_path: String path to the i2c bus
+ *               @slave_addr: 7-bit address of the slave device
+ ****************************************************************/
+extern int8_t I2C_Reopen (int *p_i2c_bus, char *p_i2c_dev_path, BYTE slave_addr)
+{
+    int8_t result = 0;
+
+    /* The old descriptor may already be gone; ignore close errors */
+    if (*p_i2c_bus >= 0)
+    {
+        (void) BUS_CLOSE(*p_i2c_bus);
+        FlightRec_Log(FLIGHTREC_I2C_CLOSE, (uint32_t) *p_i2c_bus, 0, 0);
+        *p_i2c_bus = -1;
+    }
+
+    result = I2C_Init(p_i2c_bus, p_i2c_dev_path, slave_addr);
+    FlightRec_Log(FLIGHTREC_I2C_REOPEN, (uint32_t) *p_i2c_bus, 0, result);
+    return result;
+}
+
+/****************************************************************
+ * Function Name : I2C_ClassifyError
+ * Description   : Map an errno from a failed transfer to a class
+ *                 that tells the caller how to recover
+ * Returns       : the error class
+ * Params        @err: the errno of the failed transfer
+ ****************************************************************/
+extern I2C_Error I2C_ClassifyError (int err)
+{
+    switch (err)
+    {
+    case 0:
+        return I2C_OK;
+    /* No ACK from the device: address or data byte not acknowledged */
+    case ENXIO:
+    case EREMOTEIO:
+        return I2C_ERR_NAK;
+    /* The adapter gave up waiting: clock stretching or stuck bus */
+    case ETIMEDOUT:
+        return I2C_ERR_TIMEOUT;
+    /* Arbitration lost or a bus-level glitch */
+    case EAGAIN:
+    case EIO:
+        return I2C_ERR_BUS;
+    /* The descriptor is closed, stale or the adapter went away */
+    case EBADF:
+    case ENODEV:
+    case ENOENT:
+        return I2C_ERR_FD;
+    default:
+        return I2C_ERR_OTHER;
+    }
+}
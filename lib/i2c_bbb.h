@@ -2,7 +2,7 @@
  * i2c_bbb.h
  * Author: Vy Phan
  * Created: 04/24/2023
- * Last Updated: 04/27/2023
+ * Last Updated: 10/18/2026
  */
 #ifndef I2C_BBB_H
 #define I2C_BBB_H
@@ -26,9 +26,23 @@
 #define I2C_1_DEV_PATH   "/dev/i2c-1"
 #define I2C_2_DEV_PATH   "/dev/i2c-2"
 
+#define I2C_MAX_RETRIES      4     // Attempts after the first failure
+#define I2C_REOPEN_AFTER     2     // Failed attempts before reopening the bus
+#define I2C_BACKOFF_US       500   // First retry delay, doubled every retry
+
 typedef uint8_t  BYTE;
 typedef uint16_t WORD;
 
+/* Failure classes of a transfer, from the errno it left */
+typedef enum I2C_Error {
+    I2C_OK = 0,
+    I2C_ERR_NAK,        // Device did not acknowledge - retry
+    I2C_ERR_TIMEOUT,    // Adapter timed out - retry, then reopen
+    I2C_ERR_BUS,        // Arbitration lost / bus glitch - retry
+    I2C_ERR_FD,         // Descriptor unusable - reopen the bus
+    I2C_ERR_OTHER       // Unknown - retry, then reopen
+} I2C_Error;
+
 
 /****************************************************************
  * Function Name : I2C_OpenBus
@@ -101,6 +115,27 @@ extern int8_t I2C_ReadRegisters (int i2c_bus, BYTE *p_data, uint8_t num_of_bytes
  ****************************************************************/
 extern int8_t I2C_WriteRegisters (int i2c_bus, BYTE *p_data, uint8_t num_of_bytes);
 
+/****************************************************************
+ * Function Name : I2C_Reopen
+ * Description   : Recover an unusable bus: close the old descriptor
+ *                 (if any), open the bus again and rebind the device
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_i2c_bus: Pointer to the file descriptor, updated
+ *                           in place (-1 if the bus cannot be opened)
+ *               @p_i2c_dev_path: String path to the i2c bus
+ *               @slave_addr: 7-bit address of the slave device
+ ****************************************************************/
+extern int8_t I2C_Reopen (int *p_i2c_bus, char *p_i2c_dev_path, BYTE slave_addr);
+
+/****************************************************************
+ * Function Name : I2C_ClassifyError
+ * Description   : Map an errno from a failed transfer to a class
+ *                 that tells the caller how to recover
+ * Returns       : the error class
+ * Params        @err: the errno of the failed transfer
+ ****************************************************************/
+extern I2C_Error I2C_ClassifyError (int err);
+
 /****************************************************************
  * Function Name : I2C_Close
  * Description   : Close the I2C bus
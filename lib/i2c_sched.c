@@ -0,0 +1,256 @@
+/*
+ * i2c_sched.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <string.h>         // String-handling library
+#include <errno.h>          // EBADF
+#include <pthread.h>        // Lock and condition
+
+#include "fm_clock.h"
+#include "i2c_sched.h"      // Its header file
+
+static I2CSched_Bus buses[I2CSCHED_MAX_BUSES];
+static uint8_t bus_count = 0;
+static pthread_mutex_t buses_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *class_names[I2CSCHED_CLASSES] = { "interactive", "periodic", "background" };
+
+/****************************************************************
+ * Function Name : higherWaiting (private)
+ * Description   : Check for waiters of a class above the given one
+ * Returns       : 1 if any, 0 otherwise
+ * Params        @p_bus: the bus, mutex held
+ *               @class: the class
+ ****************************************************************/
+static uint8_t higherWaiting (const I2CSched_Bus *p_bus, I2CSched_Class class)
+{
+    uint8_t higher = 0;
+
+    for (higher = 0; higher < class; higher++)
+    {
+        if (p_bus->waiting[higher] > 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : I2CSched_Open
+ * Description   : Get the scheduler of a bus, opening the bus on
+ *                 first use. Every caller of the same path shares it.
+ * Returns       : the bus, NULL on failure
+ * Params        @p_path: the bus, e.g. I2C_2_DEV_PATH
+ ****************************************************************/
+extern I2CSched_Bus* I2CSched_Open (const char *p_path)
+{
+    I2CSched_Bus *p_bus = NULL;
+    uint8_t index = 0;
+    uint8_t class = 0;
+
+    (void) pthread_mutex_lock(&buses_mutex);
+    for (index = 0; index < bus_count; index++)
+    {
+        if (strcmp(buses[index].path, p_path) == 0)
+        {
+            (void) pthread_mutex_unlock(&buses_mutex);
+            return &buses[index];
+        }
+    }
+    if ((bus_count >= I2CSCHED_MAX_BUSES) || (strlen(p_path) >= I2CSCHED_PATH_SIZE))
+    {
+        (void) pthread_mutex_unlock(&buses_mutex);
+        printf("ERROR: I2CSched - No room for bus %s\n", p_path);
+        return NULL;
+    }
+
+    p_bus = &buses[bus_count];
+    (void) memset(p_bus, 0, sizeof(I2CSched_Bus));
+    (void) snprintf(p_bus->path, sizeof(p_bus->path), "%s", p_path);
+    if (I2C_OpenBus(&p_bus->fd, p_bus->path) < 0)
+    {
+        (void) pthread_mutex_unlock(&buses_mutex);
+        return NULL;
+    }
+    (void) pthread_mutex_init(&p_bus->mutex, NULL);
+    (void) pthread_cond_init(&p_bus->cond, NULL);
+    for (class = 0; class < I2CSCHED_CLASSES; class++)
+    {
+        LatHist_Init(&p_bus->stats[class].wait_hist);
+        LatHist_Init(&p_bus->stats[class].hold_hist);
+    }
+    bus_count++;
+    (void) pthread_mutex_unlock(&buses_mutex);
+    return p_bus;
+}
+
+/****************************************************************
+ * Function Name : I2CSched_Begin
+ * Description   : Wait for the bus in the given class and bind it
+ *                 to the slave address. The bus is held on return,
+ *                 whatever the result, until I2CSched_End.
+ * Returns       : 0 when bound, -1 if the descriptor is unusable or
+ *                 the bind failed (errno set; I2CSched_Reopen)
+ * Params        @p_bus: the bus
+ *               @class: the class of the transaction
+ *               @slave_addr: 7-bit address of the slave device
+ ****************************************************************/
+extern int I2CSched_Begin (I2CSched_Bus *p_bus, I2CSched_Class class, BYTE slave_addr)
+{
+    uint64_t begin_us = FMClock_NowUs();
+    uint32_t ticket = 0;
+    uint8_t contended = 0;
+    uint8_t lower = 0;
+
+    (void) pthread_mutex_lock(&p_bus->mutex);
+    ticket = p_bus->next_ticket[class]++;
+    p_bus->waiting[class]++;
+
+    /* Granted when the bus is free, this is the oldest waiter of its
+     * class and no higher class waits */
+    while (p_bus->busy || (p_bus->serving[class] != ticket) || higherWaiting(p_bus, class))
+    {
+        contended = 1;
+        (void) FMClock_CondWait(&p_bus->cond, &p_bus->mutex, 0);
+    }
+    p_bus->waiting[class]--;
+    p_bus->serving[class]++;
+    p_bus->busy = 1;
+    p_bus->holder = class;
+    p_bus->granted_us = FMClock_NowUs();
+
+    /* Someone of a lower class was in line and goes after this one */
+    for (lower = class + 1; lower < I2CSCHED_CLASSES; lower++)
+    {
+        if (p_bus->waiting[lower] > 0)
+        {
+            p_bus->preemptions++;
+            break;
+        }
+    }
+    p_bus->stats[class].transactions++;
+    p_bus->stats[class].contended += contended;
+    LatHist_Record(&p_bus->stats[class].wait_hist, p_bus->granted_us - begin_us);
+    (void) pthread_mutex_unlock(&p_bus->mutex);
+
+    /* Only the holder touches the descriptor, so no lock from here */
+    if (p_bus->fd < 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    if (p_bus->slave != slave_addr)
+    {
+        if (I2C_ConnectToDevice(p_bus->fd, slave_addr) < 0)
+        {
+            p_bus->slave = 0;
+            return -1;
+        }
+        p_bus->slave = slave_addr;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : I2CSched_Fd
+ * Description   : Get the descriptor, for the holder of the bus
+ * Returns       : the descriptor, -1 if the bus is down
+ * Params        @p_bus: the bus
+ ****************************************************************/
+extern int I2CSched_Fd (const I2CSched_Bus *p_bus)
+{
+    return p_bus->fd;
+}
+
+/****************************************************************
+ * Function Name : I2CSched_Reopen
+ * Description   : Reopen the bus and rebind the slave, for the
+ *                 holder of the bus. Every client gets the new
+ *                 descriptor.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_bus: the bus
+ *               @slave_addr: 7-bit address of the slave device
+ ****************************************************************/
+extern int I2CSched_Reopen (I2CSched_Bus *p_bus, BYTE slave_addr)
+{
+    if (I2C_Reopen(&p_bus->fd, p_bus->path, slave_addr) < 0)
+    {
+        p_bus->slave = 0;
+        return -1;
+    }
+    p_bus->slave = slave_addr;
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : I2CSched_End
+ * Description   : End the transaction and hand the bus on
+ * Returns       : void
+ * Params        @p_bus: the bus
+ ****************************************************************/
+extern void I2CSched_End (I2CSched_Bus *p_bus)
+{
+    uint8_t waiters = 0;
+    uint8_t class = 0;
+
+    (void) pthread_mutex_lock(&p_bus->mutex);
+    LatHist_Record(&p_bus->stats[p_bus->holder].hold_hist, FMClock_NowUs() - p_bus->granted_us);
+    p_bus->busy = 0;
+    for (class = 0; class < I2CSCHED_CLASSES; class++)
+    {
+        waiters |= (p_bus->waiting[class] > 0);
+    }
+    (void) pthread_mutex_unlock(&p_bus->mutex);
+
+    /* Every waiter rechecks; only the one next in line goes */
+    if (waiters)
+    {
+        FMClock_CondBroadcast(&p_bus->cond);
+    }
+}
+
+/****************************************************************
+ * Function Name : I2CSched_Print
+ * Description   : Print, per open bus and class, the transactions
+ *                 and their queue wait and hold tails
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void I2CSched_Print (void)
+{
+    I2CSched_ClassStats stats[I2CSCHED_CLASSES];
+    uint32_t preemptions = 0;
+    uint8_t index = 0;
+    uint8_t class = 0;
+
+    (void) pthread_mutex_lock(&buses_mutex);
+    for (index = 0; index < bus_count; index++)
+    {
+        (void) pthread_mutex_lock(&buses[index].mutex);
+        (void) memcpy(stats, buses[index].stats, sizeof(stats));
+        preemptions = buses[index].preemptions;
+        (void) pthread_mutex_unlock(&buses[index].mutex);
+
+        printf("Bus %s: %u grants ahead of a lower class\n", buses[index].path, preemptions);
+        for (class = 0; class < I2CSCHED_CLASSES; class++)
+        {
+            if (stats[class].transactions == 0)
+            {
+                continue;
+            }
+            printf("Bus %s: %-11s %u transactions, %u contended; wait p99 %llu us, max %llu us; hold p99 %llu us, max %llu us\n",
+                   buses[index].path, class_names[class], stats[class].transactions, stats[class].contended,
+                   (unsigned long long) LatHist_Percentile(&stats[class].wait_hist, 99),
+                   (unsigned long long) stats[class].wait_hist.max_us,
+                   (unsigned long long) LatHist_Percentile(&stats[class].hold_hist, 99),
+                   (unsigned long long) stats[class].hold_hist.max_us);
+        }
+    }
+    (void) pthread_mutex_unlock(&buses_mutex);
+}
@@ -0,0 +1,117 @@
+/*
+ * i2c_sched.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef I2C_SCHED_H
+#define I2C_SCHED_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <pthread.h>    // Lock and condition
+
+#include "i2c_bbb.h"
+#include "latency_hist.h"
+
+/* Bus scheduler. One I2CSched_Bus owns the descriptor of each
+ * /dev/i2c-N and every client (a driver instance, a monitor, another
+ * sensor) reaches the bus through it, one transaction at a time. A
+ * transaction is a single transfer: the bus is granted with
+ * I2CSched_Begin, bound to the client's slave address, and handed on
+ * at I2CSched_End. When the bus frees, the oldest waiter of the highest
+ * class goes next, so a long sweep of background transactions is
+ * preempted at the next transaction boundary by an interactive one. */
+
+#define I2CSCHED_MAX_BUSES  12      // Buses open at once
+#define I2CSCHED_PATH_SIZE  32      // Longest bus path
+
+typedef enum I2CSched_Class {
+    I2CSCHED_INTERACTIVE = 0,   // User tune, audio, wake
+    I2CSCHED_PERIODIC,          // Status polls
+    I2CSCHED_BACKGROUND,        // Band scan
+    I2CSCHED_CLASSES
+} I2CSched_Class;
+
+typedef struct I2CSched_ClassStats {
+    uint32_t transactions;  // Transactions granted
+    uint32_t contended;     // Of those, found the bus taken or a higher class waiting
+    LatHist  wait_hist;     // Begin to grant
+    LatHist  hold_hist;     // Grant to end
+} I2CSched_ClassStats;
+
+typedef struct I2CSched_Bus {
+    char path[I2CSCHED_PATH_SIZE];  // /dev/i2c-N
+    int  fd;                        // Bus descriptor, -1 if it failed
+    BYTE slave;                     // Address fd is bound to, 0 = none
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    uint8_t  busy;                              // 1 = a transaction is running
+    I2CSched_Class holder;                      // Class of the running transaction
+    uint64_t granted_us;                        // When it was granted
+    uint32_t waiting[I2CSCHED_CLASSES];         // Clients waiting per class
+    uint32_t next_ticket[I2CSCHED_CLASSES];     // FIFO order within a class
+    uint32_t serving[I2CSCHED_CLASSES];         // Next ticket to grant
+    uint32_t preemptions;                       // Grants that went ahead of a lower class
+    I2CSched_ClassStats stats[I2CSCHED_CLASSES];
+} I2CSched_Bus;
+
+/****************************************************************
+ * Function Name : I2CSched_Open
+ * Description   : Get the scheduler of a bus, opening the bus on
+ *                 first use. Every caller of the same path shares it.
+ * Returns       : the bus, NULL on failure
+ * Params        @p_path: the bus, e.g. I2C_2_DEV_PATH
+ ****************************************************************/
+extern I2CSched_Bus* I2CSched_Open (const char *p_path);
+
+/****************************************************************
+ * Function Name : I2CSched_Begin
+ * Description   : Wait for the bus in the given class and bind it
+ *                 to the slave address. The bus is held on return,
+ *                 whatever the result, until I2CSched_End.
+ * Returns       : 0 when bound, -1 if the descriptor is unusable or
+ *                 the bind failed (errno set; I2CSched_Reopen)
+ * Params        @p_bus: the bus
+ *               @class: the class of the transaction
+ *               @slave_addr: 7-bit address of the slave device
+ ****************************************************************/
+extern int I2CSched_Begin (I2CSched_Bus *p_bus, I2CSched_Class class, BYTE slave_addr);
+
+/****************************************************************
+ * Function Name : I2CSched_Fd
+ * Description   : Get the descriptor, for the holder of the bus
+ * Returns       : the descriptor, -1 if the bus is down
+ * Params        @p_bus: the bus
+ ****************************************************************/
+extern int I2CSched_Fd (const I2CSched_Bus *p_bus);
+
+/****************************************************************
+ * Function Name : I2CSched_Reopen
+ * Description   : Reopen the bus and rebind the slave, for the
+ *                 holder of the bus. Every client gets the new
+ *                 descriptor.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_bus: the bus
+ *               @slave_addr: 7-bit address of the slave device
+ ****************************************************************/
+extern int I2CSched_Reopen (I2CSched_Bus *p_bus, BYTE slave_addr);
+
+/****************************************************************
+ * Function Name : I2CSched_End
+ * Description   : End the transaction and hand the bus on
+ * Returns       : void
+ * Params        @p_bus: the bus
+ ****************************************************************/
+extern void I2CSched_End (I2CSched_Bus *p_bus);
+
+/****************************************************************
+ * Function Name : I2CSched_Print
+ * Description   : Print, per open bus and class, the transactions
+ *                 and their queue wait and hold tails
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void I2CSched_Print (void);
+
+#endif
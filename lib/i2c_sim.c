@@ -0,0 +1,472 @@
+/*
+ * i2c_sim.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // getenv, strtoul
+#include <string.h>     // String-handling library
+#include <unistd.h>     // POSIX API
+#include <fcntl.h>      // File controls
+#include <errno.h>      // Error codes
+#include <pthread.h>    // Simulator lock
+
+#include "fm_clock.h"
+#include "i2c_sim.h"    // Its header file
+
+#define SIM_REGS            5
+#define SIM_PATH_SIZE       32
+#define SIM_US_PER_BYTE     90      // 9 bit times at 100kHz
+#define SIM_IF_HZ           225000
+#define SIM_IF_COUNT        0x37    // IF counter of a tuned station
+#define SIM_NOISE_LEVEL     1       // Level ADC with no station
+#define SIM_LEVEL_SLOPE_KHZ 50      // Level drops by one every 50kHz off a station
+#define SIM_STEREO_LEVEL    7       // Pilot detected from this level up
+
+/* Synthetic band plan the simulated tuner receives */
+typedef struct SimStation {
+    uint32_t freq_khz;
+    uint8_t  level;     // Peak level ADC (0 - 15)
+    uint8_t  stereo;    // 1 if the station transmits a pilot
+} SimStation;
+
+static const SimStation stations[] = {
+    {  76500, 10, 1 }, {  80000, 12, 1 }, {  82500,  9, 0 }, {  85200, 11, 1 },
+    {  88100, 12, 1 }, {  89300,  9, 1 }, {  90900,  6, 0 }, {  92500, 13, 1 },
+    {  94700, 14, 1 }, {  96300,  5, 0 }, {  97900, 11, 1 }, {  99500,  8, 1 },
+    { 101100, 15, 1 }, { 102700,  7, 0 }, { 104300, 10, 1 }, { 105900, 12, 1 },
+    { 107500,  4, 0 },
+};
+
+typedef struct SimBus {
+    char     path[SIM_PATH_SIZE];   // Bus path, empty if the slot is free
+    int      fd;                    // Descriptor handed out, -1 if closed
+    uint8_t  stale;                 // 1 = descriptor lost, needs a reopen
+    uint8_t  slave;                 // Selected device address
+    uint8_t  regs[SIM_REGS];        // Tuner write registers
+    uint64_t tune_us;               // When the PLL was last changed
+} SimBus;
+
+static SimBus buses[I2CSIM_MAX_BUSES];
+static I2CSim_Faults faults;
+static I2CSim_Stats stats;
+static uint32_t rng_state = 1;
+static uint8_t configured = 0;
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************
+ * Function Name : envRate (private)
+ * Description   : Read a fault rate from the environment
+ * Returns       : the value, 0 if unset
+ * Params        @p_name: the variable name
+ ****************************************************************/
+static uint32_t envRate (const char *p_name)
+{
+    const char *p_value = getenv(p_name);
+
+    return (p_value != NULL) ? (uint32_t) strtoul(p_value, NULL, 0) : 0;
+}
+
+/****************************************************************
+ * Function Name : configure (private)
+ * Description   : Load the fault rates from the environment once.
+ *                 Must be called with sim_mutex held.
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void configure (void)
+{
+    if (configured)
+    {
+        return;
+    }
+    configured = 1;
+    faults.nak_permille = envRate("FM_SIM_NAK");
+    faults.timeout_permille = envRate("FM_SIM_TIMEOUT");
+    faults.lost_permille = envRate("FM_SIM_LOST");
+    faults.seed = envRate("FM_SIM_SEED");
+    rng_state = faults.seed ? faults.seed : 1;
+}
+
+/****************************************************************
+ * Function Name : nextRandom (private)
+ * Description   : xorshift32 step. Must be called with sim_mutex held.
+ * Returns       : the next pseudo-random number
+ * Params        : N/A
+ ****************************************************************/
+static uint32_t nextRandom (void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/****************************************************************
+ * Function Name : findBus (private)
+ * Description   : Find the bus a descriptor belongs to.
+ *                 Must be called with sim_mutex held.
+ * Returns       : the bus, NULL if the descriptor is unknown
+ * Params        @fd: the descriptor
+ ****************************************************************/
+static SimBus* findBus (int fd)
+{
+    uint8_t i;
+
+    for (i = 0; i < I2CSIM_MAX_BUSES; i++)
+    {
+        if ((buses[i].path[0] != '\0') && (buses[i].fd == fd))
+        {
+            return &buses[i];
+        }
+    }
+    return NULL;
+}
+
+/****************************************************************
+ * Function Name : levelAt (private)
+ * Description   : Level ADC reading the band plan gives at a frequency
+ * Returns       : level (0 - 15)
+ * Params        @rf_hz: the received frequency
+ *               @p_stereo: to store 1 if the strongest station is stereo
+ ****************************************************************/
+static uint8_t levelAt (int64_t rf_hz, uint8_t *p_stereo)
+{
+    int32_t best = SIM_NOISE_LEVEL;
+    int32_t level;
+    int64_t offset_khz;
+    size_t i;
+
+    *p_stereo = 0;
+    for (i = 0; i < (sizeof(stations) / sizeof(stations[0])); i++)
+    {
+        offset_khz = (rf_hz / 1000) - (int64_t) stations[i].freq_khz;
+        if (offset_khz < 0)
+        {
+            offset_khz = -offset_khz;
+        }
+        level = stations[i].level - (int32_t) (offset_khz / SIM_LEVEL_SLOPE_KHZ);
+        if (level > best)
+        {
+            best = level;
+            *p_stereo = stations[i].stereo && (offset_khz < SIM_LEVEL_SLOPE_KHZ);
+        }
+    }
+    return (uint8_t) best;
+}
+
+/****************************************************************
+ * Function Name : injectFault (private)
+ * Description   : Roll the fault dice for one transfer.
+ *                 Must be called with sim_mutex held.
+ * Returns       : 0 to go ahead, otherwise the errno to fail with
+ * Params        @p_bus: the bus of the transfer
+ ****************************************************************/
+static int injectFault (SimBus *p_bus)
+{
+    uint32_t roll;
+
+    if (p_bus->stale)
+    {
+        return EBADF;
+    }
+    if (p_bus->slave != I2CSIM_TEA5767_ADDR)
+    {
+        return ENXIO;
+    }
+
+    roll = nextRandom() % 1000;
+    if (roll < faults.nak_permille)
+    {
+        stats.naks++;
+        return EREMOTEIO;
+    }
+    roll -= faults.nak_permille;
+    if (roll < faults.timeout_permille)
+    {
+        stats.timeouts++;
+        return ETIMEDOUT;
+    }
+    roll -= faults.timeout_permille;
+    if (roll < faults.lost_permille)
+    {
+        stats.lost++;
+        p_bus->stale = 1;
+        return EBADF;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : I2CSim_Open
+ * Description   : Open a simulated bus (same contract as open())
+ * Returns       : descriptor on success, -1 on failure
+ * Params        @p_path: bus path, e.g. "/dev/i2c-2"
+ ****************************************************************/
+extern int I2CSim_Open (const char *p_path)
+{
+    SimBus *p_bus = NULL;
+    SimBus *p_free = NULL;
+    uint8_t i;
+    int fd;
+
+    /* A real descriptor keeps the numbers unique in the process */
+    fd = open("/dev/null", O_RDWR);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    (void) pthread_mutex_lock(&sim_mutex);
+    configure();
+    for (i = 0; i < I2CSIM_MAX_BUSES; i++)
+    {
+        if (strncmp(buses[i].path, p_path, SIM_PATH_SIZE) == 0)
+        {
+            p_bus = &buses[i];
+            break;
+        }
+        if ((p_free == NULL) && (buses[i].path[0] == '\0'))
+        {
+            p_free = &buses[i];
+        }
+    }
+
+    /* First open of this path: the tuner powers up with zeroed registers */
+    if (p_bus == NULL)
+    {
+        if (p_free == NULL)
+        {
+            (void) pthread_mutex_unlock(&sim_mutex);
+            (void) close(fd);
+            errno = ENOENT;
+            return -1;
+        }
+        p_bus = p_free;
+        (void) memset(p_bus, 0, sizeof(SimBus));
+        (void) strncpy(p_bus->path, p_path, SIM_PATH_SIZE - 1);
+    }
+    else if (p_bus->fd >= 0)
+    {
+        /* Only one descriptor per bus: the previous one goes stale */
+        (void) close(p_bus->fd);
+    }
+    p_bus->fd = fd;
+    p_bus->stale = 0;
+    p_bus->slave = 0;
+    (void) pthread_mutex_unlock(&sim_mutex);
+    return fd;
+}
+
+/****************************************************************
+ * Function Name : I2CSim_SetSlave
+ * Description   : Select the device (same contract as I2C_SLAVE)
+ * Returns       : 0 on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ *               @addr: 7-bit device address
+ ****************************************************************/
+extern int I2CSim_SetSlave (int bus, uint8_t addr)
+{
+    SimBus *p_bus;
+
+    (void) pthread_mutex_lock(&sim_mutex);
+    p_bus = findBus(bus);
+    if ((p_bus == NULL) || p_bus->stale)
+    {
+        (void) pthread_mutex_unlock(&sim_mutex);
+        errno = EBADF;
+        return -1;
+    }
+    p_bus->slave = addr;
+    (void) pthread_mutex_unlock(&sim_mutex);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : I2CSim_Read
+ * Description   : Read from the selected device (same as read())
+ * Returns       : bytes read on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ *               @p_data: to store the data
+ *               @length: number of bytes
+ ****************************************************************/
+extern ssize_t I2CSim_Read (int bus, void *p_data, size_t length)
+{
+    SimBus *p_bus;
+    uint8_t status[SIM_REGS] = { 0 };
+    uint8_t *p_regs;
+    uint32_t pll;
+    uint32_t ref_hz;
+    int64_t lo_hz;
+    int64_t rf_hz;
+    uint8_t level = 0;
+    uint8_t stereo = 0;
+    int err;
+
+    (void) pthread_mutex_lock(&sim_mutex);
+    p_bus = findBus(bus);
+    if (p_bus == NULL)
+    {
+        (void) pthread_mutex_unlock(&sim_mutex);
+        errno = EBADF;
+        return -1;
+    }
+    err = injectFault(p_bus);
+    if (err == 0)
+    {
+        /* Decode the tuning from the write registers */
+        p_regs = p_bus->regs;
+        pll = ((uint32_t) (p_regs[0] & 0x3F) << 8) | p_regs[1];
+        ref_hz = (p_regs[3] & 0x10) ? 32768 : 50000;
+        lo_hz = ((int64_t) pll * ref_hz) / 4;
+        rf_hz = (p_regs[2] & 0x10) ? (lo_hz - SIM_IF_HZ) : (lo_hz + SIM_IF_HZ);
+
+        /* In standby nothing is received and the PLL never locks */
+        if (!(p_regs[3] & 0x40))
+        {
+            level = levelAt(rf_hz, &stereo);
+            if ((FMClock_NowUs() - p_bus->tune_us) >= I2CSIM_SETTLE_US)
+            {
+                status[0] |= 0x80;  // RF ready
+            }
+        }
+        if ((p_regs[2] & 0x08) || (level < SIM_STEREO_LEVEL))
+        {
+            stereo = 0;
+        }
+        /* Band limit: Japan 76 - 91MHz with BL set, else 87.5 - 108MHz */
+        if ((p_regs[3] & 0x20) ? ((rf_hz < 76000000) || (rf_hz > 91000000))
+                               : ((rf_hz < 87500000) || (rf_hz > 108000000)))
+        {
+            status[0] |= 0x40;
+        }
+        status[0] |= p_regs[0] & 0x3F;
+        status[1] = p_regs[1];
+        status[2] = (stereo ? 0x80 : 0x00) | SIM_IF_COUNT;
+        status[3] = (uint8_t) (level << 4);
+        stats.reads++;
+    }
+    (void) pthread_mutex_unlock(&sim_mutex);
+
+    /* Bus time, outside the lock so other buses keep going */
+    FMClock_SleepUs((err == ETIMEDOUT) ? I2CSIM_TIMEOUT_US : ((length + 1) * SIM_US_PER_BYTE));
+    if (err != 0)
+    {
+        errno = err;
+        return -1;
+    }
+
+    if (length > SIM_REGS)
+    {
+        length = SIM_REGS;
+    }
+    (void) memcpy(p_data, status, length);
+    return (ssize_t) length;
+}
+
+/****************************************************************
+ * Function Name : I2CSim_Write
+ * Description   : Write to the selected device (same as write())
+ * Returns       : bytes written on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ *               @p_data: the data
+ *               @length: number of bytes
+ ****************************************************************/
+extern ssize_t I2CSim_Write (int bus, const void *p_data, size_t length)
+{
+    SimBus *p_bus;
+    size_t count = (length > SIM_REGS) ? SIM_REGS : length;
+    int err;
+
+    (void) pthread_mutex_lock(&sim_mutex);
+    p_bus = findBus(bus);
+    if (p_bus == NULL)
+    {
+        (void) pthread_mutex_unlock(&sim_mutex);
+        errno = EBADF;
+        return -1;
+    }
+    err = injectFault(p_bus);
+    if (err == 0)
+    {
+        /* A new PLL word or injection side restarts the settle time */
+        if ((count >= 3) && (((p_bus->regs[0] ^ ((const uint8_t *) p_data)[0]) & 0x3F)
+                             || (p_bus->regs[1] != ((const uint8_t *) p_data)[1])
+                             || ((p_bus->regs[2] ^ ((const uint8_t *) p_data)[2]) & 0x10)))
+        {
+            p_bus->tune_us = FMClock_NowUs();
+        }
+        /* Leaving standby restarts it too */
+        if ((count >= 4) && (p_bus->regs[3] & 0x40) && !(((const uint8_t *) p_data)[3] & 0x40))
+        {
+            p_bus->tune_us = FMClock_NowUs();
+        }
+        (void) memcpy(p_bus->regs, p_data, count);
+        stats.writes++;
+    }
+    (void) pthread_mutex_unlock(&sim_mutex);
+
+    FMClock_SleepUs((err == ETIMEDOUT) ? I2CSIM_TIMEOUT_US : ((length + 1) * SIM_US_PER_BYTE));
+    if (err != 0)
+    {
+        errno = err;
+        return -1;
+    }
+    return (ssize_t) length;
+}
+
+/****************************************************************
+ * Function Name : I2CSim_Close
+ * Description   : Close a simulated bus (same contract as close())
+ * Returns       : 0 on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ ****************************************************************/
+extern int I2CSim_Close (int bus)
+{
+    SimBus *p_bus;
+
+    (void) pthread_mutex_lock(&sim_mutex);
+    p_bus = findBus(bus);
+    if (p_bus == NULL)
+    {
+        (void) pthread_mutex_unlock(&sim_mutex);
+        errno = EBADF;
+        return -1;
+    }
+    /* Keep the tuner registers: the device stays powered */
+    p_bus->fd = -1;
+    p_bus->stale = 0;
+    (void) pthread_mutex_unlock(&sim_mutex);
+    return close(bus);
+}
+
+/****************************************************************
+ * Function Name : I2CSim_SetFaults
+ * Description   : Change the fault injection rates
+ * Returns       : void
+ * Params        @p_faults: the new rates and seed
+ ****************************************************************/
+extern void I2CSim_SetFaults (const I2CSim_Faults *p_faults)
+{
+    (void) pthread_mutex_lock(&sim_mutex);
+    configured = 1;
+    faults = *p_faults;
+    rng_state = faults.seed ? faults.seed : 1;
+    (void) pthread_mutex_unlock(&sim_mutex);
+}
+
+/****************************************************************
+ * Function Name : I2CSim_GetStats
+ * Description   : Get a copy of the simulator counters
+ * Returns       : void
+ * Params        @p_stats: to store the counters
+ ****************************************************************/
+extern void I2CSim_GetStats (I2CSim_Stats *p_stats)
+{
+    (void) pthread_mutex_lock(&sim_mutex);
+    *p_stats = stats;
+    (void) pthread_mutex_unlock(&sim_mutex);
+}
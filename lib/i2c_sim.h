@@ -0,0 +1,102 @@
+/*
+ * i2c_sim.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef I2C_SIM_H
+#define I2C_SIM_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <sys/types.h>  // ssize_t
+
+/* Simulated I2C buses, each with one TEA5767 at its fixed address.
+ * Built in with -DI2C_SIMULATOR so the whole receiver runs off-target. */
+
+#define I2CSIM_MAX_BUSES      64      // Distinct bus paths that can be opened
+#define I2CSIM_TEA5767_ADDR   0x60    // Address the simulated tuner answers on
+#define I2CSIM_SETTLE_US      3000    // PLL settle time after a tune
+#define I2CSIM_XFER_US        500     // Time of one 5-byte transfer at 100kHz
+#define I2CSIM_TIMEOUT_US     10000   // Time an injected timeout blocks
+
+/* Fault injection, rates in permille per transfer. Read once from
+ * the environment (FM_SIM_NAK, FM_SIM_TIMEOUT, FM_SIM_LOST, FM_SIM_SEED)
+ * on the first open, or set with I2CSim_SetFaults. */
+typedef struct I2CSim_Faults {
+    uint16_t nak_permille;      // Transfer fails with EREMOTEIO
+    uint16_t timeout_permille;  // Transfer blocks, then fails with ETIMEDOUT
+    uint16_t lost_permille;     // Descriptor goes stale (EBADF) until reopened
+    uint32_t seed;              // Seed of the fault generator
+} I2CSim_Faults;
+
+typedef struct I2CSim_Stats {
+    uint32_t reads;             // Successful reads
+    uint32_t writes;            // Successful writes
+    uint32_t naks;              // Injected NAKs
+    uint32_t timeouts;          // Injected timeouts
+    uint32_t lost;              // Injected stale descriptors
+} I2CSim_Stats;
+
+/****************************************************************
+ * Function Name : I2CSim_Open
+ * Description   : Open a simulated bus (same contract as open())
+ * Returns       : descriptor on success, -1 on failure
+ * Params        @p_path: bus path, e.g. "/dev/i2c-2"
+ ****************************************************************/
+extern int I2CSim_Open (const char *p_path);
+
+/****************************************************************
+ * Function Name : I2CSim_SetSlave
+ * Description   : Select the device (same contract as I2C_SLAVE)
+ * Returns       : 0 on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ *               @addr: 7-bit device address
+ ****************************************************************/
+extern int I2CSim_SetSlave (int bus, uint8_t addr);
+
+/****************************************************************
+ * Function Name : I2CSim_Read
+ * Description   : Read from the selected device (same as read())
+ * Returns       : bytes read on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ *               @p_data: to store the data
+ *               @length: number of bytes
+ ****************************************************************/
+extern ssize_t I2CSim_Read (int bus, void *p_data, size_t length);
+
+/****************************************************************
+ * Function Name : I2CSim_Write
+ * Description   : Write to the selected device (same as write())
+ * Returns       : bytes written on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ *               @p_data: the data
+ *               @length: number of bytes
+ ****************************************************************/
+extern ssize_t I2CSim_Write (int bus, const void *p_data, size_t length);
+
+/****************************************************************
+ * Function Name : I2CSim_Close
+ * Description   : Close a simulated bus (same contract as close())
+ * Returns       : 0 on success, -1 on failure
+ * Params        @bus: descriptor from I2CSim_Open
+ ****************************************************************/
+extern int I2CSim_Close (int bus);
+
+/****************************************************************
+ * Function Name : I2CSim_SetFaults
+ * Description   : Change the fault injection rates
+ * Returns       : void
+ * Params        @p_faults: the new rates and seed
+ ****************************************************************/
+extern void I2CSim_SetFaults (const I2CSim_Faults *p_faults);
+
+/****************************************************************
+ * Function Name : I2CSim_GetStats
+ * Description   : Get a copy of the simulator counters
+ * Returns       : void
+ * Params        @p_stats: to store the counters
+ ****************************************************************/
+extern void I2CSim_GetStats (I2CSim_Stats *p_stats);
+
+#endif
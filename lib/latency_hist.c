@@ -0,0 +1,136 @@
+/*
+ * latency_hist.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <string.h>     // String-handling library
+
+#include "latency_hist.h" // Its header file
+
+/****************************************************************
+ * Function Name : bucketOf (private)
+ * Description   : Find the bucket of a sample
+ * Returns       : the bucket index
+ * Params        @latency_us: the sample in microseconds
+ ****************************************************************/
+static uint8_t bucketOf (uint64_t latency_us)
+{
+    uint8_t bucket = 0;
+
+    while ((latency_us != 0) && (bucket < (LATHIST_BUCKETS - 1)))
+    {
+        latency_us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/****************************************************************
+ * Function Name : LatHist_Init
+ * Description   : Clear a latency histogram
+ * Returns       : void
+ * Params        @p_hist: the histogram
+ ****************************************************************/
+extern void LatHist_Init (LatHist *p_hist)
+{
+    (void) memset(p_hist, 0, sizeof(LatHist));
+}
+
+/****************************************************************
+ * Function Name : LatHist_Record
+ * Description   : Add one latency sample
+ * Returns       : void
+ * Params        @p_hist: the histogram
+ *               @latency_us: the sample in microseconds
+ ****************************************************************/
+extern void LatHist_Record (LatHist *p_hist, uint64_t latency_us)
+{
+    p_hist->buckets[bucketOf(latency_us)]++;
+    if ((p_hist->count == 0) || (latency_us < p_hist->min_us))
+    {
+        p_hist->min_us = latency_us;
+    }
+    if (latency_us > p_hist->max_us)
+    {
+        p_hist->max_us = latency_us;
+    }
+    p_hist->count++;
+    p_hist->sum_us += latency_us;
+}
+
+/****************************************************************
+ * Function Name : LatHist_Percentile
+ * Description   : Estimate a percentile from the buckets
+ * Returns       : upper bound (us) of the bucket holding the
+ *                 percentile, capped at the largest sample
+ * Params        @p_hist: the histogram
+ *               @percent: the percentile (0 - 100)
+ ****************************************************************/
+extern uint64_t LatHist_Percentile (const LatHist *p_hist, uint8_t percent)
+{
+    uint64_t target = 0;
+    uint64_t seen = 0;
+    uint64_t upper_us = 0;
+    uint8_t bucket = 0;
+
+    if (p_hist->count == 0)
+    {
+        return 0;
+    }
+
+    /* Rank of the sample at the percentile, at least the first one */
+    target = (((uint64_t) p_hist->count * percent) + 99) / 100;
+    if (target == 0)
+    {
+        target = 1;
+    }
+
+    for (bucket = 0; bucket < LATHIST_BUCKETS; bucket++)
+    {
+        seen += p_hist->buckets[bucket];
+        if (seen >= target)
+        {
+            break;
+        }
+    }
+
+    upper_us = (bucket == 0) ? 0 : ((1ULL << bucket) - 1);
+    return (upper_us < p_hist->max_us) ? upper_us : p_hist->max_us;
+}
+
+/****************************************************************
+ * Function Name : LatHist_Print
+ * Description   : Print a summary line and the non-empty buckets
+ * Returns       : void
+ * Params        @p_name: label printed in front of every line
+ *               @p_hist: the histogram
+ ****************************************************************/
+extern void LatHist_Print (const char *p_name, const LatHist *p_hist)
+{
+    uint8_t bucket = 0;
+
+    printf("%s: n=%u min=%llu avg=%llu p50=%llu p99=%llu max=%llu us\n",
+           p_name, p_hist->count,
+           (unsigned long long) p_hist->min_us,
+           (unsigned long long) (p_hist->count ? (p_hist->sum_us / p_hist->count) : 0),
+           (unsigned long long) LatHist_Percentile(p_hist, 50),
+           (unsigned long long) LatHist_Percentile(p_hist, 99),
+           (unsigned long long) p_hist->max_us);
+
+    for (bucket = 0; bucket < LATHIST_BUCKETS; bucket++)
+    {
+        if (p_hist->buckets[bucket] == 0)
+        {
+            continue;
+        }
+        printf("%s:   [%8llu, %8llu%c us %u\n", p_name,
+               (unsigned long long) ((bucket == 0) ? 0 : (1ULL << (bucket - 1))),
+               (unsigned long long) ((bucket == 0) ? 1 : (1ULL << bucket)),
+               (bucket == (LATHIST_BUCKETS - 1)) ? ']' : ')',
+               p_hist->buckets[bucket]);
+    }
+}
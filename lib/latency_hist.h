@@ -0,0 +1,61 @@
+/*
+ * latency_hist.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>     // Fixed-width int type
+
+/* Bucket 0 holds 0us, bucket i (i >= 1) holds [2^(i-1), 2^i) us.
+ * The last bucket also holds everything above 2^(N-2) us (~1s). */
+#define LATHIST_BUCKETS 22
+
+typedef struct LatHist {
+    uint32_t buckets[LATHIST_BUCKETS];
+    uint32_t count;     // Samples recorded
+    uint64_t sum_us;    // Sum of all samples
+    uint64_t min_us;    // Smallest sample
+    uint64_t max_us;    // Largest sample
+} LatHist;
+
+/****************************************************************
+ * Function Name : LatHist_Init
+ * Description   : Clear a latency histogram
+ * Returns       : void
+ * Params        @p_hist: the histogram
+ ****************************************************************/
+extern void LatHist_Init (LatHist *p_hist);
+
+/****************************************************************
+ * Function Name : LatHist_Record
+ * Description   : Add one latency sample
+ * Returns       : void
+ * Params        @p_hist: the histogram
+ *               @latency_us: the sample in microseconds
+ ****************************************************************/
+extern void LatHist_Record (LatHist *p_hist, uint64_t latency_us);
+
+/****************************************************************
+ * Function Name : LatHist_Percentile
+ * Description   : Estimate a percentile from the buckets
+ * Returns       : upper bound (us) of the bucket holding the
+ *                 percentile, capped at the largest sample
+ * Params        @p_hist: the histogram
+ *               @percent: the percentile (0 - 100)
+ ****************************************************************/
+extern uint64_t LatHist_Percentile (const LatHist *p_hist, uint8_t percent);
+
+/****************************************************************
+ * Function Name : LatHist_Print
+ * Description   : Print a summary line and the non-empty buckets
+ * Returns       : void
+ * Params        @p_name: label printed in front of every line
+ *               @p_hist: the histogram
+ ****************************************************************/
+extern void LatHist_Print (const char *p_name, const LatHist *p_hist);
+
+#endif
@@ -0,0 +1,439 @@
+/*
+ * load_gen.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <stdlib.h>         // strtoul
+#include <string.h>         // String-handling library
+#include <pthread.h>        // Sources and device workers
+
+#include "i2c_bbb.h"
+#include "i2c_sched.h"
+#include "i2c_sim.h"
+#include "tea5767_i2c_driver.h"
+#include "fm_clock.h"
+#include "fm_band.h"
+#include "load_gen.h"       // Its header file
+
+#define PATH_SIZE         32
+
+typedef struct Source {
+    pthread_t thread;
+    uint32_t  index;
+    uint32_t  state;        // xorshift32 state, never 0
+    uint32_t  events;       // Commands fired, written by the source only
+    uint32_t  dropped;      // Ticks skipped after waking late
+} Source;
+
+typedef struct Device {
+    pthread_t thread;
+    CmdQueue  queue;
+    char      path[PATH_SIZE];
+    TEA5767_FM_module module;
+    uint16_t  channel;      // Band channel of the last tune
+    uint32_t  failures;     // Commands the driver failed
+} Device;
+
+static pthread_mutex_t load_mutex = PTHREAD_MUTEX_INITIALIZER;
+static LoadGen_Config config = { 4, 1, 100, { 60, 20, 20 }, 10, 1 };
+static LoadGen_Post post_zero;          // Posts to device 0
+static CmdQueue *p_queue_zero;          // Device 0's queue
+static Source sources[LOADGEN_MAX_SOURCES];
+static Device devices[LOADGEN_MAX_DEVICES];
+static uint8_t started = 0;
+static uint32_t running = 0;            // Sources still firing
+static uint64_t start_us = 0;
+static uint64_t end_us = 0;             // When the last source stopped
+static uint64_t start_cpu_us = 0;
+static uint64_t end_cpu_us = 0;
+
+/****************************************************************
+ * Function Name : nextRandom (private)
+ * Description   : Step a source's xorshift32 generator
+ * Returns       : the next number
+ * Params        @p_state: the generator state
+ ****************************************************************/
+static uint32_t nextRandom (uint32_t *p_state)
+{
+    uint32_t x = *p_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *p_state = x;
+    return x;
+}
+
+/****************************************************************
+ * Function Name : fire (private)
+ * Description   : Pick a command and a device and post it
+ * Returns       : void
+ * Params        @p_source: the source
+ ****************************************************************/
+static void fire (Source *p_source)
+{
+    uint32_t roll = nextRandom(&p_source->state) % 100;
+    uint32_t device = nextRandom(&p_source->state) % config.devices;
+    LoadGen_Command command = LOADGEN_POLL;
+
+    if (roll < config.mix[LOADGEN_TUNE])
+    {
+        command = LOADGEN_TUNE;
+    }
+    else if (roll < (uint32_t) (config.mix[LOADGEN_TUNE] + config.mix[LOADGEN_AUDIO]))
+    {
+        command = LOADGEN_AUDIO;
+    }
+
+    if (device == 0)
+    {
+        post_zero(command);
+    }
+    else
+    {
+        (void) CmdQueue_Post(&devices[device].queue, 1 << command);
+    }
+    p_source->events++;
+}
+
+/****************************************************************
+ * Function Name : sourceThread (private)
+ * Description   : Fire commands on absolute deadlines until the run
+ *                 time is over
+ * Returns       : NULL
+ * Params        @arg: the source
+ ****************************************************************/
+static void* sourceThread (void *arg)
+{
+    Source *p_source = (Source *) arg;
+    uint64_t period_us = (USEC_PER_SEC * config.sources) / config.rate;
+    uint64_t stop_us = start_us + (config.seconds * USEC_PER_SEC);
+    /* Spread the sources over one period so they do not fire together */
+    uint64_t next_us = start_us + ((period_us * p_source->index) / config.sources);
+    uint64_t now_us = 0;
+
+    FMClock_RegisterThread();
+    while (1)
+    {
+        FMClock_SleepUntilUs(next_us);
+        if (next_us >= stop_us)
+        {
+            break;
+        }
+        fire(p_source);
+
+        /* A tick a whole period in the past was missed, not delayed */
+        next_us += period_us;
+        now_us = FMClock_NowUs();
+        while ((next_us + period_us) <= now_us)
+        {
+            p_source->dropped++;
+            next_us += period_us;
+        }
+    }
+
+    (void) pthread_mutex_lock(&load_mutex);
+    if (--running == 0)
+    {
+        end_us = FMClock_NowUs();
+        end_cpu_us = FMClock_ProcessCpuUs();
+    }
+    (void) pthread_mutex_unlock(&load_mutex);
+    return NULL;
+}
+
+/****************************************************************
+ * Function Name : deviceThread (private)
+ * Description   : Serve the commands of one extra tuner, the way the
+ *                 FM thread serves device 0
+ * Returns       : NULL
+ * Params        @arg: the device
+ ****************************************************************/
+static void* deviceThread (void *arg)
+{
+    Device *p_device = (Device *) arg;
+    uint64_t posted_us[CMDQ_BITS];
+    uint64_t settle_us = 0;
+    TEA5767_Status status;
+    uint8_t pending = 0;
+
+    FMClock_RegisterThread();
+    while (1)
+    {
+        pending = CmdQueue_Take(&p_device->queue, posted_us);
+
+        p_device->module.bus_class = I2CSCHED_INTERACTIVE;
+        if (pending & (1 << LOADGEN_TUNE))
+        {
+            p_device->channel = ((p_device->channel + 1) < FMBand_Channels()) ? (p_device->channel + 1) : 0;
+            if ((TEA5767_TuneChannel(&p_device->module, p_device->channel) < 0)
+                || (TEA5767_WaitForLock(&p_device->module, LOCK_TIMEOUT, &settle_us) < 0))
+            {
+                p_device->failures++;
+            }
+        }
+        if (pending & (1 << LOADGEN_AUDIO))
+        {
+            if ((p_device->module.mute_state ? TEA5767_Unmute(&p_device->module)
+                                             : TEA5767_Mute(&p_device->module)) < 0)
+            {
+                p_device->failures++;
+            }
+        }
+        p_device->module.bus_class = I2CSCHED_PERIODIC;
+        if ((pending & (1 << LOADGEN_POLL)) && (TEA5767_ReadStatus(&p_device->module, &status) < 0))
+        {
+            p_device->failures++;
+        }
+
+        CmdQueue_Done(&p_device->queue, pending, posted_us);
+    }
+    return NULL;
+}
+
+/****************************************************************
+ * Function Name : LoadGen_Parse
+ * Description   : Read a load spec, e.g.
+ *                 "sources=8,devices=2,rate=500,mix=60/20/20,seconds=10".
+ *                 Keys left out keep their defaults.
+ * Returns       : 0 on success, -1 on a bad spec
+ * Params        @p_spec: the spec
+ *               @p_config: to store the configuration
+ ****************************************************************/
+extern int LoadGen_Parse (const char *p_spec, LoadGen_Config *p_config)
+{
+    char spec[LOADGEN_SPEC_SIZE];
+    char *p_save = NULL;
+    char *p_key = NULL;
+    char *p_value = NULL;
+    unsigned int mix[LOADGEN_COMMANDS];
+
+    *p_config = config;
+    if (strlen(p_spec) >= sizeof(spec))
+    {
+        printf("ERROR: LoadGen - Spec longer than %u characters\n", LOADGEN_SPEC_SIZE - 1);
+        return -1;
+    }
+    (void) strcpy(spec, p_spec);
+
+    for (p_key = strtok_r(spec, ",", &p_save); p_key != NULL; p_key = strtok_r(NULL, ",", &p_save))
+    {
+        p_value = strchr(p_key, '=');
+        if (p_value == NULL)
+        {
+            printf("ERROR: LoadGen - Expected KEY=VALUE, got %s\n", p_key);
+            return -1;
+        }
+        *p_value++ = '\0';
+        if (strcmp(p_key, "sources") == 0)
+        {
+            p_config->sources = (uint32_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_key, "devices") == 0)
+        {
+            p_config->devices = (uint32_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_key, "rate") == 0)
+        {
+            p_config->rate = (uint32_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_key, "seconds") == 0)
+        {
+            p_config->seconds = (uint32_t) strtoul(p_value, NULL, 10);
+        }
+        else if (strcmp(p_key, "seed") == 0)
+        {
+            p_config->seed = (uint32_t) strtoul(p_value, NULL, 10);
+        }
+        else if ((strcmp(p_key, "mix") == 0)
+                 && (sscanf(p_value, "%u/%u/%u", &mix[LOADGEN_TUNE], &mix[LOADGEN_AUDIO], &mix[LOADGEN_POLL]) == 3)
+                 && ((mix[LOADGEN_TUNE] + mix[LOADGEN_AUDIO] + mix[LOADGEN_POLL]) == 100))
+        {
+            p_config->mix[LOADGEN_TUNE] = (uint8_t) mix[LOADGEN_TUNE];
+            p_config->mix[LOADGEN_AUDIO] = (uint8_t) mix[LOADGEN_AUDIO];
+            p_config->mix[LOADGEN_POLL] = (uint8_t) mix[LOADGEN_POLL];
+        }
+        else
+        {
+            printf("ERROR: LoadGen - Bad %s=%s (mix is TUNE/AUDIO/POLL percent summing to 100)\n", p_key, p_value);
+            return -1;
+        }
+    }
+
+    if ((p_config->sources == 0) || (p_config->sources > LOADGEN_MAX_SOURCES)
+        || (p_config->devices == 0) || (p_config->devices > LOADGEN_MAX_DEVICES)
+        || (p_config->rate == 0) || (p_config->rate > (USEC_PER_SEC * p_config->sources))
+        || (p_config->seconds == 0))
+    {
+        printf("ERROR: LoadGen - Needs 1-%u sources, 1-%u devices, a rate of 1 to 1M per source and seconds > 0\n",
+               LOADGEN_MAX_SOURCES, LOADGEN_MAX_DEVICES);
+        return -1;
+    }
+    if (p_config->seed == 0)
+    {
+        p_config->seed = 1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : LoadGen_Start
+ * Description   : Bring up the extra devices and start the sources
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_config: the configuration
+ *               @post: posts a command to device 0
+ *               @p_queue: device 0's queue, for the report
+ ****************************************************************/
+extern int LoadGen_Start (const LoadGen_Config *p_config, LoadGen_Post post, CmdQueue *p_queue)
+{
+    Device *p_device;
+    uint32_t index = 0;
+
+    config = *p_config;
+    post_zero = post;
+    p_queue_zero = p_queue;
+
+    /* Device 0 is the caller's; the others get a tuner of their own */
+    for (index = 1; index < config.devices; index++)
+    {
+        p_device = &devices[index];
+        CmdQueue_Init(&p_device->queue);
+        (void) snprintf(p_device->path, sizeof(p_device->path), LOADGEN_BUS_PATH, index);
+        p_device->module.p_bus = I2CSched_Open(p_device->path);
+        if (p_device->module.p_bus == NULL)
+        {
+            perror("ERROR: LoadGen - Failed to open a device bus");
+            return -1;
+        }
+        p_device->module.device_addr = I2CSIM_TEA5767_ADDR;
+        p_device->module.auto_injection = 0;
+        p_device->module.bus_class = I2CSCHED_INTERACTIVE;
+        p_device->channel = 0;
+        if (TEA5767_Init(&p_device->module, p_device->channel, 0) < 0)
+        {
+            perror("ERROR: LoadGen - Failed to init a device");
+            return -1;
+        }
+        FMClock_AddThreads(1);
+        if (pthread_create(&p_device->thread, NULL, deviceThread, p_device) != 0)
+        {
+            FMClock_AddThreads(-1);
+            perror("ERROR: LoadGen - Failed to start a device");
+            return -1;
+        }
+    }
+
+    (void) pthread_mutex_lock(&load_mutex);
+    start_us = FMClock_NowUs();
+    start_cpu_us = FMClock_ProcessCpuUs();
+    running = config.sources;
+    started = 1;
+    (void) pthread_mutex_unlock(&load_mutex);
+
+    for (index = 0; index < config.sources; index++)
+    {
+        sources[index].index = index;
+        sources[index].state = config.seed + (index * 0x9E3779B9U);
+        sources[index].state = (sources[index].state != 0) ? sources[index].state : 1;
+        FMClock_AddThreads(1);
+        if (pthread_create(&sources[index].thread, NULL, sourceThread, &sources[index]) != 0)
+        {
+            FMClock_AddThreads(-1);
+            perror("ERROR: LoadGen - Failed to start a source");
+            (void) pthread_mutex_lock(&load_mutex);
+            running -= config.sources - index;
+            (void) pthread_mutex_unlock(&load_mutex);
+            return -1;
+        }
+    }
+    printf("INFO: LoadGen - %u sources at %u events/s on %u devices for %u s\n",
+           config.sources, config.rate, config.devices, config.seconds);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : LoadGen_Done
+ * Description   : Check whether every source has stopped and the
+ *                 extra devices have nothing pending
+ * Returns       : 1 if done, 0 otherwise or if not started
+ * Params        : N/A
+ ****************************************************************/
+extern uint8_t LoadGen_Done (void)
+{
+    uint8_t done = 0;
+    uint32_t index = 0;
+
+    (void) pthread_mutex_lock(&load_mutex);
+    done = started && (running == 0);
+    (void) pthread_mutex_unlock(&load_mutex);
+    for (index = 1; done && (index < config.devices); index++)
+    {
+        done = (CmdQueue_Pending(&devices[index].queue) == 0);
+    }
+    return done;
+}
+
+/****************************************************************
+ * Function Name : LoadGen_Print
+ * Description   : Print the offered and achieved rate, the drops,
+ *                 the CPU per event and, per device, the commands
+ *                 served and their tail latency
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void LoadGen_Print (void)
+{
+    CmdQueue_Stats stats;
+    uint64_t elapsed_us = 0;
+    uint64_t cpu_us = 0;
+    uint32_t events = 0;
+    uint32_t dropped = 0;
+    uint32_t failures = 0;
+    uint32_t index = 0;
+
+    (void) pthread_mutex_lock(&load_mutex);
+    if (!started)
+    {
+        (void) pthread_mutex_unlock(&load_mutex);
+        return;
+    }
+    /* Mid-run the counts are a snapshot of a moving target */
+    elapsed_us = ((running == 0) ? end_us : FMClock_NowUs()) - start_us;
+    cpu_us = ((running == 0) ? end_cpu_us : FMClock_ProcessCpuUs()) - start_cpu_us;
+    (void) pthread_mutex_unlock(&load_mutex);
+    for (index = 0; index < config.sources; index++)
+    {
+        events += sources[index].events;
+        dropped += sources[index].dropped;
+    }
+
+    printf("Load: %u sources, %u devices, %u events/s offered, mix %u/%u/%u tune/audio/poll, %u s\n",
+           config.sources, config.devices, config.rate,
+           config.mix[LOADGEN_TUNE], config.mix[LOADGEN_AUDIO], config.mix[LOADGEN_POLL], config.seconds);
+    printf("Load: %u events in %llu ms (%llu.%llu events/s), %u dropped by late sources\n",
+           events, (unsigned long long) (elapsed_us / 1000),
+           (unsigned long long) (elapsed_us ? ((events * USEC_PER_SEC) / elapsed_us) : 0),
+           (unsigned long long) (elapsed_us ? (((events * USEC_PER_SEC * 10) / elapsed_us) % 10) : 0),
+           dropped);
+    printf("Load: %llu ms CPU, %llu us CPU per event\n",
+           (unsigned long long) (cpu_us / 1000), (unsigned long long) (events ? (cpu_us / events) : 0));
+
+    for (index = 0; index < config.devices; index++)
+    {
+        CmdQueue_GetStats((index == 0) ? p_queue_zero : &devices[index].queue, &stats);
+        failures = (index == 0) ? 0 : devices[index].failures;
+        printf("Load device %u: %u posted, %u coalesced (%u%%), %u served (%llu/s), %u failed;"
+               " wait p99 %llu us; done p50 %llu us, p99 %llu us, max %llu us\n",
+               index, stats.posts, stats.coalesced, stats.posts ? ((stats.coalesced * 100) / stats.posts) : 0,
+               stats.served, (unsigned long long) (elapsed_us ? ((stats.served * USEC_PER_SEC) / elapsed_us) : 0),
+               failures,
+               (unsigned long long) LatHist_Percentile(&stats.wait_hist, 99),
+               (unsigned long long) LatHist_Percentile(&stats.done_hist, 50),
+               (unsigned long long) LatHist_Percentile(&stats.done_hist, 99),
+               (unsigned long long) stats.done_hist.max_us);
+    }
+}
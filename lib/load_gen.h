@@ -0,0 +1,90 @@
+/*
+ * load_gen.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef LOAD_GEN_H
+#define LOAD_GEN_H
+
+#include <stdint.h>     // Fixed-width int type
+
+#include "cmd_queue.h"
+
+/* Synthetic control-plane load for the simulator build. M sources
+ * stand in for buttons and API clients: each fires commands at a fixed
+ * rate on absolute deadlines, picking the command from a tune/audio/poll
+ * mix and the device at random. Device 0 is the receiver's own FM
+ * thread (commands go through the caller's post function); devices
+ * 1..N-1 are extra simulated TEA5767s, each on its own simulated bus
+ * and served by its own worker through a CmdQueue, like the FM thread.
+ *
+ * A source that wakes a whole period late skips the ticks it missed
+ * and counts them as dropped, so the offered rate stays open-loop. */
+
+#define LOADGEN_MAX_SOURCES 32
+#define LOADGEN_MAX_DEVICES 8
+#define LOADGEN_BUS_PATH    "/dev/i2c-load-%u"  // Simulated bus of device N
+#define LOADGEN_SPEC_SIZE   128                 // Longest -L spec
+
+typedef enum LoadGen_Command {
+    LOADGEN_TUNE = 0,       // Step to the next channel and wait for lock
+    LOADGEN_AUDIO,          // Toggle mute
+    LOADGEN_POLL,           // Read the status
+    LOADGEN_COMMANDS
+} LoadGen_Command;
+
+typedef struct LoadGen_Config {
+    uint32_t sources;                   // Concurrent sources (M)
+    uint32_t devices;                   // Tuners, device 0 included (N)
+    uint32_t rate;                      // Events per second, all sources together
+    uint8_t  mix[LOADGEN_COMMANDS];     // Percent of each command, sums to 100
+    uint32_t seconds;                   // Run time
+    uint32_t seed;                      // Seed of the sources' generators
+} LoadGen_Config;
+
+/* Posts a command to device 0, the receiver's FM thread */
+typedef void (*LoadGen_Post)(LoadGen_Command command);
+
+/****************************************************************
+ * Function Name : LoadGen_Parse
+ * Description   : Read a load spec, e.g.
+ *                 "sources=8,devices=2,rate=500,mix=60/20/20,seconds=10".
+ *                 Keys left out keep their defaults.
+ * Returns       : 0 on success, -1 on a bad spec
+ * Params        @p_spec: the spec
+ *               @p_config: to store the configuration
+ ****************************************************************/
+extern int LoadGen_Parse (const char *p_spec, LoadGen_Config *p_config);
+
+/****************************************************************
+ * Function Name : LoadGen_Start
+ * Description   : Bring up the extra devices and start the sources
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_config: the configuration
+ *               @post: posts a command to device 0
+ *               @p_queue: device 0's queue, for the report
+ ****************************************************************/
+extern int LoadGen_Start (const LoadGen_Config *p_config, LoadGen_Post post, CmdQueue *p_queue);
+
+/****************************************************************
+ * Function Name : LoadGen_Done
+ * Description   : Check whether every source has stopped and the
+ *                 extra devices have nothing pending
+ * Returns       : 1 if done, 0 otherwise or if not started
+ * Params        : N/A
+ ****************************************************************/
+extern uint8_t LoadGen_Done (void);
+
+/****************************************************************
+ * Function Name : LoadGen_Print
+ * Description   : Print the offered and achieved rate, the drops,
+ *                 the CPU per event and, per device, the commands
+ *                 served and their tail latency
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void LoadGen_Print (void);
+
+#endif
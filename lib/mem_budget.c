@@ -0,0 +1,271 @@
+/*
+ * mem_budget.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>          // Standard I/O
+#include <stdint.h>         // Fixed-width int type
+#include <stdlib.h>         // strtoul
+#include <string.h>         // String-handling library
+#include <unistd.h>         // POSIX API
+#include <fcntl.h>          // File controls
+#include <malloc.h>         // mallopt, mallinfo
+#include <pthread.h>        // Thread attributes
+#include <sys/mman.h>       // mmap, mprotect, mlockall
+
+#include "mem_budget.h"     // Its header file
+
+#define STATUS_SIZE     2048    // /proc/self/status is about 1.5 KB
+#define STDOUT_SIZE     4096    // Static stdout buffer
+#define WARN_PERCENT    75      // High-water mark worth flagging
+
+typedef struct Stack {
+    char     name[MEMBUDGET_NAME_SIZE]; // Thread name, "" until registered
+    uint8_t  *p_low;                    // Lowest usable byte (above the guard)
+    size_t   size;                      // Usable bytes
+} Stack;
+
+static pthread_mutex_t mem_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Stack stacks[MEMBUDGET_MAX_THREADS];
+static uint32_t stack_count = 0;
+
+#ifdef FM_STATIC_MEMORY
+static uint8_t stack_pool[MEMBUDGET_STACK_POOL_KB * 1024] __attribute__((aligned(MEMBUDGET_PAGE_SIZE)));
+static size_t pool_used = 0;
+static char stdout_buffer[STDOUT_SIZE];
+#endif
+
+/****************************************************************
+ * Function Name : stackRegion (private)
+ * Description   : Get a stack region with a guard page below it,
+ *                 from the static pool or from fresh anonymous memory
+ * Returns       : the region (guard page first), NULL on failure
+ * Params        @length: guard plus stack bytes, page aligned
+ ****************************************************************/
+static uint8_t* stackRegion (size_t length)
+{
+    uint8_t *p_region;
+
+#ifdef FM_STATIC_MEMORY
+    if ((pool_used + length) > sizeof(stack_pool))
+    {
+        printf("ERROR: MemBudget - Stack pool exhausted, raise MEMBUDGET_STACK_POOL_KB\n");
+        return NULL;
+    }
+    p_region = stack_pool + pool_used;
+    pool_used += length;
+#else
+    p_region = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (p_region == MAP_FAILED)
+    {
+        perror("ERROR: MemBudget - Failed to map a stack");
+        return NULL;
+    }
+#endif
+
+    /* An overflow faults on the guard instead of corrupting memory */
+    if (mprotect(p_region, MEMBUDGET_PAGE_SIZE, PROT_NONE) < 0)
+    {
+        perror("ERROR: MemBudget - Failed to protect the stack guard");
+    }
+    return p_region;
+}
+
+/****************************************************************
+ * Function Name : readStatus (private)
+ * Description   : Get one "Vm..." line of /proc/self/status. Read
+ *                 without stdio so the report itself does not
+ *                 allocate.
+ * Returns       : the value in KB, 0 if unknown
+ * Params        @p_status: the status text
+ *               @p_key: the key, e.g. "VmHWM:"
+ ****************************************************************/
+static unsigned long readStatus (const char *p_status, const char *p_key)
+{
+    const char *p_line = strstr(p_status, p_key);
+
+    if (p_line == NULL)
+    {
+        return 0;
+    }
+    return strtoul(p_line + strlen(p_key), NULL, 10);
+}
+
+/****************************************************************
+ * Function Name : MemBudget_Init
+ * Description   : Set up the memory mode: with FM_STATIC_MEMORY,
+ *                 give stdout a static buffer and lock all memory.
+ *                 Call first thing in main.
+ * Returns       : 0 on success, -1 if the memory could not be locked
+ * Params        : N/A
+ ****************************************************************/
+extern int MemBudget_Init (void)
+{
+    /* A thread's first malloc would otherwise reserve an arena of its
+     * own (64 MB of address space on 64-bit) */
+    (void) mallopt(M_ARENA_MAX, 1);
+
+#ifdef FM_STATIC_MEMORY
+    (void) setvbuf(stdout, stdout_buffer, _IOLBF, sizeof(stdout_buffer));
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+        perror("WARNING: MemBudget - Failed to lock memory, pages may fault in at run time");
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : MemBudget_SetStack
+ * Description   : Give threads created with the attribute a stack of
+ *                 the given size with a guard page below it
+ * Returns       : 0 on success, -1 on failure (the pool is exhausted
+ *                 or the size is refused)
+ * Params        @p_attr: the thread attribute
+ *               @size: usable stack size in bytes
+ ****************************************************************/
+extern int MemBudget_SetStack (pthread_attr_t *p_attr, size_t size)
+{
+    uint8_t *p_region;
+    Stack *p_stack;
+
+    size = (size + MEMBUDGET_PAGE_SIZE - 1) & ~((size_t) MEMBUDGET_PAGE_SIZE - 1);
+    if (size < PTHREAD_STACK_MIN)
+    {
+        size = PTHREAD_STACK_MIN;
+    }
+
+    (void) pthread_mutex_lock(&mem_mutex);
+    if (stack_count >= MEMBUDGET_MAX_THREADS)
+    {
+        (void) pthread_mutex_unlock(&mem_mutex);
+        return -1;
+    }
+    p_region = stackRegion(MEMBUDGET_PAGE_SIZE + size);
+    if (p_region == NULL)
+    {
+        (void) pthread_mutex_unlock(&mem_mutex);
+        return -1;
+    }
+    p_stack = &stacks[stack_count++];
+    p_stack->p_low = p_region + MEMBUDGET_PAGE_SIZE;
+    p_stack->size = size;
+    (void) pthread_mutex_unlock(&mem_mutex);
+
+    /* The stack is ours, so glibc adds no guard of its own */
+    return (pthread_attr_setstack(p_attr, p_stack->p_low, size) == 0) ? 0 : -1;
+}
+
+/****************************************************************
+ * Function Name : MemBudget_RegisterThread
+ * Description   : Record the calling thread's stack and paint the
+ *                 part it has not used yet
+ * Returns       : 0 on success, -1 if no slot is left
+ * Params        @p_name: thread name shown in the report
+ ****************************************************************/
+extern int MemBudget_RegisterThread (const char *p_name)
+{
+    /* The frame of this call is about the stack pointer */
+    uintptr_t sp = (uintptr_t) __builtin_frame_address(0);
+    uintptr_t low = 0;
+    Stack *p_stack = NULL;
+    uint32_t index = 0;
+
+    /* The stack given by MemBudget_SetStack is the one holding the frame */
+    (void) pthread_mutex_lock(&mem_mutex);
+    for (index = 0; index < stack_count; index++)
+    {
+        low = (uintptr_t) stacks[index].p_low;
+        if ((sp >= low) && (sp < (low + stacks[index].size)))
+        {
+            p_stack = &stacks[index];
+            (void) strncpy(p_stack->name, p_name, MEMBUDGET_NAME_SIZE - 1);
+            break;
+        }
+    }
+    (void) pthread_mutex_unlock(&mem_mutex);
+    if (p_stack == NULL)
+    {
+        return -1;
+    }
+
+    /* Stack grows down: everything below the caller is still unused */
+    if ((sp - low) > MEMBUDGET_PAINT_MARGIN)
+    {
+        (void) memset(p_stack->p_low, MEMBUDGET_PAINT, (sp - MEMBUDGET_PAINT_MARGIN) - low);
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : MemBudget_Print
+ * Description   : Print the stack size and high-water mark of every
+ *                 registered thread, then the process memory (peak
+ *                 and current VSZ and RSS, heap in use)
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void MemBudget_Print (void)
+{
+    static char status[STATUS_SIZE];
+    size_t total = 0;
+    size_t used = 0;
+    ssize_t length = 0;
+    uint32_t index = 0;
+    uint32_t listed = 0;
+    int fd = 0;
+
+    (void) pthread_mutex_lock(&mem_mutex);
+    for (index = 0; index < stack_count; index++)
+    {
+        if (stacks[index].name[0] == '\0')
+        {
+            continue;
+        }
+        /* The deepest call left the first unpainted byte behind */
+        used = 0;
+        while ((used < stacks[index].size) && (stacks[index].p_low[used] == MEMBUDGET_PAINT))
+        {
+            used++;
+        }
+        used = stacks[index].size - used;
+        total += stacks[index].size;
+        listed++;
+        printf("Stack %-12s %4zu KB, high-water %4zu KB (%zu%%)%s\n", stacks[index].name,
+               stacks[index].size / 1024, (used + 1023) / 1024, (used * 100) / stacks[index].size,
+               (((used * 100) / stacks[index].size) >= WARN_PERCENT) ? ", raise it" : "");
+    }
+    (void) pthread_mutex_unlock(&mem_mutex);
+    printf("Stacks: %zu KB for %u threads, each with a %u KB guard\n",
+           total / 1024, listed, MEMBUDGET_PAGE_SIZE / 1024);
+
+    fd = open("/proc/self/status", O_RDONLY);
+    if (fd >= 0)
+    {
+        length = read(fd, status, sizeof(status) - 1);
+        (void) close(fd);
+    }
+    if (length > 0)
+    {
+        status[length] = '\0';
+        printf("Memory: VSZ %lu KB (peak %lu KB), RSS %lu KB (peak %lu KB), locked %lu KB\n",
+               readStatus(status, "VmSize:"), readStatus(status, "VmPeak:"),
+               readStatus(status, "VmRSS:"), readStatus(status, "VmHWM:"),
+               readStatus(status, "VmLck:"));
+    }
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    {
+        struct mallinfo2 heap = mallinfo2();
+        printf("Heap: %zu bytes in use, %zu KB from the system\n", heap.uordblks, heap.arena / 1024);
+    }
+#elif defined(__GLIBC__)
+    {
+        struct mallinfo heap = mallinfo();
+        printf("Heap: %d bytes in use, %d KB from the system\n", heap.uordblks, heap.arena / 1024);
+    }
+#endif
+}
@@ -0,0 +1,74 @@
+/*
+ * mem_budget.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef MEM_BUDGET_H
+#define MEM_BUDGET_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <stddef.h>     // size_t
+#include <pthread.h>    // Thread attributes
+
+/* Every task gets an explicit stack size and a guard page instead of
+ * the 8 MB default. Each thread paints its unused stack at start up
+ * so the stats dump can report how deep it has ever gone.
+ *
+ * Built with -DFM_STATIC_MEMORY, the stacks are carved out of one
+ * static pool sized at compile time (MEMBUDGET_STACK_POOL_KB), stdout
+ * gets a static buffer, and all memory is locked, so nothing is
+ * allocated or paged in once the tasks are running. */
+
+#define MEMBUDGET_PAGE_SIZE     4096    // Guard and alignment unit
+#define MEMBUDGET_MAX_THREADS   16      // Threads that can be registered
+#define MEMBUDGET_NAME_SIZE     16
+#define MEMBUDGET_PAINT         0xA5    // Pattern of never used stack
+#define MEMBUDGET_PAINT_MARGIN  4096    // Bytes left below the caller unpainted
+
+#ifndef MEMBUDGET_STACK_POOL_KB
+#define MEMBUDGET_STACK_POOL_KB 512     // Static stacks + guards, FM_STATIC_MEMORY only
+#endif
+
+/****************************************************************
+ * Function Name : MemBudget_Init
+ * Description   : Set up the memory mode: with FM_STATIC_MEMORY,
+ *                 give stdout a static buffer and lock all memory.
+ *                 Call first thing in main.
+ * Returns       : 0 on success, -1 if the memory could not be locked
+ * Params        : N/A
+ ****************************************************************/
+extern int MemBudget_Init (void);
+
+/****************************************************************
+ * Function Name : MemBudget_SetStack
+ * Description   : Give threads created with the attribute a stack of
+ *                 the given size with a guard page below it
+ * Returns       : 0 on success, -1 on failure (the pool is exhausted
+ *                 or the size is refused)
+ * Params        @p_attr: the thread attribute
+ *               @size: usable stack size in bytes
+ ****************************************************************/
+extern int MemBudget_SetStack (pthread_attr_t *p_attr, size_t size);
+
+/****************************************************************
+ * Function Name : MemBudget_RegisterThread
+ * Description   : Record the calling thread's stack and paint the
+ *                 part it has not used yet
+ * Returns       : 0 on success, -1 if no slot is left
+ * Params        @p_name: thread name shown in the report
+ ****************************************************************/
+extern int MemBudget_RegisterThread (const char *p_name);
+
+/****************************************************************
+ * Function Name : MemBudget_Print
+ * Description   : Print the stack size and high-water mark of every
+ *                 registered thread, then the process memory (peak
+ *                 and current VSZ and RSS, heap in use)
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void MemBudget_Print (void);
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * rt_sched.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#define _GNU_SOURCE                 // CPU_SET, affinity, sched_getcpu
+
+#include <stdio.h>          // snprintf
+#include <stdint.h>         // Fixed-width int type
+#include <stdlib.h>         // strtoul
+#include <string.h>         // String-handling library
+#include <unistd.h>         // syscall
+#include <sched.h>          // Policies
+#include <pthread.h>        // Per-thread parameters
+#include <errno.h>          // Error codes
+#include <sys/syscall.h>    // SYS_sched_setattr
+
+#include "fm_clock.h"
+#include "rt_sched.h"       // Its header file
+
+/* Layout of the kernel's struct sched_attr (SCHED_ATTR_SIZE_VER0);
+ * declared here since older libc headers do not have it */
+typedef struct RTSched_Attr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t  sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;     // ns
+    uint64_t sched_deadline;    // ns
+    uint64_t sched_period;      // ns
+} RTSched_Attr;
+
+/****************************************************************
+ * Function Name : RTSched_SetDeadline
+ * Description   : Move the calling thread to SCHED_DEADLINE with
+ *                 the given reservation
+ * Returns       : 0 on success, -1 on failure (errno is set: EPERM
+ *                 without privileges, EBUSY when admission control
+ *                 refuses, ENOSYS/EINVAL on kernels without it)
+ * Params        @runtime_us: CPU time reserved per period
+ *               @deadline_us: relative deadline of each job
+ *               @period_us: reservation period
+ ****************************************************************/
+extern int RTSched_SetDeadline (uint32_t runtime_us, uint32_t deadline_us, uint32_t period_us)
+{
+#ifdef SYS_sched_setattr
+    RTSched_Attr attr;
+
+    (void) memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_runtime = runtime_us * NSEC_PER_USEC;
+    attr.sched_deadline = deadline_us * NSEC_PER_USEC;
+    attr.sched_period = period_us * NSEC_PER_USEC;
+
+    /* pid 0 is the calling thread */
+    return (syscall(SYS_sched_setattr, 0, &attr, 0) == 0) ? 0 : -1;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/****************************************************************
+ * Function Name : RTSched_SetFifo
+ * Description   : Move the calling thread to SCHED_FIFO
+ * Returns       : 0 on success, -1 on failure
+ * Params        @priority: the FIFO priority
+ ****************************************************************/
+extern int RTSched_SetFifo (int priority)
+{
+    struct sched_param param;
+
+    (void) memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    return (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) ? 0 : -1;
+}
+
+/****************************************************************
+ * Function Name : RTSched_GetPolicy
+ * Description   : Get the policy of the calling thread
+ * Returns       : the policy
+ * Params        : N/A
+ ****************************************************************/
+extern RTSched_Policy RTSched_GetPolicy (void)
+{
+    /* sched_getscheduler(0) reports the calling thread on Linux */
+    switch (sched_getscheduler(0))
+    {
+    case SCHED_FIFO:
+    case SCHED_RR:
+        return RTSCHED_FIFO;
+    case SCHED_DEADLINE:
+        return RTSCHED_DEADLINE;
+    default:
+        return RTSCHED_OTHER;
+    }
+}
+
+/****************************************************************
+ * Function Name : RTSched_PolicyName
+ * Description   : Name of a policy for the stats dump
+ * Returns       : the name
+ * Params        @policy: the policy
+ ****************************************************************/
+extern const char* RTSched_PolicyName (RTSched_Policy policy)
+{
+    switch (policy)
+    {
+    case RTSCHED_FIFO:
+        return "FIFO";
+    case RTSCHED_DEADLINE:
+        return "DEADLINE";
+    default:
+        return "OTHER";
+    }
+}
+
+/****************************************************************
+ * Function Name : RTSched_OnlineMask
+ * Description   : Get the mask of the online CPUs
+ * Returns       : the mask, bit n = CPU n
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t RTSched_OnlineMask (void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (cpus <= 0)
+    {
+        return 1;
+    }
+    if (cpus >= RTSCHED_MAX_CPUS)
+    {
+        return ~0ULL;
+    }
+    return (1ULL << cpus) - 1;
+}
+
+/****************************************************************
+ * Function Name : RTSched_ParseCpuList
+ * Description   : Parse a CPU list such as "3", "0-2" or "0,2-3"
+ * Returns       : 0 on success, -1 on a malformed list or a CPU
+ *                 that is not online
+ * Params        @p_list: the list
+ *               @p_mask: to store the CPUs, bit n = CPU n
+ ****************************************************************/
+extern int RTSched_ParseCpuList (const char *p_list, uint64_t *p_mask)
+{
+    uint64_t mask = 0;
+    unsigned long first = 0;
+    unsigned long last = 0;
+    char *p_end = NULL;
+
+    while (*p_list != '\0')
+    {
+        first = strtoul(p_list, &p_end, 10);
+        if (p_end == p_list)
+        {
+            return -1;
+        }
+        last = first;
+        if (*p_end == '-')
+        {
+            p_list = p_end + 1;
+            last = strtoul(p_list, &p_end, 10);
+            if ((p_end == p_list) || (last < first))
+            {
+                return -1;
+            }
+        }
+        if (last >= RTSCHED_MAX_CPUS)
+        {
+            return -1;
+        }
+        for (; first <= last; first++)
+        {
+            mask |= 1ULL << first;
+        }
+        if (*p_end == ',')
+        {
+            p_end++;
+        }
+        else if (*p_end != '\0')
+        {
+            return -1;
+        }
+        p_list = p_end;
+    }
+
+    if ((mask == 0) || (mask & ~RTSched_OnlineMask()))
+    {
+        return -1;
+    }
+    *p_mask = mask;
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : RTSched_FormatCpuList
+ * Description   : Format a CPU mask as a list, e.g. "0,2-3"
+ * Returns       : void
+ * Params        @mask: the CPUs, bit n = CPU n
+ *               @p_list: to store the list
+ *               @size: size of p_list
+ ****************************************************************/
+extern void RTSched_FormatCpuList (uint64_t mask, char *p_list, size_t size)
+{
+    uint8_t cpu = 0;
+    uint8_t last = 0;
+    size_t used = 0;
+
+    p_list[0] = '\0';
+    while ((cpu < RTSCHED_MAX_CPUS) && (used < size))
+    {
+        if (!(mask & (1ULL << cpu)))
+        {
+            cpu++;
+            continue;
+        }
+        /* Collapse a run of CPUs into "first-last" */
+        last = cpu;
+        while (((last + 1) < RTSCHED_MAX_CPUS) && (mask & (1ULL << (last + 1))))
+        {
+            last++;
+        }
+        used += snprintf(p_list + used, size - used, (last > cpu) ? "%s%u-%u" : "%s%u",
+                         (used > 0) ? "," : "", cpu, last);
+        cpu = last + 1;
+    }
+}
+
+/****************************************************************
+ * Function Name : RTSched_SetAttrAffinity
+ * Description   : Pin threads created with the attribute to a set
+ *                 of CPUs
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_attr: the thread attribute
+ *               @mask: the CPUs, bit n = CPU n
+ ****************************************************************/
+extern int RTSched_SetAttrAffinity (pthread_attr_t *p_attr, uint64_t mask)
+{
+    cpu_set_t cpus;
+    uint8_t cpu = 0;
+
+    CPU_ZERO(&cpus);
+    for (cpu = 0; cpu < RTSCHED_MAX_CPUS; cpu++)
+    {
+        if (mask & (1ULL << cpu))
+        {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    return (pthread_attr_setaffinity_np(p_attr, sizeof(cpus), &cpus) == 0) ? 0 : -1;
+}
+
+/****************************************************************
+ * Function Name : RTSched_GetAffinity
+ * Description   : Get the CPUs a thread may run on
+ * Returns       : the mask, bit n = CPU n (0 on failure)
+ * Params        @thread: the thread
+ ****************************************************************/
+extern uint64_t RTSched_GetAffinity (pthread_t thread)
+{
+    cpu_set_t cpus;
+    uint64_t mask = 0;
+    uint8_t cpu = 0;
+
+    if (pthread_getaffinity_np(thread, sizeof(cpus), &cpus) != 0)
+    {
+        return 0;
+    }
+    for (cpu = 0; cpu < RTSCHED_MAX_CPUS; cpu++)
+    {
+        if (CPU_ISSET(cpu, &cpus))
+        {
+            mask |= 1ULL << cpu;
+        }
+    }
+    return mask;
+}
+
+/****************************************************************
+ * Function Name : RTSched_CurrentCpu
+ * Description   : Get the CPU the calling thread runs on
+ * Returns       : the CPU, -1 on failure
+ * Params        : N/A
+ ****************************************************************/
+extern int RTSched_CurrentCpu (void)
+{
+    return sched_getcpu();
+}
@@ -0,0 +1,123 @@
+/*
+ * rt_sched.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef RT_SCHED_H
+#define RT_SCHED_H
+
+#include <stdint.h>     // Fixed-width int type
+#include <stddef.h>     // size_t
+#include <pthread.h>    // Thread attributes
+
+/* Scheduling policy of the calling thread. SCHED_DEADLINE goes through
+ * the raw sched_setattr syscall, which libc does not wrap. */
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE          6
+#endif
+
+#define RTSCHED_MIN_RUNTIME_US  100     // Smallest reservation worth asking for
+#define RTSCHED_MAX_CPUS        64      // CPUs a placement mask can name
+#define RTSCHED_CPU_LIST_SIZE   64      // Longest formatted CPU list
+
+typedef enum RTSched_Policy {
+    RTSCHED_OTHER = 0,  // Time sharing
+    RTSCHED_FIFO,       // Fixed priority
+    RTSCHED_DEADLINE    // Constant bandwidth reservation
+} RTSched_Policy;
+
+/****************************************************************
+ * Function Name : RTSched_SetDeadline
+ * Description   : Move the calling thread to SCHED_DEADLINE with
+ *                 the given reservation
+ * Returns       : 0 on success, -1 on failure (errno is set: EPERM
+ *                 without privileges, EBUSY when admission control
+ *                 refuses, ENOSYS/EINVAL on kernels without it)
+ * Params        @runtime_us: CPU time reserved per period
+ *               @deadline_us: relative deadline of each job
+ *               @period_us: reservation period
+ ****************************************************************/
+extern int RTSched_SetDeadline (uint32_t runtime_us, uint32_t deadline_us, uint32_t period_us);
+
+/****************************************************************
+ * Function Name : RTSched_SetFifo
+ * Description   : Move the calling thread to SCHED_FIFO
+ * Returns       : 0 on success, -1 on failure
+ * Params        @priority: the FIFO priority
+ ****************************************************************/
+extern int RTSched_SetFifo (int priority);
+
+/****************************************************************
+ * Function Name : RTSched_GetPolicy
+ * Description   : Get the policy of the calling thread
+ * Returns       : the policy
+ * Params        : N/A
+ ****************************************************************/
+extern RTSched_Policy RTSched_GetPolicy (void);
+
+/****************************************************************
+ * Function Name : RTSched_PolicyName
+ * Description   : Name of a policy for the stats dump
+ * Returns       : the name
+ * Params        @policy: the policy
+ ****************************************************************/
+extern const char* RTSched_PolicyName (RTSched_Policy policy);
+
+/****************************************************************
+ * Function Name : RTSched_ParseCpuList
+ * Description   : Parse a CPU list such as "3", "0-2" or "0,2-3"
+ * Returns       : 0 on success, -1 on a malformed list or a CPU
+ *                 that is not online
+ * Params        @p_list: the list
+ *               @p_mask: to store the CPUs, bit n = CPU n
+ ****************************************************************/
+extern int RTSched_ParseCpuList (const char *p_list, uint64_t *p_mask);
+
+/****************************************************************
+ * Function Name : RTSched_FormatCpuList
+ * Description   : Format a CPU mask as a list, e.g. "0,2-3"
+ * Returns       : void
+ * Params        @mask: the CPUs, bit n = CPU n
+ *               @p_list: to store the list
+ *               @size: size of p_list
+ ****************************************************************/
+extern void RTSched_FormatCpuList (uint64_t mask, char *p_list, size_t size);
+
+/****************************************************************
+ * Function Name : RTSched_OnlineMask
+ * Description   : Get the mask of the online CPUs
+ * Returns       : the mask, bit n = CPU n
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t RTSched_OnlineMask (void);
+
+/****************************************************************
+ * Function Name : RTSched_SetAttrAffinity
+ * Description   : Pin threads created with the attribute to a set
+ *                 of CPUs
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_attr: the thread attribute
+ *               @mask: the CPUs, bit n = CPU n
+ ****************************************************************/
+extern int RTSched_SetAttrAffinity (pthread_attr_t *p_attr, uint64_t mask);
+
+/****************************************************************
+ * Function Name : RTSched_GetAffinity
+ * Description   : Get the CPUs a thread may run on
+ * Returns       : the mask, bit n = CPU n (0 on failure)
+ * Params        @thread: the thread
+ ****************************************************************/
+extern uint64_t RTSched_GetAffinity (pthread_t thread);
+
+/****************************************************************
+ * Function Name : RTSched_CurrentCpu
+ * Description   : Get the CPU the calling thread runs on
+ * Returns       : the CPU, -1 on failure
+ * Params        : N/A
+ ****************************************************************/
+extern int RTSched_CurrentCpu (void);
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * signal_monitor.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdint.h>     // Fixed-width int type
+#include <string.h>     // String-handling library
+
+#include "signal_monitor.h" // Its header file
+
+/****************************************************************
+ * Function Name : hysteresis (private)
+ * Description   : Two-threshold switch on a Q8 value
+ * Returns       : the new switch state
+ * Params        @current: the current switch state
+ *               @value_q8: the smoothed value (Q8)
+ *               @on_below: turn on when value drops below this
+ *               @off_above: turn off when value rises above this
+ ****************************************************************/
+static uint8_t hysteresis (uint8_t current, uint16_t value_q8, uint8_t on_below, uint8_t off_above)
+{
+    if (!current && (value_q8 < (uint16_t) (on_below * SIGMON_Q8)))
+    {
+        return 1;
+    }
+    if (current && (value_q8 > (uint16_t) (off_above * SIGMON_Q8)))
+    {
+        return 0;
+    }
+    return current;
+}
+
+/****************************************************************
+ * Function Name : SigMon_Reset
+ * Description   : Clear the smoothing state, e.g. after a new tune.
+ *                 The mode starts as stereo with HCC and SNC off.
+ * Returns       : void
+ * Params        @p_state: the monitor state
+ ****************************************************************/
+extern void SigMon_Reset (SigMon_State *p_state)
+{
+    uint32_t samples = p_state->samples;
+    uint32_t mode_changes = p_state->mode_changes;
+
+    /* Keep the lifetime counters across resets */
+    (void) memset(p_state, 0, sizeof(SigMon_State));
+    p_state->samples = samples;
+    p_state->mode_changes = mode_changes;
+}
+
+/****************************************************************
+ * Function Name : SigMon_AddSample
+ * Description   : Add a level/stereo sample and re-evaluate the
+ *                 mono, HCC and SNC decision with hysteresis
+ * Returns       : 1 if the decided mode changed, 0 otherwise
+ * Params        @p_state: the monitor state
+ *               @level: level ADC reading (0 - 15)
+ *               @stereo: stereo flag reading
+ ****************************************************************/
+extern uint8_t SigMon_AddSample (SigMon_State *p_state, uint8_t level, uint8_t stereo)
+{
+    uint16_t window_level_q8;
+    uint16_t window_stereo_q8;
+    uint8_t mono;
+    uint8_t hcc;
+    uint8_t snc;
+
+    /* Slide the window: drop the oldest sample once the ring is full */
+    if (p_state->count == SIGMON_RING_SIZE)
+    {
+        p_state->level_sum -= p_state->level_ring[p_state->head];
+        p_state->stereo_sum -= p_state->stereo_ring[p_state->head];
+    }
+    else
+    {
+        p_state->count++;
+    }
+    p_state->level_ring[p_state->head] = level;
+    p_state->stereo_ring[p_state->head] = stereo ? 1 : 0;
+    p_state->level_sum += level;
+    p_state->stereo_sum += stereo ? 1 : 0;
+    p_state->head = (p_state->head + 1) % SIGMON_RING_SIZE;
+    p_state->samples++;
+
+    /* Windowed mean, then EWMA on top of it. The first sample seeds
+     * the EWMA so a fresh tune does not start from zero. */
+    window_level_q8 = (p_state->level_sum * SIGMON_Q8) / p_state->count;
+    window_stereo_q8 = (p_state->stereo_sum * SIGMON_Q8) / p_state->count;
+    if (p_state->count == 1)
+    {
+        p_state->level_q8 = window_level_q8;
+        p_state->stereo_q8 = window_stereo_q8;
+    }
+    else
+    {
+        p_state->level_q8 += ((int32_t) window_level_q8 - p_state->level_q8) >> SIGMON_EWMA_SHIFT;
+        p_state->stereo_q8 += ((int32_t) window_stereo_q8 - p_state->stereo_q8) >> SIGMON_EWMA_SHIFT;
+    }
+
+    if (p_state->dwell < SIGMON_MIN_DWELL)
+    {
+        p_state->dwell++;
+        return 0;
+    }
+
+    /* Level drives all three switches. The stereo share can only
+     * push into mono: once mono is forced the flag reads 0. */
+    mono = hysteresis(p_state->mono, p_state->level_q8, SIGMON_MONO_ON_LEVEL, SIGMON_MONO_OFF_LEVEL);
+    if (!p_state->mono && (p_state->stereo_q8 < SIGMON_STEREO_MIN_Q8))
+    {
+        mono = 1;
+    }
+    hcc = hysteresis(p_state->hcc, p_state->level_q8, SIGMON_HCC_ON_LEVEL, SIGMON_HCC_OFF_LEVEL);
+    snc = hysteresis(p_state->snc, p_state->level_q8, SIGMON_SNC_ON_LEVEL, SIGMON_SNC_OFF_LEVEL);
+
+    if ((mono == p_state->mono) && (hcc == p_state->hcc) && (snc == p_state->snc))
+    {
+        return 0;
+    }
+
+    /* Leaving forced mono: the stereo history only holds the zeros
+     * read while mono was forced, so give stereo the benefit of the
+     * doubt instead of falling straight back into mono */
+    if (p_state->mono && !mono)
+    {
+        (void) memset(p_state->stereo_ring, 1, sizeof(p_state->stereo_ring));
+        p_state->stereo_sum = p_state->count;
+        p_state->stereo_q8 = SIGMON_Q8;
+    }
+
+    p_state->mono = mono;
+    p_state->hcc = hcc;
+    p_state->snc = snc;
+    p_state->dwell = 0;
+    p_state->mode_changes++;
+    return 1;
+}
@@ -0,0 +1,65 @@
+/*
+ * signal_monitor.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef SIGNAL_MONITOR_H
+#define SIGNAL_MONITOR_H
+
+#include <stdint.h>     // Fixed-width int type
+
+#define SIGMON_RING_SIZE     8     // Samples in the smoothing window
+#define SIGMON_EWMA_SHIFT    2     // EWMA weight = 1/4
+#define SIGMON_Q8            256   // Fixed-point one (Q8)
+#define SIGMON_MIN_DWELL     4     // Samples a mode must hold before switching again
+
+/* Hysteresis thresholds on the smoothed level (0 - 15) */
+#define SIGMON_MONO_ON_LEVEL   5   // Force mono below this level
+#define SIGMON_MONO_OFF_LEVEL  7   // Back to stereo above this level
+#define SIGMON_HCC_ON_LEVEL    6   // High cut control below this level
+#define SIGMON_HCC_OFF_LEVEL   8
+#define SIGMON_SNC_ON_LEVEL    8   // Stereo noise cancelling below this level
+#define SIGMON_SNC_OFF_LEVEL   10
+/* Pilot flapping: force mono when stereo is seen less than this share */
+#define SIGMON_STEREO_MIN_Q8   64  // 25%
+
+typedef struct SigMon_State {
+    uint8_t  level_ring[SIGMON_RING_SIZE];  // Raw level samples
+    uint8_t  stereo_ring[SIGMON_RING_SIZE]; // Raw stereo flags
+    uint8_t  head;              // Next ring slot to write
+    uint8_t  count;             // Valid samples in the ring
+    uint16_t level_sum;         // Sum of level_ring
+    uint8_t  stereo_sum;        // Sum of stereo_ring
+    uint16_t level_q8;          // EWMA of the windowed level (Q8)
+    uint16_t stereo_q8;         // EWMA of the windowed stereo share (Q8)
+    uint8_t  mono;              // Decided forced mono
+    uint8_t  hcc;               // Decided high cut control
+    uint8_t  snc;               // Decided stereo noise cancelling
+    uint8_t  dwell;             // Samples since the last mode change
+    uint32_t samples;           // Total samples taken
+    uint32_t mode_changes;      // Total mode changes decided
+} SigMon_State;
+
+/****************************************************************
+ * Function Name : SigMon_Reset
+ * Description   : Clear the smoothing state, e.g. after a new tune.
+ *                 The mode starts as stereo with HCC and SNC off.
+ * Returns       : void
+ * Params        @p_state: the monitor state
+ ****************************************************************/
+extern void SigMon_Reset (SigMon_State *p_state);
+
+/****************************************************************
+ * Function Name : SigMon_AddSample
+ * Description   : Add a level/stereo sample and re-evaluate the
+ *                 mono, HCC and SNC decision with hysteresis
+ * Returns       : 1 if the decided mode changed, 0 otherwise
+ * Params        @p_state: the monitor state
+ *               @level: level ADC reading (0 - 15)
+ *               @stereo: stereo flag reading
+ ****************************************************************/
+extern uint8_t SigMon_AddSample (SigMon_State *p_state, uint8_t level, uint8_t stereo);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * startup_trace.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#include <stdio.h>              // Standard I/O
+#include <stdint.h>             // Fixed-width int type
+#include <string.h>             // String-handling library
+#include <unistd.h>             // sysconf
+#include <time.h>               // clock_gettime
+
+#include "fm_clock.h"
+#include "startup_trace.h"      // Its header file
+
+#define STAT_FIELD_STARTTIME 22 // Field of /proc/self/stat: start after boot, in ticks
+
+static const char *phase_names[STARTUP_PHASES] = {
+    "main", "state", "tasks", "gpio", "i2c", "pll", "lock", "display"
+};
+static uint64_t marks_us[STARTUP_PHASES];   // FMClock_NowUs of each phase, 0 = not reached
+static int64_t exec_us = -1;                // exec to main(), -1 if unknown
+
+/****************************************************************
+ * Function Name : execToMain (private)
+ * Description   : Work out how long ago the process was started,
+ *                 from its start time in /proc/self/stat
+ * Returns       : the time in microseconds, -1 if unknown
+ * Params        : N/A
+ ****************************************************************/
+static int64_t execToMain (void)
+{
+    char line[512];
+    char *p_field = NULL;
+    unsigned long long start_ticks = 0;
+    long ticks_per_sec = sysconf(_SC_CLK_TCK);
+    struct timespec boot;
+    uint8_t field = 0;
+    FILE *p_file = fopen("/proc/self/stat", "r");
+
+    if (p_file == NULL)
+    {
+        return -1;
+    }
+    p_field = fgets(line, sizeof(line), p_file);
+    (void) fclose(p_file);
+    (void) clock_gettime(CLOCK_BOOTTIME, &boot);
+
+    /* The command name may hold spaces: count the fields after it,
+     * starting with the state, field 3 */
+    if ((p_field == NULL) || (ticks_per_sec <= 0) || ((p_field = strrchr(line, ')')) == NULL))
+    {
+        return -1;
+    }
+    for (field = 2; (field < STAT_FIELD_STARTTIME) && (p_field != NULL); field++)
+    {
+        p_field = strchr(p_field + 1, ' ');
+    }
+    if ((p_field == NULL) || (sscanf(p_field, " %llu", &start_ticks) != 1))
+    {
+        return -1;
+    }
+
+    return ((int64_t) boot.tv_sec * (int64_t) USEC_PER_SEC) + ((int64_t) boot.tv_nsec / (int64_t) NSEC_PER_USEC)
+           - (int64_t) ((start_ticks * USEC_PER_SEC) / (unsigned long long) ticks_per_sec);
+}
+
+/****************************************************************
+ * Function Name : StartupTrace_Init
+ * Description   : Mark STARTUP_MAIN and work out when the process
+ *                 was started. Call first thing in main().
+ * Returns       : the STARTUP_MAIN time (FMClock_NowUs)
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t StartupTrace_Init (void)
+{
+    StartupTrace_Mark(STARTUP_MAIN);
+    exec_us = execToMain();
+    return __atomic_load_n(&marks_us[STARTUP_MAIN], __ATOMIC_RELAXED);
+}
+
+/****************************************************************
+ * Function Name : StartupTrace_Mark
+ * Description   : Mark a phase reached now, if not marked already
+ * Returns       : void
+ * Params        @phase: the phase
+ ****************************************************************/
+extern void StartupTrace_Mark (StartupPhase phase)
+{
+    uint64_t unmarked = 0;
+
+    if (phase >= STARTUP_PHASES)
+    {
+        return;
+    }
+    (void) __atomic_compare_exchange_n(&marks_us[phase], &unmarked, FMClock_NowUs(), 0,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/****************************************************************
+ * Function Name : StartupTrace_Since
+ * Description   : Get when a phase was reached
+ * Returns       : us from the entry to main(), 0 if not reached yet
+ * Params        @phase: the phase
+ ****************************************************************/
+extern uint64_t StartupTrace_Since (StartupPhase phase)
+{
+    uint64_t main_us = __atomic_load_n(&marks_us[STARTUP_MAIN], __ATOMIC_RELAXED);
+    uint64_t mark_us = 0;
+
+    if (phase >= STARTUP_PHASES)
+    {
+        return 0;
+    }
+    mark_us = __atomic_load_n(&marks_us[phase], __ATOMIC_RELAXED);
+    return ((mark_us == 0) || (mark_us < main_us)) ? 0 : (mark_us - main_us);
+}
+
+/****************************************************************
+ * Function Name : StartupTrace_Print
+ * Description   : Print the phases reached so far, one per line
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void StartupTrace_Print (void)
+{
+    uint8_t phase = 0;
+    uint64_t previous_us = 0;
+    uint64_t since_us = 0;
+
+    if (exec_us >= 0)
+    {
+        printf("Startup: exec to main %lld.%lld ms (clock tick resolution)\n",
+               (long long) (exec_us / 1000), (long long) ((exec_us % 1000) / 100));
+    }
+    for (phase = STARTUP_MAIN + 1; phase < STARTUP_PHASES; phase++)
+    {
+        if (__atomic_load_n(&marks_us[phase], __ATOMIC_RELAXED) == 0)
+        {
+            printf("Startup: %-7s not reached\n", phase_names[phase]);
+            continue;
+        }
+        /* GPIO and I2C run side by side, so a phase may come before
+         * the one listed above it */
+        since_us = StartupTrace_Since(phase);
+        printf("Startup: %-7s %8llu us (%c%llu us)\n", phase_names[phase], (unsigned long long) since_us,
+               (since_us >= previous_us) ? '+' : '-',
+               (unsigned long long) ((since_us >= previous_us) ? (since_us - previous_us) : (previous_us - since_us)));
+        previous_us = since_us;
+    }
+}
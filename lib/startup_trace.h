@@ -0,0 +1,65 @@
+/*
+ * startup_trace.h
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ */
+
+#ifndef STARTUP_TRACE_H
+#define STARTUP_TRACE_H
+
+#include <stdint.h>     // Fixed-width int type
+
+/* Timestamps of the start-up phases, from process start to the first
+ * audible tune. Each phase is marked once, by whichever thread reaches
+ * it, and the first mark wins; the marks are plain atomics so any
+ * thread may mark or read them. Times are reported from the entry to
+ * main(); the time from exec to main() comes from the kernel's process
+ * start time, which only has clock tick resolution. */
+
+typedef enum StartupPhase {
+    STARTUP_MAIN,       // main() entered
+    STARTUP_STATE,      // Options parsed, state restored
+    STARTUP_TASKS,      // Every task created
+    STARTUP_GPIO,       // Button pins set up
+    STARTUP_I2C,        // Tuner bus open
+    STARTUP_PLL,        // First PLL write
+    STARTUP_LOCK,       // First lock: audio from here on
+    STARTUP_DISPLAY,    // First screen drawn
+    STARTUP_PHASES
+} StartupPhase;
+
+/****************************************************************
+ * Function Name : StartupTrace_Init
+ * Description   : Mark STARTUP_MAIN and work out when the process
+ *                 was started. Call first thing in main().
+ * Returns       : the STARTUP_MAIN time (FMClock_NowUs)
+ * Params        : N/A
+ ****************************************************************/
+extern uint64_t StartupTrace_Init (void);
+
+/****************************************************************
+ * Function Name : StartupTrace_Mark
+ * Description   : Mark a phase reached now, if not marked already
+ * Returns       : void
+ * Params        @phase: the phase
+ ****************************************************************/
+extern void StartupTrace_Mark (StartupPhase phase);
+
+/****************************************************************
+ * Function Name : StartupTrace_Since
+ * Description   : Get when a phase was reached
+ * Returns       : us from the entry to main(), 0 if not reached yet
+ * Params        @phase: the phase
+ ****************************************************************/
+extern uint64_t StartupTrace_Since (StartupPhase phase);
+
+/****************************************************************
+ * Function Name : StartupTrace_Print
+ * Description   : Print the phases reached so far, one per line
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+extern void StartupTrace_Print (void);
+
+#endif
@@ -2,7 +2,7 @@
  * TEA5767_I2C_DRIVER Source File
  * Author: Vy Phan
  * Created on: 04/24/2023
- * Last Updated: 04/28/2023
+ * Last Updated: 10/18/2026
  */
 
 #include <stdio.h>
@@ -12,38 +12,210 @@
 #include <linux/i2c-dev.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <string.h>
+#include <errno.h>
 
 #include "i2c_bbb.h"
+#include "fm_clock.h"
+#include "fm_metrics.h"
 #include "tea5767_i2c_driver.h"
 
-static BYTE writeBuffer[BUFFER_SIZE] = { 0x00 };
+typedef struct ClockProfile {
+    uint32_t clock_hz;      // Crystal or external clock
+    uint32_t ref_hz;        // PLL reference it is divided down to
+    uint8_t  xtal;          // XTAL_*, BYTE 4
+    uint8_t  pllref;        // PLLREF_*, BYTE 5
+} ClockProfile;
 
-static uint8_t mute_state = 0;
-static uint8_t standby_mode = 0;
-static uint16_t clock_frequency = 32768;
+/* XTAL and PLLREF per clock, from the datasheet's clock table */
+static const ClockProfile clock_profiles[] = {
+#if !defined(TEA5767_FIXED_CLOCK) || (TEA5767_FIXED_CLOCK == CLOCK_32768HZ)
+    { CLOCK_32768HZ, REF_FREQ_32768HZ, XTAL_32768HZ, PLLREF_OFF },
+#endif
+#if !defined(TEA5767_FIXED_CLOCK) || (TEA5767_FIXED_CLOCK == CLOCK_13MHZ)
+    { CLOCK_13MHZ,   REF_FREQ_OTHER,   XTAL_OTHER,   PLLREF_OFF },
+#endif
+#if !defined(TEA5767_FIXED_CLOCK) || (TEA5767_FIXED_CLOCK == CLOCK_6500KHZ)
+    { CLOCK_6500KHZ, REF_FREQ_OTHER,   XTAL_OTHER,   PLLREF_6500KHZ },
+#endif
+};
+#define NUM_CLOCK_PROFILES (sizeof(clock_profiles) / sizeof(clock_profiles[0]))
+
+#if defined(TEA5767_FIXED_CLOCK) && (TEA5767_FIXED_CLOCK != CLOCK_32768HZ) \
+    && (TEA5767_FIXED_CLOCK != CLOCK_13MHZ) && (TEA5767_FIXED_CLOCK != CLOCK_6500KHZ)
+#error "TEA5767_FIXED_CLOCK must be CLOCK_32768HZ, CLOCK_13MHZ or CLOCK_6500KHZ"
+#endif
+
+static const ClockProfile *p_clock = &clock_profiles[0];
+
+static int buildPllTable (TEA5767_FM_module *device);
+static WORD getFrequency (uint32_t ref_hz, uint32_t freq_khz, uint8_t hi_injection);
+static int probeWord (TEA5767_FM_module *device, WORD PLL, uint8_t hi_injection, uint32_t settle_us,
+                      TEA5767_Status *p_status);
+
+/****************************************************************
+ * Function Name : transfer (private)
+ * Description   : Write the shadow register image or read the status
+ *                 bytes, recovering from bus errors: failed transfers
+ *                 are retried with exponential backoff; when the
+ *                 descriptor is unusable or retries keep failing, the
+ *                 bus is reopened, the device rebound and the shadow
+ *                 image replayed before going on. A write of the
+ *                 image the device already holds is skipped.
+ * Returns       : 0 on success, -1 once the retries are exhausted
+ * Params        @device: the FM module
+ *               @p_read_buffer: BUFFER_SIZE bytes to read into, or
+ *                               NULL to write the shadow image
+ ****************************************************************/
+static int transfer (TEA5767_FM_module *device, BYTE *p_read_buffer)
+{
+    TEA5767_RecoveryStats *p_stats = &device->recovery_stats;
+    I2C_Error error = I2C_OK;
+    uint64_t start_us = 0;
+    uint8_t attempt = 0;
+    int8_t ret = 0;
+
+    /* Nothing changed since the last acknowledged write */
+    if ((p_read_buffer == NULL) && device->image_valid
+        && (memcmp(device->device_image, device->write_buffer, BUFFER_SIZE) == 0))
+    {
+        FMMetrics_Add(FM_M_I2C_ELIDED, 1);
+        return 0;
+    }
+
+    for (attempt = 0; attempt <= I2C_MAX_RETRIES; attempt++)
+    {
+        if (attempt > 0)
+        {
+            p_stats->retries++;
+            FMMetrics_Add(FM_M_I2C_RETRIES, 1);
+            FMClock_SleepUs(I2C_BACKOFF_US << (attempt - 1));
+        }
+
+        /* Each attempt is one bus transaction, so a higher class
+         * client gets the bus between retries */
+        ret = I2CSched_Begin(device->p_bus, device->bus_class, device->device_addr);
+
+        if ((attempt > 0) && ((error == I2C_ERR_FD) || (attempt >= I2C_REOPEN_AFTER)))
+        {
+            /* Reopen, rebind and replay: the tuner may have missed
+             * writes while the bus was down */
+            p_stats->reopens++;
+            FMMetrics_Add(FM_M_I2C_REOPENS, 1);
+            if ((I2CSched_Reopen(device->p_bus, device->device_addr) < 0)
+                || (I2C_WriteRegisters(I2CSched_Fd(device->p_bus), device->write_buffer, BUFFER_SIZE) < 0))
+            {
+                error = I2C_ClassifyError(errno);
+                p_stats->errors[error]++;
+                I2CSched_End(device->p_bus);
+                continue;
+            }
+            p_stats->replays++;
+            (void) memcpy(device->device_image, device->write_buffer, BUFFER_SIZE);
+            device->image_valid = 1;
+            ret = 0;
+
+            /* The replay was the write itself */
+            if (p_read_buffer == NULL)
+            {
+                I2CSched_End(device->p_bus);
+                break;
+            }
+        }
+
+        if ((ret >= 0) && (p_read_buffer == NULL))
+        {
+            ret = I2C_WriteRegisters(I2CSched_Fd(device->p_bus), device->write_buffer, BUFFER_SIZE);
+        }
+        else if (ret >= 0)
+        {
+            ret = I2C_ReadRegisters(I2CSched_Fd(device->p_bus), p_read_buffer, BUFFER_SIZE);
+        }
+        if (ret >= 0)
+        {
+            I2CSched_End(device->p_bus);
+            break;
+        }
+
+        /* Classify the failure to pick the recovery on the next attempt */
+        error = I2C_ClassifyError(errno);
+        p_stats->errors[error]++;
+        I2CSched_End(device->p_bus);
+        if (attempt == 0)
+        {
+            start_us = FMClock_NowUs();
+        }
+    }
+
+    if (ret < 0)
+    {
+        /* The device may hold anything now: never skip the next write */
+        device->image_valid = 0;
+        p_stats->failures++;
+        return -1;
+    }
+    if (p_read_buffer == NULL)
+    {
+        (void) memcpy(device->device_image, device->write_buffer, BUFFER_SIZE);
+        device->image_valid = 1;
+    }
+    if (attempt > 0)
+    {
+        /* Time from the first failure to the transfer going through */
+        p_stats->recoveries++;
+        LatHist_Record(&p_stats->recovery_hist, FMClock_NowUs() - start_us);
+    }
+    return 0;
+}
 
 /****************************************************************
  * Function Name : TEA5767_Init
  * Description   : Connect the i2c bus to the FM module at 
- *                 the given slave address.
+ *                 the given slave address, build the PLL table of
+ *                 the selected band and tune to the given channel
+ *                 with the given mute state in the same register
+ *                 write.
  * Returns       : 0 on success, -1 on failure
  * Params        @device: the struct contains FM module's i2c file
  *                        descriptor and device address
+ *               @channel: the band channel to tune to
+ *               @mute: 1 to start muted, 0 to start unmuted
  ****************************************************************/
-extern int TEA5767_Init (TEA5767_FM_module *device)
+extern int TEA5767_Init (TEA5767_FM_module *device, uint16_t channel, uint8_t mute)
 {
-    /* Connect to the I2C FM module at the given slave addr */
-    if (I2C_ConnectToDevice(*(device->i2c_bus), device->device_addr) < 0)
+    /* Start from a clean register image */
+    memset(device->write_buffer, 0, sizeof(device->write_buffer));
+    device->image_valid = 0;
+    device->standby_mode = 0;
+    device->mono = 0;
+    device->hcc = 0;
+    device->snc = 0;
+    device->hi_injection = 1;
+    memset(device->injection_cache, INJECTION_UNKNOWN, sizeof(device->injection_cache));
+    memset(&device->injection_stats, 0, sizeof(device->injection_stats));
+    memset(&device->recovery_stats, 0, sizeof(device->recovery_stats));
+    LatHist_Init(&device->recovery_stats.recovery_hist);
+
+    /* Both PLL words of every channel up front, so a tune or a scan
+     * step is a table lookup */
+    if (TEA5767_BuildTables(device) < 0)
+    {
+        return -1;
+    }
+
+    /* The bus scheduler binds the slave address per transaction */
+    if (device->p_bus == NULL)
     {
-        /* Fail to connect to the device */
-        perror("ERROR: TEA5767 - Failed to init the FM module");
+        printf("ERROR: TEA5767 - No bus to init the FM module on\n");
         return -1;
     }
 
-    /* Tune to the default frequency */
-    if (TEA5767_SetFrequency(device, 94.73) < 0)
+    /* Tune to the start-up channel; the mute state goes out with
+     * the PLL so a muted radio never plays a burst of audio */
+    device->mute_state = mute;
+    if (TEA5767_TuneChannel(device, channel) < 0)
     {
-        perror("ERROR: TEA5767 - Failed to tune to the default frequency 94.7MHz");
+        perror("ERROR: TEA5767 - Failed to tune to the start-up frequency");
         return -1;
     }
 
@@ -51,6 +223,27 @@ extern int TEA5767_Init (TEA5767_FM_module *device)
 }
 
 
+/****************************************************************
+ * Function Name : TEA5767_BuildTables
+ * Description   : Set the band and clock bits of the selected band
+ *                 and reference clock profile and build the PLL
+ *                 table of every channel. Touches no bus.
+ * Returns       : 0 on success, -1 if a PLL word fails its check
+ * Params        @device: the FM module
+ ****************************************************************/
+extern int TEA5767_BuildTables (TEA5767_FM_module *device)
+{
+    const FMBand *p_band = FMBand_Get();
+
+    device->band_bits = p_band->japan ? BAND_JAPAN : 0x00;
+    device->deemphasis = (p_band->deemphasis_us == 75) ? DTC_75US : DTC_50US;
+    device->xtal_bits = p_clock->xtal;
+    device->pllref_bits = p_clock->pllref;
+    device->ref_hz = p_clock->ref_hz;
+    return buildPllTable(device);
+}
+
+
 /****************************************************************
  * Function Name : TEA5767_Mute
  * Description   : Mute the audio from the FM module
@@ -64,11 +257,11 @@ extern int TEA5767_Mute (TEA5767_FM_module *device)
      *  If MUTE = 1, then L and R audio are muted
      *  Turn on the bit 1 of BYTE 1 with bit-mask
      */
-    mute_state = 1;
-    writeBuffer[BYTE_1] |= MUTE_MASK;
+    device->mute_state = 1;
+    device->write_buffer[BYTE_1] |= MUTE_MASK;
 
     /* Write the buffer to registers */
-    if (I2C_WriteRegisters(*(device->i2c_bus), writeBuffer, BUFFER_SIZE) < 0)
+    if (transfer(device, NULL) < 0)
     {
         perror("ERROR: TEA5767 - Failed to mute the FM module.");
         return -1;
@@ -90,11 +283,11 @@ extern int TEA5767_Unmute (TEA5767_FM_module *device)
      *  If MUTE = 0, then L and R audio are not muted
      *  Turn off the bit 1 of BYTE 1 with bit-mask
      */
-    mute_state = 0;
-    writeBuffer[BYTE_1] &= UNMUTE_MASK;
+    device->mute_state = 0;
+    device->write_buffer[BYTE_1] &= UNMUTE_MASK;
 
     /* Write the buffer to registers */
-    if (I2C_WriteRegisters(*(device->i2c_bus), writeBuffer, BUFFER_SIZE) < 0)
+    if (transfer(device, NULL) < 0)
     {
         perror("ERROR: TEA5767 - Failed to unmute the FM module.");
         return -1;
@@ -115,11 +308,11 @@ extern int TEA5767_StandbyON (TEA5767_FM_module *device)
      *  If STBY = 1, then in Standby mode
      *  Turn on the bit 2 of BYTE 4 with bit-mask
      */
-    standby_mode = 1;
-    writeBuffer[BYTE_4] |= STANDBY_ON_MASK;
+    device->standby_mode = 1;
+    device->write_buffer[BYTE_4] |= STANDBY_ON_MASK;
 
     /* Write the buffer to registers */
-    if (I2C_WriteRegisters(*(device->i2c_bus), writeBuffer, BUFFER_SIZE) < 0)
+    if (transfer(device, NULL) < 0)
     {
         perror("ERROR: TEA5767 - Failed to turn on Standby mode.");
         return -1;
@@ -140,11 +333,11 @@ extern int TEA5767_StandbyOFF (TEA5767_FM_module *device)
      *  If STBY = 0, then not in Standby mode
      *  Turn off the bit 2 of BYTE 4 with bit-mask
      */
-    standby_mode = 0;
-    writeBuffer[BYTE_4] &= STANDBY_OFF_MASK;
+    device->standby_mode = 0;
+    device->write_buffer[BYTE_4] &= STANDBY_OFF_MASK;
 
     /* Write the buffer to registers */
-    if (I2C_WriteRegisters(*(device->i2c_bus), writeBuffer, BUFFER_SIZE) < 0)
+    if (transfer(device, NULL) < 0)
     {
         perror("ERROR: TEA5767 - Failed to tune off Standby mode.");
         return -1;
@@ -152,60 +345,321 @@ extern int TEA5767_StandbyOFF (TEA5767_FM_module *device)
     return 0;
 }
 
+/****************************************************************
+ * Function Name : TEA5767_Wake
+ * Description   : Leave Standby mode by writing the cached register
+ *                 image (station, signal mode, the given mute state)
+ *                 in one transfer. The PLL then settles again; wait
+ *                 for it with TEA5767_WaitForLock.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @mute: 1 to come back muted, 0 to come back playing
+ ****************************************************************/
+extern int TEA5767_Wake (TEA5767_FM_module *device, uint8_t mute)
+{
+    /* Mute and standby change in the same write, so the tuner never
+     * plays a burst of audio it should not */
+    device->standby_mode = 0;
+    device->mute_state = mute;
+    device->write_buffer[BYTE_4] &= STANDBY_OFF_MASK;
+    if (mute)
+    {
+        device->write_buffer[BYTE_1] |= MUTE_MASK;
+    }
+    else
+    {
+        device->write_buffer[BYTE_1] &= UNMUTE_MASK;
+    }
+
+    /* Write the buffer to registers */
+    if (transfer(device, NULL) < 0)
+    {
+        perror("ERROR: TEA5767 - Failed to wake from Standby mode.");
+        return -1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : TEA5767_WakeChannel
+ * Description   : Leave Standby mode straight onto a channel of the
+ *                 band: the new station, standby cleared and the
+ *                 given mute state go out in one transfer, with the
+ *                 injection side picked as TEA5767_TuneChannel does.
+ *                 Wait for the lock with TEA5767_WaitForLock.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @channel: the band channel, below device->channels
+ *               @mute: 1 to come back muted, 0 to come back playing
+ ****************************************************************/
+extern int TEA5767_WakeChannel (TEA5767_FM_module *device, uint16_t channel, uint8_t mute)
+{
+    /* The tune builds the whole image, so it carries the wake too */
+    device->standby_mode = 0;
+    device->mute_state = mute;
+    return TEA5767_TuneChannel(device, channel);
+}
+
 /****************************************************************
  * Function Name : TEA5767_SetClockFrequency
- * Description   : set the clock frequency (default at 32.768kHz)
- * Returns       : void
- * Params        @input_clock_freq: the desired clock frequency
+ * Description   : set the clock frequency (default at 32.768kHz).
+ *                 Takes effect at the next TEA5767_Init, which
+ *                 builds the PLL tables for it.
+ * Returns       : 0 on success, -1 if no profile matches the clock
+ *                 (or it was stripped by TEA5767_FIXED_CLOCK)
+ * Params        @input_clock_freq: CLOCK_32768HZ, CLOCK_13MHZ or
+ *                                  CLOCK_6500KHZ
  ****************************************************************/
-extern void TEA5767_SetClockFrequency (const uint16_t input_clock_freq)
+extern int TEA5767_SetClockFrequency (const uint32_t input_clock_freq)
 {
-    clock_frequency = input_clock_freq;
+    uint8_t profile = 0;
+
+    for (profile = 0; profile < NUM_CLOCK_PROFILES; profile++)
+    {
+        if (clock_profiles[profile].clock_hz == input_clock_freq)
+        {
+            p_clock = &clock_profiles[profile];
+            return 0;
+        }
+    }
+    printf("ERROR: TEA5767 - No profile for a %u Hz clock in this build\n", input_clock_freq);
+    return -1;
 }
 
 /****************************************************************
  * Function Name : TEA5767_GetClockFrequency
  * Description   : get the current clock frequency
- * Returns       : the current clock requency
+ * Returns       : the current clock frequency in Hz
  * Params        : N/A
  ****************************************************************/
-extern int TEA5767_GetClockFrequency (void)
+extern uint32_t TEA5767_GetClockFrequency (void)
 {
-    return clock_frequency;
+    return p_clock->clock_hz;
 }
 
 /****************************************************************
  * Function Name : getFrequency (private)
- * Description   : Calculate the decimal value of PLL word
+ * Description   : Calculate the decimal value of PLL word,
+ *                 N = 4 * (f_RF +/- f_IF) / f_ref, rounded to the
+ *                 nearest word in integer arithmetic
  * Returns       : a word (uint16_t) on success
- * Params        @tuning_freq: the desired frequency for tuning
+ * Params        @ref_hz: the PLL reference frequency
+ *               @freq_khz: the desired frequency for tuning
+ *               @hi_injection: 1 for high side, 0 for low side
  ****************************************************************/
-static WORD getFrequency (float tuning_freq)
+static WORD getFrequency (uint32_t ref_hz, uint32_t freq_khz, uint8_t hi_injection)
 {
-    uint16_t ref_freq;
+    uint64_t lo_hz = (uint64_t) freq_khz * 1000;
 
-    if (clock_frequency == 32768)
+    /* The local oscillator sits one IF above or below the station */
+    if (hi_injection)
     {
-        /* If clock frequency is 32.768kHz, then reference frequency
-         * is the same
-         */ 
-        ref_freq = REF_FREQ_32768HZ;
+        lo_hz += INTERMEDIATE_FREQ;
     }
     else
     {
-        /* If clock frequency is 13MHz crystal or 6.5MHz external clock,
-         * then set reference frequency to be 50kHz
-         */
-        ref_freq = REF_FREQ_OTHER;
+        lo_hz -= INTERMEDIATE_FREQ;
+    }
+
+    return (WORD) (((4 * lo_hz) + (ref_hz / 2)) / ref_hz);
+}
+
+/****************************************************************
+ * Function Name : buildPllTable (private)
+ * Description   : Fill both PLL words of every channel of the band
+ *                 and check each one: it must fit the 14-bit word
+ *                 and land within half a PLL step (f_ref / 8) of
+ *                 the wanted local oscillator. Every channel of the
+ *                 band is checked, so a bad profile or band fails
+ *                 the init instead of mistuning one station.
+ * Returns       : 0 on success, -1 if a word fails the check
+ * Params        @device: the FM module, with ref_hz set
+ ****************************************************************/
+static int buildPllTable (TEA5767_FM_module *device)
+{
+    uint16_t index = 0;
+    uint8_t hi = 0;
+    uint32_t freq_khz = 0;
+    int64_t wanted_x4 = 0;
+    int64_t error_x4 = 0;
+
+    device->channels = FMBand_Channels();
+    device->pll_error_hz = 0;
+    for (index = 0; index < device->channels; index++)
+    {
+        freq_khz = FMBand_KHz(index);
+        for (hi = 0; hi < 2; hi++)
+        {
+            device->pll_table[index][hi] = getFrequency(device->ref_hz, freq_khz, hi);
+
+            /* Tuning error: the synthesized LO (N * f_ref / 4) against
+             * the wanted one, both kept times 4 to stay exact */
+            wanted_x4 = 4 * (((int64_t) freq_khz * 1000) + (hi ? INTERMEDIATE_FREQ : -INTERMEDIATE_FREQ));
+            error_x4 = ((int64_t) device->pll_table[index][hi] * device->ref_hz) - wanted_x4;
+            if (error_x4 < 0)
+            {
+                error_x4 = -error_x4;
+            }
+            if ((wanted_x4 > ((int64_t) PLL_MAX * device->ref_hz)) || ((error_x4 * 2) > device->ref_hz))
+            {
+                printf("ERROR: TEA5767 - PLL word for %u kHz (%s side) is off by %lld Hz\n",
+                       freq_khz, hi ? "high" : "low", (long long) (error_x4 / 4));
+                return -1;
+            }
+            if ((error_x4 / 4) > device->pll_error_hz)
+            {
+                device->pll_error_hz = (uint32_t) (error_x4 / 4);
+            }
+        }
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : writeTuning (private)
+ * Description   : Build the register image for a PLL word and write
+ *                 it to the FM module
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the FM module
+ *               @PLL: the PLL word
+ *               @hi_injection: 1 for high side, 0 for low side
+ *               @force_mute: 1 to mute regardless of the mute state
+ ****************************************************************/
+static int writeTuning (TEA5767_FM_module *device, WORD PLL, uint8_t hi_injection, uint8_t force_mute)
+{
+    /* Set up buffer to write */
+    device->write_buffer[BYTE_1] = (PLL >> 8) & PLL_MASK_BYTE_1;
+    device->write_buffer[BYTE_2] = PLL & PLL_MASK_BYTE_2;
+    device->write_buffer[BYTE_3] = hi_injection ? HI_INJECTION : 0x00;
+    device->pll = PLL;
+    device->write_buffer[BYTE_4] = device->xtal_bits | device->band_bits;
+    device->write_buffer[BYTE_5] = device->pllref_bits | device->deemphasis;
+
+    /* Keep the signal mode chosen by the signal monitor */
+    if (device->mono)
+    {
+        device->write_buffer[BYTE_3] |= MONO_MASK;
+    }
+    if (device->hcc)
+    {
+        device->write_buffer[BYTE_4] |= HCC_ON_MASK;
+    }
+    if (device->snc)
+    {
+        device->write_buffer[BYTE_4] |= SNC_ON_MASK;
+    }
+
+    /* Check for Mute state and Standby mode */
+    if (device->mute_state || force_mute)
+    {
+        device->write_buffer[BYTE_1] |= MUTE_MASK;
+    }
+    if (device->standby_mode)
+    {
+        device->write_buffer[BYTE_4] |= STANDBY_ON_MASK;
+    }
+
+    /* Write the buffer to registers */
+    if (transfer(device, NULL) < 0)
+    {
+        return -1;
     }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : probeLevel (private)
+ * Description   : Probe a frequency on the given injection side, with
+ *                 the PLL word of that side, and keep only its level
+ * Returns       : level (0 - 15) on success, -1 on failure
+ * Params        @device: the FM module
+ *               @probe_freq: the frequency to probe
+ *               @hi_injection: 1 for high side, 0 for low side
+ ****************************************************************/
+static int probeLevel (TEA5767_FM_module *device, float probe_freq, uint8_t hi_injection)
+{
+    TEA5767_Status status;
+    WORD PLL = getFrequency(device->ref_hz, (uint32_t) ((probe_freq * 1000) + 0.5f), hi_injection);
 
-    /* Calculate PLL */
-    return (4 * ((tuning_freq * 1000000) + INTERMEDIATE_FREQ)) / ref_freq; 
+    if (probeWord(device, PLL, hi_injection, INJECTION_PROBE_SETTLE, &status) < 0)
+    {
+        return -1;
+    }
+    return status.level;
+}
+
+/****************************************************************
+ * Function Name : selectInjection (private)
+ * Description   : Pick the injection side for a channel, from the
+ *                 cache or by probing the image frequencies as the
+ *                 datasheet recommends: measure the level at
+ *                 f + 450kHz on the high side and f - 450kHz on the
+ *                 low side, use high side injection when the upper
+ *                 image is the weaker one.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the FM module
+ *               @tuning_freq: the desired frequency for tuning
+ *               @channel: its band channel, FMBAND_NONE if off the
+ *                         channel grid (not cached)
+ *               @p_hi_injection: to store the chosen side
+ ****************************************************************/
+static int selectInjection (TEA5767_FM_module *device, float tuning_freq, int channel, uint8_t *p_hi_injection)
+{
+    uint8_t cacheable = (channel != FMBAND_NONE);
+    uint64_t start_us = 0;
+    uint64_t probe_us = 0;
+    int level_high = 0;
+    int level_low = 0;
+
+    /* Later tunes to the same channel pay no probe cost */
+    if (cacheable && (device->injection_cache[channel] != INJECTION_UNKNOWN))
+    {
+        device->injection_stats.cache_hits++;
+        *p_hi_injection = (device->injection_cache[channel] == INJECTION_HIGH);
+        return 0;
+    }
+
+    start_us = FMClock_NowUs();
+    level_high = probeLevel(device, tuning_freq + INJECTION_PROBE_OFFSET, 1);
+    level_low = probeLevel(device, tuning_freq - INJECTION_PROBE_OFFSET, 0);
+    if ((level_high < 0) || (level_low < 0))
+    {
+        return -1;
+    }
+    *p_hi_injection = (level_high < level_low);
+
+    if (cacheable)
+    {
+        device->injection_cache[channel] = *p_hi_injection ? INJECTION_HIGH : INJECTION_LOW;
+    }
+
+    /* Account the extra latency this first tune paid */
+    probe_us = FMClock_NowUs() - start_us;
+    device->injection_stats.probes++;
+    device->injection_stats.probe_us += probe_us;
+    if (probe_us > device->injection_stats.probe_max_us)
+    {
+        device->injection_stats.probe_max_us = probe_us;
+    }
+    if (*p_hi_injection)
+    {
+        device->injection_stats.high_side++;
+    }
+    else
+    {
+        device->injection_stats.low_side++;
+    }
+    return 0;
 }
 
 /****************************************************************
  * Function Name : TEA5767_SetFrequency
- * Description   : Tune to the selected frequency
+ * Description   : Tune to the selected frequency. With auto_injection
+ *                 set, the first tune to a channel probes the level
+ *                 at +/-450kHz to pick the injection side; later tunes
+ *                 use the cached side.
  * Returns       : 0 on success, -1 on failure
  * Params        @device: the struct contains FM module's i2c file
  *                        descriptor and device address
@@ -213,31 +667,283 @@ static WORD getFrequency (float tuning_freq)
  ****************************************************************/
 extern int TEA5767_SetFrequency (TEA5767_FM_module *device, float tuning_freq)
 {
-    /* Calculate the PLL counter from the frequency */
-    WORD PLL = getFrequency(tuning_freq);
+    uint32_t freq_khz = (uint32_t) ((tuning_freq * 1000) + 0.5f);
+    int channel = FMBand_Index(freq_khz);
+    uint8_t hi_injection = 1;
 
-    /* Set up buffer to write */
-    writeBuffer[BYTE_1] = (PLL >> 8) & PLL_MASK_BYTE_1;
-    writeBuffer[BYTE_2] = PLL & PLL_MASK_BYTE_2;
-    writeBuffer[BYTE_3] = HI_INJECTION;
-    writeBuffer[BYTE_4] = XTAL_32768HZ;
-    writeBuffer[BYTE_5] = DTC_75US;
+    /* Only a frequency on the channel grid shares the channel's cache */
+    if ((channel != FMBAND_NONE) && (FMBand_KHz((uint16_t) channel) != freq_khz))
+    {
+        channel = FMBAND_NONE;
+    }
 
-    /* Check for Mute state and Standby mode */
-    if (mute_state)
+    /* Pick the injection side; high side unless auto mode says otherwise.
+     * A failed probe is not cached, so the next tune probes again. */
+    if (device->auto_injection && (selectInjection(device, tuning_freq, channel, &hi_injection) < 0))
+    {
+        perror("ERROR: TEA5767 - Failed to probe the injection side, using high side.");
+        hi_injection = 1;
+    }
+    device->hi_injection = hi_injection;
+
+    /* Calculate the PLL counter from the frequency and write it */
+    if (writeTuning(device, getFrequency(device->ref_hz, freq_khz, hi_injection), hi_injection, 0) < 0)
+    {
+        perror("ERROR: TEA5767 - Failed to tune to the selected frequency.");
+        return -1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : TEA5767_TuneChannel
+ * Description   : Tune to a channel of the band with the PLL word
+ *                 from the table. Injection side as for
+ *                 TEA5767_SetFrequency.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @channel: the band channel, below device->channels
+ ****************************************************************/
+extern int TEA5767_TuneChannel (TEA5767_FM_module *device, uint16_t channel)
+{
+    uint8_t hi_injection = 1;
+
+    if (channel >= device->channels)
+    {
+        printf("ERROR: TEA5767 - Channel %u outside the band\n", channel);
+        return -1;
+    }
+
+    if (device->auto_injection &&
+        (selectInjection(device, FMBand_KHz(channel) / 1000.0f, channel, &hi_injection) < 0))
+    {
+        perror("ERROR: TEA5767 - Failed to probe the injection side, using high side.");
+        hi_injection = 1;
+    }
+    device->hi_injection = hi_injection;
+
+    if (writeTuning(device, device->pll_table[channel][hi_injection], hi_injection, 0) < 0)
+    {
+        perror("ERROR: TEA5767 - Failed to tune to the selected channel.");
+        return -1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : TEA5767_SetSignalMode
+ * Description   : Set forced mono, high cut control and stereo
+ *                 noise cancelling. Only writes when a bit changes.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @mono: 1 to force mono
+ *               @hcc: 1 to turn on high cut control
+ *               @snc: 1 to turn on stereo noise cancelling
+ ****************************************************************/
+extern int TEA5767_SetSignalMode (TEA5767_FM_module *device, uint8_t mono, uint8_t hcc, uint8_t snc)
+{
+    /* Nothing to write if the mode is already set */
+    if ((device->mono == mono) && (device->hcc == hcc) && (device->snc == snc))
+    {
+        return 0;
+    }
+
+    /*  BYTE 3 | Bit 3 | MS  - 1 = forced mono
+     *  BYTE 4 | Bit 2 | HCC - 1 = high cut control on
+     *  BYTE 4 | Bit 1 | SNC - 1 = stereo noise cancelling on
+     */
+    device->mono = mono;
+    device->hcc = hcc;
+    device->snc = snc;
+    if (mono)
+    {
+        device->write_buffer[BYTE_3] |= MONO_MASK;
+    }
+    else
+    {
+        device->write_buffer[BYTE_3] &= STEREO_MASK;
+    }
+    if (hcc)
+    {
+        device->write_buffer[BYTE_4] |= HCC_ON_MASK;
+    }
+    else
     {
-        writeBuffer[BYTE_2] |= MUTE_MASK;
+        device->write_buffer[BYTE_4] &= HCC_OFF_MASK;
     }
-    if (standby_mode)
+    if (snc)
     {
-        writeBuffer[BYTE_4] |= STANDBY_ON_MASK;
+        device->write_buffer[BYTE_4] |= SNC_ON_MASK;
+    }
+    else
+    {
+        device->write_buffer[BYTE_4] &= SNC_OFF_MASK;
     }
 
     /* Write the buffer to registers */
-    if (I2C_WriteRegisters(*(device->i2c_bus), writeBuffer, BUFFER_SIZE) < 0)
+    if (transfer(device, NULL) < 0)
     {
-        perror("ERROR: TEA5767 - Failed to tune to the selected frequency.");
+        perror("ERROR: TEA5767 - Failed to set the signal mode.");
+        return -1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : TEA5767_ReadStatus
+ * Description   : Read the five status bytes of the FM module
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @p_status: to store the decoded status
+ ****************************************************************/
+extern int TEA5767_ReadStatus (TEA5767_FM_module *device, TEA5767_Status *p_status)
+{
+    BYTE readBuffer[BUFFER_SIZE] = { 0x00 };
+
+    /* The TEA5767 always returns its five status bytes from the start */
+    if (transfer(device, readBuffer) < 0)
+    {
+        perror("ERROR: TEA5767 - Failed to read the status.");
         return -1;
     }
+
+    /* Decode the status bytes */
+    p_status->ready = (readBuffer[BYTE_1] & READY_FLAG) ? 1 : 0;
+    p_status->band_limit = (readBuffer[BYTE_1] & BAND_LIMIT_FLAG) ? 1 : 0;
+    p_status->pll = ((WORD) (readBuffer[BYTE_1] & PLL_MASK_BYTE_1) << 8) | readBuffer[BYTE_2];
+    p_status->stereo = (readBuffer[BYTE_3] & STEREO_FLAG) ? 1 : 0;
+    p_status->if_counter = readBuffer[BYTE_3] & IF_COUNTER_MASK;
+    p_status->level = (readBuffer[BYTE_4] & LEVEL_MASK) >> LEVEL_SHIFT;
     return 0;
-}
\ No newline at end of file
+}
+
+/****************************************************************
+ * Function Name : TEA5767_WaitForLock
+ * Description   : Wait for the last tune to settle: poll the READY
+ *                 flag, bounded by a timeout, and check that the
+ *                 PLL the device reports is the one requested
+ * Returns       : 0 when locked (READY set, PLL matches),
+ *                 1 when the wait timed out with the PLL matching,
+ *                 -1 on I2C failure or PLL mismatch
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @timeout_us: bound on the wait in microseconds
+ *               @p_settle_us: to store the time waited
+ ****************************************************************/
+extern int TEA5767_WaitForLock (TEA5767_FM_module *device, uint32_t timeout_us, uint64_t *p_settle_us)
+{
+    TEA5767_Status status;
+    uint64_t start_us = FMClock_NowUs();
+    uint64_t waited_us = 0;
+
+    while (1)
+    {
+        if (TEA5767_ReadStatus(device, &status) < 0)
+        {
+            *p_settle_us = FMClock_NowUs() - start_us;
+            return -1;
+        }
+        waited_us = FMClock_NowUs() - start_us;
+
+        /* READY with the requested PLL: the tune is done */
+        if (status.ready && (status.pll == device->pll))
+        {
+            *p_settle_us = waited_us;
+            return 0;
+        }
+
+        /* Bounded wait: past the timeout the PLL has settled or failed */
+        if (waited_us >= timeout_us)
+        {
+            *p_settle_us = waited_us;
+            if (status.pll != device->pll)
+            {
+                fprintf(stderr, "ERROR: TEA5767 - PLL mismatch, requested 0x%04X, locked 0x%04X\n",
+                        device->pll, status.pll);
+                return -1;
+            }
+            return 1;
+        }
+
+        FMClock_SleepUs(LOCK_POLL_INTERVAL);
+    }
+}
+
+/****************************************************************
+ * Function Name : probeWord (private)
+ * Description   : Tune muted to a PLL word, then poll READY until
+ *                 it locks or settle_us passes
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the FM module
+ *               @PLL: the PLL word, built for the injection side
+ *               @hi_injection: 1 for high side, 0 for low side
+ *               @settle_us: bound on the wait for READY
+ *               @p_status: to store the status
+ ****************************************************************/
+static int probeWord (TEA5767_FM_module *device, WORD PLL, uint8_t hi_injection, uint32_t settle_us,
+                      TEA5767_Status *p_status)
+{
+    uint64_t start_us = 0;
+
+    if (writeTuning(device, PLL, hi_injection, 1) < 0)
+    {
+        return -1;
+    }
+
+    /* Poll READY so a fast lock ends the probe early */
+    start_us = FMClock_NowUs();
+    while (1)
+    {
+        FMClock_SleepUs(LOCK_POLL_INTERVAL);
+        if (TEA5767_ReadStatus(device, p_status) < 0)
+        {
+            return -1;
+        }
+        if (p_status->ready || ((FMClock_NowUs() - start_us) >= settle_us))
+        {
+            return 0;
+        }
+    }
+}
+
+/****************************************************************
+ * Function Name : TEA5767_Probe
+ * Description   : Tune muted (high side) to a frequency, wait for
+ *                 the level ADC to settle and read the status. The
+ *                 caller re-tunes with TEA5767_SetFrequency after.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @probe_freq: the frequency to probe
+ *               @settle_us: bound on the wait for READY
+ *               @p_status: to store the status
+ ****************************************************************/
+extern int TEA5767_Probe (TEA5767_FM_module *device, float probe_freq, uint32_t settle_us, TEA5767_Status *p_status)
+{
+    return probeWord(device, getFrequency(device->ref_hz, (uint32_t) ((probe_freq * 1000) + 0.5f), 1), 1,
+                     settle_us, p_status);
+}
+
+/****************************************************************
+ * Function Name : TEA5767_ProbeChannel
+ * Description   : TEA5767_Probe for a channel of the band, with the
+ *                 high side PLL word from the table. The caller
+ *                 re-tunes with TEA5767_TuneChannel after.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @channel: the band channel, below device->channels
+ *               @settle_us: bound on the wait for READY
+ *               @p_status: to store the status
+ ****************************************************************/
+extern int TEA5767_ProbeChannel (TEA5767_FM_module *device, uint16_t channel, uint32_t settle_us, TEA5767_Status *p_status)
+{
+    if (channel >= device->channels)
+    {
+        return -1;
+    }
+    return probeWord(device, device->pll_table[channel][1], 1, settle_us, p_status);
+}
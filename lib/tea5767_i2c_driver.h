@@ -2,7 +2,7 @@
  * TEA5767_I2C_DRIVER Header File
  * Author: Vy Phan
  * Created on: 04/24/2023
- * Last Updated: 04/28/2023
+ * Last Updated: 10/18/2026
  */
 
 #ifndef TEA5767_I2C_DRIVER_H
@@ -17,6 +17,9 @@
 #include <stdint.h>
 
 #include "i2c_bbb.h"
+#include "i2c_sched.h"
+#include "latency_hist.h"
+#include "fm_band.h"
 
 #define BUFFER_SIZE 5
 
@@ -32,8 +35,25 @@
 #define LO_INJECTION    0xEF // BYTE 3 | bit 4 | AND
 #define MONO_MASK       0x08 // BYTE 3 | bit 3 | OR
 #define STEREO_MASK     0xF7 // BYTE 3 | bit 3 | AND
-#define XTAL_32768HZ    0x10 // BYTE 4 | bit 4 | OR
-#define DTC_75US        0x40 // BYTE 5 | bit 5 | OR | PLLREF = 0
+#define BAND_JAPAN      0x20 // BYTE 4 | bit 5 | OR | BL = 1, 76 - 91MHz
+#define XTAL_32768HZ    0x10 // BYTE 4 | bit 4 | OR | XTAL = 1, 32.768kHz crystal
+#define XTAL_OTHER      0x00 // BYTE 4 | bit 4 | AND | XTAL = 0, 13MHz or 6.5MHz
+#define PLLREF_6500KHZ  0x80 // BYTE 5 | bit 7 | OR | PLLREF = 1, 6.5MHz external clock
+#define PLLREF_OFF      0x00 // BYTE 5 | bit 7 | AND | PLLREF = 0
+#define DTC_75US        0x40 // BYTE 5 | bit 6 | OR
+#define DTC_50US        0x00 // BYTE 5 | bit 6 | AND
+
+#define HCC_ON_MASK     0x04 // BYTE 4 | bit 2 | OR
+#define HCC_OFF_MASK    0xFB // BYTE 4 | bit 2 | AND
+#define SNC_ON_MASK     0x02 // BYTE 4 | bit 1 | OR
+#define SNC_OFF_MASK    0xFD // BYTE 4 | bit 1 | AND
+
+#define READY_FLAG        0x80 // READ BYTE 1 | bit 7 | RF
+#define BAND_LIMIT_FLAG   0x40 // READ BYTE 1 | bit 6 | BLF
+#define STEREO_FLAG       0x80 // READ BYTE 3 | bit 7 | STEREO
+#define IF_COUNTER_MASK   0x7F // READ BYTE 3 | bit 6-0 | PLL IF counter
+#define LEVEL_MASK        0xF0 // READ BYTE 4 | bit 7-4 | level ADC
+#define LEVEL_SHIFT       4
 
 #define MUTE_MASK             0x80   // BYTE 1 | bit 1 | OR
 #define UNMUTE_MASK           0x7F   // BYTE 1 | bit 1 | AND
@@ -42,24 +62,113 @@
 
 #define INTERMEDIATE_FREQ 225000 // 225kHz
 #define REF_FREQ_32768HZ  32768  // 32.768kHz crystal
-#define REF_FREQ_OTHER    50000  // 13MHz crystal or 6.5MHz external clock
+#define REF_FREQ_OTHER    50000  // 13MHz crystal / 260 or 6.5MHz external clock / 130
+#define PLL_MAX           0x3FFF // 14-bit PLL word
+
+/* Reference clock profiles. A board with a fixed clock can build with
+ * -DTEA5767_FIXED_CLOCK=<one of these> (./start.sh clock=HZ) to strip
+ * the other profiles; otherwise 32.768kHz is the default and
+ * TEA5767_SetClockFrequency picks another before TEA5767_Init. */
+#define CLOCK_32768HZ     32768     // 32.768kHz crystal
+#define CLOCK_13MHZ       13000000  // 13MHz crystal
+#define CLOCK_6500KHZ     6500000   // 6.5MHz external clock
 
 #define DEFAULT_FREQ 94.7 // 94.7 Station
 
+#define LOCK_POLL_INTERVAL       2000   // us between READY flag polls
+#define LOCK_TIMEOUT             100000 // us bound on the wait for lock
+
+#define INJECTION_PROBE_OFFSET   0.45f // MHz | datasheet image probe at +/-450kHz
+#define INJECTION_PROBE_SETTLE   10000 // us  | PLL + level ADC settle per probe
+#define INJECTION_UNKNOWN        0     // Cache entry not probed yet
+#define INJECTION_HIGH           1     // Cache entry: high side injection
+#define INJECTION_LOW            2     // Cache entry: low side injection
+
+typedef struct TEA5767_InjectionStats {
+    uint32_t probes;        // Tunes that had to probe both sides
+    uint32_t cache_hits;    // Tunes served from the cache
+    uint32_t high_side;     // Probes that chose high side injection
+    uint32_t low_side;      // Probes that chose low side injection
+    uint64_t probe_us;      // Total extra tune latency from probing
+    uint64_t probe_max_us;  // Worst extra tune latency from probing
+} TEA5767_InjectionStats;
+
+/* Bus error recovery counters, errors indexed by I2C_Error */
+typedef struct TEA5767_RecoveryStats {
+    uint32_t errors[I2C_ERR_OTHER + 1]; // Failed transfers per error class
+    uint32_t retries;       // Attempts after a failure
+    uint32_t reopens;       // Bus reopen + device rebind attempts
+    uint32_t replays;       // Shadow image replays after a reopen
+    uint32_t recoveries;    // Transfers that went through after failing
+    uint32_t failures;      // Transfers given up after all retries
+    LatHist  recovery_hist; // First failure to successful transfer
+} TEA5767_RecoveryStats;
+
 typedef struct TEA5767_FM_module {
-    int *i2c_bus;
+    I2CSched_Bus *p_bus;            // Bus scheduler, from I2CSched_Open
     BYTE device_addr;
+    /* Configuration, set before TEA5767_Init */
+    uint8_t auto_injection;         // 1 = pick the injection side per channel
+    I2CSched_Class bus_class;       // Class of the next transfers, may change any time
+    /* Driver state, reset by TEA5767_Init */
+    BYTE write_buffer[BUFFER_SIZE]; // Shadow of the last register image
+    BYTE device_image[BUFFER_SIZE]; // Last image the device acknowledged
+    uint8_t image_valid;            // 1 = device_image matches the device
+    uint8_t mute_state;             // 1 = muted
+    uint8_t standby_mode;           // 1 = in standby
+    uint8_t mono;                   // 1 = forced mono
+    uint8_t hcc;                    // 1 = high cut control on
+    uint8_t snc;                    // 1 = stereo noise cancelling on
+    uint8_t hi_injection;           // 1 = high side, 0 = low side injection
+    WORD pll;                       // PLL word of the last tune
+    /* Band tables, built by TEA5767_Init for the selected FMBand
+     * and the reference clock profile */
+    uint16_t channels;                          // Channels of the band
+    uint8_t band_bits;                          // BAND_JAPAN or 0, BYTE 4
+    uint8_t deemphasis;                         // DTC_75US or DTC_50US, BYTE 5
+    uint8_t xtal_bits;                          // XTAL_*, BYTE 4
+    uint8_t pllref_bits;                        // PLLREF_*, BYTE 5
+    uint32_t ref_hz;                            // PLL reference frequency
+    uint32_t pll_error_hz;                      // Worst tuning error in the table
+    WORD pll_table[FMBAND_MAX_CHANNELS][2];     // PLL word per channel, [0] low, [1] high side
+    uint8_t injection_cache[FMBAND_MAX_CHANNELS]; // INJECTION_* per channel
+    TEA5767_InjectionStats injection_stats;
+    TEA5767_RecoveryStats recovery_stats;
 } TEA5767_FM_module;
 
+typedef struct TEA5767_Status {
+    uint8_t ready;      // 1 = PLL locked / station found
+    uint8_t band_limit; // 1 = band limit reached
+    WORD    pll;        // PLL word the device is tuned to
+    uint8_t stereo;     // 1 = stereo reception
+    uint8_t if_counter; // IF counter result
+    uint8_t level;      // Level ADC output (0 - 15)
+} TEA5767_Status;
+
 /****************************************************************
  * Function Name : TEA5767_Init
  * Description   : Connect the i2c bus to the FM module at 
- *                 the given slave address.
+ *                 the given slave address, build the PLL table of
+ *                 the selected band and tune to the given channel
+ *                 with the given mute state in the same register
+ *                 write.
  * Returns       : 0 on success, -1 on failure
  * Params        @device: the struct contains FM module's i2c file
  *                        descriptor and device address
+ *               @channel: the band channel to tune to
+ *               @mute: 1 to start muted, 0 to start unmuted
  ****************************************************************/
-extern int TEA5767_Init (TEA5767_FM_module *device);
+extern int TEA5767_Init (TEA5767_FM_module *device, uint16_t channel, uint8_t mute);
+
+/****************************************************************
+ * Function Name : TEA5767_BuildTables
+ * Description   : Build the PLL table of the selected band for the
+ *                 reference clock profile, without touching the
+ *                 bus. TEA5767_Init calls it.
+ * Returns       : 0 on success, -1 if a PLL word fails its check
+ * Params        @device: the FM module
+ ****************************************************************/
+extern int TEA5767_BuildTables (TEA5767_FM_module *device);
 
 /****************************************************************
  * Function Name : TEA5767_Mute
@@ -97,25 +206,60 @@ extern int TEA5767_StandbyON (TEA5767_FM_module *device);
  ****************************************************************/
 extern int TEA5767_StandbyOFF (TEA5767_FM_module *device);
 
+/****************************************************************
+ * Function Name : TEA5767_Wake
+ * Description   : Leave Standby mode by writing the cached register
+ *                 image (station, signal mode, the given mute state)
+ *                 in one transfer. The PLL then settles again; wait
+ *                 for it with TEA5767_WaitForLock.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @mute: 1 to come back muted, 0 to come back playing
+ ****************************************************************/
+extern int TEA5767_Wake (TEA5767_FM_module *device, uint8_t mute);
+
+/****************************************************************
+ * Function Name : TEA5767_WakeChannel
+ * Description   : Leave Standby mode straight onto a channel of the
+ *                 band: the new station, standby cleared and the
+ *                 given mute state go out in one transfer, with the
+ *                 injection side picked as TEA5767_TuneChannel does.
+ *                 Wait for the lock with TEA5767_WaitForLock.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @channel: the band channel, below device->channels
+ *               @mute: 1 to come back muted, 0 to come back playing
+ ****************************************************************/
+extern int TEA5767_WakeChannel (TEA5767_FM_module *device, uint16_t channel, uint8_t mute);
+
 /****************************************************************
  * Function Name : TEA5767_SetClockFrequency
- * Description   : set the clock frequency (default at 32.768kHz)
- * Returns       : void
- * Params        @input_clock_freq: the desired clock frequency
+ * Description   : set the clock frequency (default at 32.768kHz).
+ *                 Takes effect at the next TEA5767_Init, which
+ *                 builds the PLL tables for it.
+ * Returns       : 0 on success, -1 if no profile matches the clock
+ *                 (or it was stripped by TEA5767_FIXED_CLOCK)
+ * Params        @input_clock_freq: CLOCK_32768HZ, CLOCK_13MHZ or
+ *                                  CLOCK_6500KHZ
  ****************************************************************/
-extern void TEA5767_SetClockFrequency (uint16_t input_clock_freq);
+extern int TEA5767_SetClockFrequency (uint32_t input_clock_freq);
 
 /****************************************************************
  * Function Name : TEA5767_GetClockFrequency
  * Description   : get the current clock frequency
- * Returns       : the current clock requency
+ * Returns       : the current clock frequency in Hz
  * Params        : N/A
  ****************************************************************/
-extern int TEA5767_GetClockFrequency (void);
+extern uint32_t TEA5767_GetClockFrequency (void);
 
 /****************************************************************
  * Function Name : TEA5767_SetFrequency
- * Description   : Tune to the selected frequency
+ * Description   : Tune to the selected frequency. With auto_injection
+ *                 set, the first tune to a channel probes the level
+ *                 at +/-450kHz to pick the injection side; later tunes
+ *                 use the cached side.
  * Returns       : 0 on success, -1 on failure
  * Params        @device: the struct contains FM module's i2c file
  *                        descriptor and device address
@@ -123,4 +267,82 @@ extern int TEA5767_GetClockFrequency (void);
  ****************************************************************/
 extern int TEA5767_SetFrequency (TEA5767_FM_module *device, float tuning_freq);
 
-#endif
\ No newline at end of file
+/****************************************************************
+ * Function Name : TEA5767_TuneChannel
+ * Description   : Tune to a channel of the band with the PLL word
+ *                 from the table. Injection side as for
+ *                 TEA5767_SetFrequency.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @channel: the band channel, below device->channels
+ ****************************************************************/
+extern int TEA5767_TuneChannel (TEA5767_FM_module *device, uint16_t channel);
+
+/****************************************************************
+ * Function Name : TEA5767_SetSignalMode
+ * Description   : Set forced mono, high cut control and stereo
+ *                 noise cancelling. Only writes when a bit changes.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @mono: 1 to force mono
+ *               @hcc: 1 to turn on high cut control
+ *               @snc: 1 to turn on stereo noise cancelling
+ ****************************************************************/
+extern int TEA5767_SetSignalMode (TEA5767_FM_module *device, uint8_t mono, uint8_t hcc, uint8_t snc);
+
+/****************************************************************
+ * Function Name : TEA5767_ReadStatus
+ * Description   : Read the five status bytes of the FM module
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @p_status: to store the decoded status
+ ****************************************************************/
+extern int TEA5767_ReadStatus (TEA5767_FM_module *device, TEA5767_Status *p_status);
+
+/****************************************************************
+ * Function Name : TEA5767_WaitForLock
+ * Description   : Wait for the last tune to settle: poll the READY
+ *                 flag, bounded by a timeout, and check that the
+ *                 PLL the device reports is the one requested
+ * Returns       : 0 when locked (READY set, PLL matches),
+ *                 1 when the wait timed out with the PLL matching,
+ *                 -1 on I2C failure or PLL mismatch
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @timeout_us: bound on the wait in microseconds
+ *               @p_settle_us: to store the time waited
+ ****************************************************************/
+extern int TEA5767_WaitForLock (TEA5767_FM_module *device, uint32_t timeout_us, uint64_t *p_settle_us);
+
+/****************************************************************
+ * Function Name : TEA5767_Probe
+ * Description   : Tune muted (high side) to a frequency, wait for
+ *                 the level ADC to settle and read the status. The
+ *                 caller re-tunes with TEA5767_SetFrequency after.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @probe_freq: the frequency to probe
+ *               @settle_us: bound on the wait for READY
+ *               @p_status: to store the status
+ ****************************************************************/
+extern int TEA5767_Probe (TEA5767_FM_module *device, float probe_freq, uint32_t settle_us, TEA5767_Status *p_status);
+
+/****************************************************************
+ * Function Name : TEA5767_ProbeChannel
+ * Description   : TEA5767_Probe for a channel of the band, with the
+ *                 high side PLL word from the table. The caller
+ *                 re-tunes with TEA5767_TuneChannel after.
+ * Returns       : 0 on success, -1 on failure
+ * Params        @device: the struct contains FM module's i2c file
+ *                        descriptor and device address
+ *               @channel: the band channel, below device->channels
+ *               @settle_us: bound on the wait for READY
+ *               @p_status: to store the status
+ ****************************************************************/
+extern int TEA5767_ProbeChannel (TEA5767_FM_module *device, uint16_t channel, uint32_t settle_us, TEA5767_Status *p_status);
+
+#endif
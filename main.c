@@ -2,7 +2,7 @@
  * Main.c
  * Author: Vy Phan
  * Created on: 04/24/2023
- * Last Updated: 05/03/2023
+ * Last Updated: 10/18/2026
  */
 
 #include <stdio.h>
@@ -14,10 +14,38 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <errno.h>
 
 #include "lib/gpio.h"
+#include "lib/gpio_mmap.h"
+#include "lib/gpio_encoder.h"
 #include "lib/i2c_bbb.h"
+#include "lib/i2c_sched.h"
 #include "lib/tea5767_i2c_driver.h"
+#include "lib/fm_clock.h"
+#include "lib/fm_state_store.h"
+#include "lib/signal_monitor.h"
+#include "lib/latency_hist.h"
+#include "lib/control_server.h"
+#include "lib/fm_metrics.h"
+#include "lib/deadline_monitor.h"
+#include "lib/mem_budget.h"
+#include "lib/button_trace.h"
+#include "lib/cmd_queue.h"
+#include "lib/fm_band.h"
+#include "lib/fm_scanner.h"
+#include "lib/startup_trace.h"
+#include "lib/fm_probes.h"
+#include "lib/flight_rec.h"
+#ifdef I2C_SIMULATOR
+#include "lib/i2c_sim.h"
+#include "lib/load_gen.h"
+#endif
 
 #define BUTTON_WAIT 10 // ms
 #define USEC_PER_MS 1000 // 1000us = 1ms
@@ -28,9 +56,49 @@
 #define FREQUENCY_TUNE_BACK_BUTTON    P9_18
 #define FREQUENCY_TUNE_FORWARD_BUTTON P9_27
 #define RADIO_TUNE_BUTTON			  P9_12
+#define ENCODER_A_PIN				  P9_11
+#define ENCODER_B_PIN				  P9_13
+#define ENCODER_REPLAY_POLL			  1 // ms between reads of the encoder pins in a replay
 
-#define HIGHER_PRIO 20
-#define LOWER_PRIO  50
+#define FM_STATE_FILE "/var/lib/fm_receiver.state"
+#define FLIGHT_RECORD_FILE "/var/lib/fm_receiver.flight" // Flight recorder dumps (-f)
+#define WATCHDOG_MS  10000 // ms a monitored job may run before the flight record is dumped
+#define KHZ_PER_MHZ   1000.0f
+#define CHANNEL_MHZ(channel) (FMBand_KHz(channel) / KHZ_PER_MHZ) // For printing only
+
+#define SIGNAL_MONITOR_PERIOD 		  500 // ms
+#define SIGNAL_MONITOR_TIMEOUT 		  100 // ms to wait for the FM thread to read
+#define SIGNAL_MONITOR_MAX_DUTY		  10  // permille of I2C time the monitor may use
+#define NSEC_PER_MS 				  1000000
+
+#define CONTROL_SOCKET_PATH "/run/fm_receiver.sock"
+
+#define REPLAY_POLL  100  // ms between checks for the end of a replay or load test
+						  // and of the watchdog
+#define REPLAY_DRAIN 1000 // ms to let the last replayed or generated command finish
+
+#define SCAN_SETTLE       20000 // us bound on each channel probe
+
+#define SCANNER_DEV_PATH  I2C_1_DEV_PATH // Bus of the second, always muted tuner
+#define SCANNER_STEP      50    // ms between its probes, keeps its bus duty low
+
+/* SCHED_FIFO priorities, a larger number preempts a smaller one: the
+ * button and encoder tasks run above the FM and display tasks, and
+ * those above the monitors */
+#define HIGHER_PRIO 50
+#define LOWER_PRIO  20
+#define MONITOR_PRIO 10
+
+#define FM_COMMAND_BUDGET     150000 // us, a tune with injection probe and bus retries
+#define DISPLAY_BUDGET        5000   // us, one screen update
+#define BUTTON_BUDGET         1000   // us, one GPIO poll and its action
+#define SIGNAL_MONITOR_BUDGET ((SIGNAL_MONITOR_TIMEOUT * USEC_PER_MS) + 10000) // us, poll and wait
+
+#define STANDBY_MUTED     300   // s muted before the tuner goes to standby (-m)
+#define STANDBY_WAKE_CAP  20000 // us bound on the wait for lock after a wake
+
+#define FM_STACK_KB   64 // KB, high-water 10 KB with tune, scan and presets
+#define TASK_STACK_KB 32 // KB, high-water 9 KB (16 KB on the GPIO error path)
 
 static void* fmThreadFunc	 	   		 (void* arg); 
 static void* displayThreadFunc	   		 (void* arg);
@@ -39,6 +107,33 @@ static void* toggleDigitButtonThreadFunc (void* arg);
 static void* backButtonThreadFunc 	     (void* arg);
 static void* forwardButtonThreadFunc     (void* arg);
 static void* tuneButtonThreadFunc        (void* arg);
+static void* encoderThreadFunc           (void* arg);
+static void* signalMonitorThreadFunc     (void* arg);
+static void* controlServerThreadFunc     (void* arg);
+static void* scannerThreadFunc           (void* arg);
+static void* gpioSetupThreadFunc         (void* arg);
+static void  waitGpioReady               (void);
+static void  handleControlCommand        (const char *p_command, char *p_reply, size_t reply_size);
+static void  postCommand                 (uint8_t flag);
+static void  requestTune                 (uint16_t channel);
+#ifdef I2C_SIMULATOR
+static void  postLoadCommand             (LoadGen_Command command);
+#endif
+static int   scanBand                    (TEA5767_FM_module *p_device);
+static int   sweepBand                   (TEA5767_FM_module *p_scanner, FMScanner_Plan *p_plan, uint8_t full);
+static void  dumpStats                   (void);
+static void  printUsage                  (const char *p_name);
+static void  checkWatchdog               (void);
+static int   setTaskCpus                 (const char *p_spec);
+static int   isolateTasks                (const char *p_cpu);
+static void  printPlacement              (void);
+static void  tuneCompleted               (uint16_t channel, int lock_result, uint64_t settle_us, uint64_t request_us);
+static const char* tuneStateName         (uint8_t state);
+static uint64_t standbyDeadline          (uint64_t last_input_us, uint64_t muted_since_us);
+static void  setPowerState               (uint8_t state);
+static void  wakeCompleted               (int lock_result, uint64_t input_us, uint8_t mute);
+static const char* powerStateName        (uint8_t state);
+static uint16_t startChannel             (uint32_t freq_khz);
 
 
 // Mutex
@@ -48,102 +143,488 @@ static pthread_mutex_t freq_mutex  = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t audio_mutex = PTHREAD_MUTEX_INITIALIZER;
 /* To lock the global variable of standby mode*/
 static pthread_mutex_t digit_mutex  = PTHREAD_MUTEX_INITIALIZER;
-/* To lock global variable of search signal*/
-static pthread_mutex_t flag_mutex  = PTHREAD_MUTEX_INITIALIZER;
 /* To lock global variable of lcd update */
 static pthread_mutex_t lcd_update_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* To lock the signal monitor's status and mode exchange */
+static pthread_mutex_t signal_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* To lock the global variable of GPIO set up */
+static pthread_mutex_t gpio_ready_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 // Condition variable
-/* To signal that FM module to check the global flag for next action*/
-static pthread_cond_t check_flag_cond 	  = PTHREAD_COND_INITIALIZER;
 /* To signal LCD display to update*/
 static pthread_cond_t lcd_update_cond = PTHREAD_COND_INITIALIZER;
+/* To signal the signal monitor that a status read is done */
+static pthread_cond_t signal_poll_cond;	// FMClock_CondInit, for timed waits
+/* To signal the button tasks that their pins are set up */
+static pthread_cond_t gpio_ready_cond = PTHREAD_COND_INITIALIZER;
 
+/* Commands for the FM thread, posted to g_commands. Flags are OR'ed
+ * together so one poster never overwrites another's command. */
 typedef enum Flag {
-	AUDIO,
-	TUNE,
-	WAIT
+	WAIT        = 0x00,
+	AUDIO       = 0x01,
+	TUNE        = 0x02,
+	SIGNAL_MODE = 0x04,
+	SIGNAL_POLL = 0x08,
+	SCAN        = 0x10
 } Flag;
 
+/* A thread of the receiver and its timing contract */
+typedef struct Task {
+	void* (*p_func)(void*);	// Thread function, gets its DLMon_Task
+	int priority;			// SCHED_FIFO priority
+	uint8_t rt;				// 1 = input/FM path, moved to the reserved CPU by -i
+	uint32_t stack_kb;		// Stack size, measured high-water mark plus margin
+	DLMon_Task deadline;	// Period, execution budget and overrun action
+	uint64_t cpu_mask;		// CPUs the task may run on, 0 = any (-c, -i)
+	pthread_t thread;
+	uint8_t created;		// 1 if pthread_create succeeded
+} Task;
+
+/* Where the last tune stands, as shown on the display */
+typedef enum TuneState {
+	TUNING,		// PLL written, waiting for lock
+	LOCKED,		// READY flag seen (or bounded wait passed) with the right PLL
+	UNLOCKED	// Write failed or the PLL did not match
+} TuneState;
+
+/* What the tuner draws current for */
+typedef enum PowerState {
+	POWER_PLAYING,	// Tuned with audio on
+	POWER_MUTED,	// Tuned and muted, still drawing full current
+	POWER_STANDBY,	// STBY set, only the register image is kept
+	POWER_STATES
+} PowerState;
+
 
 // Global variables
-static float g_frequency = DEFAULT_FREQ;	// The tuned frequency
+static uint16_t g_channel = 0;	// The band channel to tune to
 static uint8_t g_audio = 1;		// if audio = 0, then mute.
 							    // if audio = 1, then unmute.
-static Flag g_flag = WAIT;		// Default flag is WAIT, or do nothing
+static CmdQueue g_commands;		// Pending Flag bits for the FM thread
 static uint8_t g_lcd_update = 0;   // If lcd_update = 1, update the display; else, do nothing
 static uint8_t g_digit = 0;		// If digit = 0, then modify the decimal digit; else left-most value
+static uint64_t g_start_us = 0;	// Monotonic time at process start
+static uint8_t g_gpio_ready = 0;	// If 1, the button pins are set up
+static uint16_t g_tuned_channel = 0;	// Channel of the last tune, locked by freq_mutex
+static TuneState g_tune_state = TUNING;	// Lock state of the last tune, locked by freq_mutex
+static uint64_t g_tune_settle_us = 0;	// Settle time of the last tune, locked by freq_mutex
+static uint32_t g_lock_timeouts = 0;	// Tunes that passed the bounded wait without READY
+static uint32_t g_lock_failures = 0;	// Tunes that failed or locked to the wrong PLL
+static LatHist g_settle_hist;			// PLL write to lock, locked by freq_mutex
+static LatHist g_audio_hist;			// Button release to lock, locked by freq_mutex
+static uint8_t g_auto_injection = 0;	// If 1, pick the injection side per channel
+static uint8_t g_sched_deadline = 0;	// If 1, move the monitored tasks to SCHED_DEADLINE
+static const char *g_control_path = CONTROL_SOCKET_PATH;	// Control server socket
+static const char *g_flight_path = FLIGHT_RECORD_FILE;	// Flight recorder dump file
+static const char *g_state_path = NULL;	// State file (-t), NULL for the default
+static const char *g_gpio_mem = NULL;		// Mapped GPIO banks (-G), NULL = sysfs reads
+static const char *g_trace_record = NULL;	// Button trace to record, NULL if none
+static const char *g_trace_replay = NULL;	// Button trace to replay instead of the GPIO
+static uint32_t g_replay_speed = 1;			// Replay speed, 0 = no waiting
+static uint8_t g_encoder_enabled = 0;		// If 1, tune with the rotary encoder (-e)
+static GPIO_Encoder g_encoder;				// Decoded by the encoder task
+static uint8_t g_load_test = 0;				// If 1, run the synthetic load then exit
+static uint32_t g_standby_muted_s = STANDBY_MUTED;	// Standby after muted this long, 0 = never
+static uint32_t g_standby_idle_s = 0;		// Standby after no input this long, 0 = never
+static uint8_t g_power_state = POWER_PLAYING;	// PowerState, locked by freq_mutex
+static uint64_t g_power_since_us = 0;		// When it was entered, locked by freq_mutex
+static uint64_t g_power_us[POWER_STATES];	// Time spent in each state before that
+static uint32_t g_standbys = 0;				// Entries into standby, locked by freq_mutex
+static uint32_t g_wakes = 0;				// Wakes on input, locked by freq_mutex
+static uint32_t g_wake_over_cap = 0;		// Wakes not locked within STANDBY_WAKE_CAP
+static LatHist g_wake_hist;					// First input to lock after standby, locked by freq_mutex
+#ifdef I2C_SIMULATOR
+static LoadGen_Config g_load;				// Synthetic load, set with -L
+static uint8_t g_virtual_clock = 0;			// If 1, run on the virtual clock (-V)
+#endif
+static TEA5767_InjectionStats g_injection_stats;	// Copy of the FM module's stats, locked by freq_mutex
+static TEA5767_RecoveryStats g_recovery_stats;		// Copy of the FM module's stats, locked by freq_mutex
 
+// Signal monitor exchange, locked by signal_mutex
+static SigMon_State g_sigmon;			// Smoothing and mode decision state
+static TEA5767_Status g_signal_status;	// Last status read by the FM thread
+static int8_t g_signal_result = 0;		// Result of the last status read
+static uint32_t g_signal_seq = 0;		// Bumped after every status read
+static uint32_t g_tune_seq = 0;			// Bumped after every tune
+static uint8_t g_signal_mono = 0;		// Mode requested by the monitor
+static uint8_t g_signal_hcc = 0;
+static uint8_t g_signal_snc = 0;
+static uint64_t g_signal_cost_us = 0;	// I2C time of the last status read
+static uint64_t g_signal_max_cost_us = 0;
+static uint64_t g_signal_busy_us = 0;	// Total I2C time spent for the monitor
+static uint64_t g_signal_start_us = 0;	// When the monitor started sampling
+static uint32_t g_signal_polls = 0;		// Completed status reads
+static uint32_t g_signal_timeouts = 0;	// Polls the FM thread did not answer in time
+static uint32_t g_signal_period_ms = SIGNAL_MONITOR_PERIOD;
 
-int main() {
+// Background scanner on the second tuner
+static uint32_t g_scan_period_s = 0;	// Sweep every this long, 0 = no scanner (-S)
+static CmdQueue g_scanner_commands;		// SCAN requests for the scanner thread
+static uint32_t g_scanner_failures = 0;	// Sweeps a bus error cut short, atomic
 
-	/* Set up the GPIO */
-	GPIO_SetDirection(TOGGLE_DIGIT_BUTTON, 			 GPIO_IN);
-	GPIO_SetDirection(RADIO_AUDIO_BUTTON, 			 GPIO_IN);
-	GPIO_SetDirection(FREQUENCY_TUNE_BACK_BUTTON, 	 GPIO_IN);
-	GPIO_SetDirection(FREQUENCY_TUNE_FORWARD_BUTTON, GPIO_IN);
-	GPIO_SetDirection(RADIO_TUNE_BUTTON, 			 GPIO_IN);
 
-     // Thread attributes
-    struct sched_param hParam;
-    struct sched_param lParam;
-    pthread_attr_t hAttr;
-    pthread_attr_t lAttr;
-    
-    // Initialize the attributes
-    (void) pthread_attr_init (&hAttr);
-    (void) pthread_attr_init (&lAttr);
-    // Get the schedule param from the attribute
-    (void) pthread_attr_getschedparam (&hAttr, &hParam);
-    (void) pthread_attr_getschedparam (&lAttr, &lParam);
-    // Modify the priorities
-    hParam.sched_priority = HIGHER_PRIO;
-    lParam.sched_priority = LOWER_PRIO;
-    // Set the attributes with the new params 
-    (void) pthread_attr_setschedparam (&hAttr, &hParam);
-    (void) pthread_attr_setschedparam (&lAttr, &lParam);
-    // Set the scheduling policy to real-time FIFO
-    (void) pthread_attr_setschedpolicy(&hAttr, SCHED_FIFO);
-    (void) pthread_attr_setschedpolicy(&lAttr, SCHED_FIFO);
-
-
-    pthread_t fm_thread;
-    pthread_t display_thread;
-    pthread_t audio_button_thread;
-    pthread_t toggle_digit_button_thread;
-    pthread_t back_button_thread;
-    pthread_t forward_button_thread;
-    pthread_t tune_button_thread;
-
-	(void) pthread_create(&fm_thread, &lAttr, &fmThreadFunc, NULL);
-	(void) pthread_create(&display_thread, &lAttr, &displayThreadFunc, NULL);
-	(void) pthread_create(&audio_button_thread, &hAttr, &audioButtonThreadFunc, NULL);
-	(void) pthread_create(&toggle_digit_button_thread, &hAttr, &toggleDigitButtonThreadFunc, NULL);
-	(void) pthread_create(&back_button_thread, &hAttr, &backButtonThreadFunc, NULL);
-	(void) pthread_create(&forward_button_thread, &hAttr, &forwardButtonThreadFunc, NULL);
-	(void) pthread_create(&tune_button_thread, &hAttr, &tuneButtonThreadFunc, NULL);
-
-
-
-	(void) pthread_join(fm_thread, NULL);
-	(void) pthread_join(display_thread, NULL);
-	(void) pthread_join(audio_button_thread, NULL);
-	(void) pthread_join(toggle_digit_button_thread, NULL);
-	(void) pthread_join(back_button_thread, NULL);
-	(void) pthread_join(forward_button_thread, NULL);
-	(void) pthread_join(tune_button_thread, NULL);
-
-	// Destroy mutex
-    (void) pthread_mutex_destroy(&freq_mutex); 
-    (void) pthread_mutex_destroy(&audio_mutex);
-    (void) pthread_mutex_destroy(&digit_mutex);
-    (void) pthread_mutex_destroy(&flag_mutex);
-    (void) pthread_mutex_destroy(&lcd_update_mutex);
-
-    // Destroy condition variables
-    (void) pthread_cond_destroy(&check_flag_cond);
-    (void) pthread_cond_destroy(&lcd_update_cond);
+/* Every thread, its priority and its deadline contract. Periodic
+ * tasks are checked against their period too; event driven tasks
+ * (period 0) only against the budget of one job. */
+static Task g_tasks[] = {
+	/* Function                   Priority      RT  Stack (KB)     Name           Period (us)                          Budget (us)            On overrun */
+	{ &fmThreadFunc,                LOWER_PRIO,   1, FM_STACK_KB,   { "fm",          0,                                   FM_COMMAND_BUDGET,     DLMON_LOG } },
+	{ &displayThreadFunc,           LOWER_PRIO,   0, TASK_STACK_KB, { "display",     0,                                   DISPLAY_BUDGET,        DLMON_LOG } },
+	{ &audioButtonThreadFunc,       HIGHER_PRIO,  1, TASK_STACK_KB, { "btn_audio",   BUTTON_WAIT * USEC_PER_MS,           BUTTON_BUDGET,         DLMON_ESCALATE } },
+	{ &toggleDigitButtonThreadFunc, HIGHER_PRIO,  1, TASK_STACK_KB, { "btn_digit",   BUTTON_WAIT * USEC_PER_MS,           BUTTON_BUDGET,         DLMON_ESCALATE } },
+	{ &backButtonThreadFunc,        HIGHER_PRIO,  1, TASK_STACK_KB, { "btn_back",    BUTTON_WAIT * USEC_PER_MS,           BUTTON_BUDGET,         DLMON_ESCALATE } },
+	{ &forwardButtonThreadFunc,     HIGHER_PRIO,  1, TASK_STACK_KB, { "btn_forward", BUTTON_WAIT * USEC_PER_MS,           BUTTON_BUDGET,         DLMON_ESCALATE } },
+	{ &tuneButtonThreadFunc,        HIGHER_PRIO,  1, TASK_STACK_KB, { "btn_tune",    BUTTON_WAIT * USEC_PER_MS,           BUTTON_BUDGET,         DLMON_ESCALATE } },
+	{ &encoderThreadFunc,           HIGHER_PRIO,  1, TASK_STACK_KB, { "encoder",     0,                                   BUTTON_BUDGET,         DLMON_ESCALATE } },
+	{ &signalMonitorThreadFunc,     MONITOR_PRIO, 0, TASK_STACK_KB, { "signal",      SIGNAL_MONITOR_PERIOD * USEC_PER_MS, SIGNAL_MONITOR_BUDGET, DLMON_DEGRADE } },
+	{ &controlServerThreadFunc,     MONITOR_PRIO, 0, TASK_STACK_KB, { "control",     0,                                   0,                     DLMON_LOG } },
+	{ &scannerThreadFunc,           MONITOR_PRIO, 0, TASK_STACK_KB, { "scanner",     0,                                   0,                     DLMON_LOG } }
+};
+#define NUM_TASKS (sizeof(g_tasks) / sizeof(g_tasks[0]))
+
+int main(int argc, char *argv[]) {
+
+	sigset_t sigset;
+	int sig = 0;
+	int opt = 0;
+
+	g_start_us = StartupTrace_Init();
+	// Before anything allocates: arenas, static stdout, locked memory
+	(void) MemBudget_Init();
+
+	/* Parse the command line options */
+	while ((opt = getopt(argc, argv, "ab:c:def:G:I:i:k:L:m:p:r:S:s:t:Vx:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 'a':
+			g_auto_injection = 1;
+			break;
+		case 'b':
+			if (FMBand_Select(optarg) < 0)
+			{
+				printUsage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'c':
+			if (setTaskCpus(optarg) < 0)
+			{
+				printUsage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'd':
+			g_sched_deadline = 1;
+			break;
+		case 'e':
+			g_encoder_enabled = 1;
+			break;
+		case 'f':
+			g_flight_path = optarg;
+			break;
+		case 'G':
+			g_gpio_mem = optarg;
+			break;
+		case 'I':
+			g_standby_idle_s = (uint32_t) strtoul(optarg, NULL, 10);
+			break;
+		case 'i':
+			if (isolateTasks(optarg) < 0)
+			{
+				printUsage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'k':
+			if (TEA5767_SetClockFrequency((uint32_t) strtoul(optarg, NULL, 10)) < 0)
+			{
+				printUsage(argv[0]);
+				return 1;
+			}
+			break;
+#ifdef I2C_SIMULATOR
+		case 'L':
+			if (LoadGen_Parse(optarg, &g_load) < 0)
+			{
+				printUsage(argv[0]);
+				return 1;
+			}
+			g_load_test = 1;
+			break;
+#endif
+		case 'm':
+			g_standby_muted_s = (uint32_t) strtoul(optarg, NULL, 10);
+			break;
+		case 'p':
+			g_trace_replay = optarg;
+			break;
+		case 'r':
+			g_trace_record = optarg;
+			break;
+		case 'S':
+			g_scan_period_s = (uint32_t) strtoul(optarg, NULL, 10);
+			break;
+		case 's':
+			g_control_path = optarg;
+			break;
+		case 't':
+			g_state_path = optarg;
+			break;
+#ifdef I2C_SIMULATOR
+		case 'V':
+			g_virtual_clock = 1;
+			break;
+#endif
+		case 'x':
+			g_replay_speed = (uint32_t) strtoul(optarg, NULL, 10);
+			break;
+		default:
+			printUsage(argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+#ifdef I2C_SIMULATOR
+	/* Simulated time: every sleep and timeout of every task jumps to
+	 * its deadline as soon as nothing else can run. It starts at the
+	 * process start, so the set-up so far takes no time either. */
+	if (g_virtual_clock)
+	{
+		FMClock_UseVirtual(g_start_us);
+	}
+#endif
+	FMClock_CondInit(&signal_poll_cond);
+
+	/* Block the control signals in every thread; main waits for them */
+	(void) sigemptyset(&sigset);
+	(void) sigaddset(&sigset, SIGUSR1);
+	(void) sigaddset(&sigset, SIGUSR2);
+	(void) sigaddset(&sigset, SIGINT);
+	(void) sigaddset(&sigset, SIGTERM);
+	(void) pthread_sigmask(SIG_BLOCK, &sigset, NULL);
+
+	/* Flight recorder: always on, dumped on a crash, SIGUSR2 or a
+	 * watchdog trip */
+	FlightRec_Init(g_flight_path);
+	FlightRec_CatchFatal();
+	(void) FlightRec_RegisterThread("main");
+
+	/* Set up the GPIO while the state is restored and the FM thread
+	 * brings the tuner up: each pin is an open, write and close of
+	 * sysfs, and only the button tasks need them. It exits early, so
+	 * it keeps a glibc stack rather than a slot of the budget */
+	pthread_t gpio_setup;
+	pthread_attr_t setup_attr;
+	(void) pthread_attr_init(&setup_attr);
+	(void) pthread_attr_setdetachstate(&setup_attr, PTHREAD_CREATE_DETACHED);
+	(void) pthread_attr_setstacksize(&setup_attr, TASK_STACK_KB * 1024);
+	FMClock_AddThreads(1);
+	if (pthread_create(&gpio_setup, &setup_attr, &gpioSetupThreadFunc, NULL) != 0)
+	{
+		FMClock_AddThreads(-1);
+		(void) gpioSetupThreadFunc(NULL);
+	}
+	(void) pthread_attr_destroy(&setup_attr);
+
+	/* Restore the last station and audio state straight from the
+	 * mapped state file, so the FM thread can tune right away. A load
+	 * test runs from the defaults unless a state file is given. */
+	const char *p_state_path = (g_state_path != NULL) ? g_state_path : (g_load_test ? NULL : FM_STATE_FILE);
+	(void) FMStore_Open((g_trace_replay != NULL) ? NULL : p_state_path);
+	g_channel = startChannel(FMStore_Get()->last_freq_khz);
+	LatHist_Init(&g_settle_hist);
+	LatHist_Init(&g_audio_hist);
+	LatHist_Init(&g_wake_hist);
+	CmdQueue_Init(&g_commands);
+	CmdQueue_Init(&g_scanner_commands);
+	g_audio = FMStore_Get()->audio;
+
+	/* Button trace: log the presses, or feed them from a recording.
+	 * A replay starts from the recorded station and leaves the state
+	 * file alone, so every run of a trace does the same work. */
+	if (g_trace_replay != NULL)
+	{
+		uint32_t freq_khz = 0;
+		if (ButtonTrace_Replay(g_trace_replay, g_replay_speed, &freq_khz, &g_audio) < 0)
+		{
+			return 1;
+		}
+		g_channel = startChannel(freq_khz);
+	}
+	else if ((g_trace_record != NULL)
+			 && (ButtonTrace_Record(g_trace_record, FMStore_Get()->last_freq_khz, g_audio) < 0))
+	{
+		return 1;
+	}
+	g_tuned_channel = g_channel;
+	g_power_state = g_audio ? POWER_PLAYING : POWER_MUTED;
+	g_power_since_us = g_start_us;
+
+	/* Counters for external scrapers; without shm they stay private */
+	(void) FMMetrics_Open(FM_METRICS_NAME);
+	(void) FMMetrics_RegisterThread("main");
+	FMMetrics_SetGauge(FM_G_FREQUENCY_KHZ, FMBand_KHz(g_channel));
+	FMMetrics_SetGauge(FM_G_AUDIO, g_audio);
+	FMMetrics_SetGauge(FM_G_POWER_STATE, g_power_state);
+
+	StartupTrace_Mark(STARTUP_STATE);
+
+	/* Create every task of the table with its priority */
+	struct sched_param param;
+	pthread_attr_t attr;
+	char cpus[RTSCHED_CPU_LIST_SIZE];
+	uint8_t task = 0;
+	uint8_t fifo_refused = 0;
+	int error = 0;
+
+	for (task = 0; task < NUM_TASKS; task++)
+	{
+		(void) pthread_attr_init(&attr);
+		// Set the scheduling policy to real-time FIFO; without
+		// EXPLICIT_SCHED the thread would inherit main's policy.
+		// The policy goes first: the priority is checked against it.
+		(void) pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		(void) pthread_attr_getschedparam(&attr, &param);
+		param.sched_priority = g_tasks[task].priority;
+		(void) pthread_attr_setschedparam(&attr, &param);
+		(void) pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		if (g_tasks[task].cpu_mask != 0)
+		{
+			(void) RTSched_SetAttrAffinity(&attr, g_tasks[task].cpu_mask);
+		}
+		if (MemBudget_SetStack(&attr, g_tasks[task].stack_kb * 1024) < 0)
+		{
+			printf("WARNING: main - No stack for %s, using the default\n", g_tasks[task].deadline.p_name);
+		}
+
+		DLMon_Init(&g_tasks[task].deadline);
+		if (g_sched_deadline && (g_tasks[task].deadline.budget_us > 0))
+		{
+			/* Switches itself once its WCET has been measured */
+			DLMon_RequestReservation(&g_tasks[task].deadline);
+		}
+		FMClock_AddThreads(1);
+		error = pthread_create(&g_tasks[task].thread, &attr, g_tasks[task].p_func, &g_tasks[task].deadline);
+		if ((error == EINVAL) && (g_tasks[task].cpu_mask != 0))
+		{
+			/* Online, but outside the CPUs this process may use */
+			RTSched_FormatCpuList(g_tasks[task].cpu_mask, cpus, sizeof(cpus));
+			printf("WARNING: main - CPUs %s not allowed for %s, it runs on any CPU\n", cpus,
+				   g_tasks[task].deadline.p_name);
+			g_tasks[task].cpu_mask = 0;
+			(void) RTSched_SetAttrAffinity(&attr, RTSched_OnlineMask());
+			error = pthread_create(&g_tasks[task].thread, &attr, g_tasks[task].p_func, &g_tasks[task].deadline);
+		}
+		if (error == EPERM)
+		{
+			/* No real-time privileges: run the task time-shared */
+			if (!fifo_refused)
+			{
+				printf("WARNING: main - SCHED_FIFO refused, tasks run time-shared\n");
+				fifo_refused = 1;
+			}
+			(void) pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+			error = pthread_create(&g_tasks[task].thread, &attr, g_tasks[task].p_func, &g_tasks[task].deadline);
+		}
+		g_tasks[task].created = (error == 0);
+		if (error != 0)
+		{
+			printf("ERROR: main - Failed to create %s: %s\n", g_tasks[task].deadline.p_name, strerror(error));
+			FMClock_AddThreads(-1);
+		}
+		(void) pthread_attr_destroy(&attr);
+	}
+	StartupTrace_Mark(STARTUP_TASKS);
+	/* On the virtual clock, let every task reach its first wait, so a
+	 * task that exits early is listed the same way on every run */
+	if (FMClock_IsVirtual())
+	{
+		FMClock_SleepUs(1);
+	}
+	printPlacement();
+
+#ifdef I2C_SIMULATOR
+	/* Synthetic load: the sources post to the FM thread as device 0 */
+	if (g_load_test && (LoadGen_Start(&g_load, &postLoadCommand, &g_commands) < 0))
+	{
+		return 1;
+	}
+#endif
+
+	/* The tasks run forever; main serves the stats dump (SIGUSR1),
+	 * the flight record dump (SIGUSR2) and the watchdog, and exits
+	 * cleanly on SIGINT/SIGTERM. A replay or load test also ends once
+	 * its last command has been served, with a final dump. */
+	struct timespec replay_poll = { 0, REPLAY_POLL * NSEC_PER_MS };
+	struct timespec no_wait = { 0, 0 };
+	uint32_t drained_ms = 0;
+	uint8_t finished = 0;
+	while (1)
+	{
+		/* On the virtual clock main polls, so it is a task like any other */
+		if (FMClock_IsVirtual())
+		{
+			sig = sigtimedwait(&sigset, NULL, &no_wait);
+			if (sig < 0)
+			{
+				FMClock_SleepUs(REPLAY_POLL * USEC_PER_MS);
+			}
+		}
+		else
+		{
+			sig = sigtimedwait(&sigset, NULL, &replay_poll);
+		}
+		if (sig < 0)
+		{
+			checkWatchdog();
+			if ((g_trace_replay != NULL) || g_load_test)
+			{
+				finished = ButtonTrace_Done();
+#ifdef I2C_SIMULATOR
+				finished = finished || LoadGen_Done();
+#endif
+				drained_ms = (finished && (CmdQueue_Pending(&g_commands) == WAIT))
+							 ? (drained_ms + REPLAY_POLL) : 0;
+				if (drained_ms >= REPLAY_DRAIN)
+				{
+					dumpStats();
+					break;
+				}
+			}
+			continue;
+		}
+		if (sig == SIGUSR1)
+		{
+			dumpStats();
+			continue;
+		}
+		if (sig == SIGUSR2)
+		{
+			if (FlightRec_Dump(SIGUSR2) < 0)
+			{
+				perror("ERROR: main - Failed to dump the flight record");
+			}
+			else
+			{
+				printf("INFO: main - Flight record dumped to %s\n", FlightRec_Path());
+			}
+			continue;
+		}
+		break;
+	}
+
+	// The tasks still wait on the mutexes and condition variables, so
+	// they are left for exit to tear down (pthread_cond_destroy would
+	// block forever on a condition with waiters)
 
+    // Flush the button trace being recorded
+    ButtonTrace_Close();
+    // Flush and unmap the state file
+    FMStore_Close();
+    // Remove the metrics segment
+    FMMetrics_Close();
 
 	return 0;
 }
@@ -157,52 +638,194 @@ int main() {
  ****************************************************************/
 static void* fmThreadFunc (void* arg)
 {
-	/* Open the I2C bus at i2c_2 */
-	int i2c_bus;	// File descriptor for I2C bus
-	if (I2C_OpenBus(&i2c_bus, I2C_2_DEV_PATH) < 0)
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+
+	/* Open the I2C bus at i2c_2, shared through its scheduler */
+	I2CSched_Bus *p_bus = I2CSched_Open(I2C_2_DEV_PATH);
+	if (p_bus == NULL)
 	{
 		perror("ERROR: FmThreadFunc - Failed to open I2C bus");
 		return NULL;
 	}
+	StartupTrace_Mark(STARTUP_I2C);
+
+	uint8_t pending = WAIT;			// Commands taken from g_commands
+	uint64_t posted_us[CMDQ_BITS];	// When each of them was first posted
+	uint16_t channel = 0;			// Channel being tuned
+	int lock_result = 0;			// Result of the wait for lock
+	uint64_t settle_us = 0;			// PLL write to lock
+	TEA5767_Status status;			// Status read for the signal monitor
+	int8_t result = 0;				// Result of the status read
+	uint64_t poll_start_us = 0;		// Timestamps around the status read
+	uint64_t poll_end_us = 0;
+	uint8_t mono = 0;				// Signal mode requested by the monitor
+	uint8_t hcc = 0;
+	uint8_t snc = 0;
+	uint8_t mute = 0;				// Audio state a wake comes back with
+	uint64_t last_input_us = 0;		// Last tune, audio or scan command
+	uint64_t muted_since_us = 0;	// Last audio command
+	uint64_t standby_at_us = 0;		// When to go to standby, 0 = never
+	uint64_t input_us = 0;			// First post of the input that wakes
+	uint8_t waking = 0;				// 1 = the tune below also wakes the tuner
+	uint8_t bit = 0;
+	char event[CTL_LINE_SIZE];		// Event line for the control server
 
 	/* Create an FM module */
 	TEA5767_FM_module fm_device;
-	fm_device.i2c_bus = &i2c_bus;
+	fm_device.p_bus = p_bus;
 	fm_device.device_addr = FM_MODULE_ADDR;
+	fm_device.auto_injection = g_auto_injection;
+	fm_device.bus_class = I2CSCHED_INTERACTIVE;
 
-	/* Initialize the fm module and tune to its default frequency*/
-	if (TEA5767_Init(&fm_device) < 0)
+	/* Initialize the fm module and tune to the restored frequency.
+	 * No lock is held across the bus: a sleep in a transfer must not
+	 * block the tasks that read the station. */
+	(void) pthread_mutex_lock(&freq_mutex);
+	(void) pthread_mutex_lock(&audio_mutex);
+	channel = g_channel;
+	mute = !g_audio;
+	(void) pthread_mutex_unlock(&audio_mutex);
+	(void) pthread_mutex_unlock(&freq_mutex);
+	if (TEA5767_Init(&fm_device, channel, mute) < 0)
 	{
 		perror("ERROR: FmThreadFunc - Failed to init the FM module");
 		return NULL;
 	}
+	StartupTrace_Mark(STARTUP_PLL);
+	(void) pthread_mutex_lock(&freq_mutex);
+	g_injection_stats = fm_device.injection_stats;
+	(void) pthread_mutex_unlock(&freq_mutex);
+	printf("INFO: FmThreadFunc - %s band, %u channels on a %u Hz clock, worst tuning error %u Hz\n",
+		   FMBand_Get()->p_name, fm_device.channels, TEA5767_GetClockFrequency(), fm_device.pll_error_hz);
+
+	/* Time to audio at start-up: wait for the first lock */
+	lock_result = TEA5767_WaitForLock(&fm_device, LOCK_TIMEOUT, &settle_us);
+	StartupTrace_Mark(STARTUP_LOCK);
+	tuneCompleted(channel, lock_result, settle_us, g_start_us);
+	(void) pthread_mutex_lock(&lcd_update_mutex);
+	g_lcd_update = 1;
+	(void) pthread_mutex_unlock(&lcd_update_mutex);
+	FMClock_CondSignal(&lcd_update_cond);
+	last_input_us = FMClock_NowUs();
+	muted_since_us = last_input_us;
 
 	/* Inifity loop starts */
 	while (1)
 	{
-		(void) pthread_mutex_lock(&flag_mutex);
-		while (g_flag == WAIT)
+		/* Take every pending command at once, so posters never wait
+		 * behind a bus transfer. Idle until the standby time at most. */
+		standby_at_us = fm_device.standby_mode ? 0 : standbyDeadline(last_input_us, muted_since_us);
+		pending = CmdQueue_TakeTimed(&g_commands, posted_us, standby_at_us);
+		FMMetrics_SetGauge(FM_G_QUEUE_DEPTH, 0);
+
+		/* Muted or idle long enough: only the register image is kept */
+		if (pending == WAIT)
+		{
+			fm_device.bus_class = I2CSCHED_BACKGROUND;
+			if (TEA5767_StandbyON(&fm_device) < 0)
+			{
+				perror("ERROR: FmThreadFunc - Failed to enter standby.");
+			}
+			else
+			{
+				setPowerState(POWER_STANDBY);
+				CtlServer_Publish("EVENT POWER STANDBY");
+			}
+			continue;
+		}
+
+		/* A scan is a background sweep of many tunes, not one command */
+		if (!(pending & SCAN))
+		{
+			DLMon_JobStart(p_task);
+		}
+
+		/* User input goes ahead of every other client of the bus */
+		fm_device.bus_class = I2CSCHED_INTERACTIVE;
+
+		/* Any input wakes the tuner first, with the audio state it
+		 * asks for, and waits a bounded time for the PLL to lock. A
+		 * tune wakes it straight onto the new station instead, in
+		 * the same transfer, and its lock is the wake's. */
+		waking = 0;
+		if (fm_device.standby_mode && (pending & (TUNE | AUDIO | SCAN)))
 		{
-			(void) pthread_cond_wait(&check_flag_cond, &flag_mutex);
+			input_us = FMClock_NowUs();
+			for (bit = 0; bit < CMDQ_BITS; bit++)
+			{
+				if (((pending & (TUNE | AUDIO | SCAN)) & (1 << bit)) && (posted_us[bit] < input_us))
+				{
+					input_us = posted_us[bit];
+				}
+			}
+			(void) pthread_mutex_lock(&audio_mutex);
+			mute = !g_audio;
+			(void) pthread_mutex_unlock(&audio_mutex);
+
+			if (pending & TUNE)
+			{
+				waking = 1;
+			}
+			else
+			{
+				settle_us = 0;
+				lock_result = TEA5767_Wake(&fm_device, mute);
+				if (lock_result == 0)
+				{
+					lock_result = TEA5767_WaitForLock(&fm_device, STANDBY_WAKE_CAP, &settle_us);
+				}
+				wakeCompleted(lock_result, input_us, mute);
+			}
 		}
 
-		/* Check for which flag it is */
-		switch(g_flag)
+		/* TUNE flag: tell fm module to tune to the frequency and
+		 * only report the tune done once the PLL has locked */
+		if (pending & TUNE)
 		{
-		/* TUNE flag: tell fm module to tune to the frequency */
-		case TUNE:
 			(void) pthread_mutex_lock(&freq_mutex);
-			if (TEA5767_SetFrequency(&fm_device, g_frequency) < 0)
+			channel = g_channel;
+			g_tune_state = TUNING;
+			(void) pthread_mutex_unlock(&freq_mutex);
+
+			settle_us = 0;
+			if ((waking ? TEA5767_WakeChannel(&fm_device, channel, mute)
+						: TEA5767_TuneChannel(&fm_device, channel)) < 0)
 			{
 				perror("ERROR: FmThreadFunc - Failed to set the frequency.");
+				lock_result = -1;
 			}
-			(void) pthread_mutex_unlock(&freq_mutex);
-			break;
+			else
+			{
+				lock_result = TEA5767_WaitForLock(&fm_device, LOCK_TIMEOUT, &settle_us);
+			}
+			if (waking)
+			{
+				/* Over the cap if it did not lock within it */
+				wakeCompleted(((lock_result == 0) && (settle_us <= STANDBY_WAKE_CAP)) ? 0 : -1,
+							  input_us, mute);
+			}
+
+			/* Time to audio starts at the first unserved request */
+			tuneCompleted(channel, lock_result, settle_us, posted_us[__builtin_ctz(TUNE)]);
+
+			/* A new station: the monitor restarts its smoothing */
+			(void) pthread_mutex_lock(&signal_mutex);
+			g_tune_seq++;
+			(void) pthread_mutex_unlock(&signal_mutex);
+		}
 
 		/* AUDIO flag: tell fm module to mute or unmute the audio */
-		case AUDIO:
+		if (pending & AUDIO)
+		{
+			/* Applied outside the lock; a press meanwhile posts again */
 			(void) pthread_mutex_lock(&audio_mutex);
-			if (g_audio == 0)
+			mute = !g_audio;
+			(void) pthread_mutex_unlock(&audio_mutex);
+			if (mute)
 			{
 				/* Mute the audio */
 				if (TEA5767_Mute(&fm_device) < 0)
@@ -218,25 +841,88 @@ static void* fmThreadFunc (void* arg)
 					perror("ERROR: FmThreadFunc - Failed to unmute the audio.");
 				}
 			}
-			(void) pthread_mutex_unlock(&audio_mutex);
-			break;
+			FlightRec_Log(FLIGHTREC_AUDIO, !mute, 0, 0);
+			FMStore_SetAudio(!mute);
+			FMMetrics_SetGauge(FM_G_AUDIO, !mute);
+			CtlServer_Publish(mute ? "EVENT AUDIO MUTED" : "EVENT AUDIO ON");
 
-		/* Default case */
-		default:
-			printf("INFO: FmThreadFunc - Default case - Do nothing.");
-		} // End of switch case
+			/* The muted timer starts over */
+			muted_since_us = FMClock_NowUs();
+			setPowerState(mute ? POWER_MUTED : POWER_PLAYING);
+		}
+
+		/* SCAN flag: sweep the band and keep the stations found */
+		if (pending & SCAN)
+		{
+			(void) scanBand(&fm_device);
+		}
 
-		/* Reset the flag to WAIT */
-		g_flag = WAIT;
-		(void) pthread_mutex_unlock(&flag_mutex);
+		/* The monitor's traffic is periodic, behind user input */
+		fm_device.bus_class = I2CSCHED_PERIODIC;
 
-		/* Signal display to update */
-		(void) pthread_mutex_lock(&lcd_update_mutex);
-		g_lcd_update = 1;
-		(void) pthread_mutex_unlock(&lcd_update_mutex);
-		(void) pthread_cond_signal(&lcd_update_cond);
+		/* SIGNAL_MODE flag: apply the monitor's mono/HCC/SNC choice */
+		if (pending & SIGNAL_MODE)
+		{
+			(void) pthread_mutex_lock(&signal_mutex);
+			mono = g_signal_mono;
+			hcc = g_signal_hcc;
+			snc = g_signal_snc;
+			(void) pthread_mutex_unlock(&signal_mutex);
+			if (TEA5767_SetSignalMode(&fm_device, mono, hcc, snc) < 0)
+			{
+				perror("ERROR: FmThreadFunc - Failed to set the signal mode.");
+			}
+			else
+			{
+				(void) snprintf(event, sizeof(event), "EVENT SIGNAL %s%s%s",
+								mono ? "MONO" : "STEREO", hcc ? " HCC" : "", snc ? " SNC" : "");
+				CtlServer_Publish(event);
+			}
+		}
+
+		/* SIGNAL_POLL flag: read the status for the signal monitor */
+		if (pending & SIGNAL_POLL)
+		{
+			/* In standby nothing is received: answer without the bus */
+			poll_start_us = FMClock_NowUs();
+			result = fm_device.standby_mode ? -1 : TEA5767_ReadStatus(&fm_device, &status);
+			poll_end_us = FMClock_NowUs();
 
+			(void) pthread_mutex_lock(&signal_mutex);
+			g_signal_status = status;
+			g_signal_result = result;
+			g_signal_cost_us = poll_end_us - poll_start_us;
+			g_signal_seq++;
+			(void) pthread_mutex_unlock(&signal_mutex);
+			FMClock_CondSignal(&signal_poll_cond);
+		}
+
+		/* Publish the driver statistics for the stats dump */
+		(void) pthread_mutex_lock(&freq_mutex);
+		g_injection_stats = fm_device.injection_stats;
+		g_recovery_stats = fm_device.recovery_stats;
+		(void) pthread_mutex_unlock(&freq_mutex);
+
+		/* Persist the new state; msync is batched inside the store */
+		(void) FMStore_Sync(0);
+
+		/* Signal display to update on user-visible changes only */
+		if (pending & (TUNE | AUDIO))
+		{
+			(void) pthread_mutex_lock(&lcd_update_mutex);
+			g_lcd_update = 1;
+			(void) pthread_mutex_unlock(&lcd_update_mutex);
+			FMClock_CondSignal(&lcd_update_cond);
+		}
 
+		/* Input restarts the inactivity timer */
+		if (pending & (TUNE | AUDIO | SCAN))
+		{
+			last_input_us = FMClock_NowUs();
+		}
+
+		CmdQueue_Done(&g_commands, pending, posted_us);
+		(void) DLMon_JobEnd(p_task);
 	} // End of inifity loop
 
 }// End of fmThreadFunc
@@ -249,23 +935,16 @@ static void* fmThreadFunc (void* arg)
  ****************************************************************/
 static void* displayThreadFunc (void* arg)
 {
-	/* Terminal display at beginning */
-	/* Format line 1 with tuned Frequency */
-	/* Print Project header */
-	printf("--- FM RADIO RECEIVER --\n");
-	printf("--- 87.5MHz - 108MHz ---\n");
-	printf("-------- Vy Phan -------\n");
-	printf("------------------------\n");
-	(void) pthread_mutex_lock(&freq_mutex);
-	printf("Frequency: %.1f\n", g_frequency);
-	(void) pthread_mutex_unlock(&freq_mutex);
-	/* Format line 2 with audio status */
-	(void) pthread_mutex_lock(&audio_mutex);
-	printf("Audio: %s\n", g_audio ? "ON" : "MUTED");
-	(void) pthread_mutex_unlock(&audio_mutex);
-	printf("------------------------\n");
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+
+	uint8_t first_screen = 1;	// The header goes with the first update
 
-	
+	/* Nothing is drawn before the first tune: the terminal would only
+	 * compete with the tuner bring-up for the CPU */
 	/* Inifity loop starts */
 	while (1)
 	{
@@ -273,22 +952,42 @@ static void* displayThreadFunc (void* arg)
 		(void) pthread_mutex_lock(&lcd_update_mutex);
 		while (g_lcd_update == 0)
 		{
-			(void) pthread_cond_wait(&lcd_update_cond, &lcd_update_mutex);
+			(void) FMClock_CondWait(&lcd_update_cond, &lcd_update_mutex, 0);
 		}
 		/* Reset the lcd update signal */
 		g_lcd_update = 0;
 		(void) pthread_mutex_unlock(&lcd_update_mutex);
+		DLMon_JobStart(p_task);
+
+		/* Terminal display at beginning: print Project header */
+		if (first_screen)
+		{
+			printf("--- FM RADIO RECEIVER --\n");
+			printf("--- %s %.1f - %.1fMHz ---\n", FMBand_Get()->p_name,
+				   FMBand_Get()->low_khz / KHZ_PER_MHZ, FMBand_Get()->high_khz / KHZ_PER_MHZ);
+			printf("-------- Vy Phan -------\n");
+		}
 
 		/* Update the LCD display with the two formatted lines */
-		printf("\n------------------------\n");
+		printf(first_screen ? "------------------------\n" : "\n------------------------\n");
 		(void) pthread_mutex_lock(&freq_mutex);
-		printf("Frequency: %.1f\n", g_frequency);
+		printf("Frequency: %.1f\n", CHANNEL_MHZ(g_tuned_channel));
+		printf("Status: %s (%llu.%llu ms)\n", tuneStateName(g_tune_state),
+			   (unsigned long long) (g_tune_settle_us / USEC_PER_MS),
+			   (unsigned long long) ((g_tune_settle_us % USEC_PER_MS) / 100));
 		(void) pthread_mutex_unlock(&freq_mutex);
 		/* Format line 2 with audio status */
 		(void) pthread_mutex_lock(&audio_mutex);
 		printf("Audio: %s\n", g_audio ? "ON" : "MUTED");
 		(void) pthread_mutex_unlock(&audio_mutex);
         printf("------------------------\n");
+		if (first_screen)
+		{
+			StartupTrace_Mark(STARTUP_DISPLAY);
+			StartupTrace_Print();
+			first_screen = 0;
+		}
+		(void) DLMon_JobEnd(p_task);
 	} // End of inifity loop
     return NULL;
 }
@@ -305,12 +1004,20 @@ static void* displayThreadFunc (void* arg)
  ****************************************************************/
 static void* audioButtonThreadFunc (void* arg)
 {
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+	waitGpioReady();
+
 	int8_t isPressed = 0; // current button's state
     int8_t lastState = 0; // last button's state
     while (1)
     {
+        DLMon_JobStart(p_task);
         /* Read the current button's state from GPIO */
-        isPressed = GPIO_ReadValue(RADIO_AUDIO_BUTTON);
+        isPressed = ButtonTrace_ReadValue(RADIO_AUDIO_BUTTON);
         if (isPressed < 0)
         {
         	perror("ERROR: audioButtonThreadFunc - Failed to read the button press.");
@@ -321,6 +1028,9 @@ static void* audioButtonThreadFunc (void* arg)
          * button-press action */
         if (!isPressed && lastState)
         {
+            FMMetrics_Add(FM_M_BUTTON_EVENTS, 1);
+            FM_PROBE1(button_event, RADIO_AUDIO_BUTTON);
+            FlightRec_Log(FLIGHTREC_BUTTON, RADIO_AUDIO_BUTTON, 0, 0);
             (void) pthread_mutex_lock (&audio_mutex);
             if (g_audio == 1)
             {
@@ -336,15 +1046,13 @@ static void* audioButtonThreadFunc (void* arg)
             (void) pthread_mutex_unlock(&audio_mutex);
 
 	        /* Change flag and send a signal to check flag*/
-	        (void) pthread_mutex_lock (&flag_mutex);
-	        g_flag = AUDIO;
-	        (void) pthread_mutex_unlock (&flag_mutex);
-	        (void) pthread_cond_signal (&check_flag_cond);
+	        postCommand(AUDIO);
         }
         /* Update the last button's state with the current */
         lastState = isPressed;
+        (void) DLMon_JobEnd(p_task);
         /* Sleep for 10ms */
-        (void) usleep (BUTTON_WAIT * USEC_PER_MS);
+        FMClock_SleepUs(BUTTON_WAIT * USEC_PER_MS);
     }
     return NULL;
 }
@@ -359,12 +1067,20 @@ static void* audioButtonThreadFunc (void* arg)
  ****************************************************************/
 static void* toggleDigitButtonThreadFunc (void* arg)
 {
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+	waitGpioReady();
+
 	uint8_t isPressed = 0; // current button's state
     uint8_t lastState = 0; // last button's state
     while (1)
     {
+        DLMon_JobStart(p_task);
         /* Read the current button's state from GPIO */
-        isPressed = GPIO_ReadValue(TOGGLE_DIGIT_BUTTON);
+        isPressed = ButtonTrace_ReadValue(TOGGLE_DIGIT_BUTTON);
         if (isPressed < 0)
         {
         	perror("ERROR: toggleDigitButtonThreadFunc - Failed to read the button press.");
@@ -375,6 +1091,9 @@ static void* toggleDigitButtonThreadFunc (void* arg)
          * button-press action */
         if (!isPressed && lastState)
         {
+            FMMetrics_Add(FM_M_BUTTON_EVENTS, 1);
+            FM_PROBE1(button_event, TOGGLE_DIGIT_BUTTON);
+            FlightRec_Log(FLIGHTREC_BUTTON, TOGGLE_DIGIT_BUTTON, 0, 0);
             (void) pthread_mutex_lock(&digit_mutex);
             if (g_digit == 1)
             {
@@ -391,8 +1110,9 @@ static void* toggleDigitButtonThreadFunc (void* arg)
         }
         /* Update the last button's state with the current */
         lastState = isPressed;
+        (void) DLMon_JobEnd(p_task);
         /* Sleep for 10ms */
-        (void) usleep (BUTTON_WAIT * USEC_PER_MS);
+        FMClock_SleepUs(BUTTON_WAIT * USEC_PER_MS);
     }
     return NULL;
 }
@@ -406,12 +1126,21 @@ static void* toggleDigitButtonThreadFunc (void* arg)
  ****************************************************************/
 static void* backButtonThreadFunc (void* arg)
 {
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+	waitGpioReady();
+
 	uint8_t isPressed = 0; // current button's state
     uint8_t lastState = 0; // last button's state
+    uint16_t step = 0;     // channels per press
     while (1)
     {
+        DLMon_JobStart(p_task);
         /* Read the current button's state from GPIO */
-        isPressed = GPIO_ReadValue(FREQUENCY_TUNE_BACK_BUTTON);
+        isPressed = ButtonTrace_ReadValue(FREQUENCY_TUNE_BACK_BUTTON);
         if (isPressed < 0)
         {
         	perror("ERROR: backButtonThreadFunc - Failed to read the button press.");
@@ -422,34 +1151,27 @@ static void* backButtonThreadFunc (void* arg)
          * button-press action */
         if (!isPressed && lastState)
         {
+            FMMetrics_Add(FM_M_BUTTON_EVENTS, 1);
+            FM_PROBE1(button_event, FREQUENCY_TUNE_BACK_BUTTON);
+            FlightRec_Log(FLIGHTREC_BUTTON, FREQUENCY_TUNE_BACK_BUTTON, 0, 0);
             (void) pthread_mutex_lock(&digit_mutex);
             (void) pthread_mutex_lock(&freq_mutex);
-            if (g_digit == 1)
-            {
-                if (g_frequency > 88.4)
-                /* Decrease the frequency value by one */
-            	{
-                    g_frequency -= 1.0;
-                }
-            }
-            else
+            /* Step down 1MHz or one channel, staying in the band */
+            step = (g_digit == 1) ? (1000 / FMBand_Get()->step_khz) : 1;
+            if (g_channel >= step)
             {
-                if (g_frequency > 87.5)
-                /* Decrease the frequency value by 0.1 */
-                {
-                    g_frequency -= 0.1;
-                }
-
+                g_channel -= step;
             }
-            printf("\rTuning Frequency: %.1f", g_frequency);
+            printf("\rTuning Frequency: %.1f", CHANNEL_MHZ(g_channel));
             fflush(stdout);
             (void) pthread_mutex_unlock(&freq_mutex);
             (void) pthread_mutex_unlock(&digit_mutex);
         }
         /* Update the last button's state with the current */
         lastState = isPressed;
+        (void) DLMon_JobEnd(p_task);
         /* Sleep for 10ms */
-        (void) usleep (BUTTON_WAIT * USEC_PER_MS);
+        FMClock_SleepUs(BUTTON_WAIT * USEC_PER_MS);
     }
     return NULL;
 }
@@ -462,12 +1184,21 @@ static void* backButtonThreadFunc (void* arg)
  ****************************************************************/
 static void* forwardButtonThreadFunc (void* arg)
 {
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+	waitGpioReady();
+
 	uint8_t isPressed = 0; // current button's state
     uint8_t lastState = 0; // last button's state
+    uint16_t step = 0;     // channels per press
     while (1)
     {
+        DLMon_JobStart(p_task);
         /* Read the current button's state from GPIO */
-        isPressed = GPIO_ReadValue(FREQUENCY_TUNE_FORWARD_BUTTON);
+        isPressed = ButtonTrace_ReadValue(FREQUENCY_TUNE_FORWARD_BUTTON);
         if (isPressed < 0)
         {
         	perror("ERROR: forwardButtonThreadFunc - Failed to read the button press.");
@@ -478,33 +1209,27 @@ static void* forwardButtonThreadFunc (void* arg)
          * button-press action */
         if (!isPressed && lastState)
         {
+            FMMetrics_Add(FM_M_BUTTON_EVENTS, 1);
+            FM_PROBE1(button_event, FREQUENCY_TUNE_FORWARD_BUTTON);
+            FlightRec_Log(FLIGHTREC_BUTTON, FREQUENCY_TUNE_FORWARD_BUTTON, 0, 0);
             (void) pthread_mutex_lock(&digit_mutex);
             (void) pthread_mutex_lock(&freq_mutex);
-            if (g_digit == 1)
-            {
-                if (g_frequency < 107.0)
-                /* Increase the frequency value by one */
-            	{
-                    g_frequency += 1.0;
-                }
-            }
-            else
+            /* Step up 1MHz or one channel, staying in the band */
+            step = (g_digit == 1) ? (1000 / FMBand_Get()->step_khz) : 1;
+            if ((g_channel + step) < FMBand_Channels())
             {
-                if (g_frequency < 107.9)
-                /* Increase the frequency value by 0.1 */
-                {
-                    g_frequency += 0.1;
-                }
+                g_channel += step;
             }
-            printf("\rTuning Frequency: %.1f", g_frequency);
+            printf("\rTuning Frequency: %.1f", CHANNEL_MHZ(g_channel));
             fflush(stdout);
             (void) pthread_mutex_unlock(&freq_mutex);
             (void) pthread_mutex_unlock(&digit_mutex);
         }
         /* Update the last button's state with the current */
         lastState = isPressed;
+        (void) DLMon_JobEnd(p_task);
         /* Sleep for 10ms */
-        (void) usleep (BUTTON_WAIT * USEC_PER_MS);
+        FMClock_SleepUs(BUTTON_WAIT * USEC_PER_MS);
     }
     return NULL;
 }
@@ -517,12 +1242,20 @@ static void* forwardButtonThreadFunc (void* arg)
  ****************************************************************/
  static void* tuneButtonThreadFunc (void* arg)
 {
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+	waitGpioReady();
+
 	uint8_t isPressed = 0; // current button's state
     uint8_t lastState = 0; // last button's state
     while (1)
     {
+        DLMon_JobStart(p_task);
         /* Read the current button's state from GPIO */
-        isPressed = GPIO_ReadValue(RADIO_TUNE_BUTTON);
+        isPressed = ButtonTrace_ReadValue(RADIO_TUNE_BUTTON);
         if (isPressed < 0)
         {
         	perror("ERROR: tuneButtonThreadFunc - Failed to read the button press.");
@@ -533,16 +1266,1303 @@ static void* forwardButtonThreadFunc (void* arg)
          * button-press action */
         if (!isPressed && lastState)
         {
-            (void) pthread_mutex_lock(&flag_mutex);
-            g_flag = TUNE;
-            (void) pthread_cond_signal(&check_flag_cond);
-            (void) pthread_mutex_unlock(&flag_mutex);
+            FMMetrics_Add(FM_M_BUTTON_EVENTS, 1);
+            FM_PROBE1(button_event, RADIO_TUNE_BUTTON);
+            FlightRec_Log(FLIGHTREC_BUTTON, RADIO_TUNE_BUTTON, 0, 0);
+            postCommand(TUNE);
         }
         /* Update the last button's state with the current */
         lastState = isPressed;
+        (void) DLMon_JobEnd(p_task);
         /* Sleep for 10ms */
-        (void) usleep (BUTTON_WAIT * USEC_PER_MS);
+        FMClock_SleepUs(BUTTON_WAIT * USEC_PER_MS);
     }
     return NULL;
 
-}
\ No newline at end of file
+}
+/****************************************************************
+ * Function Name : encoderThreadFunc
+ * Description   : Decode the rotary encoder on every edge and tune
+ * 					by the channels it moved. In a replay the pins
+ * 					come from the trace, read in turn, one edge each.
+ * Returns       : N/A
+ * Params        @arg : arguments of the thread function
+ ****************************************************************/
+static void* encoderThreadFunc (void* arg)
+{
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	uint8_t replaying = (g_trace_replay != NULL);
+	uint8_t state = 0;		// A/B state, A in bit 1
+	int level = 0;
+	int result = 0;
+	int32_t steps = 0;		// Channels moved since the last tune
+	int32_t channel = 0;
+
+	FMClock_RegisterThread();
+	if (!g_encoder_enabled && !replaying)
+	{
+		return NULL;
+	}
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+
+	GPIOEncoder_Init(&g_encoder, ENCODER_A_PIN, ENCODER_B_PIN);
+	if (replaying)
+	{
+		/* A replayed pin starts low until its first edge */
+		g_encoder.state = 0;
+	}
+	else if (GPIOEncoder_Open(&g_encoder) < 0)
+	{
+		perror("ERROR: encoderThreadFunc - Failed to open the encoder.");
+		return NULL;
+	}
+	else
+	{
+		ButtonTrace_LogEdge(ENCODER_A_PIN, g_encoder.state >> 1);
+		ButtonTrace_LogEdge(ENCODER_B_PIN, g_encoder.state & 1);
+		// Woken by the edges, not by the clock
+		FMClock_UnregisterThread();
+	}
+
+	while (1)
+	{
+		if (replaying)
+		{
+			FMClock_SleepUs(ENCODER_REPLAY_POLL * USEC_PER_MS);
+			DLMon_JobStart(p_task);
+			level = ButtonTrace_ReadValue(ENCODER_A_PIN);
+			(void) GPIOEncoder_Feed(&g_encoder, (uint8_t) ((level << 1) | (g_encoder.state & 1)), FMClock_NowUs());
+			level = ButtonTrace_ReadValue(ENCODER_B_PIN);
+			(void) GPIOEncoder_Feed(&g_encoder, (uint8_t) ((g_encoder.state & 2) | level), FMClock_NowUs());
+		}
+		else
+		{
+			result = GPIOEncoder_Wait(&g_encoder, -1, &state);
+			if (result < 0)
+			{
+				perror("ERROR: encoderThreadFunc - Failed to read the encoder.");
+				return NULL;
+			}
+			DLMon_JobStart(p_task);
+			ButtonTrace_LogEdge(ENCODER_A_PIN, state >> 1);
+			ButtonTrace_LogEdge(ENCODER_B_PIN, state & 1);
+			(void) GPIOEncoder_Feed(&g_encoder, state, FMClock_NowUs());
+		}
+
+		/* Every detent tunes, staying in the band; tunes posted while
+		 * the FM thread is busy coalesce into the last one */
+		steps = GPIOEncoder_Take(&g_encoder);
+		if (steps != 0)
+		{
+			FMMetrics_Add(FM_M_BUTTON_EVENTS, 1);
+			FM_PROBE1(button_event, ENCODER_A_PIN);
+			FlightRec_Log(FLIGHTREC_BUTTON, ENCODER_A_PIN, 0, 0);
+			(void) pthread_mutex_lock(&freq_mutex);
+			channel = (int32_t) g_channel + steps;
+			channel = (channel < 0) ? 0 : channel;
+			channel = (channel >= FMBand_Channels()) ? (FMBand_Channels() - 1) : channel;
+			(void) pthread_mutex_unlock(&freq_mutex);
+			requestTune((uint16_t) channel);
+		}
+		(void) DLMon_JobEnd(p_task);
+	}
+	return NULL;
+}
+
+/****************************************************************
+ * Function Name : gpioSetupThreadFunc
+ * Description   : Set up the button pins, then let the button
+ *                 tasks start polling them
+ * Returns       : N/A
+ * Params        @arg : arguments of the thread function, unused
+ ****************************************************************/
+static void* gpioSetupThreadFunc (void* arg)
+{
+	(void) arg;
+	FMClock_RegisterThread();
+
+	/* Set up the GPIO */
+	GPIO_SetDirection(TOGGLE_DIGIT_BUTTON, 			 GPIO_IN);
+	GPIO_SetDirection(RADIO_AUDIO_BUTTON, 			 GPIO_IN);
+	GPIO_SetDirection(FREQUENCY_TUNE_BACK_BUTTON, 	 GPIO_IN);
+	GPIO_SetDirection(FREQUENCY_TUNE_FORWARD_BUTTON, GPIO_IN);
+	GPIO_SetDirection(RADIO_TUNE_BUTTON, 			 GPIO_IN);
+
+	/* Read the buttons straight from the bank registers; sysfs stays
+	 * the fallback if the banks cannot be mapped */
+	if (g_gpio_mem != NULL)
+	{
+		static const uint8_t buttons[] = { RADIO_AUDIO_BUTTON, TOGGLE_DIGIT_BUTTON, FREQUENCY_TUNE_BACK_BUTTON,
+										   FREQUENCY_TUNE_FORWARD_BUTTON, RADIO_TUNE_BUTTON };
+		if (GPIOMmap_Open(g_gpio_mem, buttons, sizeof(buttons)) < 0)
+		{
+			printf("ERROR: Reading the buttons through sysfs instead of %s\n", g_gpio_mem);
+		}
+	}
+	StartupTrace_Mark(STARTUP_GPIO);
+
+	(void) pthread_mutex_lock(&gpio_ready_mutex);
+	g_gpio_ready = 1;
+	(void) pthread_mutex_unlock(&gpio_ready_mutex);
+	FMClock_CondBroadcast(&gpio_ready_cond);
+	return NULL;
+}
+
+/****************************************************************
+ * Function Name : waitGpioReady
+ * Description   : Wait until the button pins are set up
+ * Returns       : void
+ * Params        : N/A
+ ****************************************************************/
+static void waitGpioReady (void)
+{
+	(void) pthread_mutex_lock(&gpio_ready_mutex);
+	while (g_gpio_ready == 0)
+	{
+		(void) FMClock_CondWait(&gpio_ready_cond, &gpio_ready_mutex, 0);
+	}
+	(void) pthread_mutex_unlock(&gpio_ready_mutex);
+}
+
+/****************************************************************
+ * Function Name : signalMonitorThreadFunc
+ * Description   : Periodically ask the FM thread for the level and
+ * 					stereo flag, smooth them and request mono/HCC/SNC
+ * 					changes through the FM thread's command path.
+ * 					The period stretches so the monitor never uses
+ * 					more than SIGNAL_MONITOR_MAX_DUTY permille of
+ * 					the I2C bus.
+ * Returns       : N/A
+ * Params        @arg : arguments of the thread function
+ ****************************************************************/
+static void* signalMonitorThreadFunc (void* arg)
+{
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	FMClock_RegisterThread();
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+
+	uint32_t seen_seq = 0;		// Status read sequence before the poll
+	uint32_t tune_seq = 0;		// Last tune the smoothing belongs to
+	uint32_t period_ms = SIGNAL_MONITOR_PERIOD;
+	uint64_t cost_us = 0;		// I2C time of this poll
+	uint8_t post_mode = 0;		// 1 to send a SIGNAL_MODE command
+	uint64_t deadline_us = 0;	// When to stop waiting for the read
+	int ret = 0;
+
+	(void) pthread_mutex_lock(&signal_mutex);
+	(void) memset(&g_sigmon, 0, sizeof(g_sigmon));
+	g_signal_start_us = FMClock_NowUs();
+	(void) pthread_mutex_unlock(&signal_mutex);
+
+	while (1)
+	{
+		FMClock_SleepUs(period_ms * USEC_PER_MS);
+		DLMon_JobStart(p_task);
+
+		/* Ask the FM thread to read the status */
+		(void) pthread_mutex_lock(&signal_mutex);
+		seen_seq = g_signal_seq;
+		(void) pthread_mutex_unlock(&signal_mutex);
+
+		postCommand(SIGNAL_POLL);
+
+		/* Wait a bounded time for the read; the FM thread may be busy */
+		deadline_us = FMClock_NowUs() + (SIGNAL_MONITOR_TIMEOUT * USEC_PER_MS);
+
+		(void) pthread_mutex_lock(&signal_mutex);
+		ret = 0;
+		while ((g_signal_seq == seen_seq) && (ret == 0))
+		{
+			ret = FMClock_CondWait(&signal_poll_cond, &signal_mutex, deadline_us);
+		}
+		if (g_signal_seq == seen_seq)
+		{
+			g_signal_timeouts++;
+			(void) pthread_mutex_unlock(&signal_mutex);
+			(void) DLMon_JobEnd(p_task);
+			continue;
+		}
+
+		/* Account the sampling cost */
+		cost_us = g_signal_cost_us;
+		g_signal_polls++;
+		g_signal_busy_us += cost_us;
+		if (cost_us > g_signal_max_cost_us)
+		{
+			g_signal_max_cost_us = cost_us;
+		}
+
+		/* A new tune restarts the smoothing and the default mode */
+		post_mode = 0;
+		if (tune_seq != g_tune_seq)
+		{
+			tune_seq = g_tune_seq;
+			SigMon_Reset(&g_sigmon);
+			post_mode = 1;
+		}
+		if ((g_signal_result == 0)
+			&& SigMon_AddSample(&g_sigmon, g_signal_status.level, g_signal_status.stereo))
+		{
+			post_mode = 1;
+		}
+		FMMetrics_SetGauge(FM_G_SIGNAL_LEVEL, g_sigmon.level_q8 / SIGMON_Q8);
+		g_signal_mono = g_sigmon.mono;
+		g_signal_hcc = g_sigmon.hcc;
+		g_signal_snc = g_sigmon.snc;
+
+		/* Cap the I2C duty cycle: stretch the period if one read
+		 * costs more than the allowed share of it */
+		period_ms = SIGNAL_MONITOR_PERIOD;
+		if (((cost_us * 1000) / SIGNAL_MONITOR_MAX_DUTY) > ((uint64_t) period_ms * USEC_PER_MS))
+		{
+			period_ms = (uint32_t) ((cost_us * 1000) / SIGNAL_MONITOR_MAX_DUTY / USEC_PER_MS) + 1;
+		}
+		/* Over budget: sample half as often until it runs clean again */
+		if (DLMon_Degraded(p_task))
+		{
+			period_ms *= 2;
+		}
+		p_task->period_us = period_ms * USEC_PER_MS;
+		g_signal_period_ms = period_ms;
+		(void) pthread_mutex_unlock(&signal_mutex);
+
+		/* Writes only go through the FM thread */
+		if (post_mode)
+		{
+			postCommand(SIGNAL_MODE);
+		}
+		(void) DLMon_JobEnd(p_task);
+	}
+	return NULL;
+}
+
+/****************************************************************
+ * Function Name : dumpStats
+ * Description   : Print the runtime statistics (on SIGUSR1)
+ * Returns       : N/A
+ * Params        : N/A
+ ****************************************************************/
+static void dumpStats (void)
+{
+	uint64_t elapsed_us = 0;
+
+	printf("\n--------- STATS --------\n");
+
+	/* Signal monitor: smoothed signal, mode and its cost on the bus */
+	(void) pthread_mutex_lock(&signal_mutex);
+	elapsed_us = FMClock_NowUs() - g_signal_start_us;
+	printf("Signal: level %u.%02u/15, stereo %u%%, %s%s%s\n",
+		   g_sigmon.level_q8 / SIGMON_Q8, ((g_sigmon.level_q8 % SIGMON_Q8) * 100) / SIGMON_Q8,
+		   (g_sigmon.stereo_q8 * 100) / SIGMON_Q8,
+		   g_sigmon.mono ? "MONO" : "STEREO", g_sigmon.hcc ? " HCC" : "", g_sigmon.snc ? " SNC" : "");
+	printf("Signal monitor: %u polls, %u timeouts, %u mode changes\n",
+		   g_signal_polls, g_signal_timeouts, g_sigmon.mode_changes);
+	printf("Signal monitor: cost avg %llu us, max %llu us, period %u ms\n",
+		   (unsigned long long) (g_signal_polls ? (g_signal_busy_us / g_signal_polls) : 0),
+		   (unsigned long long) g_signal_max_cost_us, g_signal_period_ms);
+	printf("Signal monitor: I2C duty %llu.%llu permille (cap %u)\n",
+		   (unsigned long long) (elapsed_us ? ((g_signal_busy_us * 1000) / elapsed_us) : 0),
+		   (unsigned long long) (elapsed_us ? (((g_signal_busy_us * 10000) / elapsed_us) % 10) : 0),
+		   SIGNAL_MONITOR_MAX_DUTY);
+	(void) pthread_mutex_unlock(&signal_mutex);
+
+	/* Tune completion: PLL settle time and true time to audio */
+	(void) pthread_mutex_lock(&freq_mutex);
+	printf("Tune: %u lock timeouts, %u failures\n", g_lock_timeouts, g_lock_failures);
+	LatHist_Print("Tune settle", &g_settle_hist);
+	LatHist_Print("Time to audio", &g_audio_hist);
+	(void) pthread_mutex_unlock(&freq_mutex);
+
+	/* Power: time in each state and what waking up costs */
+	(void) pthread_mutex_lock(&freq_mutex);
+	{
+		uint64_t now_us = FMClock_NowUs();
+		uint64_t state_us = 0;
+		uint8_t state = 0;
+		printf("Power:");
+		for (state = 0; state < POWER_STATES; state++)
+		{
+			state_us = g_power_us[state] + ((state == g_power_state) ? (now_us - g_power_since_us) : 0);
+			printf("%s %s %llu.%llu s (%llu%%)", (state > 0) ? "," : "", powerStateName(state),
+				   (unsigned long long) (state_us / USEC_PER_SEC),
+				   (unsigned long long) ((state_us / (USEC_PER_SEC / 10)) % 10),
+				   (unsigned long long) ((now_us > g_start_us) ? ((state_us * 100) / (now_us - g_start_us)) : 0));
+		}
+		printf("\n");
+		printf("Power: %u standbys, %u wakes, %u over the %u ms wake cap\n",
+			   g_standbys, g_wakes, g_wake_over_cap, STANDBY_WAKE_CAP / USEC_PER_MS);
+		LatHist_Print("Wake to lock", &g_wake_hist);
+	}
+	(void) pthread_mutex_unlock(&freq_mutex);
+
+	/* Command hand-off to the FM thread: coalescing and tail latency */
+	CmdQueue_Print("Commands", &g_commands);
+
+	/* Background scanner: how fresh the station list is */
+	if (g_scan_period_s > 0)
+	{
+		FMScanner_Result scanned;
+		if (FMScanner_Read(&scanned) < 0)
+		{
+			(void) memset(&scanned, 0, sizeof(scanned));
+		}
+		printf("Scanner: %u sweeps, %u failed, %u stations, last %llu ms ago in %llu ms, %u read retries\n",
+			   scanned.sweeps, __atomic_load_n(&g_scanner_failures, __ATOMIC_RELAXED), scanned.count,
+			   (unsigned long long) (scanned.sweeps ? ((FMClock_NowUs() - scanned.swept_us) / USEC_PER_MS) : 0),
+			   (unsigned long long) (scanned.sweep_us / USEC_PER_MS), FMScanner_ReadRetries());
+		printf("Scanner: %u full sweeps (last %llu ms), %u incremental (last %llu ms), %llu probes, %llu saved (%llu%%), %u changes\n",
+			   scanned.plan.full_sweeps, (unsigned long long) (scanned.plan.full_us / USEC_PER_MS),
+			   scanned.plan.incremental_sweeps, (unsigned long long) (scanned.plan.incremental_us / USEC_PER_MS),
+			   (unsigned long long) scanned.plan.probes, (unsigned long long) scanned.plan.probes_saved,
+			   (unsigned long long) ((scanned.plan.probes + scanned.plan.probes_saved)
+									 ? ((scanned.plan.probes_saved * 100) / (scanned.plan.probes + scanned.plan.probes_saved)) : 0),
+			   scanned.plan.changes);
+		printf("Scanner: station list converged within %llu ms (a full sweep takes %llu ms)\n",
+			   (unsigned long long) (scanned.plan.converge_us / USEC_PER_MS),
+			   (unsigned long long) (scanned.plan.full_us / USEC_PER_MS));
+	}
+
+	/* Deadline monitor: budget, WCET and jitter of every task */
+	{
+		uint32_t utilization = 0;
+		uint32_t reserved = 0;
+		uint8_t task = 0;
+		for (task = 0; task < NUM_TASKS; task++)
+		{
+			DLMon_Print(&g_tasks[task].deadline);
+			utilization += DLMon_Utilization(&g_tasks[task].deadline);
+			if (g_tasks[task].deadline.policy == RTSCHED_DEADLINE)
+			{
+				reserved += (g_tasks[task].deadline.runtime_us * 1000) / g_tasks[task].deadline.reserve_period_us;
+			}
+		}
+		printf("Periodic tasks at WCET use %u.%u%% of one CPU\n", utilization / 10, utilization % 10);
+		printf("SCHED_DEADLINE reservations: %u.%u%% of one CPU\n", reserved / 10, reserved % 10);
+	}
+
+	/* Memory: stack high-water marks, VSZ and RSS */
+	MemBudget_Print();
+
+	/* Input and bus traffic, comparable between runs of one trace */
+	{
+		BTrace_Stats trace_stats;
+		ButtonTrace_GetStats(&trace_stats);
+		printf("Buttons: %llu presses, %llu commands, trace %u edges",
+			   (unsigned long long) FMMetrics_Total(FM_M_BUTTON_EVENTS),
+			   (unsigned long long) FMMetrics_Total(FM_M_COMMANDS), trace_stats.events);
+		if (g_trace_replay != NULL)
+		{
+			printf(" of %u (%u skipped) at speed %u, %llu ms", trace_stats.total, trace_stats.skipped,
+				   trace_stats.speed, (unsigned long long) (trace_stats.elapsed_us / USEC_PER_MS));
+		}
+		printf("\n");
+		if (g_encoder_enabled || (g_trace_replay != NULL))
+		{
+			GPIOEnc_Stats encoder_stats;
+			GPIOEncoder_GetStats(&g_encoder, &encoder_stats);
+			printf("Encoder: %u detents (net %d), %u channels, %u transitions, %u skipped states recovered, %u lost\n",
+				   encoder_stats.detents, encoder_stats.position, encoder_stats.steps,
+				   encoder_stats.transitions, encoder_stats.skipped, encoder_stats.invalid);
+		}
+		printf("I2C traffic: %llu reads, %llu writes, %llu bytes, %llu writes elided\n",
+			   (unsigned long long) FMMetrics_Total(FM_M_I2C_READS),
+			   (unsigned long long) FMMetrics_Total(FM_M_I2C_WRITES),
+			   (unsigned long long) FMMetrics_Total(FM_M_I2C_BYTES),
+			   (unsigned long long) FMMetrics_Total(FM_M_I2C_ELIDED));
+	}
+
+	/* Control server */
+	{
+		CtlServer_Stats ctl_stats;
+		CtlServer_GetStats(&ctl_stats);
+		printf("Control: %u clients (peak %u), %u subscribers, %u accepted, %u rejected\n",
+			   ctl_stats.clients, ctl_stats.peak_clients, ctl_stats.subscribers,
+			   ctl_stats.accepted, ctl_stats.rejected);
+		printf("Control: %u commands, %u events, %u event lines sent, %u events dropped, %u slow clients dropped\n",
+			   ctl_stats.commands, ctl_stats.events, ctl_stats.events_sent,
+			   ctl_stats.events_dropped, ctl_stats.slow_dropped);
+	}
+
+	/* I2C error recovery */
+	(void) pthread_mutex_lock(&freq_mutex);
+	printf("I2C errors: %u NAK, %u timeout, %u bus, %u fd, %u other\n",
+		   g_recovery_stats.errors[I2C_ERR_NAK], g_recovery_stats.errors[I2C_ERR_TIMEOUT],
+		   g_recovery_stats.errors[I2C_ERR_BUS], g_recovery_stats.errors[I2C_ERR_FD],
+		   g_recovery_stats.errors[I2C_ERR_OTHER]);
+	printf("I2C recovery: %u retries, %u reopens, %u replays, %u recovered, %u failed\n",
+		   g_recovery_stats.retries, g_recovery_stats.reopens, g_recovery_stats.replays,
+		   g_recovery_stats.recoveries, g_recovery_stats.failures);
+	LatHist_Print("I2C recovery time", &g_recovery_stats.recovery_hist);
+	(void) pthread_mutex_unlock(&freq_mutex);
+	I2CSched_Print();
+
+#ifdef I2C_SIMULATOR
+	{
+		I2CSim_Stats sim_stats;
+		I2CSim_GetStats(&sim_stats);
+		printf("Simulator: %u reads, %u writes, injected %u NAK, %u timeout, %u lost fd\n",
+			   sim_stats.reads, sim_stats.writes, sim_stats.naks, sim_stats.timeouts, sim_stats.lost);
+	}
+	LoadGen_Print();
+#endif
+
+	/* Injection side selection: probe cost and cache efficiency */
+	if (g_auto_injection)
+	{
+		(void) pthread_mutex_lock(&freq_mutex);
+		printf("Injection: %u probes (%u high, %u low), %u cache hits, hit rate %u%%\n",
+			   g_injection_stats.probes, g_injection_stats.high_side, g_injection_stats.low_side,
+			   g_injection_stats.cache_hits,
+			   (g_injection_stats.probes + g_injection_stats.cache_hits)
+			   ? (g_injection_stats.cache_hits * 100) / (g_injection_stats.probes + g_injection_stats.cache_hits) : 0);
+		printf("Injection: first-tune extra latency avg %llu us, max %llu us\n",
+			   (unsigned long long) (g_injection_stats.probes ? (g_injection_stats.probe_us / g_injection_stats.probes) : 0),
+			   (unsigned long long) g_injection_stats.probe_max_us);
+		(void) pthread_mutex_unlock(&freq_mutex);
+	}
+
+	/* Start-up: process start to first audible tune */
+	StartupTrace_Print();
+
+	printf("------------------------\n");
+	fflush(stdout);
+}
+
+/****************************************************************
+ * Function Name : printUsage
+ * Description   : Print the command line options
+ * Returns       : N/A
+ * Params        @p_name: the program name
+ ****************************************************************/
+static void printUsage (const char *p_name)
+{
+	printf("Usage: %s [options]\n", p_name);
+	printf("  -a        auto-select high/low side injection per channel\n");
+	printf("  -b BAND   US (default, 200kHz, 75us), EU (100kHz, 50us) or JP (76 - 91MHz)\n");
+	printf("  -c T=CPUS run task T (e.g. fm, btn_tune, btn_*) on CPUS (e.g. 1 or 0,2-3)\n");
+	printf("  -d        run the monitored tasks under SCHED_DEADLINE (falls back to FIFO)\n");
+	printf("  -e        tune with a rotary encoder on P9_11 (A) and P9_13 (B)\n");
+	printf("  -f PATH   flight recorder dump file (default %s)\n", FLIGHT_RECORD_FILE);
+	printf("  -G PATH   read the buttons from the mapped GPIO banks: %s, or a stand-in file\n", GPIOMMAP_DEV_MEM);
+	printf("  -I SECS   put the tuner in standby after SECS without input (default never)\n");
+	printf("  -i CPU    reserve CPU for the input and FM tasks, keep the others off it\n");
+	printf("  -k HZ     TEA5767 clock: %u (default), %u or %u\n", CLOCK_32768HZ, CLOCK_13MHZ, CLOCK_6500KHZ);
+#ifdef I2C_SIMULATOR
+	printf("  -L SPEC   run a synthetic load, then exit; SPEC is KEY=VALUE,... with sources,\n");
+	printf("            devices, rate (events/s), mix (tune/audio/poll %%), seconds, seed\n");
+#endif
+	printf("  -m SECS   put the tuner in standby after SECS muted (default %u, 0 = never)\n", STANDBY_MUTED);
+	printf("  -p TRACE  replay the buttons from TRACE instead of the GPIO, then exit\n");
+	printf("  -r TRACE  record the button presses to TRACE\n");
+	printf("  -S SECS   sweep the band every SECS on a second tuner on I2C-1 (default off)\n");
+	printf("  -s PATH   control socket path (default %s)\n", CONTROL_SOCKET_PATH);
+	printf("  -t PATH   state file (default %s)\n", FM_STATE_FILE);
+#ifdef I2C_SIMULATOR
+	printf("  -V        run on a virtual clock: sleeps and timeouts take no real time\n");
+#endif
+	printf("  -x SPEED  replay SPEED times faster (default 1, 0 = no waiting)\n");
+	printf("  -h        show this help\n");
+}
+
+/****************************************************************
+ * Function Name : checkWatchdog
+ * Description   : Dump the flight record once when a monitored task
+ * 					has been in the same job for WATCHDOG_MS; it
+ * 					re-arms when no task is stuck
+ * Returns       : N/A
+ * Params        : N/A
+ ****************************************************************/
+static void checkWatchdog (void)
+{
+	static uint8_t tripped = 0;
+	uint64_t now_us = FMClock_NowUs();
+	uint64_t start_us = 0;
+	uint8_t task = 0;
+
+	for (task = 0; task < NUM_TASKS; task++)
+	{
+		start_us = __atomic_load_n(&g_tasks[task].deadline.start_us, __ATOMIC_RELAXED);
+		if ((g_tasks[task].deadline.budget_us > 0) && (start_us != 0) && (now_us > start_us)
+			&& ((now_us - start_us) >= (WATCHDOG_MS * USEC_PER_MS)))
+		{
+			break;
+		}
+	}
+	if (task == NUM_TASKS)
+	{
+		tripped = 0;
+		return;
+	}
+	if (tripped)
+	{
+		return;
+	}
+	tripped = 1;
+	printf("WARNING: main - Watchdog: task %s stuck for %llu ms\n", g_tasks[task].deadline.p_name,
+		   (unsigned long long) ((now_us - start_us) / USEC_PER_MS));
+	if (FlightRec_Dump(FLIGHTREC_WATCHDOG) == 0)
+	{
+		printf("INFO: main - Flight record dumped to %s\n", FlightRec_Path());
+	}
+}
+
+/****************************************************************
+ * Function Name : tuneCompleted
+ * Description   : Record the outcome of a tune: lock state, settle
+ * 					and time-to-audio histograms, persisted station
+ * Returns       : N/A
+ * Params        @channel : the tuned channel
+ * 				 @lock_result : result of TEA5767_WaitForLock
+ * 				 @settle_us : PLL write to lock
+ * 				 @request_us : when the tune was requested
+ ****************************************************************/
+static void tuneCompleted (uint16_t channel, int lock_result, uint64_t settle_us, uint64_t request_us)
+{
+	uint64_t done_us = FMClock_NowUs();
+	uint32_t freq_khz = FMBand_KHz(channel);
+	char event[CTL_LINE_SIZE];
+
+	(void) pthread_mutex_lock(&freq_mutex);
+	g_tuned_channel = channel;
+	g_tune_settle_us = settle_us;
+	if (lock_result < 0)
+	{
+		g_tune_state = UNLOCKED;
+		g_lock_failures++;
+		FMMetrics_Add(FM_M_TUNE_FAILURES, 1);
+	}
+	else
+	{
+		/* A bounded wait with the right PLL still counts as locked */
+		g_tune_state = LOCKED;
+		if (lock_result > 0)
+		{
+			g_lock_timeouts++;
+			FMMetrics_Add(FM_M_TUNE_TIMEOUTS, 1);
+		}
+		LatHist_Record(&g_settle_hist, settle_us);
+		LatHist_Record(&g_audio_hist, done_us - request_us);
+		FMStore_SetFrequency(freq_khz);
+	}
+	(void) snprintf(event, sizeof(event), "EVENT TUNE %.1f %s %llu",
+					freq_khz / KHZ_PER_MHZ, tuneStateName(g_tune_state), (unsigned long long) settle_us);
+	(void) pthread_mutex_unlock(&freq_mutex);
+
+	FM_PROBE4(tune_done, freq_khz, lock_result, settle_us, done_us - request_us);
+	FlightRec_Log(FLIGHTREC_TUNE, freq_khz, (uint32_t) settle_us, lock_result);
+	FMMetrics_ObserveTune(done_us - request_us);
+	FMMetrics_SetGauge(FM_G_FREQUENCY_KHZ, freq_khz);
+	FMMetrics_SetGauge(FM_G_LOCKED, lock_result >= 0);
+
+	/* API clients get the real "locked" event, not the PLL write */
+	CtlServer_Publish(event);
+}
+
+/****************************************************************
+ * Function Name : tuneStateName
+ * Description   : Name of a tune state for the display
+ * Returns       : the name
+ * Params        @state : the tune state
+ ****************************************************************/
+static const char* tuneStateName (uint8_t state)
+{
+	switch (state)
+	{
+	case LOCKED:
+		return "LOCKED";
+	case UNLOCKED:
+		return "NOT LOCKED";
+	default:
+		return "TUNING";
+	}
+}
+
+/****************************************************************
+ * Function Name : standbyDeadline
+ * Description   : When the FM thread should put the tuner in standby
+ * 					if no command comes: after g_standby_muted_s
+ * 					muted or g_standby_idle_s without input
+ * Returns       : the monotonic time, 0 = never
+ * Params        @last_input_us : the last tune, audio or scan command
+ * 				 @muted_since_us : the last audio command
+ ****************************************************************/
+static uint64_t standbyDeadline (uint64_t last_input_us, uint64_t muted_since_us)
+{
+	uint64_t deadline_us = 0;
+	uint64_t idle_us = 0;
+	uint8_t audio = 0;
+
+	(void) pthread_mutex_lock(&audio_mutex);
+	audio = g_audio;
+	(void) pthread_mutex_unlock(&audio_mutex);
+
+	if (!audio && (g_standby_muted_s > 0))
+	{
+		deadline_us = muted_since_us + (g_standby_muted_s * USEC_PER_SEC);
+	}
+	if (g_standby_idle_s > 0)
+	{
+		idle_us = last_input_us + (g_standby_idle_s * USEC_PER_SEC);
+		if ((deadline_us == 0) || (idle_us < deadline_us))
+		{
+			deadline_us = idle_us;
+		}
+	}
+	return deadline_us;
+}
+
+/****************************************************************
+ * Function Name : setPowerState
+ * Description   : Account the time spent in the current power state
+ * 					and move to a new one
+ * Returns       : N/A
+ * Params        @state : the new PowerState
+ ****************************************************************/
+static void setPowerState (uint8_t state)
+{
+	uint64_t now_us = FMClock_NowUs();
+
+	(void) pthread_mutex_lock(&freq_mutex);
+	FlightRec_Log(FLIGHTREC_POWER, state, g_power_state, 0);
+	g_power_us[g_power_state] += now_us - g_power_since_us;
+	g_power_since_us = now_us;
+	g_power_state = state;
+	if (state == POWER_STANDBY)
+	{
+		g_standbys++;
+	}
+	(void) pthread_mutex_unlock(&freq_mutex);
+	FMMetrics_SetGauge(FM_G_POWER_STATE, state);
+}
+
+/****************************************************************
+ * Function Name : wakeCompleted
+ * Description   : Record a wake from standby: input to lock latency
+ * 					and whether the lock came within the cap
+ * Returns       : N/A
+ * Params        @lock_result : TEA5767_Wake or TEA5767_WaitForLock result
+ * 				 @input_us : first post of the input that woke the tuner
+ * 				 @mute : the audio state it woke up with
+ ****************************************************************/
+static void wakeCompleted (int lock_result, uint64_t input_us, uint8_t mute)
+{
+	uint64_t ready_us = FMClock_NowUs();
+
+	(void) pthread_mutex_lock(&freq_mutex);
+	g_wakes++;
+	if (lock_result != 0)
+	{
+		g_wake_over_cap++;
+	}
+	LatHist_Record(&g_wake_hist, ready_us - input_us);
+	(void) pthread_mutex_unlock(&freq_mutex);
+
+	setPowerState(mute ? POWER_MUTED : POWER_PLAYING);
+	CtlServer_Publish("EVENT POWER ON");
+}
+
+/****************************************************************
+ * Function Name : powerStateName
+ * Description   : Name of a power state for the stats dump
+ * Returns       : the name
+ * Params        @state : the power state
+ ****************************************************************/
+static const char* powerStateName (uint8_t state)
+{
+	switch (state)
+	{
+	case POWER_PLAYING:
+		return "playing";
+	case POWER_MUTED:
+		return "muted";
+	default:
+		return "standby";
+	}
+}
+
+/****************************************************************
+ * Function Name : postCommand
+ * Description   : Add a command for the FM thread and wake it up
+ * Returns       : N/A
+ * Params        @flag : the Flag bit of the command
+ ****************************************************************/
+static void postCommand (uint8_t flag)
+{
+	FMMetrics_SetGauge(FM_G_QUEUE_DEPTH, __builtin_popcount(CmdQueue_Post(&g_commands, flag)));
+	FMMetrics_Add(FM_M_COMMANDS, 1);
+}
+
+/****************************************************************
+ * Function Name : requestTune
+ * Description   : Set the channel to tune to and post TUNE
+ * Returns       : N/A
+ * Params        @channel : the band channel
+ ****************************************************************/
+static void requestTune (uint16_t channel)
+{
+	(void) pthread_mutex_lock(&freq_mutex);
+	g_channel = channel;
+	(void) pthread_mutex_unlock(&freq_mutex);
+	postCommand(TUNE);
+}
+
+#ifdef I2C_SIMULATOR
+/****************************************************************
+ * Function Name : postLoadCommand
+ * Description   : Post a synthetic command to the FM thread the way
+ * 					the buttons and the signal monitor do
+ * Returns       : N/A
+ * Params        @command : the load generator's command
+ ****************************************************************/
+static void postLoadCommand (LoadGen_Command command)
+{
+	uint16_t channel = 0;
+
+	switch (command)
+	{
+	case LOADGEN_TUNE:
+		/* Step up one channel, wrapping at the top of the band */
+		(void) pthread_mutex_lock(&freq_mutex);
+		channel = ((g_channel + 1) < FMBand_Channels()) ? (g_channel + 1) : 0;
+		(void) pthread_mutex_unlock(&freq_mutex);
+		requestTune(channel);
+		break;
+	case LOADGEN_AUDIO:
+		(void) pthread_mutex_lock(&audio_mutex);
+		g_audio = !g_audio;
+		(void) pthread_mutex_unlock(&audio_mutex);
+		postCommand(AUDIO);
+		break;
+	default:
+		postCommand(SIGNAL_POLL);
+		break;
+	}
+}
+#endif
+
+/****************************************************************
+ * Function Name : scanBand
+ * Description   : Sweep the band muted, keep the channels that
+ * 					peak above FMSCANNER_MIN_LEVEL as the scan table and
+ * 					return to the tuned station. A button or API
+ * 					command aborts the sweep so it is served at once.
+ * Returns       : number of stations found, -1 if aborted or failed
+ * Params        @p_device : the FM module
+ ****************************************************************/
+static int scanBand (TEA5767_FM_module *p_device)
+{
+	static uint8_t levels[FMBAND_MAX_CHANNELS];	// Level per channel of this sweep
+	static uint8_t stereo[FMBAND_MAX_CHANNELS];
+	uint16_t channels = FMBand_Channels();
+	FMStore_Station found[FM_STORE_SCAN_SIZE];
+	TEA5767_Status status;
+	char event[CTL_LINE_SIZE];
+	uint16_t channel = 0;
+	uint16_t count = 0;
+	uint8_t aborted = 0;
+	uint64_t settle_us = 0;
+	int lock_result = 0;
+
+	/* Probes yield the bus to every other class between channels */
+	p_device->bus_class = I2CSCHED_BACKGROUND;
+	for (channel = 0; channel < channels; channel++)
+	{
+		/* User commands win over the sweep */
+		aborted = (CmdQueue_Pending(&g_commands) & (TUNE | AUDIO)) ? 1 : 0;
+		if (aborted)
+		{
+			break;
+		}
+
+		if (TEA5767_ProbeChannel(p_device, channel, SCAN_SETTLE, &status) < 0)
+		{
+			aborted = 1;
+			break;
+		}
+		levels[channel] = status.level;
+		stereo[channel] = status.stereo;
+	}
+
+	if (!aborted)
+	{
+		count = FMScanner_FindStations(levels, stereo, channels, found, FM_STORE_SCAN_SIZE);
+		FMStore_SetScanTable(found, count);
+	}
+
+	/* Back to the station that was playing */
+	p_device->bus_class = I2CSCHED_INTERACTIVE;
+	(void) pthread_mutex_lock(&freq_mutex);
+	channel = g_tuned_channel;
+	(void) pthread_mutex_unlock(&freq_mutex);
+	lock_result = TEA5767_TuneChannel(p_device, channel);
+	if (lock_result == 0)
+	{
+		lock_result = TEA5767_WaitForLock(p_device, LOCK_TIMEOUT, &settle_us);
+	}
+	if (lock_result < 0)
+	{
+		perror("ERROR: scanBand - Failed to return to the tuned station.");
+	}
+
+	if (aborted)
+	{
+		CtlServer_Publish("EVENT SCAN ABORTED");
+		return -1;
+	}
+	(void) snprintf(event, sizeof(event), "EVENT SCAN %u", count);
+	CtlServer_Publish(event);
+	return count;
+}
+
+/****************************************************************
+ * Function Name : scannerThreadFunc
+ * Description   : The thread function for the background scanner:
+ * 					a second TEA5767 on SCANNER_DEV_PATH, always muted,
+ * 					sweeps the band every g_scan_period_s and sleeps in
+ * 					standby in between, so the station list stays
+ * 					fresh without touching the tuner that is playing.
+ * 					Periodic sweeps are incremental; a SCAN command
+ * 					sweeps the whole band at once.
+ * Returns       : N/A
+ * Params        @arg : arguments of the thread function
+ ****************************************************************/
+static void* scannerThreadFunc (void* arg)
+{
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	uint64_t posted_us[CMDQ_BITS];	// When the SCAN taken was first posted
+	uint64_t next_us = 0;			// Start of the next periodic sweep
+	uint8_t pending = WAIT;
+	FMScanner_Plan plan;			// What each channel showed last
+
+	FMClock_RegisterThread();
+	if (g_scan_period_s == 0)
+	{
+		return NULL;
+	}
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+
+	/* The scanner is the only client of its bus */
+	I2CSched_Bus *p_bus = I2CSched_Open(SCANNER_DEV_PATH);
+	if (p_bus == NULL)
+	{
+		perror("ERROR: scannerThreadFunc - Failed to open I2C bus");
+		return NULL;
+	}
+
+	/* Create the scanner module, muted for good */
+	TEA5767_FM_module scanner;
+	scanner.p_bus = p_bus;
+	scanner.device_addr = FM_MODULE_ADDR;
+	scanner.auto_injection = 0;
+	scanner.bus_class = I2CSCHED_BACKGROUND;
+	if (TEA5767_Init(&scanner, 0, 1) < 0)
+	{
+		perror("ERROR: scannerThreadFunc - Failed to init the scanner module");
+		return NULL;
+	}
+	FMScanner_PlanInit(&plan, scanner.channels);
+
+	while (1)
+	{
+		next_us = FMClock_NowUs() + ((uint64_t) g_scan_period_s * USEC_PER_SEC);
+		if (sweepBand(&scanner, &plan, (pending & SCAN) ? 1 : 0) < 0)
+		{
+			(void) __atomic_add_fetch(&g_scanner_failures, 1, __ATOMIC_RELAXED);
+		}
+
+		/* Sleep in standby until the period is up or a SCAN comes */
+		if (TEA5767_StandbyON(&scanner) < 0)
+		{
+			perror("ERROR: scannerThreadFunc - Failed to enter standby.");
+		}
+		pending = CmdQueue_TakeTimed(&g_scanner_commands, posted_us, next_us);
+		if (pending != WAIT)
+		{
+			CmdQueue_Done(&g_scanner_commands, pending, posted_us);
+		}
+	}
+	return NULL;
+}
+
+/****************************************************************
+ * Function Name : sweepBand
+ * Description   : Probe the channels the plan picks on the scanner
+ * 					module, SCANNER_STEP apart, and publish the
+ * 					stations found; the scan table is rewritten only
+ * 					when they changed
+ * Returns       : number of stations found, -1 if a probe failed
+ * Params        @p_scanner : the scanner module
+ * 				 @p_plan : last level of every channel
+ * 				 @full : 1 to probe every channel
+ ****************************************************************/
+static int sweepBand (TEA5767_FM_module *p_scanner, FMScanner_Plan *p_plan, uint8_t full)
+{
+	FMStore_Station found[FM_STORE_SCAN_SIZE];
+	FMStore_Station stored[FM_STORE_SCAN_SIZE];
+	TEA5767_Status status;
+	char event[CTL_LINE_SIZE];
+	uint64_t start_us = FMClock_NowUs();
+	uint16_t channel = 0;
+	uint16_t count = 0;
+	uint16_t stored_count = 0;
+	uint8_t changed = 0;
+
+	if (p_scanner->standby_mode && (TEA5767_Wake(p_scanner, 1) < 0))
+	{
+		perror("ERROR: sweepBand - Failed to wake the scanner.");
+		return -1;
+	}
+	(void) FMScanner_PlanSweep(p_plan, full);
+	for (channel = 0; channel < p_plan->channels; channel++)
+	{
+		if (!p_plan->probe[channel])
+		{
+			continue;
+		}
+		if (TEA5767_ProbeChannel(p_scanner, channel, SCAN_SETTLE, &status) < 0)
+		{
+			perror("ERROR: sweepBand - Failed to probe a channel.");
+			FMScanner_PlanEnd(p_plan);
+			return -1;
+		}
+		(void) FMScanner_PlanRecord(p_plan, channel, status.level, status.stereo);
+		FMClock_SleepUs(SCANNER_STEP * USEC_PER_MS);
+	}
+	FMScanner_PlanEnd(p_plan);
+
+	/* Channels left out keep their last probe */
+	count = FMScanner_FindStations(p_plan->levels, p_plan->stereo, p_plan->channels, found, FM_STORE_SCAN_SIZE);
+	FMScanner_Publish(found, count, FMClock_NowUs() - start_us, &p_plan->stats);
+
+	/* Most sweeps find the same stations, their levels aside: the
+	 * state file is only rewritten when a frequency changed */
+	stored_count = FMStore_CopyScan(stored);
+	changed = (count != stored_count);
+	for (channel = 0; (channel < count) && !changed; channel++)
+	{
+		changed = (found[channel].freq_khz != stored[channel].freq_khz);
+	}
+	if (changed)
+	{
+		FMStore_SetScanTable(found, count);
+	}
+	(void) snprintf(event, sizeof(event), "EVENT STATIONS %u", count);
+	CtlServer_Publish(event);
+	return count;
+}
+
+/****************************************************************
+ * Function Name : controlServerThreadFunc
+ * Description   : Serve the local control socket: every client on
+ * 					one epoll loop, no thread per client
+ * Returns       : N/A
+ * Params        @arg : arguments of the thread function
+ ****************************************************************/
+static void* controlServerThreadFunc (void* arg)
+{
+	DLMon_Task *p_task = (DLMon_Task *) arg;	// Deadline contract of this task
+	(void) FMMetrics_RegisterThread(p_task->p_name);
+	(void) MemBudget_RegisterThread(p_task->p_name);
+	(void) FlightRec_RegisterThread(p_task->p_name);
+	// Woken by its clients, not by the clock
+	FMClock_UnregisterThread();
+
+	if (CtlServer_Open(g_control_path) < 0)
+	{
+		perror("ERROR: controlServerThreadFunc - Failed to open the control socket.");
+		return NULL;
+	}
+	(void) CtlServer_Run(&handleControlCommand);
+	return NULL;
+}
+
+/****************************************************************
+ * Function Name : handleControlCommand
+ * Description   : Serve one control command:
+ * 					TUNE <MHz> | MUTE | UNMUTE | SCAN | STATUS |
+ * 					PRESET <n> | PRESET SAVE <n> | STATIONS | SCANNER
+ * Returns       : N/A
+ * Params        @p_command : the command line
+ * 				 @p_reply : to store the reply line
+ * 				 @reply_size : size of p_reply
+ ****************************************************************/
+static void handleControlCommand (const char *p_command, char *p_reply, size_t reply_size)
+{
+	const FMStore_Station *p_stations = NULL;
+	FMStore_Station stored[FM_STORE_SCAN_SIZE];
+	FMScanner_Result scanned;
+	char word[16] = "";
+	char argument[16] = "";
+	float freq = 0;
+	int channel = 0;
+	unsigned int slot = 0;
+	uint32_t freq_khz = 0;
+	uint16_t i = 0;
+	uint16_t count = 0;
+	int used = 0;
+
+	if (sscanf(p_command, "%15s", word) != 1)
+	{
+		(void) snprintf(p_reply, reply_size, "ERR EMPTY COMMAND");
+		return;
+	}
+
+	if (strcasecmp(word, "TUNE") == 0)
+	{
+		/* Snapped to the nearest channel of the band */
+		if ((sscanf(p_command, "%*15s %f", &freq) != 1) || (freq <= 0)
+			|| ((channel = FMBand_Index((uint32_t) ((freq * KHZ_PER_MHZ) + 0.5f))) == FMBAND_NONE))
+		{
+			(void) snprintf(p_reply, reply_size, "ERR FREQUENCY OUT OF BAND");
+			return;
+		}
+		requestTune((uint16_t) channel);
+		(void) snprintf(p_reply, reply_size, "OK TUNING %.1f", CHANNEL_MHZ(channel));
+	}
+	else if ((strcasecmp(word, "MUTE") == 0) || (strcasecmp(word, "UNMUTE") == 0))
+	{
+		(void) pthread_mutex_lock(&audio_mutex);
+		g_audio = (strcasecmp(word, "UNMUTE") == 0);
+		(void) pthread_mutex_unlock(&audio_mutex);
+		postCommand(AUDIO);
+		(void) snprintf(p_reply, reply_size, "OK %s", word);
+	}
+	else if (strcasecmp(word, "SCAN") == 0)
+	{
+		/* With a scanner the tuner that is playing is left alone */
+		if (g_scan_period_s > 0)
+		{
+			(void) CmdQueue_Post(&g_scanner_commands, SCAN);
+		}
+		else
+		{
+			postCommand(SCAN);
+		}
+		(void) snprintf(p_reply, reply_size, "OK SCANNING");
+	}
+	else if (strcasecmp(word, "SCANNER") == 0)
+	{
+		/* Sweeps done, age of the last one and its station count */
+		if ((g_scan_period_s == 0) || (FMScanner_Read(&scanned) < 0))
+		{
+			(void) snprintf(p_reply, reply_size, (g_scan_period_s == 0) ? "ERR NO SCANNER" : "ERR NO SWEEP YET");
+			return;
+		}
+		(void) snprintf(p_reply, reply_size, "OK %u %llu %u", scanned.sweeps,
+						(unsigned long long) ((FMClock_NowUs() - scanned.swept_us) / USEC_PER_MS), scanned.count);
+	}
+	else if (strcasecmp(word, "PRESET") == 0)
+	{
+		/* The second word is SAVE or the slot to recall */
+		(void) sscanf(p_command, "%*15s %15s", argument);
+		if (strcasecmp(argument, "SAVE") == 0)
+		{
+			if ((sscanf(p_command, "%*15s %*15s %u", &slot) != 1) || (slot >= FM_STORE_NUM_PRESETS))
+			{
+				(void) snprintf(p_reply, reply_size, "ERR NO SUCH PRESET");
+				return;
+			}
+			(void) pthread_mutex_lock(&freq_mutex);
+			channel = g_tuned_channel;
+			(void) pthread_mutex_unlock(&freq_mutex);
+			(void) FMStore_SetPreset((uint8_t) slot, FMBand_KHz(channel));
+			(void) snprintf(p_reply, reply_size, "OK PRESET %u %.1f", slot, CHANNEL_MHZ(channel));
+		}
+		else if ((sscanf(argument, "%u", &slot) == 1) && (slot < FM_STORE_NUM_PRESETS)
+				 && ((freq_khz = FMStore_GetPreset((uint8_t) slot)) != FM_STORE_EMPTY_PRESET))
+		{
+			/* Presets keep kHz; one saved in another band does not map */
+			channel = FMBand_Index(freq_khz);
+			if (channel == FMBAND_NONE)
+			{
+				(void) snprintf(p_reply, reply_size, "ERR FREQUENCY OUT OF BAND");
+				return;
+			}
+			requestTune((uint16_t) channel);
+			(void) snprintf(p_reply, reply_size, "OK TUNING %.1f", CHANNEL_MHZ(channel));
+		}
+		else
+		{
+			(void) snprintf(p_reply, reply_size, "ERR NO SUCH PRESET");
+		}
+	}
+	else if (strcasecmp(word, "STATUS") == 0)
+	{
+		(void) pthread_mutex_lock(&freq_mutex);
+		used = snprintf(p_reply, reply_size, "OK %.1f %s", CHANNEL_MHZ(g_tuned_channel), tuneStateName(g_tune_state));
+		(void) pthread_mutex_unlock(&freq_mutex);
+		(void) pthread_mutex_lock(&audio_mutex);
+		used += snprintf(p_reply + used, reply_size - used, " %s", g_audio ? "ON" : "MUTED");
+		(void) pthread_mutex_unlock(&audio_mutex);
+		(void) pthread_mutex_lock(&signal_mutex);
+		(void) snprintf(p_reply + used, reply_size - used, " LEVEL %u %s",
+						g_sigmon.level_q8 / SIGMON_Q8, g_sigmon.mono ? "MONO" : "STEREO");
+		(void) pthread_mutex_unlock(&signal_mutex);
+	}
+	else if (strcasecmp(word, "STATIONS") == 0)
+	{
+		/* The scanner's last sweep, read without a lock, or else a
+		 * copy of the scan table of the state file */
+		if ((g_scan_period_s > 0) && (FMScanner_Read(&scanned) == 0))
+		{
+			p_stations = scanned.stations;
+			count = scanned.count;
+		}
+		else
+		{
+			p_stations = stored;
+			count = FMStore_CopyScan(stored);
+		}
+
+		/* As many stations as fit on one reply line */
+		used = snprintf(p_reply, reply_size, "OK %u", count);
+		for (i = 0; (i < count) && ((size_t) used + 7 < reply_size); i++)
+		{
+			used += snprintf(p_reply + used, reply_size - used, " %.1f",
+							 (float) p_stations[i].freq_khz / KHZ_PER_MHZ);
+		}
+	}
+	else
+	{
+		(void) snprintf(p_reply, reply_size, "ERR UNKNOWN COMMAND");
+	}
+}
+
+/****************************************************************
+ * Function Name : setTaskCpus
+ * Description   : Apply a "-c TASK=CPUS" option. A TASK ending in
+ * 					'*' matches every task starting with the rest.
+ * Returns       : 0 on success, -1 on a bad option
+ * Params        @p_spec : the option argument
+ ****************************************************************/
+static int setTaskCpus (const char *p_spec)
+{
+	const char *p_cpus = strchr(p_spec, '=');
+	uint64_t mask = 0;
+	size_t length = 0;
+	uint8_t prefix = 0;
+	uint8_t matched = 0;
+	uint8_t task = 0;
+
+	if ((p_cpus == NULL) || (RTSched_ParseCpuList(p_cpus + 1, &mask) < 0))
+	{
+		printf("ERROR: main - Bad CPU placement \"%s\"\n", p_spec);
+		return -1;
+	}
+	length = p_cpus - p_spec;
+	if ((length > 0) && (p_spec[length - 1] == '*'))
+	{
+		prefix = 1;
+		length--;
+	}
+
+	for (task = 0; task < NUM_TASKS; task++)
+	{
+		if ((strncmp(g_tasks[task].deadline.p_name, p_spec, length) == 0)
+			&& (prefix || (g_tasks[task].deadline.p_name[length] == '\0')))
+		{
+			g_tasks[task].cpu_mask = mask;
+			matched = 1;
+		}
+	}
+	if (!matched)
+	{
+		printf("ERROR: main - No task matches \"%s\"\n", p_spec);
+		return -1;
+	}
+	return 0;
+}
+
+/****************************************************************
+ * Function Name : isolateTasks
+ * Description   : Apply a "-i CPU" option: the input and FM tasks
+ * 					get the CPU to themselves, the other tasks run on
+ * 					the remaining CPUs. "-c" options given later win.
+ * Returns       : 0 on success, -1 on a bad option
+ * Params        @p_cpu : the option argument
+ ****************************************************************/
+static int isolateTasks (const char *p_cpu)
+{
+	uint64_t reserved = 0;
+	uint64_t others = 0;
+	uint8_t task = 0;
+
+	if ((RTSched_ParseCpuList(p_cpu, &reserved) < 0) || ((reserved & (reserved - 1)) != 0))
+	{
+		printf("ERROR: main - Bad CPU to reserve \"%s\"\n", p_cpu);
+		return -1;
+	}
+	/* With a single CPU there is nothing to keep the others on */
+	others = RTSched_OnlineMask() & ~reserved;
+	if (others == 0)
+	{
+		printf("WARNING: main - Only one CPU online, -i ignored\n");
+		return 0;
+	}
+
+	for (task = 0; task < NUM_TASKS; task++)
+	{
+		g_tasks[task].cpu_mask = g_tasks[task].rt ? reserved : others;
+	}
+	return 0;
+}
+
+/****************************************************************
+ * Function Name : printPlacement
+ * Description   : Report the policy, priority and CPUs of every task
+ * Returns       : N/A
+ * Params        : N/A
+ ****************************************************************/
+static void printPlacement (void)
+{
+	char cpus[RTSCHED_CPU_LIST_SIZE];
+	struct sched_param param;
+	int policy = 0;
+	uint8_t task = 0;
+
+	printf("Placement (%u CPUs online):\n", (unsigned int) __builtin_popcountll(RTSched_OnlineMask()));
+	for (task = 0; task < NUM_TASKS; task++)
+	{
+		if (!g_tasks[task].created)
+		{
+			printf("  %-12s not running\n", g_tasks[task].deadline.p_name);
+			continue;
+		}
+		// A task that already returned has no policy left to report
+		if (pthread_getschedparam(g_tasks[task].thread, &policy, &param) != 0)
+		{
+			printf("  %-12s exited\n", g_tasks[task].deadline.p_name);
+			continue;
+		}
+		RTSched_FormatCpuList(RTSched_GetAffinity(g_tasks[task].thread), cpus, sizeof(cpus));
+		printf("  %-12s %-5s prio %2d  CPUs %s\n", g_tasks[task].deadline.p_name,
+			   (policy == SCHED_FIFO) ? "FIFO" : "OTHER", param.sched_priority, cpus);
+	}
+}
+
+/****************************************************************
+ * Function Name : startChannel
+ * Description   : Map a stored or recorded station to a channel of
+ * 					the band; one outside the band (saved under
+ * 					another band) starts at the first channel
+ * Returns       : the channel
+ * Params        @freq_khz : the station in kHz
+ ****************************************************************/
+static uint16_t startChannel (uint32_t freq_khz)
+{
+	int channel = FMBand_Index(freq_khz);
+
+	if (channel == FMBAND_NONE)
+	{
+		printf("WARNING: main - %.1fMHz is outside the %s band, starting at %.1fMHz\n",
+			   freq_khz / KHZ_PER_MHZ, FMBand_Get()->p_name, CHANNEL_MHZ(0));
+		return 0;
+	}
+	return (uint16_t) channel;
+}
@@ -1,3 +1,52 @@
 #!/bin/bash
 
-gcc -pthread main.c lib/gpio.c lib/gpio.h lib/i2c_bbb.c lib/i2c_bbb.h lib/tea5767_i2c_driver.c lib/tea5767_i2c_driver.h -o fm_receiver -Wall -Werror
+# Usage: ./start.sh [sim] [static] [clock=HZ] [noprobes] | tools
+#   sim    - build fm_receiver_sim against the simulated I2C bus (lib/i2c_sim.c),
+#            so the receiver runs without a TEA5767 attached
+#   static - take every thread stack from a static pool and lock all memory
+#            (FM_STATIC_MEMORY), so nothing is allocated at run time
+#   clock=HZ - fixed TEA5767 clock (32768, 13000000 or 6500000): only that
+#            reference clock profile is compiled in (TEA5767_FIXED_CLOCK)
+#   noprobes - compile the USDT probes (lib/fm_probes.h) out even when
+#            sys/sdt.h is installed (FM_NO_PROBES)
+#   tools  - build the helper tools in tools/ (fm_metrics_reader, encoder_replay,
+#            flight_decode, gpio_bench, client_flood, pll_check, i2c_sched_check)
+
+SOURCES="main.c lib/gpio.c lib/gpio.h lib/gpio_mmap.c lib/gpio_mmap.h lib/gpio_encoder.c lib/gpio_encoder.h lib/i2c_bbb.c lib/i2c_bbb.h lib/tea5767_i2c_driver.c lib/tea5767_i2c_driver.h lib/fm_clock.c lib/fm_clock.h lib/fm_state_store.c lib/fm_state_store.h lib/signal_monitor.c lib/signal_monitor.h lib/latency_hist.c lib/latency_hist.h lib/control_server.c lib/control_server.h lib/fm_metrics.c lib/fm_metrics.h lib/deadline_monitor.c lib/deadline_monitor.h lib/rt_sched.c lib/rt_sched.h lib/mem_budget.c lib/mem_budget.h lib/button_trace.c lib/button_trace.h lib/cmd_queue.c lib/cmd_queue.h lib/fm_band.c lib/fm_band.h lib/i2c_sched.c lib/i2c_sched.h lib/fm_scanner.c lib/fm_scanner.h lib/startup_trace.c lib/startup_trace.h lib/fm_probes.h lib/flight_rec.c lib/flight_rec.h"
+CFLAGS="-pthread -Wall -Werror"
+LIBS="-lrt"
+OUTPUT=fm_receiver
+
+if [ "$1" = "tools" ]; then
+    gcc $CFLAGS tools/fm_metrics_reader.c -o tools/fm_metrics_reader $LIBS || exit $?
+    gcc $CFLAGS tools/encoder_replay.c lib/gpio_encoder.c lib/gpio.c -o tools/encoder_replay $LIBS || exit $?
+    gcc $CFLAGS tools/flight_decode.c lib/flight_rec.c lib/fm_clock.c -o tools/flight_decode $LIBS || exit $?
+    gcc $CFLAGS tools/gpio_bench.c lib/gpio_mmap.c lib/gpio.c lib/fm_clock.c -o tools/gpio_bench $LIBS || exit $?
+    gcc $CFLAGS tools/client_flood.c lib/latency_hist.c lib/fm_clock.c -o tools/client_flood $LIBS || exit $?
+    gcc $CFLAGS tools/pll_check.c lib/tea5767_i2c_driver.c lib/i2c_bbb.c lib/i2c_sched.c lib/fm_clock.c \
+        lib/fm_metrics.c lib/flight_rec.c lib/latency_hist.c lib/fm_band.c -o tools/pll_check $LIBS || exit $?
+    gcc $CFLAGS -DI2C_SIMULATOR tools/i2c_sched_check.c lib/i2c_sched.c lib/i2c_bbb.c lib/i2c_sim.c lib/fm_clock.c \
+        lib/fm_metrics.c lib/flight_rec.c lib/latency_hist.c -o tools/i2c_sched_check $LIBS
+    exit $?
+fi
+
+for arg in "$@"; do
+    case "$arg" in
+    sim)
+        SOURCES="$SOURCES lib/i2c_sim.c lib/i2c_sim.h lib/load_gen.c lib/load_gen.h"
+        CFLAGS="$CFLAGS -DI2C_SIMULATOR"
+        OUTPUT=fm_receiver_sim
+        ;;
+    static)
+        CFLAGS="$CFLAGS -DFM_STATIC_MEMORY"
+        ;;
+    noprobes)
+        CFLAGS="$CFLAGS -DFM_NO_PROBES"
+        ;;
+    clock=*)
+        CFLAGS="$CFLAGS -DTEA5767_FIXED_CLOCK=${arg#clock=}"
+        ;;
+    esac
+done
+
+gcc $CFLAGS $SOURCES -o $OUTPUT $LIBS
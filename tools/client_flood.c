@@ -0,0 +1,533 @@
+/*
+ * client_flood.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ *
+ * Flood the receiver's control socket (lib/control_server.c) with
+ * hundreds of clients from one epoll loop. Each client sends its
+ * commands one at a time, the next as soon as the reply is in: a mix
+ * of TUNE, MUTE/UNMUTE, PRESET and PRESET SAVE, and STATUS. A share of
+ * the clients SUBSCRIBE first and count the events they get, and slow
+ * subscribers never read, so the server has to drop them.
+ *
+ * The report gives the clients accepted, refused and dropped, the
+ * replies and ERR replies, the events each subscriber got against the
+ * best one, and the reply latency. With -k the receiver is sent
+ * SIGUSR1 at the end, so its own control counters go in its dump.
+ *
+ * Usage: client_flood [-c CLIENTS] [-n COMMANDS] [-u PERCENT] [-w SLOW]
+ *                     [-m TUNE/AUDIO/PRESET/STATUS] [-k PID] SOCKET
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // strtoul, calloc, rand_r
+#include <string.h>     // String-handling library
+#include <unistd.h>     // POSIX API
+#include <fcntl.h>      // File controls
+#include <errno.h>      // Error codes
+#include <signal.h>     // kill
+#include <sys/socket.h> // Sockets
+#include <sys/un.h>     // Unix domain sockets
+#include <sys/epoll.h>  // epoll
+
+#include "../lib/fm_clock.h"
+#include "../lib/latency_hist.h"
+
+#define DEFAULT_CLIENTS     300
+#define DEFAULT_COMMANDS    20
+#define DEFAULT_SUBSCRIBERS 25      // Percent of the clients
+#define LINE_SIZE           256
+#define EPOLL_BATCH         64
+#define QUIET_MS            500     // No input this long ends the run
+#define STALL_MS            10000   // No input this long with replies owed is a failure
+
+typedef struct Client {
+    int      fd;                // -1 once closed
+    uint8_t  subscriber;        // Sent SUBSCRIBE first
+    uint8_t  slow;              // Subscribed and never reads
+    uint8_t  closed_by_server;  // Read EOF or an error
+    uint32_t sent;              // Commands sent
+    uint32_t replies;           // Reply lines read
+    uint32_t errors;            // "ERR ..." replies
+    uint32_t events;            // "EVENT ..." lines read
+    uint64_t sent_us;           // When the last command went out
+    uint32_t seed;              // Command picks
+    uint16_t in_length;         // Bytes in input
+    char     input[LINE_SIZE];  // Partial line
+} Client;
+
+static Client *p_clients = NULL;
+static uint32_t num_clients = DEFAULT_CLIENTS;
+static uint32_t commands = DEFAULT_COMMANDS;
+static uint32_t slow_clients = 0;
+static uint32_t total_clients = 0;              // Slow ones first
+static uint8_t mix[4] = { 40, 20, 20, 20 };    // TUNE, AUDIO, PRESET, STATUS
+static LatHist reply_hist;
+static uint32_t refused = 0;                    // connect() failed
+
+/****************************************************************
+ * Function Name : connectClient
+ * Description   : Connect one client to the control socket
+ * Returns       : the socket, -1 if the connection was refused
+ * Params        @p_path: the socket path
+ ****************************************************************/
+static int connectClient (const char *p_path)
+{
+    struct sockaddr_un address;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0)
+    {
+        perror("ERROR: client_flood - Failed to create a socket");
+        return -1;
+    }
+    (void) memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    (void) strncpy(address.sun_path, p_path, sizeof(address.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *) &address, sizeof(address)) < 0)
+    {
+        (void) close(fd);
+        return -1;
+    }
+    (void) fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+/****************************************************************
+ * Function Name : pickCommand
+ * Description   : Pick a client's next command from the mix
+ * Returns       : void
+ * Params        @p_client: the client
+ *               @p_line: to store the line, newline included
+ *               @size: size of p_line
+ ****************************************************************/
+static void pickCommand (Client *p_client, char *p_line, size_t size)
+{
+    uint32_t roll = (uint32_t) rand_r(&p_client->seed) % 100;
+    uint32_t pick = (uint32_t) rand_r(&p_client->seed);
+
+    if (roll < mix[0])
+    {
+        /* 87.9 - 107.9 MHz, on the US and EU grids */
+        (void) snprintf(p_line, size, "TUNE %u.%u\n", 88 + (pick % 20), ((pick / 20) % 5) * 2 + 1);
+    }
+    else if (roll < (uint32_t) (mix[0] + mix[1]))
+    {
+        (void) snprintf(p_line, size, (pick & 1) ? "MUTE\n" : "UNMUTE\n");
+    }
+    else if (roll < (uint32_t) (mix[0] + mix[1] + mix[2]))
+    {
+        (void) snprintf(p_line, size, (pick & 1) ? "PRESET SAVE %u\n" : "PRESET %u\n", (pick >> 1) % 8);
+    }
+    else
+    {
+        (void) snprintf(p_line, size, "STATUS\n");
+    }
+}
+
+/****************************************************************
+ * Function Name : sendLine
+ * Description   : Send one line; it always fits the socket buffer
+ * Returns       : 0 on success, -1 if the socket failed
+ * Params        @p_client: the client
+ *               @p_line: the line
+ ****************************************************************/
+static int sendLine (Client *p_client, const char *p_line)
+{
+    size_t length = strlen(p_line);
+
+    p_client->sent_us = FMClock_NowUs();
+    p_client->sent++;
+    return (send(p_client->fd, p_line, length, MSG_NOSIGNAL) == (ssize_t) length) ? 0 : -1;
+}
+
+/****************************************************************
+ * Function Name : closeClient
+ * Description   : Close a client's socket
+ * Returns       : void
+ * Params        @p_client: the client
+ *               @by_server: 1 if the server closed it first
+ ****************************************************************/
+static void closeClient (Client *p_client, uint8_t by_server)
+{
+    (void) close(p_client->fd);
+    p_client->fd = -1;
+    p_client->closed_by_server = by_server;
+}
+
+/****************************************************************
+ * Function Name : handleLine
+ * Description   : Count one line from the server, and send the
+ *                 next command after a reply
+ * Returns       : 0 on success, -1 if the client failed
+ * Params        @p_client: the client
+ *               @p_line: the line, without newline
+ ****************************************************************/
+static int handleLine (Client *p_client, const char *p_line)
+{
+    char command[LINE_SIZE];
+
+    if (strncmp(p_line, "EVENT ", 6) == 0)
+    {
+        p_client->events++;
+        return 0;
+    }
+    /* A slow subscriber's reply waited for the end of the run */
+    if (!p_client->slow)
+    {
+        LatHist_Record(&reply_hist, FMClock_NowUs() - p_client->sent_us);
+    }
+    p_client->replies++;
+    if (strncmp(p_line, "ERR", 3) == 0)
+    {
+        p_client->errors++;
+    }
+    /* The SUBSCRIBE reply does not count as a command */
+    if (!p_client->slow && ((p_client->sent - p_client->subscriber) < commands))
+    {
+        pickCommand(p_client, command, sizeof(command));
+        return sendLine(p_client, command);
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : readClient
+ * Description   : Read what the server sent a client
+ * Returns       : void
+ * Params        @p_client: the client
+ ****************************************************************/
+static void readClient (Client *p_client)
+{
+    ssize_t received = 0;
+    char *p_newline;
+    size_t line_length;
+
+    while (1)
+    {
+        received = read(p_client->fd, p_client->input + p_client->in_length,
+                        sizeof(p_client->input) - 1 - p_client->in_length);
+        if ((received < 0) && (errno == EAGAIN))
+        {
+            return;
+        }
+        if (received <= 0)
+        {
+            closeClient(p_client, 1);
+            return;
+        }
+        p_client->in_length += (uint16_t) received;
+        p_client->input[p_client->in_length] = '\0';
+        while ((p_newline = strchr(p_client->input, '\n')) != NULL)
+        {
+            *p_newline = '\0';
+            if (handleLine(p_client, p_client->input) < 0)
+            {
+                closeClient(p_client, 1);
+                return;
+            }
+            line_length = (size_t) (p_newline - p_client->input) + 1;
+            p_client->in_length -= (uint16_t) line_length;
+            (void) memmove(p_client->input, p_newline + 1, p_client->in_length + 1);
+        }
+        if (p_client->in_length == (sizeof(p_client->input) - 1))
+        {
+            printf("ERROR: client_flood - Line too long from the server\n");
+            closeClient(p_client, 1);
+            return;
+        }
+    }
+}
+
+/****************************************************************
+ * Function Name : owed
+ * Description   : Count the replies still owed to open clients
+ * Returns       : the count
+ * Params        : N/A
+ ****************************************************************/
+static uint32_t owed (void)
+{
+    uint32_t total = 0;
+    uint32_t id = 0;
+
+    for (id = 0; id < total_clients; id++)
+    {
+        if ((p_clients[id].fd >= 0) && !p_clients[id].slow)
+        {
+            total += p_clients[id].sent - p_clients[id].replies;
+            total += (commands + p_clients[id].subscriber) - p_clients[id].sent;
+        }
+    }
+    return total;
+}
+
+/****************************************************************
+ * Function Name : report
+ * Description   : Print the results
+ * Returns       : number of failed clients (closed with replies
+ *                 owed), 1 if none was accepted
+ * Params        @elapsed_us: length of the flood
+ ****************************************************************/
+static uint32_t report (uint64_t elapsed_us)
+{
+    uint32_t accepted = 0, rejected = 0, dropped = 0, slow_dropped = 0, failed = 0;
+    uint32_t replies = 0, errors = 0, subscribers = 0;
+    uint32_t best_events = 0, least_events = 0xFFFFFFFFU;
+    uint64_t events = 0, missed = 0;
+    Client *p_client;
+    uint32_t id = 0;
+
+    for (id = 0; id < total_clients; id++)
+    {
+        p_client = &p_clients[id];
+        if (p_client->subscriber && !p_client->slow && (p_client->replies > 0))
+        {
+            best_events = (p_client->events > best_events) ? p_client->events : best_events;
+        }
+    }
+    for (id = 0; id < total_clients; id++)
+    {
+        p_client = &p_clients[id];
+        replies += p_client->replies;
+        errors += p_client->errors;
+        if (p_client->replies == 0)
+        {
+            /* Closed by the server without a word: the table was full */
+            rejected += (p_client->sent > 0);
+            continue;
+        }
+        accepted++;
+        if (p_client->slow)
+        {
+            /* Read only at the end: just its fate is known */
+            slow_dropped += p_client->closed_by_server;
+            continue;
+        }
+        dropped += p_client->closed_by_server;
+        failed += p_client->closed_by_server;
+        if (p_client->subscriber)
+        {
+            subscribers++;
+            events += p_client->events;
+            missed += best_events - p_client->events;
+            least_events = (p_client->events < least_events) ? p_client->events : least_events;
+        }
+    }
+
+    printf("Clients: %u accepted, %u rejected (table full), %u refused (connect failed)\n",
+           accepted, rejected, refused);
+    printf("Clients: %u dropped with replies owed, %u of %u slow subscribers dropped\n",
+           dropped, slow_dropped, slow_clients);
+    printf("Commands: %u replies (%u ERR) in %llu ms, %llu replies/s\n", replies, errors,
+           (unsigned long long) (elapsed_us / 1000),
+           (unsigned long long) (elapsed_us ? ((uint64_t) replies * USEC_PER_SEC) / elapsed_us : 0));
+    printf("Events: %u subscribers got %llu events, %u to %u each, %llu behind the best\n", subscribers,
+           (unsigned long long) events, subscribers ? least_events : 0, best_events, (unsigned long long) missed);
+    LatHist_Print("Reply latency", &reply_hist);
+    return failed + (accepted == 0);
+}
+
+/****************************************************************
+ * Function Name : parseMix
+ * Description   : Parse -m TUNE/AUDIO/PRESET/STATUS percentages
+ * Returns       : 0 on success, -1 if they do not add up to 100
+ * Params        @p_spec: the option argument
+ ****************************************************************/
+static int parseMix (const char *p_spec)
+{
+    unsigned int tune = 0, audio = 0, preset = 0, status = 0;
+
+    if ((sscanf(p_spec, "%u/%u/%u/%u", &tune, &audio, &preset, &status) != 4)
+        || ((tune + audio + preset + status) != 100))
+    {
+        printf("ERROR: client_flood - The mix must be four percentages adding up to 100\n");
+        return -1;
+    }
+    mix[0] = (uint8_t) tune;
+    mix[1] = (uint8_t) audio;
+    mix[2] = (uint8_t) preset;
+    mix[3] = (uint8_t) status;
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : printUsage
+ * Description   : Print the command line options
+ * Returns       : void
+ * Params        @p_name: the program name
+ ****************************************************************/
+static void printUsage (const char *p_name)
+{
+    printf("Usage: %s [-c CLIENTS] [-n COMMANDS] [-u PERCENT] [-w SLOW] [-m MIX] [-k PID] SOCKET\n", p_name);
+    printf("  -c CLIENTS  clients connected at once (default %u)\n", DEFAULT_CLIENTS);
+    printf("  -n COMMANDS commands per client (default %u)\n", DEFAULT_COMMANDS);
+    printf("  -u PERCENT  clients that SUBSCRIBE first (default %u)\n", DEFAULT_SUBSCRIBERS);
+    printf("  -w SLOW     extra subscribers that never read\n");
+    printf("  -m MIX      TUNE/AUDIO/PRESET/STATUS percent (default 40/20/20/20)\n");
+    printf("  -k PID      send the receiver SIGUSR1 at the end, for its own counters\n");
+}
+
+int main (int argc, char *argv[])
+{
+    struct epoll_event events[EPOLL_BATCH];
+    char command[LINE_SIZE];
+    uint32_t subscribe_percent = DEFAULT_SUBSCRIBERS;
+    uint64_t start_us = 0;
+    uint64_t last_input_us = 0;
+    uint64_t end_us = 0;
+    Client *p_client;
+    pid_t receiver = 0;
+    uint32_t id = 0;
+    int epoll_fd = -1;
+    int ready = 0;
+    int index = 0;
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "c:k:m:n:u:w:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            num_clients = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'k':
+            receiver = (pid_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'm':
+            if (parseMix(optarg) < 0)
+            {
+                return 1;
+            }
+            break;
+        case 'n':
+            commands = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'u':
+            subscribe_percent = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'w':
+            slow_clients = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        default:
+            printUsage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind != (argc - 1))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    total_clients = num_clients + slow_clients;
+    p_clients = calloc(total_clients, sizeof(Client));
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if ((p_clients == NULL) || (epoll_fd < 0))
+    {
+        perror("ERROR: client_flood - Failed to set up");
+        return 1;
+    }
+    LatHist_Init(&reply_hist);
+
+    /* Connect everyone first, so the clients are all in at once. The
+     * slow subscribers go first, so they get a slot in the table. */
+    for (id = 0; id < total_clients; id++)
+    {
+        p_client = &p_clients[id];
+        p_client->seed = id + 1;
+        p_client->slow = (id < slow_clients);
+        p_client->subscriber = p_client->slow
+                               || ((((id - slow_clients) * 100) / (num_clients ? num_clients : 1)) < subscribe_percent);
+        p_client->fd = connectClient(argv[optind]);
+        if (p_client->fd < 0)
+        {
+            refused++;
+            continue;
+        }
+        if (!p_client->slow)
+        {
+            events[0].events = EPOLLIN | EPOLLRDHUP;
+            events[0].data.u32 = id;
+            (void) epoll_ctl(epoll_fd, EPOLL_CTL_ADD, p_client->fd, &events[0]);
+        }
+    }
+
+    start_us = FMClock_NowUs();
+    for (id = 0; id < total_clients; id++)
+    {
+        p_client = &p_clients[id];
+        if (p_client->fd < 0)
+        {
+            continue;
+        }
+        if (p_client->subscriber)
+        {
+            (void) snprintf(command, sizeof(command), "SUBSCRIBE\n");
+        }
+        else
+        {
+            pickCommand(p_client, command, sizeof(command));
+        }
+        if (sendLine(p_client, command) < 0)
+        {
+            closeClient(p_client, 1);
+        }
+    }
+
+    /* Serve replies until every command is answered and the events
+     * have stopped coming */
+    last_input_us = FMClock_NowUs();
+    while (1)
+    {
+        ready = epoll_wait(epoll_fd, events, EPOLL_BATCH, QUIET_MS / 10);
+        if ((ready < 0) && (errno != EINTR))
+        {
+            perror("ERROR: client_flood - epoll_wait failed");
+            return 1;
+        }
+        for (index = 0; index < ready; index++)
+        {
+            p_client = &p_clients[events[index].data.u32];
+            if (p_client->fd >= 0)
+            {
+                readClient(p_client);
+            }
+        }
+        if (ready > 0)
+        {
+            last_input_us = FMClock_NowUs();
+            if (owed() == 0)
+            {
+                end_us = last_input_us;
+            }
+            continue;
+        }
+        if ((owed() == 0) && ((FMClock_NowUs() - last_input_us) >= (QUIET_MS * 1000ULL)))
+        {
+            break;
+        }
+        if ((FMClock_NowUs() - last_input_us) >= (STALL_MS * 1000ULL))
+        {
+            printf("ERROR: client_flood - No reply for %u ms, %u replies owed\n", STALL_MS, owed());
+            break;
+        }
+    }
+
+    /* A slow subscriber still open has its events queued; one the
+     * server dropped reads EOF after them */
+    for (id = 0; id < slow_clients; id++)
+    {
+        if (p_clients[id].fd >= 0)
+        {
+            readClient(&p_clients[id]);
+        }
+    }
+
+    if (receiver > 0)
+    {
+        (void) kill(receiver, SIGUSR1);
+    }
+    return ((report((end_us ? end_us : last_input_us) - start_us) > 0) || (owed() > 0)) ? 1 : 0;
+}
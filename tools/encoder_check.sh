@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Check the rotary encoder end to end on a generated trace. The trace
+# (tools/encoder_replay -g, random bursts with contact bounce) is first
+# decoded by encoder_replay at speeds 1 to 10, then replayed through the
+# receiver with no waiting. The receiver must replay every edge and
+# decode the same detents, net position included, as the trace itself,
+# with no lost states. Exits non-zero if any step fails.
+#
+# Usage: tools/encoder_check.sh [detents] [seed]
+#   detents - detents in the generated trace (default 200)
+#   seed    - generator seed (default 1)
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set,
+# and tools/encoder_replay (./start.sh tools).
+
+DETENTS=${1:-200}
+SEED=${2:-1}
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+REPLAY=./tools/encoder_replay
+TRACE=/tmp/fm_encoder_check.trace
+SOCKET=/tmp/fm_encoder_check.sock
+LOG=/tmp/fm_encoder_check.log
+
+if [ ! -x "$RECEIVER" ] || [ ! -x "$REPLAY" ]; then
+    echo "Build the receiver and the tools first: ./start.sh sim; ./start.sh tools"
+    exit 1
+fi
+
+# The decoder alone, edge by edge and at each modelled read latency
+"$REPLAY" -g "$DETENTS" -r "$SEED" -x 1,2,5,10 $TRACE > $LOG
+status=$?
+cat $LOG
+expected=$(head -1 $LOG | grep -o '[0-9]* detents (net -\?[0-9]*)')
+if [ $status -ne 0 ] || [ -z "$expected" ]; then
+    echo "encoder_replay failed"
+    rm -f $TRACE
+    exit 1
+fi
+
+# The receiver's encoder task on the same trace
+timeout 120 "$RECEIVER" -s $SOCKET -p $TRACE -x 0 > $LOG 2>&1
+status=$?
+rm -f $TRACE
+encoder=$(grep '^Encoder:' $LOG)
+buttons=$(grep '^Buttons:' $LOG)
+echo "receiver: exit $status, ${buttons#Buttons: }"
+echo "receiver: ${encoder#Encoder: }"
+if [ $status -ne 0 ] || ! echo "$buttons" | grep -q "(0 skipped)" ||
+   ! echo "$encoder" | grep -q "^Encoder: $expected, .* 0 lost$"; then
+    echo "Receiver did not decode $expected"
+    exit 1
+fi
+echo "Receiver decoded $expected"
@@ -0,0 +1,356 @@
+/*
+ * encoder_replay.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ *
+ * Replay the encoder edges of a button trace through the decoder at
+ * several speeds and check that no detent is lost. Each speed models
+ * the edge reader: it wakes LATENCY after an edge and reads both pins
+ * once, so edges closer than that reach the decoder as one state. The
+ * detents decoded from every edge one by one are the reference.
+ *
+ * With -g the trace is first generated: DETENTS detents in bursts of
+ * random direction and speed, with contact bounce.
+ *
+ * Usage: encoder_replay [-g DETENTS [-r SEED]] [-l LATENCY_US] [-x SPEEDS] TRACE
+ * Exit status 1 if a speed lost a detent.
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // strtoul, malloc
+#include <string.h>     // strtok
+#include <unistd.h>     // getopt
+
+#include "../lib/gpio.h"
+#include "../lib/gpio_encoder.h"
+#include "../lib/button_trace.h"
+
+#define ENCODER_A       P9_11
+#define ENCODER_B       P9_13
+#define DEFAULT_LATENCY 50          // us from an edge to the read of both pins
+#define DEFAULT_SPEEDS  "1,2,5,10"
+#define BOUNCE_US       200         // Contact bounce, per bounced edge
+#define BOUNCE_PERMILLE 100         // Edges that bounce
+
+typedef struct Edge {
+    uint64_t at_us;     // Since the start of the trace
+    uint8_t  gpio;
+    uint8_t  level;
+} Edge;
+
+typedef struct Result {
+    uint32_t reads;         // States fed to the decoder
+    uint64_t min_gap_us;    // Closest two edges
+    GPIOEnc_Stats stats;
+} Result;
+
+static uint32_t seed = 1;
+
+/****************************************************************
+ * Function Name : nextRandom
+ * Description   : Step the generator (xorshift32)
+ * Returns       : the next pseudo-random number
+ * Params        : N/A
+ ****************************************************************/
+static uint32_t nextRandom (void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/****************************************************************
+ * Function Name : writeEdge
+ * Description   : Append one record to the trace being generated
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_file: the trace
+ *               @p_last_us: time of the previous record, updated
+ *               @at_us: time of this one
+ *               @gpio: the pin
+ *               @level: its new level
+ ****************************************************************/
+static int writeEdge (FILE *p_file, uint64_t *p_last_us, uint64_t at_us, uint8_t gpio, uint8_t level)
+{
+    BTrace_Record record = { (uint32_t) (at_us - *p_last_us), gpio, level };
+
+    *p_last_us = at_us;
+    return (fwrite(&record, sizeof(record), 1, p_file) == 1) ? 0 : -1;
+}
+
+/****************************************************************
+ * Function Name : generate
+ * Description   : Write a trace of detents turned in bursts, each
+ *                 burst one way at one speed, with bounce
+ * Returns       : 0 on success, -1 on failure
+ * Params        @p_path: the trace file
+ *               @detents: detents to turn
+ ****************************************************************/
+static int generate (const char *p_path, uint32_t detents)
+{
+    /* Clockwise from rest: B falls, A falls, B rises, A rises */
+    static const uint8_t cw_pin[GPIOENC_QUARTERS] = { ENCODER_B, ENCODER_A, ENCODER_B, ENCODER_A };
+    static const uint8_t cw_level[GPIOENC_QUARTERS] = { 0, 0, 1, 1 };
+    BTrace_Header header = { BTRACE_MAGIC, BTRACE_VERSION, sizeof(BTrace_Record), 0, 1, { 0 } };
+    FILE *p_file = fopen(p_path, "wb");
+    uint64_t at_us = 0;
+    uint64_t last_us = 0;
+    uint32_t interval_us = 0;
+    uint32_t burst = 0;
+    uint8_t quarter = 0;
+    uint8_t index = 0;
+    int8_t direction = 1;
+    int failed = 0;
+
+    if (p_file == NULL)
+    {
+        perror("ERROR: encoder_replay - Failed to create the trace");
+        return -1;
+    }
+    failed |= (fwrite(&header, sizeof(header), 1, p_file) != 1);
+
+    /* The recorder logs the rest state first */
+    failed |= writeEdge(p_file, &last_us, 0, ENCODER_A, 1);
+    failed |= writeEdge(p_file, &last_us, 0, ENCODER_B, 1);
+
+    while ((detents > 0) && !failed)
+    {
+        /* A burst: 1 to 20 detents, 3 to 300 ms apart */
+        burst = 1 + (nextRandom() % 20);
+        burst = (burst > detents) ? detents : burst;
+        direction = (nextRandom() & 1) ? 1 : -1;
+        interval_us = 3000 + (nextRandom() % 297000);
+        detents -= burst;
+
+        at_us += 500000;
+        for (; burst > 0; burst--)
+        {
+            for (quarter = 0; quarter < GPIOENC_QUARTERS; quarter++)
+            {
+                index = (direction > 0) ? quarter : (GPIOENC_QUARTERS - 1 - quarter);
+                at_us += interval_us / GPIOENC_QUARTERS;
+                /* Counter-clockwise runs the clockwise edges backwards */
+                failed |= writeEdge(p_file, &last_us, at_us, cw_pin[index],
+                                    (direction > 0) ? cw_level[index] : !cw_level[index]);
+                if ((nextRandom() % 1000) < BOUNCE_PERMILLE)
+                {
+                    failed |= writeEdge(p_file, &last_us, at_us + BOUNCE_US / 2, cw_pin[index],
+                                        (direction > 0) ? !cw_level[index] : cw_level[index]);
+                    failed |= writeEdge(p_file, &last_us, at_us + BOUNCE_US, cw_pin[index],
+                                        (direction > 0) ? cw_level[index] : !cw_level[index]);
+                    at_us += BOUNCE_US;
+                }
+            }
+        }
+    }
+    failed |= (fclose(p_file) != 0);
+    if (failed)
+    {
+        perror("ERROR: encoder_replay - Failed to write the trace");
+        return -1;
+    }
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : load
+ * Description   : Read the encoder edges of a trace
+ * Returns       : the edge count, -1 on failure
+ * Params        @p_path: the trace file
+ *               @pp_edges: to store the edges (malloc'ed)
+ ****************************************************************/
+static int load (const char *p_path, Edge **pp_edges)
+{
+    FILE *p_file = fopen(p_path, "rb");
+    BTrace_Header header;
+    BTrace_Record record;
+    Edge *p_edges = NULL;
+    uint64_t at_us = 0;
+    int capacity = 0;
+    int count = 0;
+
+    if (p_file == NULL)
+    {
+        perror("ERROR: encoder_replay - Failed to open the trace");
+        return -1;
+    }
+    if ((fread(&header, sizeof(header), 1, p_file) != 1) || (header.magic != BTRACE_MAGIC)
+        || (header.version != BTRACE_VERSION) || (header.record_size != sizeof(BTrace_Record)))
+    {
+        printf("ERROR: encoder_replay - %s is not a version %u button trace\n", p_path, BTRACE_VERSION);
+        (void) fclose(p_file);
+        return -1;
+    }
+    while (fread(&record, sizeof(record), 1, p_file) == 1)
+    {
+        at_us += record.delta_us;
+        if ((record.gpio != ENCODER_A) && (record.gpio != ENCODER_B))
+        {
+            continue;
+        }
+        if (count == capacity)
+        {
+            capacity = capacity ? (capacity * 2) : 1024;
+            p_edges = realloc(p_edges, capacity * sizeof(Edge));
+            if (p_edges == NULL)
+            {
+                perror("ERROR: encoder_replay - Out of memory");
+                (void) fclose(p_file);
+                return -1;
+            }
+        }
+        p_edges[count].at_us = at_us;
+        p_edges[count].gpio = record.gpio;
+        p_edges[count].level = record.level;
+        count++;
+    }
+    (void) fclose(p_file);
+    *pp_edges = p_edges;
+    return count;
+}
+
+/****************************************************************
+ * Function Name : replay
+ * Description   : Feed the edges to a decoder the way the reader
+ *                 sees them at a speed
+ * Returns       : void
+ * Params        @p_edges: the edges
+ *               @count: edge count
+ *               @speed: replay speed, 0 = every edge on its own
+ *               @latency_us: edge to read
+ *               @p_result: to store the outcome
+ ****************************************************************/
+static void replay (const Edge *p_edges, int count, uint32_t speed, uint32_t latency_us, Result *p_result)
+{
+    GPIO_Encoder encoder;
+    uint64_t read_us = 0;
+    uint64_t gap_us = 0;
+    uint8_t levels = 0;     // Pin levels, A in bit 1; replayed pins start low
+    int next = 0;
+
+    GPIOEncoder_Init(&encoder, ENCODER_A, ENCODER_B);
+    (void) memset(p_result, 0, sizeof(Result));
+    p_result->min_gap_us = UINT64_MAX;
+
+    /* The recorder logs the start levels first, all at once */
+    while ((next < count) && (p_edges[next].at_us == p_edges[0].at_us))
+    {
+        levels = (p_edges[next].gpio == ENCODER_A) ? ((levels & 1) | (p_edges[next].level << 1))
+                                                   : ((levels & 2) | p_edges[next].level);
+        next++;
+    }
+    encoder.state = levels;
+
+    while (next < count)
+    {
+        /* The reader wakes on this edge and reads both pins once; every
+         * edge up to the read is already in the levels it sees */
+        read_us = (speed > 0) ? ((p_edges[next].at_us / speed) + latency_us) : 0;
+        do
+        {
+            levels = (p_edges[next].gpio == ENCODER_A) ? ((levels & 1) | (p_edges[next].level << 1))
+                                                       : ((levels & 2) | p_edges[next].level);
+            if ((next + 1) < count)
+            {
+                gap_us = (p_edges[next + 1].at_us - p_edges[next].at_us) / ((speed > 0) ? speed : 1);
+                p_result->min_gap_us = (gap_us < p_result->min_gap_us) ? gap_us : p_result->min_gap_us;
+            }
+            next++;
+        } while ((speed > 0) && (next < count) && ((p_edges[next].at_us / speed) <= read_us));
+
+        (void) GPIOEncoder_Feed(&encoder, levels, read_us);
+        p_result->reads++;
+    }
+    GPIOEncoder_GetStats(&encoder, &p_result->stats);
+}
+
+/****************************************************************
+ * Function Name : printUsage
+ * Description   : Print the command line options
+ * Returns       : void
+ * Params        @p_name: the program name
+ ****************************************************************/
+static void printUsage (const char *p_name)
+{
+    printf("Usage: %s [-g DETENTS [-r SEED]] [-l LATENCY_US] [-x SPEEDS] TRACE\n", p_name);
+    printf("  -g DETENTS  generate TRACE first, DETENTS detents with bounce\n");
+    printf("  -r SEED     seed of the generator (default 1)\n");
+    printf("  -l US       edge to read latency of the reader (default %u)\n", DEFAULT_LATENCY);
+    printf("  -x SPEEDS   comma separated replay speeds (default %s)\n", DEFAULT_SPEEDS);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *p_speeds = DEFAULT_SPEEDS;
+    uint32_t latency_us = DEFAULT_LATENCY;
+    uint32_t generate_detents = 0;
+    char speeds[64] = "";
+    char *p_speed = NULL;
+    Edge *p_edges = NULL;
+    Result reference;
+    Result result;
+    int count = 0;
+    int lost = 0;
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "g:r:l:x:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'g':
+            generate_detents = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            seed = (uint32_t) strtoul(optarg, NULL, 10);
+            seed = (seed == 0) ? 1 : seed;
+            break;
+        case 'l':
+            latency_us = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'x':
+            p_speeds = optarg;
+            break;
+        default:
+            printUsage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind != (argc - 1))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if ((generate_detents > 0) && (generate(argv[optind], generate_detents) < 0))
+    {
+        return 1;
+    }
+    count = load(argv[optind], &p_edges);
+    if (count < 0)
+    {
+        return 1;
+    }
+
+    /* Every edge on its own: what the encoder really did */
+    replay(p_edges, count, 0, 0, &reference);
+    printf("%s: %d encoder edges, %u detents (net %d)\n", argv[optind], count,
+           reference.stats.detents, reference.stats.position);
+
+    (void) snprintf(speeds, sizeof(speeds), "%s", p_speeds);
+    for (p_speed = strtok(speeds, ","); p_speed != NULL; p_speed = strtok(NULL, ","))
+    {
+        replay(p_edges, count, (uint32_t) strtoul(p_speed, NULL, 10), latency_us, &result);
+        printf("speed %5s: closest edges %6llu us, %6u reads, %5u skipped states, %3u lost states, "
+               "%u detents (net %d) %s\n",
+               p_speed, (unsigned long long) result.min_gap_us, result.reads, result.stats.skipped,
+               result.stats.invalid, result.stats.detents, result.stats.position,
+               ((result.stats.detents == reference.stats.detents)
+                && (result.stats.position == reference.stats.position)) ? "OK" : "LOST");
+        lost |= (result.stats.detents != reference.stats.detents)
+                || (result.stats.position != reference.stats.position);
+    }
+    free(p_edges);
+    return lost ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * flight_decode.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ *
+ * Print a flight recorder dump (fm_receiver -f, SIGUSR2, a crash or a
+ * watchdog trip) as one timeline: the records of every thread merged
+ * by time, each shown relative to the dump.
+ *
+ * With -b the recorder itself is timed instead: COUNT records logged
+ * back to back, and the cost of one.
+ *
+ * Usage: flight_decode [-n LAST] [-t THREAD] DUMP
+ *        flight_decode -b COUNT
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // strtoul, malloc, qsort
+#include <string.h>     // strcmp, strsignal
+#include <unistd.h>     // getopt
+
+#include "../lib/fm_clock.h"
+#include "../lib/flight_rec.h"
+
+typedef struct Entry {
+    const FlightRec_Record *p_record;
+    const char *p_thread;
+} Entry;
+
+static const char *event_names[FLIGHTREC_EVENTS] = {
+    "NONE", "BUTTON", "CMD_POST", "CMD_TAKE", "I2C_READ", "I2C_WRITE",
+    "I2C_CLOSE", "I2C_REOPEN", "TUNE", "POWER", "AUDIO", "DUMP"
+};
+static const char *power_names[] = { "PLAYING", "MUTED", "STANDBY" };
+
+/****************************************************************
+ * Function Name : reasonName
+ * Description   : Name what made the receiver dump
+ * Returns       : the name
+ * Params        @reason: signal number or FlightRec_Reason
+ ****************************************************************/
+static const char* reasonName (uint32_t reason)
+{
+    if (reason == FLIGHTREC_WATCHDOG)
+    {
+        return "watchdog";
+    }
+    return strsignal((int) reason);
+}
+
+/****************************************************************
+ * Function Name : byTime
+ * Description   : qsort order of two entries, oldest first
+ * Returns       : <0, 0 or >0
+ * Params        @p_a, @p_b: the entries
+ ****************************************************************/
+static int byTime (const void *p_a, const void *p_b)
+{
+    uint64_t a_us = ((const Entry *) p_a)->p_record->at_us;
+    uint64_t b_us = ((const Entry *) p_b)->p_record->at_us;
+
+    return (a_us > b_us) - (a_us < b_us);
+}
+
+/****************************************************************
+ * Function Name : printArgs
+ * Description   : Print the arguments of a record in words
+ * Returns       : void
+ * Params        @p_record: the record
+ ****************************************************************/
+static void printArgs (const FlightRec_Record *p_record)
+{
+    switch (p_record->event)
+    {
+    case FLIGHTREC_BUTTON:
+        printf("gpio %u", p_record->a);
+        break;
+    case FLIGHTREC_CMD_POST:
+        printf("bits 0x%02x, pending 0x%02x", p_record->a, p_record->b);
+        break;
+    case FLIGHTREC_CMD_TAKE:
+        printf("bits 0x%02x, oldest waited %u us", p_record->a, p_record->b);
+        break;
+    case FLIGHTREC_I2C_READ:
+    case FLIGHTREC_I2C_WRITE:
+        printf("fd %d, %u bytes, ", (int32_t) p_record->a, p_record->b);
+        if (p_record->c < 0)
+        {
+            printf("failed: %s", strerror(-p_record->c));
+        }
+        else
+        {
+            printf("%d done", p_record->c);
+        }
+        break;
+    case FLIGHTREC_I2C_CLOSE:
+        printf("fd %d%s%s", (int32_t) p_record->a, (p_record->c < 0) ? ", failed: " : "",
+               (p_record->c < 0) ? strerror(-p_record->c) : "");
+        break;
+    case FLIGHTREC_I2C_REOPEN:
+        printf("fd %d, %s", (int32_t) p_record->a, (p_record->c < 0) ? "failed" : "ok");
+        break;
+    case FLIGHTREC_TUNE:
+        printf("%u.%u MHz, settle %u us, %s", p_record->a / 1000, (p_record->a % 1000) / 100, p_record->b,
+               (p_record->c < 0) ? "UNLOCKED" : ((p_record->c > 0) ? "LOCKED (timeout)" : "LOCKED"));
+        break;
+    case FLIGHTREC_POWER:
+        printf("%s -> %s", (p_record->b < 3) ? power_names[p_record->b] : "?",
+               (p_record->a < 3) ? power_names[p_record->a] : "?");
+        break;
+    case FLIGHTREC_AUDIO:
+        printf("%s", p_record->a ? "ON" : "MUTED");
+        break;
+    case FLIGHTREC_DUMP:
+        printf("%s", reasonName(p_record->a));
+        break;
+    default:
+        printf("a %u, b %u, c %d", p_record->a, p_record->b, p_record->c);
+        break;
+    }
+}
+
+/****************************************************************
+ * Function Name : benchmark
+ * Description   : Time FlightRec_Log
+ * Returns       : 0
+ * Params        @count: records to log
+ ****************************************************************/
+static int benchmark (uint32_t count)
+{
+    uint64_t start_us = 0;
+    uint64_t elapsed_us = 0;
+    uint32_t index = 0;
+
+    FlightRec_Init(NULL);
+    (void) FlightRec_RegisterThread("bench");
+    start_us = FMClock_NowUs();
+    for (index = 0; index < count; index++)
+    {
+        FlightRec_Log(FLIGHTREC_I2C_WRITE, 3, 5, (int32_t) index);
+    }
+    elapsed_us = FMClock_NowUs() - start_us;
+    printf("%u records in %llu us: %llu ns per record\n", count, (unsigned long long) elapsed_us,
+           (unsigned long long) (count ? ((elapsed_us * 1000) / count) : 0));
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : printUsage
+ * Description   : Print the command line options
+ * Returns       : void
+ * Params        @p_name: the program name
+ ****************************************************************/
+static void printUsage (const char *p_name)
+{
+    printf("Usage: %s [-n LAST] [-t THREAD] DUMP\n", p_name);
+    printf("       %s -b COUNT\n", p_name);
+    printf("  -n LAST    only the last LAST records\n");
+    printf("  -t THREAD  only the records of THREAD (e.g. fm, btn_tune, shared)\n");
+    printf("  -b COUNT   time COUNT records instead of decoding\n");
+}
+
+int main (int argc, char *argv[])
+{
+    const char *p_thread = NULL;
+    uint32_t last = 0;
+    FILE *p_file = NULL;
+    FlightRec_Header header;
+    FlightRec_Ring *p_rings = NULL;
+    Entry *p_entries = NULL;
+    uint32_t count = 0;
+    uint32_t ring = 0;
+    uint32_t taken = 0;
+    uint32_t index = 0;
+    uint32_t first = 0;
+    const FlightRec_Record *p_record;
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "b:n:t:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            return benchmark((uint32_t) strtoul(optarg, NULL, 10));
+        case 'n':
+            last = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            p_thread = optarg;
+            break;
+        default:
+            printUsage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind != (argc - 1))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    p_file = fopen(argv[optind], "rb");
+    if (p_file == NULL)
+    {
+        perror("ERROR: flight_decode - Failed to open the dump");
+        return 1;
+    }
+    if ((fread(&header, sizeof(header), 1, p_file) != 1) || (header.magic != FLIGHTREC_MAGIC)
+        || (header.version != FLIGHTREC_VERSION) || (header.record_size != sizeof(FlightRec_Record))
+        || (header.ring_size != FLIGHTREC_RING_SIZE) || (header.rings > FLIGHTREC_MAX_RINGS))
+    {
+        printf("ERROR: flight_decode - %s is not a version %u flight record\n", argv[optind], FLIGHTREC_VERSION);
+        (void) fclose(p_file);
+        return 1;
+    }
+    p_rings = malloc(header.rings * sizeof(FlightRec_Ring));
+    p_entries = malloc(header.rings * FLIGHTREC_RING_SIZE * sizeof(Entry));
+    if ((p_rings == NULL) || (p_entries == NULL)
+        || (fread(p_rings, sizeof(FlightRec_Ring), header.rings, p_file) != header.rings))
+    {
+        printf("ERROR: flight_decode - %s is truncated\n", argv[optind]);
+        (void) fclose(p_file);
+        return 1;
+    }
+    (void) fclose(p_file);
+
+    /* The last ring_size records of each ring, oldest overwritten */
+    for (ring = 0; ring < header.rings; ring++)
+    {
+        p_rings[ring].name[FLIGHTREC_NAME_SIZE - 1] = '\0';
+        if ((p_thread != NULL) && (strcmp(p_thread, p_rings[ring].name) != 0))
+        {
+            continue;
+        }
+        taken = (p_rings[ring].head < FLIGHTREC_RING_SIZE) ? p_rings[ring].head : FLIGHTREC_RING_SIZE;
+        for (index = 0; index < taken; index++)
+        {
+            p_record = &p_rings[ring].records[index];
+            if ((p_record->event == FLIGHTREC_NONE) || (p_record->event >= FLIGHTREC_EVENTS))
+            {
+                continue;
+            }
+            p_entries[count].p_record = p_record;
+            p_entries[count].p_thread = p_rings[ring].name;
+            count++;
+        }
+    }
+    qsort(p_entries, count, sizeof(Entry), &byTime);
+
+    printf("Flight record: dumped on %s, %llu.%03llu s after start, %u threads, %u records\n",
+           reasonName(header.reason), (unsigned long long) ((header.dump_us - header.start_us) / USEC_PER_SEC),
+           (unsigned long long) (((header.dump_us - header.start_us) % USEC_PER_SEC) / 1000), header.rings, count);
+    first = ((last > 0) && (last < count)) ? (count - last) : 0;
+    for (index = first; index < count; index++)
+    {
+        p_record = p_entries[index].p_record;
+        printf("%10.3f ms  %-12s %-11s ", ((double) p_record->at_us - (double) header.dump_us) / 1000.0,
+               p_entries[index].p_thread, event_names[p_record->event]);
+        printArgs(p_record);
+        printf("\n");
+    }
+
+    free(p_entries);
+    free(p_rings);
+    return 0;
+}
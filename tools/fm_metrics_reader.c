@@ -0,0 +1,194 @@
+/*
+ * fm_metrics_reader.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ *
+ * Print the receiver's shared memory metrics in the Prometheus text
+ * format. The segment is mapped read-only once; every scrape after
+ * that is plain memory loads, with no call into the receiver.
+ *
+ * Usage: fm_metrics_reader [-n NAME] [-i SECONDS]
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // atoi
+#include <unistd.h>     // POSIX API
+#include <fcntl.h>      // File controls
+#include <sys/mman.h>   // shm_open, mmap
+
+#include "../lib/fm_metrics.h"
+
+#define TUNE_BUCKET_BASE_MS 1   // Upper bound of the first bucket
+
+typedef struct MetricInfo {
+    const char *p_name;     // Prometheus metric name
+    const char *p_help;     // HELP line
+} MetricInfo;
+
+/* Indexed by FMMetrics_Counter, up to the tune histogram */
+static const MetricInfo counter_info[FM_M_TUNE_SUM_US] = {
+    { "fm_i2c_reads_total",          "Register reads that went through" },
+    { "fm_i2c_writes_total",         "Register writes that went through" },
+    { "fm_i2c_bytes_total",          "Bytes moved on the I2C bus" },
+    { "fm_i2c_errors_total",         "Failed I2C reads and writes" },
+    { "fm_i2c_retries_total",        "I2C transfer attempts after a failure" },
+    { "fm_i2c_reopens_total",        "I2C bus reopen and rebind attempts" },
+    { "fm_i2c_elided_writes_total",  "Register writes skipped, image unchanged" },
+    { "fm_button_events_total",      "Completed button presses" },
+    { "fm_commands_total",           "Commands posted to the FM thread" },
+    { "fm_tunes_total",              "Tunes completed" },
+    { "fm_tune_timeouts_total",      "Tunes that did not lock in time" },
+    { "fm_tune_failures_total",      "Tunes that failed" },
+};
+
+/* Indexed by FMMetrics_Gauge */
+static const MetricInfo gauge_info[FM_G_GAUGES] = {
+    { "fm_queue_depth",              "Commands waiting for the FM thread" },
+    { "fm_frequency_khz",            "Tuned frequency" },
+    { "fm_locked",                   "1 if the PLL is locked on the tuned frequency" },
+    { "fm_audio_on",                 "1 if the audio is on" },
+    { "fm_signal_level",             "Smoothed level ADC (0 - 15)" },
+    { "fm_control_clients",          "Control socket clients" },
+    { "fm_power_state",              "Tuner power state: 0 playing, 1 muted, 2 standby" },
+};
+
+/****************************************************************
+ * Function Name : readCounter
+ * Description   : Load one counter of one slot
+ * Returns       : the counter value
+ * Params        @p_segment: the mapped segment
+ *               @slot: the slot index
+ *               @counter: the counter
+ ****************************************************************/
+static uint64_t readCounter (const FMMetrics_Segment *p_segment, uint32_t slot, uint32_t counter)
+{
+    return __atomic_load_n(&p_segment->slot[slot].counters[counter], __ATOMIC_RELAXED);
+}
+
+/****************************************************************
+ * Function Name : printMetrics
+ * Description   : Print one scrape: per-thread counters, the tune
+ *                 latency histogram (summed over threads) and gauges
+ * Returns       : void
+ * Params        @p_segment: the mapped segment
+ ****************************************************************/
+static void printMetrics (const FMMetrics_Segment *p_segment)
+{
+    uint32_t slots = __atomic_load_n(&p_segment->slots, __ATOMIC_RELAXED);
+    uint64_t cumulative = 0;
+    uint64_t sum_us = 0;
+    uint32_t counter = 0;
+    uint32_t slot = 0;
+    uint32_t bucket = 0;
+
+    if (slots > FM_METRICS_MAX_SLOTS)
+    {
+        slots = FM_METRICS_MAX_SLOTS;
+    }
+
+    for (counter = 0; counter < FM_M_TUNE_SUM_US; counter++)
+    {
+        printf("# HELP %s %s\n", counter_info[counter].p_name, counter_info[counter].p_help);
+        printf("# TYPE %s counter\n", counter_info[counter].p_name);
+        for (slot = 0; slot < slots; slot++)
+        {
+            printf("%s{thread=\"%.*s\"} %llu\n", counter_info[counter].p_name,
+                   FM_METRICS_NAME_SIZE, p_segment->slot[slot].name,
+                   (unsigned long long) readCounter(p_segment, slot, counter));
+        }
+    }
+
+    /* Buckets are stored per range; Prometheus wants them cumulative */
+    printf("# HELP fm_tune_latency_seconds Tune request to PLL lock\n");
+    printf("# TYPE fm_tune_latency_seconds histogram\n");
+    for (bucket = 0; bucket < FM_METRICS_TUNE_BUCKETS; bucket++)
+    {
+        for (slot = 0; slot < slots; slot++)
+        {
+            cumulative += readCounter(p_segment, slot, FM_M_TUNE_BUCKET + bucket);
+        }
+        if (bucket < (FM_METRICS_TUNE_BUCKETS - 1))
+        {
+            printf("fm_tune_latency_seconds_bucket{le=\"%g\"} %llu\n",
+                   (double) (TUNE_BUCKET_BASE_MS << bucket) / 1000, (unsigned long long) cumulative);
+        }
+        else
+        {
+            printf("fm_tune_latency_seconds_bucket{le=\"+Inf\"} %llu\n", (unsigned long long) cumulative);
+        }
+    }
+    for (slot = 0; slot < slots; slot++)
+    {
+        sum_us += readCounter(p_segment, slot, FM_M_TUNE_SUM_US);
+    }
+    printf("fm_tune_latency_seconds_sum %.6f\n", (double) sum_us / 1000000);
+    printf("fm_tune_latency_seconds_count %llu\n", (unsigned long long) cumulative);
+
+    for (counter = 0; counter < FM_G_GAUGES; counter++)
+    {
+        printf("# HELP %s %s\n", gauge_info[counter].p_name, gauge_info[counter].p_help);
+        printf("# TYPE %s gauge\n", gauge_info[counter].p_name);
+        printf("%s %lld\n", gauge_info[counter].p_name,
+               (long long) __atomic_load_n(&p_segment->gauges[counter], __ATOMIC_RELAXED));
+    }
+    (void) fflush(stdout);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *p_name = FM_METRICS_NAME;
+    const FMMetrics_Segment *p_segment;
+    int interval = 0;
+    int opt = 0;
+    int fd = 0;
+
+    while ((opt = getopt(argc, argv, "n:i:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            p_name = optarg;
+            break;
+        case 'i':
+            interval = atoi(optarg);
+            break;
+        default:
+            printf("Usage: %s [-n NAME] [-i SECONDS]\n", argv[0]);
+            printf("  -n NAME      shm segment name (default %s)\n", FM_METRICS_NAME);
+            printf("  -i SECONDS   print again every SECONDS instead of once\n");
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    fd = shm_open(p_name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        perror("ERROR: fm_metrics_reader - Failed to open the metrics segment");
+        return 1;
+    }
+    p_segment = mmap(NULL, sizeof(FMMetrics_Segment), PROT_READ, MAP_SHARED, fd, 0);
+    (void) close(fd);
+    if (p_segment == MAP_FAILED)
+    {
+        perror("ERROR: fm_metrics_reader - Failed to map the metrics segment");
+        return 1;
+    }
+
+    if ((__atomic_load_n(&p_segment->magic, __ATOMIC_ACQUIRE) != FM_METRICS_MAGIC)
+        || (p_segment->version != FM_METRICS_VERSION)
+        || (p_segment->size != sizeof(FMMetrics_Segment)))
+    {
+        fprintf(stderr, "ERROR: fm_metrics_reader - Unknown segment layout\n");
+        return 1;
+    }
+
+    printMetrics(p_segment);
+    while (interval > 0)
+    {
+        (void) sleep(interval);
+        printMetrics(p_segment);
+    }
+    return 0;
+}
@@ -0,0 +1,323 @@
+/*
+ * gpio_bench.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ *
+ * Check and time the mapped GPIO backend (lib/gpio_mmap.c) on a
+ * stand-in file, off the board. Every level pattern of the five buttons
+ * is written into the stand-in and read back with GPIOMmap_ReadAll and
+ * GPIOMmap_ReadValue; then one scan of the buttons is timed through the
+ * mapping and through the file reads the sysfs path makes.
+ *
+ * With -w a level is written into the stand-in instead, to press or
+ * release a button of a receiver started with -G FILE.
+ *
+ * Usage: gpio_bench [-n COUNT] FILE
+ *        gpio_bench -w GPIO=LEVEL FILE
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // strtoul, mkstemp
+#include <string.h>     // strchr
+#include <unistd.h>     // getopt, read, close
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap
+
+#include "../lib/gpio.h"
+#include "../lib/gpio_mmap.h"
+#include "../lib/fm_clock.h"
+
+#define DEFAULT_COUNT   100000
+
+/* The receiver's buttons: P9_24, P9_26, P9_18, P9_27, P9_12 */
+static const uint8_t buttons[] = { P9_24, P9_26, P9_18, P9_27, P9_12 };
+#define NUM_BUTTONS (sizeof(buttons) / sizeof(buttons[0]))
+
+static volatile uint32_t sink = 0;      // Keeps the timed reads
+
+/****************************************************************
+ * Function Name : mapStandIn
+ * Description   : Map the stand-in for writing, the way the
+ *                 hardware would change the levels
+ * Returns       : the mapping, NULL on failure
+ * Params        @p_path: the stand-in file
+ ****************************************************************/
+static volatile uint8_t* mapStandIn (const char *p_path)
+{
+    void *p_map = NULL;
+    int fd = open(p_path, O_RDWR);
+
+    if (fd < 0)
+    {
+        perror("ERROR: gpio_bench - Failed to open the stand-in");
+        return NULL;
+    }
+    p_map = mmap(NULL, GPIOMMAP_BANKS * GPIOMMAP_BANK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void) close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        perror("ERROR: gpio_bench - Failed to map the stand-in");
+        return NULL;
+    }
+    return (volatile uint8_t *) p_map;
+}
+
+/****************************************************************
+ * Function Name : setLevel
+ * Description   : Set the level of one pin in the stand-in
+ * Returns       : void
+ * Params        @p_standin: the writable mapping
+ *               @gpio: the GPIO number
+ *               @level: 1 = high, 0 = low
+ ****************************************************************/
+static void setLevel (volatile uint8_t *p_standin, uint8_t gpio, uint8_t level)
+{
+    volatile uint32_t *p_datain = (volatile uint32_t *) (p_standin + GPIOMMAP_STANDIN_DATAIN(gpio / 32));
+
+    if (level)
+    {
+        (void) __atomic_fetch_or(p_datain, 1U << (gpio % 32), __ATOMIC_RELAXED);
+    }
+    else
+    {
+        (void) __atomic_fetch_and(p_datain, ~(1U << (gpio % 32)), __ATOMIC_RELAXED);
+    }
+}
+
+/****************************************************************
+ * Function Name : writeLevel
+ * Description   : Handle -w GPIO=LEVEL
+ * Returns       : 0 on success, 1 on failure
+ * Params        @p_spec: GPIO=LEVEL
+ *               @p_path: the stand-in file
+ ****************************************************************/
+static int writeLevel (const char *p_spec, const char *p_path)
+{
+    const char *p_equal = strchr(p_spec, '=');
+    uint32_t gpio = (uint32_t) strtoul(p_spec, NULL, 10);
+    uint8_t pin = (uint8_t) gpio;
+    volatile uint8_t *p_standin = NULL;
+
+    if ((p_equal == NULL) || (gpio >= (GPIOMMAP_BANKS * 32)))
+    {
+        printf("ERROR: gpio_bench - Expected GPIO=LEVEL with a GPIO below %u\n", GPIOMMAP_BANKS * 32);
+        return 1;
+    }
+    /* Opening creates and sizes the stand-in if it does not exist */
+    if (GPIOMmap_Open(p_path, &pin, 1) < 0)
+    {
+        return 1;
+    }
+    GPIOMmap_Close();
+    p_standin = mapStandIn(p_path);
+    if (p_standin == NULL)
+    {
+        return 1;
+    }
+    setLevel(p_standin, pin, (strtoul(p_equal + 1, NULL, 10) != 0));
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : verify
+ * Description   : Read back every level pattern of the buttons
+ * Returns       : number of mismatches
+ * Params        @p_standin: the writable mapping
+ ****************************************************************/
+static uint32_t verify (volatile uint8_t *p_standin)
+{
+    uint32_t pattern = 0;
+    uint32_t levels = 0;
+    uint32_t errors = 0;
+    uint8_t index = 0;
+
+    for (pattern = 0; pattern < (1U << NUM_BUTTONS); pattern++)
+    {
+        for (index = 0; index < NUM_BUTTONS; index++)
+        {
+            setLevel(p_standin, buttons[index], ((pattern >> index) & 1));
+        }
+        levels = GPIOMmap_ReadAll();
+        if (levels != pattern)
+        {
+            printf("ERROR: gpio_bench - Wrote 0x%02x, ReadAll gave 0x%02x\n", pattern, levels);
+            errors++;
+        }
+        for (index = 0; index < NUM_BUTTONS; index++)
+        {
+            if (GPIOMmap_ReadValue(buttons[index]) != (int) ((pattern >> index) & 1))
+            {
+                printf("ERROR: gpio_bench - Pattern 0x%02x, GPIO %u read wrong\n", pattern, buttons[index]);
+                errors++;
+            }
+        }
+    }
+    /* Leave every button released */
+    for (index = 0; index < NUM_BUTTONS; index++)
+    {
+        setLevel(p_standin, buttons[index], 0);
+    }
+    /* Pins that were not opened fall back to sysfs */
+    if (GPIOMmap_ReadValue(P9_11) != -1)
+    {
+        printf("ERROR: gpio_bench - GPIO %u read although it was not opened\n", P9_11);
+        errors++;
+    }
+    printf("Verify: %u patterns of %u buttons, %u mismatches\n", 1U << NUM_BUTTONS, (uint32_t) NUM_BUTTONS,
+           errors);
+    return errors;
+}
+
+/****************************************************************
+ * Function Name : printCost
+ * Description   : Print the cost of one scan of the buttons
+ * Returns       : void
+ * Params        @p_name: what was timed
+ *               @count: scans
+ *               @elapsed_us: their total time
+ ****************************************************************/
+static void printCost (const char *p_name, uint32_t count, uint64_t elapsed_us)
+{
+    printf("  %-26s %8llu ns per scan\n", p_name,
+           (unsigned long long) (count ? ((elapsed_us * 1000) / count) : 0));
+}
+
+/****************************************************************
+ * Function Name : benchmark
+ * Description   : Time one scan of the buttons through each path
+ * Returns       : 0 on success, 1 on failure
+ * Params        @count: scans per path
+ ****************************************************************/
+static int benchmark (uint32_t count)
+{
+    char value_path[] = "/tmp/gpio_bench_valueXXXXXX";
+    uint64_t start_us = 0;
+    uint32_t scan = 0;
+    uint8_t index = 0;
+    char state = '0';
+    int fd = mkstemp(value_path);
+
+    /* A regular file stands in for the sysfs value files */
+    if ((fd < 0) || (write(fd, "0\n", 2) != 2))
+    {
+        perror("ERROR: gpio_bench - Failed to create the value file");
+        return 1;
+    }
+
+    printf("Benchmark: %u scans of %u buttons\n", count, (uint32_t) NUM_BUTTONS);
+    start_us = FMClock_NowUs();
+    for (scan = 0; scan < count; scan++)
+    {
+        sink += GPIOMmap_ReadAll();
+    }
+    printCost("mmap, GPIOMmap_ReadAll", count, FMClock_NowUs() - start_us);
+
+    start_us = FMClock_NowUs();
+    for (scan = 0; scan < count; scan++)
+    {
+        for (index = 0; index < NUM_BUTTONS; index++)
+        {
+            sink += (uint32_t) GPIOMmap_ReadValue(buttons[index]);
+        }
+    }
+    printCost("mmap, GPIOMmap_ReadValue", count, FMClock_NowUs() - start_us);
+
+    start_us = FMClock_NowUs();
+    for (scan = 0; scan < count; scan++)
+    {
+        for (index = 0; index < NUM_BUTTONS; index++)
+        {
+            sink += (uint32_t) GPIO_ReadFd(fd);
+        }
+    }
+    printCost("file, lseek + read", count, FMClock_NowUs() - start_us);
+    (void) close(fd);
+
+    /* What GPIO_ReadValue does for every read */
+    start_us = FMClock_NowUs();
+    for (scan = 0; scan < count; scan++)
+    {
+        for (index = 0; index < NUM_BUTTONS; index++)
+        {
+            fd = open(value_path, O_RDONLY);
+            if ((fd < 0) || (read(fd, &state, 1) != 1))
+            {
+                perror("ERROR: gpio_bench - Failed to read the value file");
+                (void) unlink(value_path);
+                return 1;
+            }
+            (void) close(fd);
+            sink += (uint32_t) (state == '1');
+        }
+    }
+    printCost("file, open + read + close", count, FMClock_NowUs() - start_us);
+    (void) unlink(value_path);
+    return 0;
+}
+
+/****************************************************************
+ * Function Name : printUsage
+ * Description   : Print the command line options
+ * Returns       : void
+ * Params        @p_name: the program name
+ ****************************************************************/
+static void printUsage (const char *p_name)
+{
+    printf("Usage: %s [-n COUNT] FILE\n", p_name);
+    printf("       %s -w GPIO=LEVEL FILE\n", p_name);
+    printf("  -n COUNT       scans timed per read path (default %u)\n", DEFAULT_COUNT);
+    printf("  -w GPIO=LEVEL  set one pin of the stand-in FILE, e.g. 60=1\n");
+}
+
+int main (int argc, char *argv[])
+{
+    const char *p_write = NULL;
+    uint32_t count = DEFAULT_COUNT;
+    volatile uint8_t *p_standin = NULL;
+    uint32_t errors = 0;
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "n:w:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'w':
+            p_write = optarg;
+            break;
+        default:
+            printUsage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind != (argc - 1))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (p_write != NULL)
+    {
+        return writeLevel(p_write, argv[optind]);
+    }
+
+    if (GPIOMmap_Open(argv[optind], buttons, NUM_BUTTONS) < 0)
+    {
+        return 1;
+    }
+    p_standin = mapStandIn(argv[optind]);
+    if (p_standin == NULL)
+    {
+        return 1;
+    }
+    errors = verify(p_standin);
+    if (benchmark(count) != 0)
+    {
+        return 1;
+    }
+    GPIOMmap_Close();
+    return (errors > 0) ? 1 : 0;
+}
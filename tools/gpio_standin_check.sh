@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Check the mapped GPIO path end to end on a stand-in file. Starts the
+# receiver with -G on a fresh stand-in, presses forward three times
+# and then tune with tools/gpio_bench -w, and checks from the console
+# that each forward press stepped one 200 kHz channel (US band) and
+# that the tune press put the new station on the screen. Exits
+# non-zero if a press was missed or the station is not the one
+# expected.
+#
+# Usage: tools/gpio_standin_check.sh
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set,
+# and tools/gpio_bench (./start.sh tools).
+
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+BENCH=./tools/gpio_bench
+STANDIN=/tmp/fm_gpio_standin_check.standin
+STATE=/tmp/fm_gpio_standin_check.state
+SOCKET=/tmp/fm_gpio_standin_check.sock
+LOG=/tmp/fm_gpio_standin_check.log
+FORWARD=115     # P9_27
+TUNE=60         # P9_12
+
+if [ ! -x "$RECEIVER" ] || [ ! -x "$BENCH" ]; then
+    echo "Build the receiver and the tools first: ./start.sh sim; ./start.sh tools"
+    exit 1
+fi
+
+# press GPIO: hold the button for 100 ms, then let it go for 100 ms
+press () {
+    "$BENCH" -w "$1=1" $STANDIN && sleep 0.1 && "$BENCH" -w "$1=0" $STANDIN && sleep 0.1
+}
+
+# screen: the console with each screen update on its own line
+screen () {
+    tr '\r' '\n' < $LOG
+}
+
+rm -f $STANDIN $STATE $SOCKET
+"$RECEIVER" -b US -G $STANDIN -t $STATE -s $SOCKET > $LOG 2>&1 &
+pid=$!
+# The console is block buffered into the log, so wait for the
+# control socket instead of the first screen
+for i in $(seq 1 50); do
+    [ -S $SOCKET ] && break
+    sleep 0.1
+done
+
+status=0
+press $FORWARD && press $FORWARD && press $FORWARD && press $TUNE || status=1
+sleep 0.5
+kill -TERM $pid
+wait $pid
+
+start=$(screen | grep '^Frequency:' | head -1 | cut -d' ' -f2)
+expected=$(awk -v start="$start" 'BEGIN { printf "%.1f", start + 0.6 }')
+steps=$(screen | grep '^Tuning Frequency:' | cut -d' ' -f3 | paste -sd' ')
+tuned=$(screen | grep '^Frequency:' | tail -1 | cut -d' ' -f2)
+echo "Started on ${start:-nothing}, forward steps: ${steps:-none}, tuned to ${tuned:-nothing}"
+rm -f $STANDIN $STATE $SOCKET
+if [ $status -ne 0 ] || [ -z "$start" ] || [ "$(echo $steps | wc -w)" -ne 3 ] || [ "$tuned" != "$expected" ]; then
+    echo "Expected three steps and a tune to $expected"
+    exit 1
+fi
@@ -0,0 +1,227 @@
+/*
+ * i2c_sched_check.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ *
+ * Check the priority classes of the I2C bus scheduler (lib/i2c_sched.c)
+ * on the simulated bus. Background clients sweep the tuner back to
+ * back, a periodic client polls its status every 10 ms, and an
+ * interactive client writes a tune every 20 ms. For each interactive
+ * transaction the background tickets queued at its begin and the
+ * background grants made before it are counted: it has overtaken the
+ * queue when fewer background transactions went first than were
+ * waiting (one may slip in before it joins the line). Prints the
+ * counts and the bus report, and exits 1 if an interactive
+ * transaction waited behind two or more queued background ones or
+ * none ever found the queue busy.
+ *
+ * Usage: i2c_sched_check [-b CLIENTS] [-n COUNT]
+ *   -b - background clients (default 4)
+ *   -n - interactive transactions (default 100)
+ *
+ * Built against lib/i2c_sim.c by ./start.sh tools.
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // strtoul
+#include <unistd.h>     // getopt
+#include <pthread.h>    // Clients
+
+#include "../lib/i2c_bbb.h"
+#include "../lib/i2c_sched.h"
+#include "../lib/i2c_sim.h"
+#include "../lib/fm_clock.h"
+
+#define DEFAULT_CLIENTS     4
+#define DEFAULT_COUNT       100
+#define MAX_CLIENTS         16
+#define POLL_PERIOD         10000   // us between status polls
+#define TUNE_PERIOD         20000   // us between interactive tunes
+#define IMAGE_SIZE          5
+
+static I2CSched_Bus *p_bus = NULL;
+static volatile uint8_t stop = 0;
+static uint32_t failures = 0;      // Transfers that failed, any client
+
+/****************************************************************
+ * Function Name : transfer
+ * Description   : Run one transaction of the given class: a write of
+ *                 the register image, or a status read
+ * Returns       : 0 on success, -1 on failure
+ * Params        @class: the client's class
+ *               @write: 1 to write, 0 to read
+ ****************************************************************/
+static int transfer (I2CSched_Class class, uint8_t write)
+{
+    BYTE image[IMAGE_SIZE] = { 0x2F, 0x60, 0x10, 0x10, 0x00 };     // 94.7 MHz, high side
+    int result = 0;
+
+    if (I2CSched_Begin(p_bus, class, I2CSIM_TEA5767_ADDR) < 0)
+    {
+        I2CSched_End(p_bus);
+        return -1;
+    }
+    result = write ? I2C_WriteRegisters(I2CSched_Fd(p_bus), image, IMAGE_SIZE)
+                   : I2C_ReadRegisters(I2CSched_Fd(p_bus), image, IMAGE_SIZE);
+    I2CSched_End(p_bus);
+    return (result < 0) ? -1 : 0;
+}
+
+/****************************************************************
+ * Function Name : backgroundThread
+ * Description   : Sweep the tuner back to back, like a band scan
+ * Returns       : NULL
+ * Params        @arg: unused
+ ****************************************************************/
+static void* backgroundThread (void *arg)
+{
+    (void) arg;
+    while (!stop)
+    {
+        if (transfer(I2CSCHED_BACKGROUND, 1) < 0)
+        {
+            __sync_fetch_and_add(&failures, 1);
+        }
+    }
+    return NULL;
+}
+
+/****************************************************************
+ * Function Name : periodicThread
+ * Description   : Poll the status on a fixed period
+ * Returns       : NULL
+ * Params        @arg: unused
+ ****************************************************************/
+static void* periodicThread (void *arg)
+{
+    (void) arg;
+    while (!stop)
+    {
+        if (transfer(I2CSCHED_PERIODIC, 0) < 0)
+        {
+            __sync_fetch_and_add(&failures, 1);
+        }
+        FMClock_SleepUs(POLL_PERIOD);
+    }
+    return NULL;
+}
+
+/****************************************************************
+ * Function Name : backgroundQueue
+ * Description   : Read the background line of the bus
+ * Returns       : void
+ * Params        @p_waiting: to store the background clients waiting
+ *               @p_served: to store the background grants so far
+ ****************************************************************/
+static void backgroundQueue (uint32_t *p_waiting, uint32_t *p_served)
+{
+    (void) pthread_mutex_lock(&p_bus->mutex);
+    *p_waiting = p_bus->waiting[I2CSCHED_BACKGROUND];
+    *p_served = p_bus->serving[I2CSCHED_BACKGROUND];
+    (void) pthread_mutex_unlock(&p_bus->mutex);
+}
+
+static void printUsage (const char *p_name)
+{
+    printf("Usage: %s [-b CLIENTS] [-n COUNT]\n", p_name);
+}
+
+int main (int argc, char *argv[])
+{
+    pthread_t background[MAX_CLIENTS];
+    pthread_t periodic;
+    uint32_t clients = DEFAULT_CLIENTS;
+    uint32_t count = DEFAULT_COUNT;
+    uint32_t index = 0;
+    uint32_t waiting = 0;
+    uint32_t waiting_held = 0;
+    uint32_t served_before = 0;
+    uint32_t served_after = 0;
+    uint32_t queued = 0;            // Interactive transactions that found a queue
+    uint32_t queued_total = 0;      // Background tickets they found waiting
+    uint32_t overtaken = 0;         // Of those, granted ahead of the queue
+    uint32_t late = 0;              // Waited behind two or more queued ones
+    uint64_t next_us = 0;
+    BYTE image[IMAGE_SIZE] = { 0x2F, 0x60, 0x10, 0x10, 0x00 };     // 94.7 MHz, high side
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "b:n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            clients = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'n':
+            count = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        default:
+            printUsage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if ((clients == 0) || (clients > MAX_CLIENTS) || (count == 0))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    p_bus = I2CSched_Open(I2C_2_DEV_PATH);
+    if (p_bus == NULL)
+    {
+        printf("ERROR: i2c_sched_check - Failed to open the simulated bus\n");
+        return 1;
+    }
+    for (index = 0; index < clients; index++)
+    {
+        (void) pthread_create(&background[index], NULL, backgroundThread, NULL);
+    }
+    (void) pthread_create(&periodic, NULL, periodicThread, NULL);
+
+    next_us = FMClock_NowUs() + TUNE_PERIOD;
+    for (index = 0; index < count; index++)
+    {
+        FMClock_SleepUntilUs(next_us);
+        next_us += TUNE_PERIOD;
+
+        /* The queue as this transaction joins it, and the background
+         * grants made by the time it holds the bus */
+        backgroundQueue(&waiting, &served_before);
+        if (I2CSched_Begin(p_bus, I2CSCHED_INTERACTIVE, I2CSIM_TEA5767_ADDR) < 0)
+        {
+            __sync_fetch_and_add(&failures, 1);
+        }
+        backgroundQueue(&waiting_held, &served_after);
+        if (I2C_WriteRegisters(I2CSched_Fd(p_bus), image, IMAGE_SIZE) < 0)
+        {
+            __sync_fetch_and_add(&failures, 1);
+        }
+        I2CSched_End(p_bus);
+
+        if (waiting > 0)
+        {
+            queued++;
+            queued_total += waiting;
+            overtaken += ((served_after - served_before) < waiting) ? 1 : 0;
+        }
+        late += ((served_after - served_before) >= 2) ? 1 : 0;
+    }
+    stop = 1;
+    for (index = 0; index < clients; index++)
+    {
+        (void) pthread_join(background[index], NULL);
+    }
+    (void) pthread_join(periodic, NULL);
+
+    printf("Interactive: %u transactions, %u found background ones queued (%u on average), "
+           "%u went ahead of them, %u waited behind two or more\n",
+           count, queued, queued ? (queued_total / queued) : 0, overtaken, late);
+    I2CSched_Print();
+    if (failures > 0)
+    {
+        printf("%u transfers failed\n", failures);
+    }
+    return ((late == 0) && (overtaken > 0) && (failures == 0)) ? 0 : 1;
+}
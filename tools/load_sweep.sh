@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# Sweep the synthetic control-plane load and print one line per step,
+# to find where coalescing and tail latency start to climb. A step
+# fails if the receiver exits non-zero, prints no report, or a device
+# has failed commands or posted ones that were neither coalesced nor
+# served; the script exits non-zero if any step failed.
+#
+# Usage: tools/load_sweep.sh [seconds] [devices] [sources] [mix] [rate ...]
+#   seconds - run time of each step (default 5)
+#   devices - simulated tuners, the receiver's own included (default 1)
+#   sources - concurrent command sources (default 8)
+#   mix     - tune/audio/poll percent (default 60/20/20)
+#   rate    - offered events/s of each step (default 50 100 200 400 800 1600)
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set.
+
+SECONDS_PER_STEP=${1:-5}
+DEVICES=${2:-1}
+SOURCES=${3:-8}
+MIX=${4:-60/20/20}
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+SOCKET=/tmp/fm_load_sweep.sock
+LOG=/tmp/fm_load_sweep.log
+FAILED=0
+
+shift $(( $# < 4 ? $# : 4 ))
+if [ $# -eq 0 ]; then
+    set -- 50 100 200 400 800 1600
+fi
+
+printf "%8s %10s %8s %8s %10s %10s %10s %10s\n" \
+    "offered" "achieved" "dropped" "coalesc" "served/s" "done p50" "done p99" "CPU/event"
+for rate in "$@"; do
+    "$RECEIVER" -s $SOCKET -L "sources=$SOURCES,devices=$DEVICES,rate=$rate,mix=$MIX,seconds=$SECONDS_PER_STEP" > $LOG 2>&1
+    status=$?
+    # Totals over every device; latencies are the worst device's
+    awk -v rate="$rate" -v status=$status '
+        /^Load: .* events in / { achieved = $7; sub(/\(/, "", achieved); dropped = $9 }
+        /^Load: .* CPU per event/ { cpu = $5 }
+        /^Load device / {
+            devices++
+            posted += $4; coalesced += $6; served_s += substr($11, 2) + 0
+            if (($4 != $6 + $9) || ($12 != 0)) bad = bad " device " substr($3, 1, length($3) - 1)
+            for (i = 1; i <= NF; i++) {
+                if ($i == "p50") { p50 = $(i + 1) + 0; if (p50 > max50) max50 = p50 }
+                if ($i == "p99" && $(i - 1) != "wait") { p99 = $(i + 1) + 0; if (p99 > max99) max99 = p99 }
+            }
+        }
+        END {
+            if (status != 0) bad = bad " exit " status
+            if (devices == 0) bad = bad " no report"
+            printf "%8s %10s %8s %7d%% %10d %7d us %7d us %7s us%s\n", rate, achieved, dropped,
+                   posted ? (coalesced * 100) / posted : 0, served_s, max50, max99, cpu,
+                   (bad != "") ? "  FAILED:" bad : ""
+            exit (bad != "")
+        }' $LOG || FAILED=1
+done
+exit $FAILED
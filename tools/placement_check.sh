@@ -0,0 +1,100 @@
+#!/bin/bash
+
+# Check that -c and -i place the tasks where they say, from the
+# placement report the receiver prints at start-up. Each case runs a
+# one second load test, so the receiver exits on its own:
+#   - "-c fm=LAST -c btn_*=0" pins those tasks and leaves the rest free
+#   - "-i LAST" moves the input and FM tasks onto the last CPU and the
+#     others off it (two CPUs or more)
+#   - "-c fm=N", a CPU that is not online, is refused at start-up
+#   - under "taskset -c 0", "-c fm=1" is reported as not allowed and
+#     fm runs on CPU 0 (two CPUs or more, needs taskset)
+# Prints one line per case and exits non-zero if any case fails. The
+# latency effect of a placement is measured by tools/sched_compare.sh.
+#
+# Usage: tools/placement_check.sh
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set.
+
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+SOCKET=/tmp/fm_placement_check.sock
+LOG=/tmp/fm_placement_check.log
+CPUS=$(nproc --all)
+LAST=$((CPUS - 1))
+RT_TASKS="fm btn_audio btn_digit btn_back btn_forward btn_tune encoder"
+OTHER_TASKS="display signal control scanner"
+FAILED=0
+
+if [ ! -x "$RECEIVER" ]; then
+    echo "Build the receiver first: ./start.sh sim"
+    exit 1
+fi
+
+# The receiver's CPU list for CPUs first to last
+cpu_list () {
+    if [ "$1" -eq "$2" ]; then echo "$1"; else echo "$1-$2"; fi
+}
+
+# start [prefix command] -- options: run the receiver, keep its log
+start () {
+    local prefix=()
+    while [ "$1" != "--" ]; do prefix+=("$1"); shift; done
+    shift
+    "${prefix[@]}" "$RECEIVER" -s $SOCKET -L sources=1,rate=1,seconds=1 "$@" > $LOG 2>&1
+}
+
+# expect TASK CPUS: check one line of the placement report
+expect () {
+    local got
+    got=$(awk -v task="$1" '$1 == task && $(NF - 1) == "CPUs" { print $NF; exit }' $LOG)
+    if [ "$got" != "$2" ]; then
+        echo "    $1 on CPUs ${got:-?}, expected $2"
+        return 1
+    fi
+}
+
+# result NAME STATUS: print and count one case
+result () {
+    if [ "$2" -eq 0 ]; then
+        printf "%-40s ok\n" "$1"
+    else
+        printf "%-40s FAILED\n" "$1"
+        FAILED=1
+    fi
+}
+
+echo "Placement check on $CPUS CPUs"
+
+start -- -c fm=$LAST -c "btn_*=0"
+status=0
+expect fm $LAST || status=1
+for task in btn_audio btn_digit btn_back btn_forward btn_tune; do expect $task 0 || status=1; done
+for task in encoder $OTHER_TASKS; do expect $task "$(cpu_list 0 $LAST)" || status=1; done
+result "-c fm=$LAST -c btn_*=0" $status
+
+if [ "$CPUS" -ge 2 ]; then
+    start -- -i $LAST
+    status=0
+    for task in $RT_TASKS; do expect $task $LAST || status=1; done
+    for task in $OTHER_TASKS; do expect $task "$(cpu_list 0 $((LAST - 1)))" || status=1; done
+    result "-i $LAST" $status
+else
+    printf "%-40s skipped, one CPU\n" "-i $LAST"
+fi
+
+start -- -c fm=$CPUS
+status=$?
+grep -q "Bad CPU placement" $LOG && [ $status -ne 0 ]
+result "-c fm=$CPUS refused" $?
+
+if [ "$CPUS" -ge 2 ] && command -v taskset > /dev/null; then
+    start taskset -c 0 -- -c fm=1
+    status=0
+    grep -q "CPUs 1 not allowed for fm" $LOG || { echo "    no warning for fm"; status=1; }
+    expect fm 0 || status=1
+    result "taskset -c 0, -c fm=1" $status
+else
+    printf "%-40s skipped, one CPU or no taskset\n" "taskset -c 0, -c fm=1"
+fi
+
+exit $FAILED
@@ -0,0 +1,152 @@
+/*
+ * pll_check.c
+ * Author: Vy Phan
+ * Created on: 10/18/2026
+ * Last Updated: 10/18/2026
+ *
+ * Check the TEA5767 PLL tables off the board. For every reference
+ * clock profile and every band the driver builds its table
+ * (TEA5767_BuildTables), then each channel's low and high side words
+ * are checked here again from scratch: the word must fit 14 bits and
+ * the LO it synthesizes (N * f_ref / 4) must be within half a PLL
+ * step (f_ref / 8) of the wanted one. Prints one line per profile and
+ * band with its worst error and exits 1 if any channel misses.
+ *
+ * Usage: pll_check [-v]
+ *   -v - print every channel's words and errors
+ */
+
+#include <stdio.h>      // Standard I/O
+#include <stdint.h>     // Fixed-width int type
+#include <stdlib.h>     // llabs
+#include <string.h>     // memset
+#include <unistd.h>     // getopt
+
+#include "../lib/fm_band.h"
+#include "../lib/tea5767_i2c_driver.h"
+
+static const uint32_t clocks[] = { CLOCK_32768HZ, CLOCK_13MHZ, CLOCK_6500KHZ };
+#define NUM_CLOCKS (sizeof(clocks) / sizeof(clocks[0]))
+
+static const char *bands[] = { "US", "EU", "JP" };
+#define NUM_BANDS (sizeof(bands) / sizeof(bands[0]))
+
+static TEA5767_FM_module device;    // Only its tables are used
+
+/****************************************************************
+ * Function Name : checkTable
+ * Description   : Check every word of the table just built for the
+ *                 selected band and clock profile
+ * Returns       : the number of words out of bounds
+ * Params        @verbose: 1 to print every channel
+ *               @p_worst_hz: to store the worst tuning error
+ ****************************************************************/
+static uint32_t checkTable (uint8_t verbose, uint32_t *p_worst_hz)
+{
+    const FMBand *p_band = FMBand_Get();
+    uint32_t misses = 0;
+    uint32_t freq_khz = 0;
+    uint16_t channel = 0;
+    uint8_t hi = 0;
+    int64_t wanted_x4 = 0;
+    int64_t error_x4 = 0;
+
+    *p_worst_hz = 0;
+
+    /* The table must cover the band, first to last channel */
+    if ((device.channels != ((p_band->high_khz - p_band->low_khz) / p_band->step_khz) + 1) ||
+        (FMBand_KHz(0) != p_band->low_khz) || (FMBand_KHz(device.channels - 1) != p_band->high_khz))
+    {
+        printf("    %u channels do not cover %u - %u kHz\n", device.channels, p_band->low_khz, p_band->high_khz);
+        misses++;
+    }
+
+    for (channel = 0; channel < device.channels; channel++)
+    {
+        freq_khz = FMBand_KHz(channel);
+        for (hi = 0; hi < 2; hi++)
+        {
+            /* Kept times 4 so the PLL step (f_ref / 4) stays exact */
+            wanted_x4 = 4 * (((int64_t) freq_khz * 1000) + (hi ? INTERMEDIATE_FREQ : -INTERMEDIATE_FREQ));
+            error_x4 = llabs(((int64_t) device.pll_table[channel][hi] * device.ref_hz) - wanted_x4);
+            if ((error_x4 / 4) > *p_worst_hz)
+            {
+                *p_worst_hz = (uint32_t) (error_x4 / 4);
+            }
+            if (verbose)
+            {
+                printf("    %6u kHz %s side: word %5u, error %5lld Hz\n", freq_khz,
+                       hi ? "high" : "low ", device.pll_table[channel][hi], (long long) (error_x4 / 4));
+            }
+            if ((device.pll_table[channel][hi] > PLL_MAX) || ((error_x4 * 2) > device.ref_hz))
+            {
+                printf("    %u kHz %s side: word %u is off by %lld Hz, bound %u Hz\n", freq_khz,
+                       hi ? "high" : "low", device.pll_table[channel][hi], (long long) (error_x4 / 4),
+                       device.ref_hz / 8);
+                misses++;
+            }
+        }
+    }
+
+    /* The driver reports the same worst error at start-up */
+    if (device.pll_error_hz != *p_worst_hz)
+    {
+        printf("    driver reports a worst error of %u Hz, checked %u Hz\n", device.pll_error_hz, *p_worst_hz);
+        misses++;
+    }
+    return misses;
+}
+
+int main (int argc, char *argv[])
+{
+    uint8_t verbose = 0;
+    uint32_t clock = 0;
+    uint32_t band = 0;
+    uint32_t misses = 0;
+    uint32_t failed = 0;
+    uint32_t worst_hz = 0;
+    int option = 0;
+
+    while ((option = getopt(argc, argv, "vh")) != -1)
+    {
+        switch (option)
+        {
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            printf("Usage: %s [-v]\n", argv[0]);
+            return (option == 'h') ? 0 : 1;
+        }
+    }
+
+    for (clock = 0; clock < NUM_CLOCKS; clock++)
+    {
+        for (band = 0; band < NUM_BANDS; band++)
+        {
+            memset(&device, 0, sizeof(device));
+            if ((TEA5767_SetClockFrequency(clocks[clock]) < 0) || (FMBand_Select(bands[band]) < 0))
+            {
+                failed++;
+                continue;
+            }
+            if (TEA5767_BuildTables(&device) < 0)
+            {
+                printf("%8u Hz clock, %s band: the driver refused its table\n", clocks[clock], bands[band]);
+                failed++;
+                continue;
+            }
+            misses = checkTable(verbose, &worst_hz);
+            printf("%8u Hz clock, %s band: %3u channels, worst error %4u Hz of %4u Hz, %s\n",
+                   clocks[clock], bands[band], device.channels, worst_hz, device.ref_hz / 8,
+                   (misses == 0) ? "ok" : "FAILED");
+            if (misses > 0)
+            {
+                failed++;
+            }
+        }
+    }
+
+    printf("%u of %u profile and band tables failed\n", failed, (uint32_t) (NUM_CLOCKS * NUM_BANDS));
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# Check button trace replay. Writes a short trace (starts on 98.1 MHz,
+# five forward presses, two back presses, then a tune press), replays
+# it twice with no waiting and once at 20 times real speed, and checks
+# that every run:
+#   - exits on its own after the last press
+#   - applies all 16 edges and skips none, counting 8 presses
+#   - ends tuned to 98.7 MHz (three 200 kHz US channels up)
+# and that the two runs with no waiting print the same button and I2C
+# traffic lines. Exits non-zero if any check fails.
+#
+# Usage: tools/replay_check.sh
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set.
+
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+TRACE=/tmp/fm_replay_check.trace
+SOCKET=/tmp/fm_replay_check.sock
+LOG=/tmp/fm_replay_check.log
+FORWARD=115     # P9_27
+BACK=4          # P9_18
+TUNE=60         # P9_12
+FAILED=0
+
+if [ ! -x "$RECEIVER" ]; then
+    echo "Build the receiver first: ./start.sh sim"
+    exit 1
+fi
+
+# byte VALUE: write one byte
+byte () {
+    printf "\\x$(printf %02x "$1")"
+}
+
+# le32 VALUE: write a little-endian 32-bit word
+le32 () {
+    byte $(($1 & 255)); byte $((($1 >> 8) & 255)); byte $((($1 >> 16) & 255)); byte $((($1 >> 24) & 255))
+}
+
+# press GPIO: a press after 200 ms, released 100 ms later
+press () {
+    le32 200000; byte "$1"; byte 1
+    le32 100000; byte "$1"; byte 0
+}
+
+# BTrace_Header: "FBTR", version 1, 6-byte records, 98100 kHz, audio on
+{
+    le32 0x52544246; printf '\x01\x00\x06\x00'; le32 98100; printf '\x01\x00\x00\x00'
+    for i in 1 2 3 4 5; do press $FORWARD; done
+    press $BACK; press $BACK
+    press $TUNE
+} > $TRACE
+
+# replay SPEED OUT: run the trace, keep its result lines in OUT
+replay () {
+    local status
+    timeout 30 "$RECEIVER" -b US -s $SOCKET -p $TRACE -x "$1" > $LOG 2>&1
+    status=$?
+    local frequency=$(grep '^Frequency:' $LOG | tail -1 | cut -d' ' -f2)
+    local buttons=$(grep '^Buttons:' $LOG)
+    printf "Speed %-3s exit %d, %s MHz, %s\n" "$1" $status "${frequency:-?}" "${buttons#Buttons: }"
+    if [ $status -ne 0 ] || [ "$frequency" != "98.7" ] ||
+       ! echo "$buttons" | grep -q "^Buttons: 8 presses, .* 16 edges of 16 (0 skipped)"; then
+        echo "    FAILED"
+        FAILED=1
+    fi
+    grep -E '^Buttons:|^I2C traffic:' $LOG | sed 's/, [0-9]* ms$//' > "$2"
+}
+
+replay 0 $LOG.first
+replay 0 $LOG.second
+replay 20 $LOG.fast
+if ! cmp -s $LOG.first $LOG.second; then
+    echo "Runs with no waiting differ:"
+    diff $LOG.first $LOG.second
+    FAILED=1
+fi
+rm -f $TRACE $LOG.first $LOG.second $LOG.fast
+exit $FAILED
@@ -0,0 +1,100 @@
+#!/bin/bash
+
+# Compare the task jitter, migrations and CPU reservation of the
+# receiver across scheduling and placement options, with a synthetic
+# CPU load.
+#
+# Usage: tools/sched_compare.sh [seconds] [load threads] [label=options ...]
+#   seconds      - how long each run lasts (default 20)
+#   load threads - busy loops competing for the CPUs (default: one per CPU)
+#   label=options - one run per argument, e.g. "float=" "isolated=-i 3"
+#                   (default: "fifo=" "deadline=-d")
+#
+# After the runs, one summary line per run: the periodic tasks on
+# SCHED_DEADLINE, their worst and median p99 release jitter, the CPU
+# reserved and the migrations. The script exits non-zero if a run left
+# no stats dump, or if a periodic task that ran its 50 measuring jobs
+# under -d neither moved to SCHED_DEADLINE nor logged why it stayed.
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set.
+# SCHED_FIFO and SCHED_DEADLINE need root (or CAP_SYS_NICE).
+
+SECONDS_PER_RUN=${1:-20}
+LOAD_THREADS=${2:-$(nproc)}
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+SOCKET=/tmp/fm_sched_compare.sock
+SUMMARY=/tmp/fm_sched_compare.summary
+FAILED=0
+
+if [ ! -x "$RECEIVER" ]; then
+    echo "Build the receiver first: ./start.sh sim"
+    exit 1
+fi
+
+run () {
+    local label=$1
+    shift
+    local log=/tmp/fm_sched_compare_$label.log
+    local load_pids=""
+
+    for i in $(seq "$LOAD_THREADS"); do
+        sh -c 'while :; do :; done' &
+        load_pids="$load_pids $!"
+    done
+
+    "$RECEIVER" -s $SOCKET "$@" > "$log" 2>&1 &
+    local pid=$!
+    sleep "$SECONDS_PER_RUN"
+    kill -USR1 $pid
+    sleep 1
+    kill -TERM $pid
+    wait $pid 2> /dev/null
+    kill $load_pids 2> /dev/null
+
+    echo "=== $label: ${SECONDS_PER_RUN}s, $LOAD_THREADS load threads ==="
+    grep -E "^Task|^Periodic|^SCHED_DEADLINE|SCHED_FIFO refused|^Placement|^  " "$log"
+    echo
+
+    # A periodic task is on a policy line after its jitter line
+    if ! awk -v label="$label" -v deadline="$(echo " $* " | grep -c -- ' -d ')" '
+        /^Task .* period +[0-9]+ us/ { period[$2] = $4; jobs[$2] = $11 + 0 }
+        /^Task .* release jitter/ { p99[$2] = $9 }
+        /^Task .* policy/ {
+            task = $2
+            if (!(task in p99) || period[task] == 0) next
+            periodic++
+            if ($4 == "DEADLINE,") on_deadline++
+            else if (deadline && jobs[task] >= 50 && $0 !~ /refused/) {
+                printf "%s: %s ran %d jobs but stayed on %s with no reason\n", label, task, jobs[task], $4 > "/dev/stderr"
+                bad++
+            }
+            migrations += $6
+            # Insertion sort, for the median
+            for (i = periodic; i > 1 && sorted[i - 1] > p99[task] + 0; i--) sorted[i] = sorted[i - 1]
+            sorted[i] = p99[task] + 0
+        }
+        /^SCHED_DEADLINE reservations/ { reserved = $3 }
+        END {
+            if (periodic == 0) { printf "%s: no stats dump\n", label > "/dev/stderr"; exit 1 }
+            n = periodic
+            printf "%-12s %4d/%-4d %10d %10d %9s %10d\n", label, on_deadline, periodic,
+                   sorted[n], sorted[int((n + 1) / 2)], reserved, migrations
+            exit (bad > 0)
+        }' "$log" >> $SUMMARY; then
+        FAILED=1
+    fi
+}
+
+shift $(( $# < 2 ? $# : 2 ))
+if [ $# -eq 0 ]; then
+    set -- "fifo=" "deadline=-d"
+fi
+
+printf "%-12s %9s %10s %10s %9s %10s\n" "run" "deadline" "p99 worst" "p99 median" "reserved" "migrations" > $SUMMARY
+for config in "$@"; do
+    # Options are split on spaces on purpose
+    run "${config%%=*}" ${config#*=}
+done
+echo "=== Periodic tasks: release jitter in us ==="
+cat $SUMMARY
+exit $FAILED
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Start the receiver several times and print the min, median and max
+# time of every start-up phase, from the entry to main() to the first
+# screen; "exec" is the time from exec to main(). The receiver runs a
+# one second load test each time, so it exits on its own and leaves
+# the state file alone. A run fails if the receiver exits non-zero,
+# misses a phase, or shows the first screen before the first lock
+# (or locks before the first PLL write); the script then exits
+# non-zero.
+#
+# Usage: tools/startup_bench.sh [runs] [options]
+#   runs    - start-ups to measure (default 20)
+#   options - extra receiver options, e.g. "-a" or "-S 30"
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set.
+
+RUNS=${1:-20}
+OPTIONS=${2:-}
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+SOCKET=/tmp/fm_startup_bench.sock
+LOG=/tmp/fm_startup_bench.log
+TIMES=/tmp/fm_startup_bench.times
+PHASES="exec state gpio i2c tasks pll lock display"
+FAILED=0
+
+if [ ! -x "$RECEIVER" ]; then
+    echo "Build the receiver first: ./start.sh sim"
+    exit 1
+fi
+
+: > $TIMES
+for run in $(seq 1 "$RUNS"); do
+    # shellcheck disable=SC2086
+    "$RECEIVER" -s $SOCKET -L sources=1,rate=1,seconds=1 $OPTIONS > $LOG 2>&1
+    status=$?
+    # The last report is the final stats dump, with every phase in
+    awk -v run="$run" -v status=$status -v phases="$PHASES" '
+         /^Startup: exec to main/ { us["exec"] = $5 * 1000 }
+         /^Startup: [a-z0-9]+ +[0-9]+ us/ { us[$2] = $3 }
+         END {
+             if (status != 0) bad = bad " exit " status
+             n = split(phases, names, " ")
+             for (i = 1; i <= n; i++) if (!(names[i] in us)) bad = bad " no " names[i]
+             if (("lock" in us) && ("display" in us) && (us["display"] < us["lock"])) bad = bad " screen before lock"
+             if (("pll" in us) && ("lock" in us) && (us["lock"] < us["pll"])) bad = bad " lock before pll"
+             if (bad != "") { printf "Run %d:%s\n", run, bad > "/dev/stderr"; exit 1 }
+             for (phase in us) printf "%s %d\n", phase, us[phase]
+         }' $LOG >> $TIMES || FAILED=1
+done
+
+printf "%-8s %10s %10s %10s   (%s runs, us from main)\n" "phase" "min" "median" "max" "$RUNS"
+for phase in $PHASES; do
+    grep "^$phase " $TIMES | cut -d' ' -f2 | sort -n | awk -v phase="$phase" '
+        { v[NR] = $1 }
+        END {
+            if (NR == 0) { printf "%-8s %10s\n", phase, "-"; exit }
+            printf "%-8s %10d %10d %10d\n", phase, v[1], v[int((NR + 1) / 2)], v[NR]
+        }'
+done
+exit $FAILED
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Replay one button trace against several builds of the receiver and
+# print their latency and bus-traffic numbers side by side.
+#
+# Usage: tools/trace_bench.sh TRACE [speed] [receiver ...]
+#   TRACE    - a trace recorded with fm_receiver -r TRACE
+#   speed    - replay speed, 1 = real time, 0 = no waiting (default 1)
+#   receiver - builds to compare (default ./fm_receiver_sim)
+#
+# Record on the target with ./fm_receiver -r session.trace, then build
+# each version with ./start.sh sim and copy the binary aside.
+
+TRACE=$1
+SPEED=${2:-1}
+SOCKET=/tmp/fm_trace_bench.sock
+
+if [ ! -r "$TRACE" ]; then
+    echo "Usage: $0 TRACE [speed] [receiver ...]"
+    exit 1
+fi
+shift $(( $# < 2 ? $# : 2 ))
+if [ $# -eq 0 ]; then
+    set -- ./fm_receiver_sim
+fi
+
+for receiver in "$@"; do
+    log=/tmp/fm_trace_bench_$(basename "$receiver").log
+    # The receiver exits on its own after the last replayed press
+    "$receiver" -s $SOCKET -p "$TRACE" -x "$SPEED" > "$log" 2>&1
+    echo "=== $receiver: $TRACE at speed $SPEED (exit $?) ==="
+    grep -E "^Buttons|^I2C traffic|^Simulator|^Tune|^Time to audio: n|^Task (fm|btn)" "$log"
+    echo
+done
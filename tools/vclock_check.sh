@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# Check the virtual clock (-V) of the simulator build:
+#   - speed: a short load test on the virtual clock must finish at
+#     least ten times faster than the same test on the real clock
+#   - repeatability: several virtual runs of a longer load test must
+#     print the same report on stdout, apart from what stays real (CPU
+#     times, memory and the start-up timing). Errors go unbuffered to
+#     stderr (e.g. GPIO on a host without it) and would land in the
+#     middle of a report line, so stderr is kept apart and not compared.
+# Prints the run times and exits non-zero if either check fails.
+#
+# Usage: tools/vclock_check.sh [runs] [spec]
+#   runs - virtual runs to compare (default 3)
+#   spec - load spec of those runs (default sources=4,rate=200,seconds=30)
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set.
+
+RUNS=${1:-3}
+SPEC=${2:-sources=4,rate=200,seconds=30}
+SHORT=sources=2,rate=50,seconds=5
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+SOCKET=/tmp/fm_vclock_check.sock
+LOG=/tmp/fm_vclock_check.log
+ERRORS=/tmp/fm_vclock_check.err
+FAILED=0
+
+if [ ! -x "$RECEIVER" ]; then
+    echo "Build the receiver first: ./start.sh sim"
+    exit 1
+fi
+
+# run_ms [options]: run the receiver and print its wall time in ms
+run_ms () {
+    local start=$(date +%s%N)
+    "$RECEIVER" -s $SOCKET "$@" > $LOG 2> $ERRORS || echo "    $RECEIVER $* exited with $?" >&2
+    echo $((($(date +%s%N) - start) / 1000000))
+}
+
+real_ms=$(run_ms -L $SHORT)
+virtual_ms=$(run_ms -V -L $SHORT)
+echo "-L $SHORT: real clock $real_ms ms, virtual clock $virtual_ms ms"
+if [ $((virtual_ms * 10)) -gt "$real_ms" ]; then
+    echo "    FAILED: the virtual clock is less than ten times faster"
+    FAILED=1
+fi
+
+for run in $(seq 1 "$RUNS"); do
+    ms=$(run_ms -V -L "$SPEC")
+    grep -v -E '^Startup:|CPU|^Memory:' $LOG > $LOG.$run
+    echo "-V -L $SPEC: run $run, $ms ms, $(grep -c '' $LOG.$run) report lines"
+    if [ "$run" -gt 1 ] && ! cmp -s $LOG.1 $LOG.$run; then
+        echo "    FAILED: the report differs from run 1:"
+        diff $LOG.1 $LOG.$run | head -10
+        FAILED=1
+    fi
+done
+rm -f $LOG.* $ERRORS
+exit $FAILED
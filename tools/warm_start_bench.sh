@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Check the warm start from the state file and time it. Each run first
+# leaves a station in a scratch state file (a short tune load test with
+# its own seed), then starts the receiver again on that file with a
+# poll-only load and checks that the first screen shows that station.
+# It prints the min, median and max time from exec to the first PLL
+# write ("exec to main" plus the "pll" phase, so clock tick resolution)
+# and exits non-zero if any start-up tuned somewhere else.
+#
+# Usage: tools/warm_start_bench.sh [runs]
+#   runs - warm starts to check (default 10)
+#
+# Runs the simulator build (./start.sh sim) unless FM_RECEIVER is set.
+
+RUNS=${1:-10}
+RECEIVER=${FM_RECEIVER:-./fm_receiver_sim}
+STATE=/tmp/fm_warm_start.state
+SOCKET=/tmp/fm_warm_start.sock
+LOG=/tmp/fm_warm_start.log
+TIMES=/tmp/fm_warm_start.times
+
+if [ ! -x "$RECEIVER" ]; then
+    echo "Build the receiver first: ./start.sh sim"
+    exit 1
+fi
+
+: > $TIMES
+misses=0
+for run in $(seq 1 "$RUNS"); do
+    rm -f $STATE
+    # Leave a station behind: the last screen shows the last tune
+    "$RECEIVER" -t $STATE -s $SOCKET -L sources=1,rate=20,seconds=1,mix=100/0/0,seed=$run > $LOG 2>/dev/null
+    saved=$(grep '^Frequency:' $LOG | tail -1 | cut -d' ' -f2)
+
+    # Start on it: polls only, so nothing tunes after the start-up
+    "$RECEIVER" -t $STATE -s $SOCKET -L sources=1,rate=1,seconds=1,mix=0/0/100 > $LOG 2>/dev/null
+    restored=$(grep '^Frequency:' $LOG | head -1 | cut -d' ' -f2)
+    awk '/^Startup: exec to main/ { exec_us = $5 * 1000 }
+         /^Startup: pll +[0-9]+ us/ { pll_us = $3 }
+         END { if (pll_us != "") printf "%d\n", exec_us + pll_us }' $LOG >> $TIMES
+
+    if [ -z "$saved" ] || [ "$saved" != "$restored" ]; then
+        echo "Run $run: saved ${saved:-nothing}, started on ${restored:-nothing}"
+        misses=$((misses + 1))
+    fi
+done
+
+sort -n $TIMES | awk -v runs="$RUNS" -v misses="$misses" '
+    { v[NR] = $1 }
+    END {
+        printf "Warm start: %d of %d runs started on the saved station\n", runs - misses, runs
+        if (NR > 0) printf "Exec to first PLL write: min %d us, median %d us, max %d us\n",
+                           v[1], v[int((NR + 1) / 2)], v[NR]
+    }'
+rm -f $STATE
+[ "$misses" -eq 0 ]